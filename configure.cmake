@@ -1088,3 +1088,17 @@ IF(NOT MSVC)
   )
 ENDIF()
 
+# io_uring with the features the thread pool needs (Linux 5.11 headers)
+CHECK_C_SOURCE_COMPILES("
+  #include <linux/io_uring.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+  int main()
+  {
+    struct io_uring_params p;
+    p.features= IORING_FEAT_NODROP | IORING_FEAT_SINGLE_MMAP;
+    return (int) syscall(__NR_io_uring_setup, 1, &p) + IORING_OP_RECV +
+           IORING_SQ_CQ_OVERFLOW;
+  }"
+  HAVE_IO_URING)
+
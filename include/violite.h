@@ -104,6 +104,9 @@ my_bool vio_is_connected(Vio *vio);
 #ifndef DBUG_OFF
 ssize_t vio_pending(Vio *vio);
 #endif
+/* Buffered reads with data read by the caller, see vio_buff_fill(). */
+my_bool vio_buff_enable(Vio *vio);
+void    vio_buff_fill(Vio *vio, size_t length);
 /* Set timeout for a network operation. */
 extern int vio_timeout(Vio *vio, uint which, int timeout_sec);
 extern void vio_set_wait_callback(void (*before_wait)(void),
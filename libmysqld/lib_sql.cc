@@ -427,7 +427,7 @@ static void emb_free_embedded_thd(MYSQL *mysql)
   thd->clear_data_list();
   thread_count--;
   thd->store_globals();
-  thd->unlink();
+  server_threads.erase(thd);
   delete thd;
   mysql_mutex_unlock(&LOCK_thread_count);
   my_pthread_setspecific_ptr(THR_THD,  0);
@@ -664,7 +664,7 @@ void init_embedded_mysql(MYSQL *mysql, int client_flag)
 void *create_embedded_thd(int client_flag)
 {
   THD * thd= new THD;
-  thd->thread_id= thd->variables.pseudo_thread_id= thread_id++;
+  thd->thread_id= thd->variables.pseudo_thread_id= next_thread_id();
 
   thd->thread_stack= (char*) &thd;
   if (thd->store_globals())
@@ -698,8 +698,8 @@ void *create_embedded_thd(int client_flag)
 
   mysql_mutex_lock(&LOCK_thread_count);
   thread_count++;
-  threads.append(thd);
   mysql_mutex_unlock(&LOCK_thread_count);
+  server_threads.insert(thd);
   thd->mysys_var= 0;
   thd->reset_globals();
   return thd;
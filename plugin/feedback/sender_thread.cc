@@ -92,8 +92,8 @@ static int prepare_for_fill(TABLE_LIST *tables)
   thd->thread_id= thd->variables.pseudo_thread_id= thd_thread_id;
   mysql_mutex_lock(&LOCK_thread_count);
   thread_count++;
-  threads.append(thd);
   mysql_mutex_unlock(&LOCK_thread_count);
+  server_threads.insert(thd);
   thd->thread_stack= (char*) &tables;
   if (thd->store_globals())
     return 1;
@@ -266,6 +266,7 @@ static void send_report(const char *when)
     thd->killed= KILL_CONNECTION;
     mysql_cond_broadcast(&COND_thread_count);
     mysql_mutex_unlock(&LOCK_thread_count);
+    server_threads.erase(thd);
     delete thd;
     thd= 0;
   }
@@ -279,9 +280,7 @@ pthread_handler_t background_thread(void *arg __attribute__((unused)))
   if (my_thread_init())
     return 0;
 
-  mysql_mutex_lock(&LOCK_thread_count);
-  thd_thread_id= thread_id++;
-  mysql_mutex_unlock(&LOCK_thread_count);
+  thd_thread_id= next_thread_id();
 
   if (slept_ok(startup_interval))
   {
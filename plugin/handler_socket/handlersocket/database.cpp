@@ -308,9 +308,9 @@ dbcontext::init_thread(const void *stack_bottom, volatile int& shutdown_flag)
     DBG_THR(fprintf(stderr, "HNDSOCK x0 %p\n", thd));
   }
   {
+    thd->thread_id = next_thread_id();
+    server_threads.insert(thd);
     pthread_mutex_lock(&LOCK_thread_count);
-    thd->thread_id = thread_id++;
-    threads.append(thd);
     ++thread_count;
     pthread_mutex_unlock(&LOCK_thread_count);
   }
@@ -346,6 +346,7 @@ dbcontext::term_thread()
   unlock_tables_if();
   my_pthread_setspecific_ptr(THR_THD, 0);
   {
+    server_threads.erase(thd);
     pthread_mutex_lock(&LOCK_thread_count);
     delete thd;
     thd = 0;
@@ -47,6 +47,10 @@ class Accessible_Query_Cache : public Query_cache {
   {
     return &this->queries;
   }
+  Accessible_Query_Cache *partition(uint n)
+  {
+    return (Accessible_Query_Cache *) get_partition(n);
+  }
 } *qc;
 
 bool schema_table_store_record(THD *thd, TABLE *table);
@@ -106,19 +110,60 @@ static ST_FIELD_INFO qc_info_fields[]=
   {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, 0}
 };
 
+#define COLUMN_PARTITION_NUMBER 0
+#define COLUMN_PARTITION_SIZE 1
+#define COLUMN_PARTITION_FREE_MEMORY 2
+#define COLUMN_PARTITION_FREE_BLOCKS 3
+#define COLUMN_PARTITION_TOTAL_BLOCKS 4
+#define COLUMN_PARTITION_QUERIES 5
+#define COLUMN_PARTITION_HITS 6
+#define COLUMN_PARTITION_MISSES 7
+#define COLUMN_PARTITION_INSERTS 8
+#define COLUMN_PARTITION_NOT_CACHED 9
+#define COLUMN_PARTITION_LOWMEM_PRUNES 10
+
+static ST_FIELD_INFO qc_partitions_fields[]=
+{
+  {"PARTITION_NUMBER", MY_INT32_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0, 0},
+  {"SIZE", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"FREE_MEMORY", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"FREE_BLOCKS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"TOTAL_BLOCKS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"QUERIES_IN_CACHE", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"HITS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"MISSES", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"INSERTS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"NOT_CACHED", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"LOWMEM_PRUNES", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, 0}
+};
+
+static int qc_info_fill_partition(THD *thd, TABLE *table,
+                                  Accessible_Query_Cache *part);
+
 static int qc_info_fill_table(THD *thd, TABLE_LIST *tables,
                                               COND *cond)
 {
-  int status= 1;
-  CHARSET_INFO *scs= system_charset_info;
-  TABLE *table= tables->table;
-  HASH *queries = qc->get_queries();
-
   /* one must have PROCESS privilege to see others' queries */
   if (check_global_access(thd, PROCESS_ACL, true))
     return 0;
 
-  if (qc->try_lock(thd))
+  for (uint i= 0; i < qc->partition_count(); i++)
+  {
+    if (qc_info_fill_partition(thd, tables->table, qc->partition(i)))
+      return 1;
+  }
+  return 0;
+}
+
+static int qc_info_fill_partition(THD *thd, TABLE *table,
+                                  Accessible_Query_Cache *part)
+{
+  int status= 1;
+  CHARSET_INFO *scs= system_charset_info;
+  HASH *queries = part->get_queries();
+
+  if (part->try_lock(thd))
     return 0; // QC is or is being disabled
 
   /* loop through all queries in the query cache */
@@ -239,17 +284,12 @@ static int qc_info_fill_table(THD *thd, TABLE_LIST *tables,
   status = 0;
 
 cleanup:
-  qc->unlock();
+  part->unlock();
   return status;
 }
 
-static int qc_info_plugin_init(void *p)
+static int find_query_cache()
 {
-  ST_SCHEMA_TABLE *schema= (ST_SCHEMA_TABLE *)p;
-
-  schema->fields_info= qc_info_fields;
-  schema->fill_table= qc_info_fill_table;
-
 #ifdef _WIN32
   qc = (Accessible_Query_Cache *)
     GetProcAddress(GetModuleHandle(NULL), "?query_cache@@3VQuery_cache@@A");
@@ -260,6 +300,54 @@ static int qc_info_plugin_init(void *p)
   return qc == 0;
 }
 
+static int qc_info_plugin_init(void *p)
+{
+  ST_SCHEMA_TABLE *schema= (ST_SCHEMA_TABLE *)p;
+
+  schema->fields_info= qc_info_fields;
+  schema->fill_table= qc_info_fill_table;
+
+  return find_query_cache();
+}
+
+
+static int qc_partitions_fill_table(THD *thd, TABLE_LIST *tables,
+                                    COND *cond)
+{
+  TABLE *table= tables->table;
+
+  for (uint i= 0; i < qc->partition_count(); i++)
+  {
+    Query_cache *part= qc->partition(i);
+
+    /* The counters are read without a lock, like SHOW STATUS does */
+    table->field[COLUMN_PARTITION_NUMBER]->store(i, 1);
+    table->field[COLUMN_PARTITION_SIZE]->store(part->query_cache_size, 1);
+    table->field[COLUMN_PARTITION_FREE_MEMORY]->store(part->free_memory, 1);
+    table->field[COLUMN_PARTITION_FREE_BLOCKS]->store(part->free_memory_blocks, 1);
+    table->field[COLUMN_PARTITION_TOTAL_BLOCKS]->store(part->total_blocks, 1);
+    table->field[COLUMN_PARTITION_QUERIES]->store(part->queries_in_cache, 1);
+    table->field[COLUMN_PARTITION_HITS]->store(part->hits, 1);
+    table->field[COLUMN_PARTITION_MISSES]->store(part->misses, 1);
+    table->field[COLUMN_PARTITION_INSERTS]->store(part->inserts, 1);
+    table->field[COLUMN_PARTITION_NOT_CACHED]->store(part->refused, 1);
+    table->field[COLUMN_PARTITION_LOWMEM_PRUNES]->store(part->lowmem_prunes, 1);
+
+    if (schema_table_store_record(thd, table))
+      return 1;
+  }
+  return 0;
+}
+
+static int qc_partitions_plugin_init(void *p)
+{
+  ST_SCHEMA_TABLE *schema= (ST_SCHEMA_TABLE *)p;
+
+  schema->fields_info= qc_partitions_fields;
+  schema->fill_table= qc_partitions_fill_table;
+
+  return find_query_cache();
+}
 
 static struct st_mysql_information_schema qc_info_plugin=
 { MYSQL_INFORMATION_SCHEMA_INTERFACE_VERSION };
@@ -283,6 +371,21 @@ maria_declare_plugin(query_cache_info)
   NULL,                       /* system variables     */
   "1.1",                      /* version as a string  */
   MariaDB_PLUGIN_MATURITY_GAMMA
+},
+{
+  MYSQL_INFORMATION_SCHEMA_PLUGIN,
+  &qc_info_plugin,
+  "QUERY_CACHE_PARTITION_STATS",
+  "MariaDB Corporation",
+  "Statistics of the query cache partitions.",
+  PLUGIN_LICENSE_BSD,
+  qc_partitions_plugin_init,  /* Plugin Init */
+  0,                          /* Plugin Deinit        */
+  0x0100,                     /* version, hex         */
+  NULL,                       /* status variables     */
+  NULL,                       /* system variables     */
+  "1.0",                      /* version as a string  */
+  MariaDB_PLUGIN_MATURITY_EXPERIMENTAL
 }
 maria_declare_plugin_end;
 
@@ -39,6 +39,7 @@
 #include "sql_select.h"
 #include "log_slow.h"
 #include "debug_sync.h"
+#include "my_atomic.h"
 
 /// How to write record_ref.
 #define WRITE_REF(file,from) \
@@ -293,6 +294,7 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
 
   param.sort_form= table;
   param.end=(param.local_sortorder=sortorder)+s_length;
+  param.sort_threads= (uint) thd->variables.sort_threads;
   num_rows= find_all_keys(thd, &param, select,
                           &table_sort,
                           &buffpek_pointers,
@@ -1418,6 +1420,238 @@ bool check_if_pq_applicable(Sort_param *param,
 }
 
 
+/*
+  Parallel merge passes.
+
+  The merge_buffers() calls of one merge_many_buff() pass are independent
+  of each other, and as every group of MERGEBUFF buffers is written to
+  to_file in order, the position of the result of each group is known
+  before the pass starts. So with sort_threads > 1 the groups of a pass
+  are merged by several threads in any order: the sort buffer is divided
+  between the threads, each result is written with pwrite() to its own
+  part of to_file, and the BUFFPEKs of the results are installed after
+  all threads have finished, as a group may still read the BUFFPEK that
+  the serial code would overwrite with the result of a later group.
+
+  Encrypted temporary files are always merged by the session thread, as
+  their reads go through the IO_CACHE of from_file.
+*/
+
+/** Each merge thread gets at least this much of the sort buffer */
+#define MERGE_THREAD_MIN_MEMORY (MERGEBUFF * DISK_BUFFER_SIZE)
+
+/** One merge_buffers() call of a parallel merge pass */
+struct Merge_group
+{
+  BUFFPEK *first, *last;
+  my_off_t to_pos;                      // Where the result is written
+  BUFFPEK result;
+};
+
+/** A merge pass shared by the session thread and the merge threads */
+struct Merge_pass
+{
+  IO_CACHE *from_file;
+  File to_file;
+  Merge_group *groups;
+  int32 group_count;
+  int32 next_group;
+  int32 error;
+};
+
+struct Merge_thread
+{
+  Merge_pass *pass;
+  Sort_param param;                     // With its part of the buffer
+  uchar *sort_buffer;
+  uint merges;
+  pthread_t id;
+};
+
+
+/**
+  write_function of the IO_CACHEs of a parallel merge pass. All threads
+  write to the same file, so the file position must not be used.
+*/
+
+static int merge_cache_pwrite(IO_CACHE *info, const uchar *buffer,
+                              size_t count)
+{
+  if (mysql_file_pwrite(info->file, buffer, count, info->pos_in_file,
+                        info->myflags | MY_NABP))
+    return info->error= -1;
+  info->pos_in_file+= count;
+  return 0;
+}
+
+
+static bool merge_group(Merge_thread *thread, Merge_group *group)
+{
+  IO_CACHE to_file;
+  bool error;
+
+  if (init_io_cache(&to_file, thread->pass->to_file, DISK_BUFFER_SIZE,
+                    WRITE_CACHE, group->to_pos, 0, MYF(MY_WME)))
+    return TRUE;
+  to_file.write_function= merge_cache_pwrite;
+  error= merge_buffers(&thread->param, thread->pass->from_file, &to_file,
+                       thread->sort_buffer, &group->result,
+                       group->first, group->last, 0) != 0;
+  if (end_io_cache(&to_file))
+    error= TRUE;
+  return error;
+}
+
+
+/** Merge groups of the pass until there are none left or one failed */
+
+static void merge_groups(Merge_thread *thread)
+{
+  Merge_pass *pass= thread->pass;
+  int32 i;
+
+  while (!my_atomic_load32(&pass->error) &&
+         (i= my_atomic_add32(&pass->next_group, 1)) < pass->group_count)
+  {
+    if (merge_group(thread, pass->groups + i))
+    {
+      my_atomic_store32(&pass->error, 1);
+      break;
+    }
+    thread->merges++;
+  }
+}
+
+
+pthread_handler_t merge_thread(void *arg)
+{
+  my_thread_init();
+  merge_groups((Merge_thread*) arg);
+  my_thread_end();
+  return 0;
+}
+
+
+/**
+  Number of threads to use for the next merge_many_buff() pass.
+  1 means that the pass is done by the session thread alone.
+*/
+
+static uint merge_pass_threads(Sort_param *param, uint maxbuffer,
+                               IO_CACHE *from_file, IO_CACHE *to_file)
+{
+  uint threads= param->sort_threads;
+
+  /* Unique and encrypted files are merged by the session thread */
+  if (threads <= 1 || param->unique_buff ||
+      ((from_file->myflags | to_file->myflags) & MY_ENCRYPT))
+    return 1;
+  set_if_smaller(threads, (maxbuffer + 1) / MERGEBUFF);
+  set_if_smaller(threads, (uint) ((ulonglong) param->max_keys_per_buffer *
+                                  param->rec_length /
+                                  MERGE_THREAD_MIN_MEMORY));
+  return MY_MAX(threads, 1);
+}
+
+
+/**
+  Do one merge_many_buff() pass with several threads.
+
+  @return The BUFFPEK after the last result of the pass, or NULL on error.
+*/
+
+static BUFFPEK *merge_pass_parallel(Sort_param *param, uchar *sort_buffer,
+                                    BUFFPEK *buffpek, uint maxbuffer,
+                                    IO_CACHE *from_file, IO_CACHE *to_file,
+                                    uint threads)
+{
+  THD *thd= current_thd;
+  Merge_pass pass;
+  Merge_thread *thread;
+  my_off_t pos= 0;
+  ulong keys_per_thread= param->max_keys_per_buffer / threads;
+  uint i, started= 0;
+  int32 groups= 0;
+  BUFFPEK *res= NULL;
+  DBUG_ENTER("merge_pass_parallel");
+
+  if ((to_file->file < 0 && real_open_cached_file(to_file)) ||
+      !(pass.groups= (Merge_group*)
+        my_malloc((maxbuffer / MERGEBUFF + 2) * sizeof(Merge_group),
+                  MYF(MY_WME | MY_THREAD_SPECIFIC))))
+    DBUG_RETURN(NULL);
+  if (!(thread= (Merge_thread*) my_malloc(threads * sizeof(Merge_thread),
+                                          MYF(MY_WME | MY_THREAD_SPECIFIC))))
+  {
+    my_free(pass.groups);
+    DBUG_RETURN(NULL);
+  }
+
+  /* The same groups as in the serial merge_many_buff() loop */
+  for (i=0 ; i <= maxbuffer-MERGEBUFF*3/2 ; i+=MERGEBUFF)
+  {
+    pass.groups[groups].first= buffpek+i;
+    pass.groups[groups++].last= buffpek+i+MERGEBUFF-1;
+  }
+  pass.groups[groups].first= buffpek+i;
+  pass.groups[groups++].last= buffpek+maxbuffer;
+  for (int32 g= 0; g < groups; g++)
+  {
+    pass.groups[g].to_pos= pos;
+    for (BUFFPEK *b= pass.groups[g].first; b <= pass.groups[g].last; b++)
+      pos+= b->count * param->rec_length;
+  }
+  pass.from_file= from_file;
+  pass.to_file= to_file->file;
+  pass.group_count= groups;
+  pass.next_group= 0;
+  pass.error= 0;
+
+  for (i= 0; i < threads; i++)
+  {
+    thread[i].pass= &pass;
+    thread[i].param= *param;
+    thread[i].param.max_keys_per_buffer= keys_per_thread;
+    thread[i].sort_buffer= sort_buffer + i * keys_per_thread *
+                                         param->rec_length;
+    thread[i].merges= 0;
+  }
+  /* thread[0] is the session thread; fewer threads do the same work */
+  for (i= 1; i < threads; i++)
+  {
+    if (!mysql_thread_create(0, /* Not instrumented */
+                             &thread[i].id, NULL, merge_thread, thread + i))
+      started= i;
+    else
+      break;
+  }
+  merge_groups(thread);
+  for (i= 1; i <= started; i++)
+  {
+    pthread_join(thread[i].id, NULL);
+    /* The session thread counted its own passes in merge_buffers() */
+    while (thread[i].merges--)
+    {
+      thd->inc_status_sort_merge_passes();
+      thd->query_plan_fsort_passes++;
+    }
+  }
+
+  if (!pass.error && !reinit_io_cache(to_file, WRITE_CACHE, pos, 0, 1))
+  {
+    for (i= 0; i < (uint) groups; i++)
+    {
+      buffpek[i].count= pass.groups[i].result.count;
+      buffpek[i].file_pos= pass.groups[i].result.file_pos;
+    }
+    res= buffpek + groups;
+  }
+  my_free(thread);
+  my_free(pass.groups);
+  DBUG_RETURN(res);
+}
+
+
 /** Merge buffers to make < MERGEBUFF2 buffers. */
 
 int merge_many_buff(Sort_param *param, uchar *sort_buffer,
@@ -1426,6 +1660,7 @@ int merge_many_buff(Sort_param *param, uchar *sort_buffer,
   register uint i;
   IO_CACHE t_file2,*from_file,*to_file,*temp;
   BUFFPEK *lastbuff;
+  uint threads;
   DBUG_ENTER("merge_many_buff");
 
   if (*maxbuffer < MERGEBUFF2)
@@ -1442,16 +1677,27 @@ int merge_many_buff(Sort_param *param, uchar *sort_buffer,
       goto cleanup;
     if (reinit_io_cache(to_file,WRITE_CACHE,0L,0,0))
       goto cleanup;
-    lastbuff=buffpek;
-    for (i=0 ; i <= *maxbuffer-MERGEBUFF*3/2 ; i+=MERGEBUFF)
+    if ((threads= merge_pass_threads(param, *maxbuffer,
+                                     from_file, to_file)) > 1)
+    {
+      if (!(lastbuff= merge_pass_parallel(param, sort_buffer, buffpek,
+                                          *maxbuffer, from_file, to_file,
+                                          threads)))
+        goto cleanup;
+    }
+    else
     {
+      lastbuff=buffpek;
+      for (i=0 ; i <= *maxbuffer-MERGEBUFF*3/2 ; i+=MERGEBUFF)
+      {
+        if (merge_buffers(param,from_file,to_file,sort_buffer,lastbuff++,
+                          buffpek+i,buffpek+i+MERGEBUFF-1,0))
+        goto cleanup;
+      }
       if (merge_buffers(param,from_file,to_file,sort_buffer,lastbuff++,
-			buffpek+i,buffpek+i+MERGEBUFF-1,0))
-      goto cleanup;
+                        buffpek+i,buffpek+ *maxbuffer,0))
+        break;					/* purecov: inspected */
     }
-    if (merge_buffers(param,from_file,to_file,sort_buffer,lastbuff++,
-		      buffpek+i,buffpek+ *maxbuffer,0))
-      break;					/* purecov: inspected */
     if (flush_io_cache(to_file))
       break;					/* purecov: inspected */
     temp=from_file; from_file=to_file; to_file=temp;
@@ -1474,6 +1720,10 @@ int merge_many_buff(Sort_param *param, uchar *sort_buffer,
 /**
   Read data to buffer.
 
+  If the buffer has more data in the file, the kernel is asked to start
+  reading the next part of it, so that it is in the page cache when the
+  merge comes back to this buffer.
+
   @retval
     (uint)-1 if something goes wrong
 */
@@ -1493,6 +1743,13 @@ uint read_to_buffer(IO_CACHE *fromfile, BUFFPEK *buffpek,
     buffpek->file_pos+= length;			/* New filepos */
     buffpek->count-=	count;
     buffpek->mem_count= count;
+#ifdef POSIX_FADV_WILLNEED
+    if (buffpek->count && !(fromfile->myflags & MY_ENCRYPT))
+      (void) posix_fadvise(fromfile->file, buffpek->file_pos,
+                           rec_length * MY_MIN((ha_rows) buffpek->max_keys,
+                                               buffpek->count),
+                           POSIX_FADV_WILLNEED);
+#endif
   }
   return (count*rec_length);
 } /* read_to_buffer */
@@ -1574,8 +1831,15 @@ int merge_buffers(Sort_param *param, IO_CACHE *from_file,
   THD* const thd=current_thd;
   DBUG_ENTER("merge_buffers");
 
-  thd->inc_status_sort_merge_passes();
-  thd->query_plan_fsort_passes++;
+  /*
+    Parallel merge threads have no THD: they check the killed flag of the
+    session and the session counts their passes.
+  */
+  if (thd)
+  {
+    thd->inc_status_sort_merge_passes();
+    thd->query_plan_fsort_passes++;
+  }
 
   error=0;
   rec_length= param->rec_length;
@@ -1652,7 +1916,8 @@ int merge_buffers(Sort_param *param, IO_CACHE *from_file,
 
   while (queue.elements > 1)
   {
-    if (killable && thd->check_killed())
+    if (killable && (thd ? thd->check_killed() :
+                     param->sort_form->in_use->killed != NOT_KILLED))
     {
       error= 1; goto err;                        /* purecov: inspected */
     }
@@ -18,6 +18,9 @@
 #include "sql_sort.h"
 #include "table.h"
 #include "my_sys.h"
+#include "my_atomic.h"
+#include "myisampack.h"
+#include <algorithm>
 
 
 namespace {
@@ -123,6 +126,12 @@ void Filesort_buffer::free_sort_buffer()
 }
 
 
+/*
+  Below this number of keys copying the key prefixes costs more than
+  what the radix sort saves over my_qsort2().
+*/
+static const uint KEY_PREFIX_SORT_MIN_KEYS= 1000;
+
 void Filesort_buffer::sort_buffer(const Sort_param *param, uint count)
 {
   size_t size= param->sort_length;
@@ -138,6 +147,255 @@ void Filesort_buffer::sort_buffer(const Sort_param *param, uint count)
     my_free(buffer);
     return;
   }
-  
+
+  /*
+    If there is no memory for the (prefix, pointer) array we can still
+    sort the pointers in place.
+  */
+  if (count >= KEY_PREFIX_SORT_MIN_KEYS &&
+      !radixsort_key_prefixes(keys, count, size, param->sort_threads))
+    return;
+
   my_qsort2(keys, count, sizeof(uchar*), get_ptr_compare(size), &size);
 }
+
+
+namespace {
+
+/** A key pointer together with the first bytes of the key */
+struct Key_prefix
+{
+  ulonglong prefix;
+  uchar *key;
+};
+
+const uint KEY_PREFIX_LENGTH= sizeof(ulonglong);
+
+/** Buckets with fewer keys than this are finished by a comparison sort */
+const size_t RADIX_MIN_BUCKET= 64;
+
+/** Sorts with fewer keys than this are always done by one thread */
+const size_t RADIX_PARALLEL_MIN_KEYS= 256 * 1024;
+
+const uint RADIX_MAX_THREADS= 64;
+
+/**
+  Read the first bytes of a key as a big-endian integer, so that
+  comparing two prefixes as integers gives the memcmp() order of them.
+  Short keys are padded with zeroes.
+*/
+inline ulonglong load_key_prefix(const uchar *key, size_t key_length)
+{
+  if (key_length >= KEY_PREFIX_LENGTH)
+    return mi_uint8korr(key);
+  ulonglong prefix= 0;
+  for (size_t i= 0; i < KEY_PREFIX_LENGTH; i++)
+    prefix= (prefix << 8) | (i < key_length ? key[i] : 0);
+  return prefix;
+}
+
+
+/** Orders key prefixes by the prefix first, then by the rest of the key */
+class Key_prefix_less
+{
+  size_t m_tail_length;
+public:
+  explicit Key_prefix_less(size_t key_length)
+    :m_tail_length(key_length > KEY_PREFIX_LENGTH ?
+                   key_length - KEY_PREFIX_LENGTH : 0)
+  {}
+  bool has_tail() const { return m_tail_length != 0; }
+  bool operator()(const Key_prefix &a, const Key_prefix &b) const
+  {
+    if (a.prefix != b.prefix)
+      return a.prefix < b.prefix;
+    return m_tail_length &&
+           memcmp(a.key + KEY_PREFIX_LENGTH, b.key + KEY_PREFIX_LENGTH,
+                  m_tail_length) < 0;
+  }
+};
+
+
+/**
+  Distribute the keys into 256 buckets by the prefix byte number 'depth'.
+
+  @param[out] bucket_start  Offset of every bucket, bucket_start[256] is
+                            the number of keys.
+
+  @retval FALSE  All keys have the same byte and nothing was moved
+  @retval TRUE   The keys were distributed over several buckets
+*/
+bool radix_pass(Key_prefix *data, Key_prefix *tmp, size_t count, uint depth,
+                size_t *bucket_start)
+{
+  size_t counts[256], pos[256];
+  const uint shift= (KEY_PREFIX_LENGTH - 1 - depth) * 8;
+  Key_prefix *end= data + count;
+
+  memset(counts, 0, sizeof(counts));
+  for (Key_prefix *p= data; p < end; p++)
+    counts[(p->prefix >> shift) & 0xff]++;
+
+  size_t sum= 0;
+  for (uint i= 0; i < 256; i++)
+  {
+    bucket_start[i]= sum;
+    sum+= counts[i];
+  }
+  bucket_start[256]= sum;
+
+  if (counts[(data->prefix >> shift) & 0xff] == count)
+    return FALSE;
+
+  memcpy(pos, bucket_start, sizeof(pos));
+  for (Key_prefix *p= data; p < end; p++)
+    tmp[pos[(p->prefix >> shift) & 0xff]++]= *p;
+  memcpy(data, tmp, count * sizeof(Key_prefix));
+  return TRUE;
+}
+
+
+/**
+  MSD radix sort on the prefix bytes from 'depth' to 'max_depth'.
+  'tmp' must have room for 'count' elements.
+*/
+void radix_sort(Key_prefix *data, Key_prefix *tmp, size_t count, uint depth,
+                uint max_depth, const Key_prefix_less &less)
+{
+  size_t bucket_start[257];
+
+  if (depth == max_depth)
+  {
+    /* All prefixes in the bucket are equal */
+    if (less.has_tail())
+      std::sort(data, data + count, less);
+    return;
+  }
+  if (count < RADIX_MIN_BUCKET)
+  {
+    std::sort(data, data + count, less);
+    return;
+  }
+
+  radix_pass(data, tmp, count, depth, bucket_start);
+  for (uint i= 0; i < 256; i++)
+  {
+    size_t n= bucket_start[i + 1] - bucket_start[i];
+    if (n > 1)
+      radix_sort(data + bucket_start[i], tmp + bucket_start[i], n,
+                 depth + 1, max_depth, less);
+  }
+}
+
+} // namespace
+
+
+/**
+  Buckets of one radix pass shared by the sorting threads. Every thread
+  takes the next unsorted bucket until there are none left.
+*/
+struct Radix_sort_work
+{
+  Key_prefix *data, *tmp;
+  size_t bucket_start[257];
+  uint depth, max_depth;
+  const Key_prefix_less *less;
+  int32 next_bucket;
+
+  void sort_buckets()
+  {
+    int32 i;
+    while ((i= my_atomic_add32(&next_bucket, 1)) < 256)
+    {
+      size_t n= bucket_start[i + 1] - bucket_start[i];
+      if (n > 1)
+        radix_sort(data + bucket_start[i], tmp + bucket_start[i], n,
+                   depth, max_depth, *less);
+    }
+  }
+};
+
+
+pthread_handler_t radix_sort_thread(void *arg)
+{
+  my_thread_init();
+  ((Radix_sort_work*) arg)->sort_buckets();
+  my_thread_end();
+  return 0;
+}
+
+
+/**
+  Sort with several threads. The leading prefix bytes that are equal in
+  all keys are skipped, the first pass that spreads the keys is done by
+  the calling thread and the resulting buckets are shared.
+*/
+static void radix_sort_parallel(Key_prefix *data, Key_prefix *tmp,
+                                size_t count, uint max_depth,
+                                const Key_prefix_less &less, uint threads)
+{
+  Radix_sort_work work;
+  pthread_t ids[RADIX_MAX_THREADS];
+  uint depth= 0, started= 0;
+
+  while (!radix_pass(data, tmp, count, depth, work.bucket_start))
+  {
+    if (++depth == max_depth)
+    {
+      radix_sort(data, tmp, count, depth, max_depth, less);
+      return;
+    }
+  }
+
+  work.data= data;
+  work.tmp= tmp;
+  work.depth= depth + 1;
+  work.max_depth= max_depth;
+  work.less= &less;
+  work.next_bucket= 0;
+
+  set_if_smaller(threads, RADIX_MAX_THREADS);
+  /* If a thread can't be created the remaining ones do its work */
+  for (uint i= 1; i < threads; i++)
+  {
+    if (!mysql_thread_create(0, /* Not instrumented */
+                             &ids[started], NULL, radix_sort_thread, &work))
+      started++;
+  }
+  work.sort_buckets();
+  for (uint i= 0; i < started; i++)
+    pthread_join(ids[i], NULL);
+}
+
+
+bool radixsort_key_prefixes(uchar **keys, size_t count, size_t key_length,
+                            uint threads)
+{
+  Key_prefix *data, *tmp;
+  Key_prefix_less less(key_length);
+  uint max_depth= (uint) MY_MIN(key_length, KEY_PREFIX_LENGTH);
+  DBUG_ENTER("radixsort_key_prefixes");
+
+  if (count <= 1 || key_length == 0)
+    DBUG_RETURN(FALSE);
+  if (!(data= (Key_prefix*) my_malloc(2 * count * sizeof(Key_prefix),
+                                      MYF(MY_THREAD_SPECIFIC))))
+    DBUG_RETURN(TRUE);
+  tmp= data + count;
+
+  for (size_t i= 0; i < count; i++)
+  {
+    data[i].prefix= load_key_prefix(keys[i], key_length);
+    data[i].key= keys[i];
+  }
+
+  if (threads > 1 && count >= RADIX_PARALLEL_MIN_KEYS)
+    radix_sort_parallel(data, tmp, count, max_depth, less, threads);
+  else
+    radix_sort(data, tmp, count, 0, max_depth, less);
+
+  for (size_t i= 0; i < count; i++)
+    keys[i]= data[i].key;
+  my_free(data);
+  DBUG_RETURN(FALSE);
+}
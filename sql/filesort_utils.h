@@ -45,6 +45,31 @@ double get_merge_many_buffs_cost_fast(ha_rows num_rows,
                                       uint    elem_size);
 
 
+/**
+  Sort an array of pointers to fixed length keys in memcmp() order.
+
+    @param keys        Array of key pointers, sorted in place.
+    @param count       Number of keys.
+    @param key_length  Length of every key.
+    @param threads     Maximum number of threads to use, including the
+                       calling one.
+
+  The first 8 bytes of every key are loaded into a big-endian integer
+  and stored next to the key pointer, so that most comparisons are done
+  on one machine word in a contiguous array instead of through the
+  pointers. The (prefix, pointer) pairs are sorted with an MSD radix sort
+  on the prefix bytes; small buckets and buckets with equal prefixes are
+  finished by a comparison sort. With threads > 1 and enough keys the
+  buckets of the first radix pass are sorted in parallel.
+
+  @retval FALSE  ok
+  @retval TRUE   out of memory; the keys were not sorted
+*/
+
+bool radixsort_key_prefixes(uchar **keys, size_t count, size_t key_length,
+                            uint threads);
+
+
 /**
   A wrapper class around the buffer used by filesort().
   The buffer is a contiguous chunk of memory,
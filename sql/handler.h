@@ -248,6 +248,12 @@ enum enum_alter_inplace_result {
  */
 #define HA_CAN_EXPORT                 (1LL << 45)
 
+/*
+  Several clones of the handler may read the table at the same time in
+  different threads on behalf of one session, see sql_parallel_scan.cc
+*/
+#define HA_CAN_PARALLEL_SCAN          (1LL << 46)
+
 
 /*
   Set of all binlog flags. Currently only contain the capabilities
@@ -4087,6 +4093,8 @@ class handler :public Sql_alloc
   virtual void set_lock_type(enum thr_lock_type lock);
 
   friend enum icp_result handler_index_cond_check(void* h_arg);
+  friend int parallel_scan_read(handler *file, uchar *buf, const uchar *key,
+                                bool next);
 protected:
   Handler_share *get_ha_share_ptr();
   void set_ha_share_ptr(Handler_share *arg_ha_share);
@@ -1416,6 +1416,60 @@ bool Item_sum_sum::add()
 }
 
 
+/**
+  Add a partial sum of the argument values calculated outside of this item.
+
+  @param add_sum_decimal  the partial sum, NULL if it is a sum over
+                          no non-NULL values
+*/
+
+void Item_sum_sum::direct_add(my_decimal *add_sum_decimal)
+{
+  DBUG_ENTER("Item_sum_sum::direct_add");
+  if (!add_sum_decimal)
+    DBUG_VOID_RETURN;
+  if (hybrid_type == DECIMAL_RESULT)
+  {
+    my_decimal_add(E_DEC_FATAL_ERROR, dec_buffs + (curr_dec_buff^1),
+                   add_sum_decimal, dec_buffs + curr_dec_buff);
+    curr_dec_buff^= 1;
+  }
+  else
+  {
+    double add_sum_real;
+    my_decimal2double(E_DEC_FATAL_ERROR, add_sum_decimal, &add_sum_real);
+    sum+= add_sum_real;
+  }
+  null_value= 0;
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Add a partial sum of the argument values calculated outside of this item.
+
+  @param add_sum_real     the partial sum
+  @param add_sum_is_null  TRUE if it is a sum over no non-NULL values
+*/
+
+void Item_sum_sum::direct_add(double add_sum_real, bool add_sum_is_null)
+{
+  DBUG_ENTER("Item_sum_sum::direct_add");
+  if (add_sum_is_null)
+    DBUG_VOID_RETURN;
+  if (hybrid_type == DECIMAL_RESULT)
+  {
+    my_decimal value;
+    double2my_decimal(E_DEC_FATAL_ERROR, add_sum_real, &value);
+    direct_add(&value);
+    DBUG_VOID_RETURN;
+  }
+  sum+= add_sum_real;
+  null_value= 0;
+  DBUG_VOID_RETURN;
+}
+
+
 longlong Item_sum_sum::val_int()
 {
   DBUG_ASSERT(fixed == 1);
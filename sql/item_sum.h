@@ -742,6 +742,9 @@ class Item_sum_sum :public Item_sum_num
   }
   void clear();
   bool add();
+  /* Add a sum calculated elsewhere, e.g. by a parallel scan */
+  void direct_add(my_decimal *add_sum_decimal);
+  void direct_add(double add_sum_real, bool add_sum_is_null);
   double val_real();
   longlong val_int();
   String *val_str(String*str);
@@ -799,6 +802,8 @@ class Item_sum_count :public Item_sum_int
     count=count_arg;
     Item_sum::make_const();
   }
+  /* Add a count calculated elsewhere, e.g. by a parallel scan */
+  void direct_add(longlong add_to) { count+= add_to; }
   longlong val_int();
   void reset_field();
   void update_field();
@@ -53,6 +53,7 @@
 #include "sql_plugin.h"
 #include "rpl_handler.h"
 #include "debug_sync.h"
+#include "key.h"                                // key_copy, key_hashnr
 #include "sql_show.h"
 #include "my_pthread.h"
 #include "wsrep_mysqld.h"
@@ -71,6 +72,7 @@ const char *log_bin_index= 0;
 const char *log_bin_basename= 0;
 
 MYSQL_BIN_LOG mysql_bin_log(&sync_binlog_period);
+Binlog_ring binlog_ring;
 
 static bool test_if_number(const char *str,
 			   ulong *res, bool allow_wildcards);
@@ -458,7 +460,8 @@ class binlog_cache_mngr {
                     ulong *param_ptr_binlog_stmt_cache_disk_use,
                     ulong *param_ptr_binlog_cache_use,
                     ulong *param_ptr_binlog_cache_disk_use)
-    : last_commit_pos_offset(0), using_xa(FALSE), xa_xid(0)
+    : last_commit_pos_offset(0), using_xa(FALSE), xa_xid(0),
+      writeset_unusable(FALSE)
   {
      stmt_cache.set_binlog_cache_info(param_max_binlog_stmt_cache_size,
                                       param_ptr_binlog_stmt_cache_use,
@@ -467,6 +470,12 @@ class binlog_cache_mngr {
                                      param_ptr_binlog_cache_use,
                                      param_ptr_binlog_cache_disk_use);
      last_commit_pos_file[0]= 0;
+     my_init_dynamic_array(&writeset, sizeof(uint64), 0, 64, MYF(0));
+  }
+
+  ~binlog_cache_mngr()
+  {
+    delete_dynamic(&writeset);
   }
 
   void reset(bool do_stmt, bool do_trx)
@@ -479,9 +488,20 @@ class binlog_cache_mngr {
       using_xa= FALSE;
       last_commit_pos_file[0]= 0;
       last_commit_pos_offset= 0;
+      reset_dynamic(&writeset);
+      writeset_unusable= FALSE;
     }
   }
 
+  /*
+    The writeset of the transaction cache for the binlog_writeset_history,
+    or NULL if it does not describe all changes of the transaction.
+  */
+  DYNAMIC_ARRAY *get_writeset()
+  {
+    return writeset_unusable ? NULL : &writeset;
+  }
+
   binlog_cache_data* get_binlog_cache_data(bool is_transactional)
   {
     return (is_transactional ? &trx_cache : &stmt_cache);
@@ -521,6 +541,15 @@ class binlog_cache_mngr {
   /* Set if we get an error during commit that must be returned from unlog(). */
   bool delayed_error;
 
+  /*
+    With @@binlog_track_writesets, the hashes of the primary and unique key
+    values changed by the transaction, see THD::binlog_record_writeset().
+    writeset_unusable is set when the transaction logged something that the
+    writeset does not describe.
+  */
+  DYNAMIC_ARRAY writeset;
+  bool writeset_unusable;
+
 private:
 
   binlog_cache_mngr& operator=(const binlog_cache_mngr& info);
@@ -3425,6 +3454,9 @@ bool MYSQL_BIN_LOG::open(const char *log_name,
 
   open_count++;
 
+  if (!is_relay_log && binlog_ring.enabled())
+    binlog_ring.attach(&log_file, log_file_name);
+
   DBUG_ASSERT(log_type == LOG_BIN);
 
   {
@@ -4095,7 +4127,7 @@ bool MYSQL_BIN_LOG::reset_logs(THD *thd, bool create_new_log,
     thread. If the transaction involved MyISAM tables, it should go
     into binlog even on rollback.
   */
-  mysql_mutex_lock(&LOCK_thread_count);
+  server_threads.lock_all();
 
   /* Save variables so that we can reopen the log */
   save_name=name;
@@ -4203,7 +4235,7 @@ bool MYSQL_BIN_LOG::reset_logs(THD *thd, bool create_new_log,
 err:
   if (error == 1)
     name= const_cast<char*>(save_name);
-  mysql_mutex_unlock(&LOCK_thread_count);
+  server_threads.unlock_all();
 
   if (!is_relay_log)
   {
@@ -5604,6 +5636,95 @@ int THD::binlog_write_table_map(TABLE *table, bool is_transactional,
   DBUG_RETURN(0);
 }
 
+
+/**
+  Add the primary and unique key values of a row to the writeset of the
+  transaction, for @@binlog_track_writesets.
+
+  Keys with a NULL part do not conflict and are skipped. If the row is not
+  fully described by its keys (no primary key, a table referenced by a
+  foreign key, a non-transactional table or a key value that was not read),
+  the writeset is marked unusable, and the transaction will be a barrier
+  for parallel replication.
+
+  @param table           The table of the row
+  @param is_transactional Whether the row goes to the transactional cache
+  @param record          The row, table->record[0] or table->record[1]
+  @param check_read_set  The record only holds the columns in read_set
+
+  @return 0 on success, or a handler error
+*/
+
+int THD::binlog_record_writeset(TABLE *table, bool is_transactional,
+                                const uchar *record, bool check_read_set)
+{
+  uchar key_buf[MAX_KEY_LENGTH];
+  my_ptrdiff_t ptrdiff= record - table->record[0];
+  ulong table_nr= 1, table_nr2= 4;
+  DBUG_ENTER("THD::binlog_record_writeset");
+
+  binlog_cache_mngr *const cache_mngr= binlog_setup_trx_data();
+  if (!cache_mngr)
+    DBUG_RETURN(HA_ERR_OUT_OF_MEM);
+  if (cache_mngr->writeset_unusable)
+    DBUG_RETURN(0);
+
+  /* Ensure that all events in a GTID group are in the same cache */
+  if (variables.option_bits & OPTION_GTID_BEGIN)
+    is_transactional= 1;
+
+  if (!is_transactional || table->s->primary_key == MAX_KEY ||
+      table->file->referenced_by_foreign_key() ||
+      cache_mngr->writeset.elements >= opt_binlog_writeset_history_size)
+  {
+    cache_mngr->writeset_unusable= TRUE;
+    DBUG_RETURN(0);
+  }
+
+  my_charset_bin.coll->hash_sort(&my_charset_bin,
+                                 (const uchar *) table->s->table_cache_key.str,
+                                 table->s->table_cache_key.length,
+                                 &table_nr, &table_nr2);
+
+  for (uint i= 0; i < table->s->keys; i++)
+  {
+    KEY *key_info= table->key_info + i;
+    KEY_PART_INFO *key_part, *key_part_end;
+    bool has_null= false;
+    uint64 hash;
+
+    if (!(key_info->flags & HA_NOSAME))
+      continue;
+    key_part_end= key_info->key_part + key_info->user_defined_key_parts;
+    for (key_part= key_info->key_part; key_part < key_part_end; key_part++)
+    {
+      if (check_read_set &&
+          !bitmap_is_set(table->read_set, key_part->fieldnr - 1))
+      {
+        cache_mngr->writeset_unusable= TRUE;
+        DBUG_RETURN(0);
+      }
+      if (key_part->null_bit &&
+          (record[key_part->null_offset] & key_part->null_bit))
+        has_null= true;
+    }
+    if (has_null)
+      continue;
+
+    for (key_part= key_info->key_part; key_part < key_part_end; key_part++)
+      key_part->field->move_field_offset(ptrdiff);
+    key_copy(key_buf, (uchar *) record, key_info, key_info->key_length);
+    for (key_part= key_info->key_part; key_part < key_part_end; key_part++)
+      key_part->field->move_field_offset(-ptrdiff);
+
+    hash= ((uint64) table_nr + i) * 0x9E3779B97F4A7C15ULL +
+      key_hashnr(key_info, key_info->user_defined_key_parts, key_buf);
+    if (insert_dynamic(&cache_mngr->writeset, (uchar *) &hash))
+      DBUG_RETURN(HA_ERR_OUT_OF_MEM);
+  }
+  DBUG_RETURN(0);
+}
+
 /**
   This function retrieves a pending row event from a cache which is
   specified through the parameter @c is_transactional. Respectively, when it
@@ -5753,11 +5874,25 @@ MYSQL_BIN_LOG::flush_and_set_pending_rows_event(THD *thd,
 }
 
 
-/* Generate a new global transaction ID, and write it to the binlog */
+/*
+  The writesets of the last transactions written to the binlog, for
+  @@binlog_track_writesets. Protected by LOCK_log of mysql_bin_log.
+*/
+static rpl_writeset_history binlog_writeset_history;
+
+
+/*
+  Generate a new global transaction ID, and write it to the binlog
+
+  With @@binlog_track_writesets, the writeset (NULL if the event group has
+  none that can be used) is added to binlog_writeset_history to find the
+  depends_seq_no of the GTID.
+*/
 
 bool
 MYSQL_BIN_LOG::write_gtid_event(THD *thd, bool standalone,
-                                bool is_transactional, uint64 commit_id)
+                                bool is_transactional, uint64 commit_id,
+                                DYNAMIC_ARRAY *writeset)
 {
   rpl_gtid gtid;
   uint32 domain_id;
@@ -5818,6 +5953,23 @@ MYSQL_BIN_LOG::write_gtid_event(THD *thd, bool standalone,
                             LOG_EVENT_SUPPRESS_USE_F, is_transactional,
                             commit_id);
 
+  mysql_mutex_assert_owner(&LOCK_log);
+  if (opt_binlog_track_writesets)
+  {
+    if (binlog_writeset_history.add(domain_id, seq_no,
+                                    writeset ?
+                                    (uint64 *) writeset->buffer : NULL,
+                                    writeset ? writeset->elements : 0,
+                                    opt_binlog_writeset_history_size,
+                                    &gtid_event.depends_seq_no))
+      gtid_event.flags2|= Gtid_log_event::FL_DEPENDS;
+  }
+  else if (!binlog_writeset_history.is_empty())
+  {
+    /* Transactions logged now would be missing from the history */
+    binlog_writeset_history.reset();
+  }
+
   /* Write the event to the binary log. */
   DBUG_ASSERT(this == &mysql_bin_log);
   if (write_event(&gtid_event))
@@ -6138,6 +6290,9 @@ bool MYSQL_BIN_LOG::write(Log_event *event_info, my_bool *with_annotate)
       is_trans_cache= use_trans_cache(thd, using_trans);
       file= cache_mngr->get_binlog_cache_log(is_trans_cache);
       cache_data= cache_mngr->get_binlog_cache_data(is_trans_cache);
+      /* The writeset only describes row events */
+      if (is_trans_cache)
+        cache_mngr->writeset_unusable= TRUE;
 
       if (thd->lex->stmt_accessed_non_trans_temp_table())
         cache_data->set_changes_to_non_trans_temp_table();
@@ -7784,7 +7939,10 @@ MYSQL_BIN_LOG::write_transaction_or_stmt(group_commit_entry *entry,
   binlog_cache_mngr *mngr= entry->cache_mngr;
   DBUG_ENTER("MYSQL_BIN_LOG::write_transaction_or_stmt");
 
-  if (write_gtid_event(entry->thd, false, entry->using_trx_cache, commit_id))
+  if (write_gtid_event(entry->thd, false, entry->using_trx_cache, commit_id,
+                       (entry->using_trx_cache &&
+                        (!entry->using_stmt_cache || mngr->stmt_cache.empty()) ?
+                        mngr->get_writeset() : NULL)))
     DBUG_RETURN(ER_ERROR_ON_WRITE);
 
   if (entry->using_stmt_cache && !mngr->stmt_cache.empty() &&
@@ -8061,6 +8219,139 @@ int MYSQL_BIN_LOG::wait_for_update_binlog_end_pos(THD* thd,
 }
 
 
+bool Binlog_ring::init(ulong size_arg)
+{
+  DBUG_ENTER("Binlog_ring::init");
+  if (!(buf= (uchar *) my_malloc(size_arg, MYF(MY_WME))))
+    DBUG_RETURN(true);
+  size= size_arg;
+  start= end= 0;
+  file_name[0]= 0;
+  mysql_rwlock_init(key_rwlock_LOCK_binlog_ring, &LOCK_ring);
+  DBUG_RETURN(false);
+}
+
+
+void Binlog_ring::cleanup()
+{
+  if (buf)
+  {
+    mysql_rwlock_destroy(&LOCK_ring);
+    my_free(buf);
+    buf= NULL;
+  }
+}
+
+
+/**
+  Start keeping a copy of a newly opened binary log file.
+
+  Writes of @c log to the file go through write_hook() from now on.
+  The caller holds LOCK_log.
+*/
+void Binlog_ring::attach(IO_CACHE *log, const char *log_name)
+{
+  mysql_rwlock_wrlock(&LOCK_ring);
+  strmake_buf(file_name, log_name);
+  start= end= my_b_tell(log);
+  mysql_rwlock_unlock(&LOCK_ring);
+  next_write= log->write_function;
+  log->write_function= write_hook;
+}
+
+
+int Binlog_ring::write_hook(IO_CACHE *info, const uchar *buffer, size_t count)
+{
+  my_off_t pos= info->pos_in_file;
+  int res= binlog_ring.next_write(info, buffer, count);
+  /* The write function may write only part of the buffer */
+  if (!res && info->pos_in_file > pos)
+    binlog_ring.append(pos, buffer, (size_t) (info->pos_in_file - pos));
+  return res;
+}
+
+
+void Binlog_ring::append(my_off_t pos, const uchar *data, size_t length)
+{
+  mysql_rwlock_wrlock(&LOCK_ring);
+  if (pos != end)
+    start= pos;                               // Not contiguous, start over
+  if (length > size)
+  {
+    data+= length - size;
+    pos+= length - size;
+    length= size;
+  }
+  size_t offset= (size_t) (pos % size);
+  size_t first= MY_MIN(length, size - offset);
+  memcpy(buf + offset, data, first);
+  memcpy(buf, data + first, length - first);
+  end= pos + length;
+  if (end - start > size)
+    start= end - size;
+  mysql_rwlock_unlock(&LOCK_ring);
+}
+
+
+void Binlog_ring::copy(my_off_t pos, uchar *to, size_t length)
+{
+  size_t offset= (size_t) (pos % size);
+  size_t first= MY_MIN(length, size - offset);
+  memcpy(to, buf + offset, first);
+  memcpy(to + first, buf, length - first);
+}
+
+
+/**
+  Append the event at @c pos in @c log_name to @c packet, if the ring
+  still holds all of it.
+
+  @return true if the event was appended, false if it has to be read
+          from the file.
+*/
+bool Binlog_ring::read_event(const char *log_name, my_off_t pos,
+                             my_off_t end_pos, String *packet,
+                             enum enum_binlog_checksum_alg checksum_alg)
+{
+  uchar header[LOG_EVENT_MINIMAL_HEADER_LEN];
+  uint32 ev_offset= packet->length();
+  ulong data_len= 0;
+
+  mysql_rwlock_rdlock(&LOCK_ring);
+  if (pos >= start && pos + sizeof(header) <= MY_MIN(end, end_pos) &&
+      !strcmp(log_name, file_name))
+  {
+    copy(pos, header, sizeof(header));
+    data_len= uint4korr(header + EVENT_LEN_OFFSET);
+    if (data_len < sizeof(header) ||
+        pos + data_len > MY_MIN(end, end_pos) ||
+        packet->reserve(data_len))
+      data_len= 0;
+    else
+    {
+      copy(pos, (uchar *) packet->ptr() + ev_offset, data_len);
+      packet->length(ev_offset + data_len);
+    }
+  }
+  mysql_rwlock_unlock(&LOCK_ring);
+
+  if (data_len && data_len > LOG_EVENT_MINIMAL_HEADER_LEN &&
+      event_checksum_test((uchar *) packet->ptr() + ev_offset, data_len,
+                          checksum_alg))
+  {
+    /* Let the file read report the error */
+    packet->length(ev_offset);
+    data_len= 0;
+  }
+
+  if (data_len)
+    my_atomic_add64((int64 *) &hits, 1);
+  else
+    my_atomic_add64((int64 *) &misses, 1);
+  return data_len != 0;
+}
+
+
 /**
   Close the log file.
 
@@ -9508,9 +9799,7 @@ binlog_background_thread(void *arg __attribute__((unused)))
   thd= new THD;
   thd->system_thread= SYSTEM_THREAD_BINLOG_BACKGROUND;
   thd->thread_stack= (char*) &thd;           /* Set approximate stack start */
-  mysql_mutex_lock(&LOCK_thread_count);
-  thd->thread_id= thread_id++;
-  mysql_mutex_unlock(&LOCK_thread_count);
+  thd->thread_id= next_thread_id();
   thd->store_globals();
   thd->security_ctx->skip_grants();
   thd->set_command(COM_DAEMON);
@@ -812,7 +812,7 @@ class MYSQL_BIN_LOG: public TC_LOG, private MYSQL_LOG
   void set_status_variables(THD *thd);
   bool is_xidlist_idle();
   bool write_gtid_event(THD *thd, bool standalone, bool is_transactional,
-                        uint64 commit_id);
+                        uint64 commit_id, DYNAMIC_ARRAY *writeset= NULL);
   int read_state_from_file();
   int write_state_to_file();
   int get_most_recent_gtid_list(rpl_gtid **list, uint32 *size);
@@ -888,6 +888,46 @@ class MYSQL_BIN_LOG: public TC_LOG, private MYSQL_LOG
   char binlog_end_pos_file[FN_REFLEN];
 };
 
+
+/**
+  In-memory copy of the most recently written part of the active binary
+  log.
+
+  Every write of the binary log IO_CACHE to the file is also appended to
+  the ring, and binlog dump threads that are close to the end of the log
+  copy events from it instead of reading the file back. Dump threads for
+  older positions or other files read the file as before.
+*/
+class Binlog_ring
+{
+public:
+  Binlog_ring() : buf(NULL), size(0), hits(0), misses(0) {}
+  bool init(ulong size_arg);
+  void cleanup();
+  bool enabled() const { return buf != NULL; }
+  void attach(IO_CACHE *log, const char *log_name);
+  bool read_event(const char *log_name, my_off_t pos, my_off_t end_pos,
+                  String *packet, enum enum_binlog_checksum_alg checksum_alg);
+
+  ulonglong hits;            /* Events sent from the ring */
+  ulonglong misses;          /* Events read back from the file */
+
+private:
+  static int write_hook(IO_CACHE *info, const uchar *buffer, size_t count);
+  void append(my_off_t pos, const uchar *data, size_t length);
+  void copy(my_off_t pos, uchar *to, size_t length);
+
+  mysql_rwlock_t LOCK_ring;
+  uchar *buf;
+  ulong size;
+  /* File offsets of the first and one-after the last byte in the ring */
+  my_off_t start, end;
+  char file_name[FN_REFLEN];
+  int (*next_write)(IO_CACHE *, const uchar *, size_t);
+};
+
+extern Binlog_ring binlog_ring;
+
 class Log_event_handler
 {
 public:
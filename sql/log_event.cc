@@ -48,6 +48,7 @@
 
 #include <base64.h>
 #include <my_bitmap.h>
+#include <zlib.h>
 #include "rpl_utility.h"
 #include "rpl_constants.h"
 #include "sql_digest.h"
@@ -111,6 +112,146 @@ const ulong checksum_version_product_mariadb=
    checksum_version_split_mariadb[1]) * 256 +
   checksum_version_split_mariadb[2];
 
+/**
+  The size of the buffer that binlog_buf_compress() needs for len bytes
+*/
+uint32 binlog_get_compress_len(uint32 len)
+{
+  /* 1 byte of header and up to 4 bytes of uncompressed length */
+  return (uint32) compressBound(len) + 5;
+}
+
+/**
+  Compress the query or the rows of a compressed event.
+
+  @param src     The data to compress
+  @param dst     Buffer of binlog_get_compress_len(len) bytes for the result
+  @param len     Length of src
+  @param comlen  [out] Length of the result
+
+  @retval false  Ok
+  @retval true   Compression failed
+*/
+bool binlog_buf_compress(const uchar *src, uchar *dst, uint32 len,
+                         uint32 *comlen)
+{
+  uint len_bytes= len < 0x100 ? 1 : len < 0x10000 ? 2 : len < 0x1000000 ? 3 : 4;
+  uLongf tmplen= compressBound(len);
+
+  /* Algorithm 0 (zlib) in bits 4-6 */
+  dst[0]= (uchar) (0x80 | len_bytes);
+  for (uint i= len_bytes, n= len; i > 0; i--, n>>= 8)
+    dst[i]= (uchar) n;
+
+  if (compress((Bytef*) dst + 1 + len_bytes, &tmplen, (const Bytef*) src,
+               (uLong) len) != Z_OK)
+    return true;
+  *comlen= (uint32) tmplen + 1 + len_bytes;
+  return false;
+}
+
+/**
+  Uncompress the query or the rows of a compressed event.
+
+  @param src     The data written by binlog_buf_compress()
+  @param len     Length of src
+  @param newlen  [out] Length of the uncompressed data
+  @param extra   Number of bytes to allocate after the uncompressed data
+
+  @return The uncompressed data in a buffer allocated with my_malloc(), or
+          NULL if the data is corrupt or there is not enough memory
+*/
+uchar *binlog_buf_uncompress(const uchar *src, uint32 len, uint32 *newlen,
+                             size_t extra)
+{
+#ifndef MYSQL_CLIENT
+  ulonglong start_time= microsecond_interval_timer();
+#endif
+  uint len_bytes;
+  uint32 un_len= 0;
+  uLongf tmplen;
+  uchar *dst;
+
+  /* Only zlib is known */
+  if (len < 1 || (src[0] & 0xf0) != 0x80)
+    return NULL;
+  len_bytes= src[0] & 0x07;
+  if (len_bytes < 1 || len_bytes > 4 || len < 1 + len_bytes)
+    return NULL;
+  for (uint i= 1; i <= len_bytes; i++)
+    un_len= (un_len << 8) | src[i];
+
+  if (!(dst= (uchar*) my_malloc(un_len + extra, MYF(MY_WME))))
+    return NULL;
+  tmplen= un_len;
+  if (uncompress((Bytef*) dst, &tmplen, (const Bytef*) src + 1 + len_bytes,
+                 (uLong) (len - 1 - len_bytes)) != Z_OK ||
+      tmplen != un_len)
+  {
+    my_free(dst);
+    return NULL;
+  }
+  *newlen= un_len;
+
+#ifndef MYSQL_CLIENT
+  if (THD *thd= current_thd)
+  {
+    status_var_increment(thd->status_var.binlog_decompressed_events);
+    status_var_add(thd->status_var.binlog_decompression_time,
+                   microsecond_interval_timer() - start_time);
+  }
+#endif
+  return dst;
+}
+
+#ifdef MYSQL_SERVER
+/**
+  Whether an event with a query or rows of this length is logged
+  compressed
+*/
+bool binlog_should_compress(ulong len)
+{
+  return opt_bin_log_compress && len >= opt_bin_log_compress_min_len;
+}
+
+/**
+  Compress the query or the rows of an event that is to be logged
+  compressed, and account for it in the status of the thread.
+
+  @return The compressed data in a buffer allocated with my_malloc(), or
+          NULL if the event is to be logged uncompressed because the data
+          does not compress
+*/
+static uchar *binlog_compress_event_data(THD *thd, const uchar *src,
+                                         uint32 len, uint32 *comlen)
+{
+  ulonglong start_time= microsecond_interval_timer();
+  uchar *buf;
+
+  if (!(buf= (uchar*) my_malloc(binlog_get_compress_len(len), MYF(MY_WME))))
+    return NULL;
+  if (binlog_buf_compress(src, buf, len, comlen) || *comlen >= len)
+  {
+    my_free(buf);
+    buf= NULL;
+  }
+
+  if (thd)
+  {
+    status_var_add(thd->status_var.binlog_compression_time,
+                   microsecond_interval_timer() - start_time);
+    if (buf)
+    {
+      status_var_increment(thd->status_var.binlog_compressed_events);
+      status_var_add(thd->status_var.binlog_bytes_before_compression, len);
+      status_var_add(thd->status_var.binlog_bytes_after_compression,
+                     *comlen);
+    }
+  }
+  return buf;
+}
+#endif /* MYSQL_SERVER */
+
 #if !defined(MYSQL_CLIENT) && defined(HAVE_REPLICATION)
 static int rows_event_stmt_cleanup(rpl_group_info *rgi, THD* thd);
 
@@ -817,6 +958,13 @@ const char* Log_event::get_type_str(Log_event_type type)
   case GTID_EVENT: return "Gtid";
   case GTID_LIST_EVENT: return "Gtid_list";
   case START_ENCRYPTION_EVENT: return "Start_encryption";
+  case QUERY_COMPRESSED_EVENT: return "Query_compressed";
+  case WRITE_ROWS_COMPRESSED_EVENT_V1: return "Write_rows_compressed_v1";
+  case UPDATE_ROWS_COMPRESSED_EVENT_V1: return "Update_rows_compressed_v1";
+  case DELETE_ROWS_COMPRESSED_EVENT_V1: return "Delete_rows_compressed_v1";
+  case WRITE_ROWS_COMPRESSED_EVENT: return "Write_rows_compressed";
+  case UPDATE_ROWS_COMPRESSED_EVENT: return "Update_rows_compressed";
+  case DELETE_ROWS_COMPRESSED_EVENT: return "Delete_rows_compressed";
 
   /* The following is only for mysqlbinlog */
   case IGNORABLE_LOG_EVENT: return "Ignorable log event";
@@ -1660,6 +1808,10 @@ Log_event* Log_event::read_log_event(const char* buf, uint event_len,
     case QUERY_EVENT:
       ev  = new Query_log_event(buf, event_len, fdle, QUERY_EVENT);
       break;
+    case QUERY_COMPRESSED_EVENT:
+      ev= new Query_compressed_log_event(buf, event_len, fdle,
+                                         QUERY_COMPRESSED_EVENT);
+      break;
     case LOAD_EVENT:
       ev = new Load_log_event(buf, event_len, fdle);
       break;
@@ -1723,14 +1875,20 @@ Log_event* Log_event::read_log_event(const char* buf, uint event_len,
       break;
     case WRITE_ROWS_EVENT_V1:
     case WRITE_ROWS_EVENT:
+    case WRITE_ROWS_COMPRESSED_EVENT_V1:
+    case WRITE_ROWS_COMPRESSED_EVENT:
       ev = new Write_rows_log_event(buf, event_len, fdle);
       break;
     case UPDATE_ROWS_EVENT_V1:
     case UPDATE_ROWS_EVENT:
+    case UPDATE_ROWS_COMPRESSED_EVENT_V1:
+    case UPDATE_ROWS_COMPRESSED_EVENT:
       ev = new Update_rows_log_event(buf, event_len, fdle);
       break;
     case DELETE_ROWS_EVENT_V1:
     case DELETE_ROWS_EVENT:
+    case DELETE_ROWS_COMPRESSED_EVENT_V1:
+    case DELETE_ROWS_COMPRESSED_EVENT:
       ev = new Delete_rows_log_event(buf, event_len, fdle);
       break;
 
@@ -2816,6 +2974,8 @@ void Log_event::print_base64(IO_CACHE* file,
     }
     case WRITE_ROWS_EVENT:
     case WRITE_ROWS_EVENT_V1:
+    case WRITE_ROWS_COMPRESSED_EVENT:
+    case WRITE_ROWS_COMPRESSED_EVENT_V1:
     {
       ev= new Write_rows_log_event((const char*) ptr, size,
                                    glob_description_event);
@@ -2823,6 +2983,8 @@ void Log_event::print_base64(IO_CACHE* file,
     }
     case DELETE_ROWS_EVENT:
     case DELETE_ROWS_EVENT_V1:
+    case DELETE_ROWS_COMPRESSED_EVENT:
+    case DELETE_ROWS_COMPRESSED_EVENT_V1:
     {
       ev= new Delete_rows_log_event((const char*) ptr, size,
                                     glob_description_event);
@@ -2830,6 +2992,8 @@ void Log_event::print_base64(IO_CACHE* file,
     }
     case UPDATE_ROWS_EVENT:
     case UPDATE_ROWS_EVENT_V1:
+    case UPDATE_ROWS_COMPRESSED_EVENT:
+    case UPDATE_ROWS_COMPRESSED_EVENT_V1:
     {
       ev= new Update_rows_log_event((const char*) ptr, size,
                                     glob_description_event);
@@ -3773,6 +3937,87 @@ Query_log_event::Query_log_event(const char* buf, uint event_len,
 }
 
 
+/**************************************************************************
+	Query_compressed_log_event methods
+**************************************************************************/
+
+#ifdef MYSQL_SERVER
+Query_compressed_log_event::
+Query_compressed_log_event(THD* thd_arg, const char* query_arg,
+                           ulong query_length, bool using_trans,
+                           bool direct, bool suppress_use, int errcode)
+  :Query_log_event(thd_arg, query_arg, query_length, using_trans, direct,
+                   suppress_use, errcode),
+   query_buf(0), compressed(true)
+{
+}
+
+
+bool Query_compressed_log_event::write()
+{
+  const char *query_save= query;
+  uint32 q_len_save= q_len;
+  uint32 comlen;
+  uchar *combuf;
+  bool res;
+
+  if (!(combuf= binlog_compress_event_data(thd, (const uchar*) query, q_len,
+                                           &comlen)))
+  {
+    compressed= false;
+    return Query_log_event::write();
+  }
+
+  /* Log the compressed query in place of the query */
+  query= (const char*) combuf;
+  q_len= comlen;
+  res= Query_log_event::write();
+  query= query_save;
+  q_len= q_len_save;
+  my_free(combuf);
+  return res;
+}
+#endif /* MYSQL_SERVER */
+
+
+/**
+  Read a Query_compressed_log_event, and uncompress its query into
+  query_buf. The query is followed by the same bytes as in the data_buf
+  of a Query_log_event, see Query_log_event::Query_log_event(const char*,...)
+*/
+Query_compressed_log_event::
+Query_compressed_log_event(const char *buf, uint event_len,
+                           const Format_description_log_event
+                           *description_event,
+                           Log_event_type event_type)
+  :Query_log_event(buf, event_len, description_event, event_type),
+   query_buf(0), compressed(true)
+{
+  uint32 un_len;
+  size_t extra= 1;
+
+  if (!query)
+    return;
+#if !defined(MYSQL_CLIENT) && defined(HAVE_QUERY_CACHE)
+  extra+= sizeof(size_t) + QUERY_CACHE_DB_LENGTH_SIZE + QUERY_CACHE_FLAGS_SIZE;
+#endif
+  /* NULL if the query is corrupt, caught in is_valid() */
+  if (!(query_buf= binlog_buf_uncompress((const uchar*) query, q_len, &un_len,
+                                         extra)))
+  {
+    query= 0;
+    return;
+  }
+  query_buf[un_len]= '\0';
+#if !defined(MYSQL_CLIENT) && defined(HAVE_QUERY_CACHE)
+  size_t db_length= (size_t) db_len;
+  memcpy(query_buf + un_len + 1, &db_length, sizeof(size_t));
+#endif
+  query= (const char*) query_buf;
+  q_len= un_len;
+}
+
+
 /*
   Replace a binlog event read into a packet with a dummy event. Either a
   Query_log_event that has just a comment, or if that will not fit in the
@@ -3902,12 +4147,15 @@ Query_log_event::begin_event(String *packet, ulong ev_offset,
 
   /*
     Currently we only need to replace GTID event.
-    The length of GTID differs depending on whether it contains commit id.
+    The length of GTID differs depending on whether it contains commit id
+    (2 more bytes) and depends_seq_no (8 more bytes).
   */
-  DBUG_ASSERT(data_len == LOG_EVENT_HEADER_LEN + GTID_HEADER_LEN ||
-              data_len == LOG_EVENT_HEADER_LEN + GTID_HEADER_LEN + 2);
-  if (data_len != LOG_EVENT_HEADER_LEN + GTID_HEADER_LEN &&
-      data_len != LOG_EVENT_HEADER_LEN + GTID_HEADER_LEN + 2)
+  size_t extra_len= data_len - (LOG_EVENT_HEADER_LEN + GTID_HEADER_LEN);
+  DBUG_ASSERT(data_len >= LOG_EVENT_HEADER_LEN + GTID_HEADER_LEN &&
+              (extra_len == 0 || extra_len == 2 ||
+               extra_len == 8 || extra_len == 10));
+  if (data_len < LOG_EVENT_HEADER_LEN + GTID_HEADER_LEN ||
+      (extra_len != 0 && extra_len != 2 && extra_len != 8 && extra_len != 10))
     return 1;
 
   flags= uint2korr(p + FLAGS_OFFSET);
@@ -3920,22 +4168,15 @@ Query_log_event::begin_event(String *packet, ulong ev_offset,
   int4store(q + Q_EXEC_TIME_OFFSET, 0);
   q[Q_DB_LEN_OFFSET]= 0;
   int2store(q + Q_ERR_CODE_OFFSET, 0);
-  if (data_len == LOG_EVENT_HEADER_LEN + GTID_HEADER_LEN)
-  {
-    int2store(q + Q_STATUS_VARS_LEN_OFFSET, 0);
-    q[Q_DATA_OFFSET]= 0;                    /* Zero terminator for empty db */
-    q+= Q_DATA_OFFSET + 1;
-  }
-  else
+  /* Put in empty time_zone_str entries to take up the extra bytes. */
+  int2store(q + Q_STATUS_VARS_LEN_OFFSET, extra_len);
+  q+= Q_DATA_OFFSET;
+  for (; extra_len; extra_len-= 2)
   {
-    DBUG_ASSERT(data_len == LOG_EVENT_HEADER_LEN + GTID_HEADER_LEN + 2);
-    /* Put in an empty time_zone_str to take up the extra 2 bytes. */
-    int2store(q + Q_STATUS_VARS_LEN_OFFSET, 2);
-    q[Q_DATA_OFFSET]= Q_TIME_ZONE_CODE;
-    q[Q_DATA_OFFSET+1]= 0;           /* Zero length for empty time_zone_str */
-    q[Q_DATA_OFFSET+2]= 0;                  /* Zero terminator for empty db */
-    q+= Q_DATA_OFFSET + 3;
+    *q++= Q_TIME_ZONE_CODE;
+    *q++= 0;                         /* Zero length for empty time_zone_str */
   }
+  *q++= 0;                                  /* Zero terminator for empty db */
   memcpy(q, "BEGIN", 5);
 
   if (checksum_alg == BINLOG_CHECKSUM_ALG_CRC32)
@@ -5025,6 +5266,13 @@ Format_description_log_event(uint8 binlog_ver, const char* server_ver)
       post_header_len[GTID_EVENT-1]= GTID_HEADER_LEN;
       post_header_len[GTID_LIST_EVENT-1]= GTID_LIST_HEADER_LEN;
       post_header_len[START_ENCRYPTION_EVENT-1]= START_ENCRYPTION_HEADER_LEN;
+      post_header_len[QUERY_COMPRESSED_EVENT-1]= QUERY_HEADER_LEN;
+      post_header_len[WRITE_ROWS_COMPRESSED_EVENT_V1-1]= ROWS_HEADER_LEN_V1;
+      post_header_len[UPDATE_ROWS_COMPRESSED_EVENT_V1-1]= ROWS_HEADER_LEN_V1;
+      post_header_len[DELETE_ROWS_COMPRESSED_EVENT_V1-1]= ROWS_HEADER_LEN_V1;
+      post_header_len[WRITE_ROWS_COMPRESSED_EVENT-1]= ROWS_HEADER_LEN_V2;
+      post_header_len[UPDATE_ROWS_COMPRESSED_EVENT-1]= ROWS_HEADER_LEN_V2;
+      post_header_len[DELETE_ROWS_COMPRESSED_EVENT-1]= ROWS_HEADER_LEN_V2;
 
       // Sanity-check that all post header lengths are initialized.
       int i;
@@ -6566,7 +6814,8 @@ bool Binlog_checkpoint_log_event::write()
 
 Gtid_log_event::Gtid_log_event(const char *buf, uint event_len,
                const Format_description_log_event *description_event)
-  : Log_event(buf, description_event), seq_no(0), commit_id(0)
+  : Log_event(buf, description_event), seq_no(0), commit_id(0),
+    depends_seq_no(0)
 {
   uint8 header_size= description_event->common_header_len;
   uint8 post_header_len= description_event->post_header_len[GTID_EVENT-1];
@@ -6574,7 +6823,8 @@ Gtid_log_event::Gtid_log_event(const char *buf, uint event_len,
       post_header_len < GTID_HEADER_LEN)
     return;
 
-  buf+= header_size;
+  const char *post_header= buf + header_size;
+  buf= post_header;
   seq_no= uint8korr(buf);
   buf+= 8;
   domain_id= uint4korr(buf);
@@ -6590,6 +6840,16 @@ Gtid_log_event::Gtid_log_event(const char *buf, uint event_len,
     ++buf;
     commit_id= uint8korr(buf);
   }
+  if (flags2 & FL_DEPENDS)
+  {
+    uint offset= GTID_HEADER_LEN + ((flags2 & FL_GROUP_COMMIT_ID) ? 2 : 0);
+    if (event_len < (uint)header_size + offset + 8)
+    {
+      seq_no= 0;                                // So is_valid() returns false
+      return;
+    }
+    depends_seq_no= uint8korr(post_header + offset);
+  }
 }
 
 
@@ -6600,7 +6860,8 @@ Gtid_log_event::Gtid_log_event(THD *thd_arg, uint64 seq_no_arg,
                                uint16 flags_arg, bool is_transactional,
                                uint64 commit_id_arg)
   : Log_event(thd_arg, flags_arg, is_transactional),
-    seq_no(seq_no_arg), commit_id(commit_id_arg), domain_id(domain_id_arg),
+    seq_no(seq_no_arg), commit_id(commit_id_arg), depends_seq_no(0),
+    domain_id(domain_id_arg),
     flags2((standalone ? FL_STANDALONE : 0) | (commit_id_arg ? FL_GROUP_COMMIT_ID : 0))
 {
   cache_type= Log_event::EVENT_NO_CACHE;
@@ -6659,7 +6920,7 @@ Gtid_log_event::peek(const char *event_start, size_t event_len,
 bool
 Gtid_log_event::write()
 {
-  uchar buf[GTID_HEADER_LEN+2];
+  uchar buf[GTID_HEADER_LEN+2+8];
   size_t write_len;
 
   int8store(buf, seq_no);
@@ -6675,6 +6936,11 @@ Gtid_log_event::write()
     bzero(buf+13, GTID_HEADER_LEN-13);
     write_len= GTID_HEADER_LEN;
   }
+  if (flags2 & FL_DEPENDS)
+  {
+    int8store(buf+write_len, depends_seq_no);
+    write_len+= 8;
+  }
   return write_header(write_len) ||
          write_data(buf, write_len) ||
          write_footer();
@@ -6715,7 +6981,7 @@ Gtid_log_event::make_compatible_event(String *packet, bool *need_dummy_event,
 void
 Gtid_log_event::pack_info(Protocol *protocol)
 {
-  char buf[6+5+10+1+10+1+20+1+4+20+1];
+  char buf[6+5+10+1+10+1+20+1+4+20+1+9+20];
   char *p;
   p = strmov(buf, (flags2 & FL_STANDALONE ? "GTID " : "BEGIN GTID "));
   p= longlong10_to_str(domain_id, p, 10);
@@ -6728,6 +6994,11 @@ Gtid_log_event::pack_info(Protocol *protocol)
     p= strmov(p, " cid=");
     p= longlong10_to_str(commit_id, p, 10);
   }
+  if (flags2 & FL_DEPENDS)
+  {
+    p= strmov(p, " depends=");
+    p= longlong10_to_str(depends_seq_no, p, 10);
+  }
 
   protocol->store(buf, p-buf, &my_charset_bin);
 }
@@ -6839,6 +7110,11 @@ Gtid_log_event::print(FILE *file, PRINT_EVENT_INFO *print_event_info)
       longlong10_to_str(commit_id, buf2, 10);
       my_b_printf(&cache, " cid=%s", buf2);
     }
+    if (flags2 & FL_DEPENDS)
+    {
+      longlong10_to_str(depends_seq_no, buf2, 10);
+      my_b_printf(&cache, " depends=%s", buf2);
+    }
     if (flags2 & FL_DDL)
       my_b_write_string(&cache, " ddl");
     if (flags2 & FL_TRANSACTIONAL)
@@ -9365,10 +9641,11 @@ Rows_log_event::Rows_log_event(const char *buf, uint event_len,
 {
   DBUG_ENTER("Rows_log_event::Rows_log_event(const char*,...)");
   uint8 const common_header_len= description_event->common_header_len;
-  Log_event_type event_type= (Log_event_type) buf[EVENT_TYPE_OFFSET];
+  Log_event_type event_type= (Log_event_type)(uchar) buf[EVENT_TYPE_OFFSET];
   m_type= event_type;
   
   uint8 const post_header_len= description_event->post_header_len[event_type-1];
+  Log_event_type const rows_type= uncompressed_rows_event_type(event_type);
 
   DBUG_PRINT("enter",("event_len: %u  common_header_len: %d  "
 		      "post_header_len: %d",
@@ -9464,8 +9741,8 @@ Rows_log_event::Rows_log_event(const char *buf, uint event_len,
 
   m_cols_ai.bitmap= m_cols.bitmap; /* See explanation in is_valid() */
 
-  if ((event_type == UPDATE_ROWS_EVENT) ||
-      (event_type == UPDATE_ROWS_EVENT_V1))
+  if ((rows_type == UPDATE_ROWS_EVENT) ||
+      (rows_type == UPDATE_ROWS_EVENT_V1))
   {
     DBUG_PRINT("debug", ("Reading from %p", ptr_after_width));
 
@@ -9496,6 +9773,23 @@ Rows_log_event::Rows_log_event(const char *buf, uint event_len,
   DBUG_PRINT("info",("m_table_id: %lu  m_flags: %d  m_width: %lu  data_size: %lu",
                      m_table_id, m_flags, m_width, (ulong) data_size));
 
+  if (is_compressed_rows_event(event_type))
+  {
+    uint32 un_len;
+    /* NULL if the rows are corrupt, caught in is_valid() */
+    m_rows_buf= binlog_buf_uncompress(ptr_rows_data, (uint32) data_size,
+                                      &un_len, 0);
+    if (likely((bool)m_rows_buf))
+    {
+#if !defined(MYSQL_CLIENT) && defined(HAVE_REPLICATION)
+      m_curr_row= m_rows_buf;
+#endif
+      m_rows_end= m_rows_buf + un_len;
+      m_rows_cur= m_rows_end;
+    }
+    DBUG_VOID_RETURN;
+  }
+
   m_rows_buf= (uchar*) my_malloc(data_size, MYF(MY_WME));
   if (likely((bool)m_rows_buf))
   {
@@ -9534,7 +9828,8 @@ int Rows_log_event::get_data_size()
                   (m_rows_cur - m_rows_buf););
 
   int data_size= 0;
-  bool is_v2_event= get_type_code() > DELETE_ROWS_EVENT_V1;
+  bool is_v2_event=
+    uncompressed_rows_event_type(get_type_code()) > DELETE_ROWS_EVENT_V1;
   if (is_v2_event)
   {
     data_size= ROWS_HEADER_LEN_V2 +
@@ -9977,6 +10272,10 @@ int Rows_log_event::do_apply_event(rpl_group_info *rgi)
     rgi->set_row_stmt_start_timestamp();
 
     THD_STAGE_INFO(thd, stage_executing);
+    m_hash_scan= false;
+    if (!error && (get_general_type_code() == DELETE_ROWS_EVENT ||
+                   get_general_type_code() == UPDATE_ROWS_EVENT))
+      hash_scan_rows(rgi);
     do
     {
       /* in_use can have been set to NULL in close_tables_for_reopen */
@@ -10034,6 +10333,8 @@ int Rows_log_event::do_apply_event(rpl_group_info *rgi)
     } // row processing loop
     while (error == 0 && (m_curr_row != m_rows_end));
 
+    hash_scan_end();
+
     /*
       Restore the sql_mode after the rows event is processed.
     */
@@ -10246,6 +10547,32 @@ Rows_log_event::do_update_pos(rpl_group_info *rgi)
 #endif /* !defined(MYSQL_CLIENT) && defined(HAVE_REPLICATION) */
 
 #ifndef MYSQL_CLIENT
+bool Rows_log_event::write()
+{
+  uint32 len= (uint32) (m_rows_cur - m_rows_buf);
+  uchar *rows_buf= m_rows_buf, *rows_cur= m_rows_cur, *rows_end= m_rows_end;
+  Log_event_type type= m_type;
+  uint32 comlen;
+  uchar *combuf;
+  bool res;
+
+  if (!binlog_should_compress(len) ||
+      !(combuf= binlog_compress_event_data(thd, m_rows_buf, len, &comlen)))
+    return Log_event::write();
+
+  /* Log the compressed rows in place of the rows */
+  m_rows_buf= combuf;
+  m_rows_cur= m_rows_end= combuf + comlen;
+  m_type= compressed_rows_event_type(type);
+  res= Log_event::write();
+  m_rows_buf= rows_buf;
+  m_rows_cur= rows_cur;
+  m_rows_end= rows_end;
+  m_type= type;
+  my_free(combuf);
+  return res;
+}
+
 bool Rows_log_event::write_data_header()
 {
   uchar buf[ROWS_HEADER_LEN_V2];        // No need to init the buffer
@@ -11906,6 +12233,198 @@ void issue_long_find_row_warning(Log_event_type type,
 }
 
 
+/**
+  Hash the before image columns of the row in @c m_table->record[0].
+
+  Blobs are skipped, as their contents are not stored in the record.
+  Rows that record_compare() finds equal always have the same hash.
+*/
+ulong Rows_log_event::hash_record()
+{
+  ulong nr= 1, nr2= 4;
+  uint fields= MY_MIN(m_width, m_table->s->fields);
+
+  for (uint i= 0; i < fields; i++)
+  {
+    Field *field= m_table->field[i];
+    if (bitmap_is_set(&m_cols, i) && !(field->flags & BLOB_FLAG))
+      field->hash(&nr, &nr2);
+  }
+  return nr;
+}
+
+
+/**
+  Locate all rows of a DELETE or UPDATE event with a single table scan.
+
+  Without a usable key, find_row() has to scan the table once for every
+  row in the event. Instead, when the event has more than one row, the
+  before images are put in a hash and matched against every table row
+  in one pass. The position of each matching row is saved, so that
+  find_row() can later fetch it with rnd_pos().
+
+  Any row that is not found is left without a position, and find_row()
+  reports it as missing like a table scan would. If the hash cannot be
+  built, find_row() falls back to scanning the table for each row.
+*/
+void Rows_log_event::hash_scan_rows(rpl_group_info *rgi)
+{
+  TABLE *table= m_table;
+  hash_scan_row *first= NULL, **last= &first;
+  const uchar *saved_row_end= m_curr_row_end;
+  uint rows= 0, found= 0;
+  int error;
+  DBUG_ENTER("Rows_log_event::hash_scan_rows");
+
+  /*
+    BLACKHOLE pretends to find every row for the slave, so there is
+    nothing to match against.
+  */
+  if (m_key_info || !table->in_use || table->file->inited ||
+      table->file->ht->db_type == DB_TYPE_BLACKHOLE_DB ||
+      ((table->file->ha_table_flags() & HA_PRIMARY_KEY_REQUIRED_FOR_POSITION) &&
+       table->s->primary_key < MAX_KEY))
+    DBUG_VOID_RETURN;
+
+  init_alloc_root(&m_hash_scan_root, 4096, 0, MYF(MY_THREAD_SPECIFIC));
+  if (my_hash_init(&m_hash_scan_rows, &my_charset_bin, 64,
+                   offsetof(hash_scan_row, hash), sizeof(ulong), NULL, NULL,
+                   HASH_THREAD_SPECIFIC))
+  {
+    free_root(&m_hash_scan_root, MYF(0));
+    DBUG_VOID_RETURN;
+  }
+  m_hash_scan= true;
+  m_hash_scan_error= 0;
+
+  /* Hash the before image of every row in the event */
+  table->use_all_columns();
+  for (m_curr_row= m_rows_buf; m_curr_row != m_rows_end; rows++)
+  {
+    hash_scan_row *entry;
+    prepare_record(table, m_width, FALSE);
+    if (unpack_current_row(rgi) ||
+        !(entry= (hash_scan_row *) alloc_root(&m_hash_scan_root,
+                                              sizeof(*entry))))
+      goto err;
+    entry->hash= hash_record();
+    entry->row= m_curr_row;
+    entry->ref= NULL;
+    entry->next= NULL;
+    *last= entry;
+    last= &entry->next;
+    if (my_hash_insert(&m_hash_scan_rows, (uchar *) entry))
+      goto err;
+
+    /* Skip the after image of an update */
+    m_curr_row= m_curr_row_end;
+    if (get_general_type_code() == UPDATE_ROWS_EVENT)
+    {
+      if (unpack_current_row(rgi, &m_cols_ai))
+        goto err;
+      m_curr_row= m_curr_row_end;
+    }
+  }
+  if (rows < 2)
+    goto err;
+
+  DBUG_PRINT("info",("locating %u rows using one table scan (rnd_next)",
+                     rows));
+  /* We use this to test that the correct key is used in test cases. */
+  DBUG_EXECUTE_IF("slave_crash_if_table_scan", abort(););
+
+  if ((error= table->file->ha_rnd_init_with_error(1)))
+  {
+    m_hash_scan_error= error;
+    goto end;
+  }
+  while (found < rows)
+  {
+    HASH_SEARCH_STATE state;
+    hash_scan_row *entry;
+    ulong hash;
+    bool positioned= false;
+
+    if ((error= table->file->ha_rnd_next(table->record[0])))
+    {
+      if (error == HA_ERR_RECORD_DELETED)
+        continue;
+      if (error != HA_ERR_END_OF_FILE)
+        m_hash_scan_error= error;
+      break;
+    }
+
+    hash= hash_record();
+    for (entry= (hash_scan_row *) my_hash_first(&m_hash_scan_rows,
+                                                (uchar *) &hash, sizeof(hash),
+                                                &state);
+         entry;
+         entry= (hash_scan_row *) my_hash_next(&m_hash_scan_rows,
+                                               (uchar *) &hash, sizeof(hash),
+                                               &state))
+    {
+      if (entry->ref)
+        continue;
+      if (!positioned)
+      {
+        /*
+          Keep the table row in record[1] and unpack the candidate
+          before images into record[0] to compare them.
+        */
+        table->file->position(table->record[0]);
+        store_record(table, record[1]);
+        positioned= true;
+      }
+      m_curr_row= entry->row;
+      prepare_record(table, m_width, FALSE);
+      if (unpack_current_row(rgi))
+        continue;
+      if (!record_compare(table))
+      {
+        if (!(entry->ref= (uchar *) memdup_root(&m_hash_scan_root,
+                                                table->file->ref,
+                                                table->file->ref_length)))
+        {
+          table->file->ha_rnd_end();
+          goto err;
+        }
+        found++;
+        break;
+      }
+    }
+  }
+  table->file->ha_rnd_end();
+  statistic_increment(slave_rows_hash_scans, LOCK_status);
+  issue_long_find_row_warning(get_general_type_code(), m_table->alias.c_ptr(),
+                              false, rgi);
+
+end:
+  m_hash_scan_next= first;
+  m_curr_row= m_rows_buf;
+  m_curr_row_end= saved_row_end;
+  table->default_column_bitmaps();
+  DBUG_VOID_RETURN;
+
+err:
+  hash_scan_end();
+  m_curr_row= m_rows_buf;
+  m_curr_row_end= saved_row_end;
+  table->default_column_bitmaps();
+  DBUG_VOID_RETURN;
+}
+
+
+void Rows_log_event::hash_scan_end()
+{
+  if (m_hash_scan)
+  {
+    my_hash_free(&m_hash_scan_rows);
+    free_root(&m_hash_scan_root, MYF(0));
+    m_hash_scan= false;
+  }
+}
+
+
 /**
   Locate the current row in event's table.
 
@@ -11960,6 +12479,43 @@ int Rows_log_event::find_row(rpl_group_info *rgi)
   DBUG_PRINT("info",("looking for the following record"));
   DBUG_DUMP("record[0]", table->record[0], table->s->reclength);
 
+  if (m_hash_scan && !error)
+  {
+    hash_scan_row *entry= m_hash_scan_next;
+    if ((error= m_hash_scan_error) || !entry || entry->row != m_curr_row)
+    {
+      /* Report the scan error once, then locate rows one by one */
+      hash_scan_end();
+      if (error)
+      {
+        table->file->print_error(error, MYF(0));
+        DBUG_RETURN(error);
+      }
+    }
+    else
+    {
+      DBUG_PRINT("info",("locating record found by the hash scan (rnd_pos)"));
+      m_hash_scan_next= entry->next;
+      if (!entry->ref)
+        DBUG_RETURN(HA_ERR_END_OF_FILE);
+
+      if (!table->file->inited &&
+          (error= table->file->ha_rnd_init_with_error(0)))
+        DBUG_RETURN(error);
+
+      table->use_all_columns();
+      if ((error= table->file->ha_rnd_pos(table->record[0], entry->ref)))
+      {
+        DBUG_PRINT("info",("rnd_pos returns error %d",error));
+        if (error == HA_ERR_RECORD_DELETED)
+          error= HA_ERR_KEY_NOT_FOUND;
+        table->file->print_error(error, MYF(0));
+      }
+      table->default_column_bitmaps();
+      DBUG_RETURN(error);
+    }
+  }
+
   if ((table->file->ha_table_flags() & HA_PRIMARY_KEY_REQUIRED_FOR_POSITION) &&
       table->s->primary_key < MAX_KEY)
   {
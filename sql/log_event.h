@@ -692,6 +692,20 @@ enum Log_event_type
 
   START_ENCRYPTION_EVENT= 164,
 
+  /*
+    Compressed events. These are the Query and Rows events with their
+    query or their rows stored compressed, see binlog_buf_compress().
+    The rows events are in the same order as the uncompressed ones, see
+    uncompressed_rows_event_type().
+  */
+  QUERY_COMPRESSED_EVENT= 165,
+  WRITE_ROWS_COMPRESSED_EVENT_V1= 166,
+  UPDATE_ROWS_COMPRESSED_EVENT_V1= 167,
+  DELETE_ROWS_COMPRESSED_EVENT_V1= 168,
+  WRITE_ROWS_COMPRESSED_EVENT= 169,
+  UPDATE_ROWS_COMPRESSED_EVENT= 170,
+  DELETE_ROWS_COMPRESSED_EVENT= 171,
+
   /* Add new MariaDB events here - right above this comment!  */
 
   ENUM_END_EVENT /* end marker */
@@ -704,6 +718,54 @@ enum Log_event_type
 */
 #define LOG_EVENT_TYPES (ENUM_END_EVENT-1)
 
+static inline bool is_compressed_rows_event(Log_event_type type)
+{
+  return type >= WRITE_ROWS_COMPRESSED_EVENT_V1 &&
+         type <= DELETE_ROWS_COMPRESSED_EVENT;
+}
+
+/*
+  The type of a rows event with its rows not compressed, for example
+  WRITE_ROWS_EVENT_V1 for WRITE_ROWS_COMPRESSED_EVENT_V1
+*/
+static inline Log_event_type uncompressed_rows_event_type(Log_event_type type)
+{
+  if (type >= WRITE_ROWS_COMPRESSED_EVENT)
+    return (Log_event_type) (type - WRITE_ROWS_COMPRESSED_EVENT +
+                             WRITE_ROWS_EVENT);
+  if (type >= WRITE_ROWS_COMPRESSED_EVENT_V1)
+    return (Log_event_type) (type - WRITE_ROWS_COMPRESSED_EVENT_V1 +
+                             WRITE_ROWS_EVENT_V1);
+  return type;
+}
+
+/* The type of a rows event with its rows compressed */
+static inline Log_event_type compressed_rows_event_type(Log_event_type type)
+{
+  if (type >= WRITE_ROWS_EVENT)
+    return (Log_event_type) (type - WRITE_ROWS_EVENT +
+                             WRITE_ROWS_COMPRESSED_EVENT);
+  return (Log_event_type) (type - WRITE_ROWS_EVENT_V1 +
+                           WRITE_ROWS_COMPRESSED_EVENT_V1);
+}
+
+/*
+  The compressed query or rows of a compressed event:
+
+    1 byte     bit 7 always 1, bits 4-6 the algorithm (always 0, zlib),
+               bits 0-2 the number of bytes of the uncompressed length
+    1-4 bytes  the uncompressed length, high byte first
+    ...        the compressed data
+*/
+uint32 binlog_get_compress_len(uint32 len);
+bool binlog_buf_compress(const uchar *src, uchar *dst, uint32 len,
+                         uint32 *comlen);
+uchar *binlog_buf_uncompress(const uchar *src, uint32 len, uint32 *newlen,
+                             size_t extra);
+#ifdef MYSQL_SERVER
+bool binlog_should_compress(ulong len);
+#endif
+
 enum Int_event_type
 {
   INVALID_INT_EVENT = 0, LAST_INSERT_ID_EVENT = 1, INSERT_ID_EVENT = 2
@@ -2052,6 +2114,45 @@ class Query_log_event: public Log_event
 };
 
 
+/**
+  @class Query_compressed_log_event
+
+  A Query_log_event with the query stored compressed. It is logged
+  instead of a Query_log_event when log_bin_compress is set and the
+  query is at least log_bin_compress_min_len bytes long.
+
+  The query is uncompressed when the event is read, so that the event is
+  applied and printed as a Query_log_event. As log_bin_compress_min_len
+  is at least 10, BEGIN, COMMIT and ROLLBACK are never compressed.
+*/
+class Query_compressed_log_event: public Query_log_event
+{
+protected:
+  Log_event::Byte *query_buf;                   // The uncompressed query
+  /* false if the query did not compress, and is logged uncompressed */
+  bool compressed;
+public:
+#ifdef MYSQL_SERVER
+  Query_compressed_log_event(THD* thd_arg, const char* query_arg,
+                             ulong query_length, bool using_trans,
+                             bool direct, bool suppress_use, int error);
+  bool write();
+#endif
+  Query_compressed_log_event(const char* buf, uint event_len,
+                             const Format_description_log_event
+                             *description_event,
+                             Log_event_type event_type);
+  ~Query_compressed_log_event()
+  {
+    my_free(query_buf);
+  }
+  Log_event_type get_type_code()
+  {
+    return compressed ? QUERY_COMPRESSED_EVENT : QUERY_EVENT;
+  }
+};
+
+
 /*****************************************************************************
   sql_ex_info struct
  ****************************************************************************/
@@ -3159,6 +3260,8 @@ class Binlog_checkpoint_log_event: public Log_event
         @@SESSION.replicate_allow_parallel value was true at commit).</td>
     <td>Bit 4 set indicates that this transaction encountered a row (or other)
         lock wait during execution.</td>
+    <td>Bit 5 set indicates that the event group contains DDL.</td>
+    <td>Bit 6 set indicates that depends_seq_no exists.</td>
   </tr>
 
   <tr>
@@ -3168,10 +3271,20 @@ class Binlog_checkpoint_log_event: public Log_event
         group commit). OR commit id, same for all GTIDs in the same group
         commit (see flags bit 1).</td>
   </tr>
+
+  <tr>
+    <td>depends_seq_no (see flags bit 6)</td>
+    <td>8 byte unsigned integer</td>
+    <td>The largest seq_no in the same domain of an earlier event group that
+        changed a row with the same primary or unique key value, computed
+        with @@binlog_track_writesets. The event group does not conflict
+        with the event groups after that one.</td>
+  </tr>
   </table>
 
-  The Body of Gtid_log_event is empty. The total event size is 19 bytes +
-  the normal 19 bytes common-header.
+  The Body of Gtid_log_event is empty. The total event size is 19 bytes
+  (+ 2 with commit id, + 8 with depends_seq_no) + the normal 19 bytes
+  common-header. Old slaves ignore the depends_seq_no.
 */
 
 class Gtid_log_event: public Log_event
@@ -3179,6 +3292,7 @@ class Gtid_log_event: public Log_event
 public:
   uint64 seq_no;
   uint64 commit_id;
+  uint64 depends_seq_no;
   uint32 domain_id;
   uchar flags2;
 
@@ -3208,6 +3322,12 @@ class Gtid_log_event: public Log_event
   static const uchar FL_WAITED= 16;
   /* FL_DDL is set for event group containing DDL. */
   static const uchar FL_DDL= 32;
+  /*
+    FL_DEPENDS is set when the writeset of the event group was tracked on the
+    master, and depends_seq_no is the last earlier event group it conflicts
+    with.
+  */
+  static const uchar FL_DEPENDS= 64;
 
 #ifdef MYSQL_SERVER
   Gtid_log_event(THD *thd_arg, uint64 seq_no, uint32 domain_id, bool standalone,
@@ -3227,7 +3347,8 @@ class Gtid_log_event: public Log_event
   Log_event_type get_type_code() { return GTID_EVENT; }
   int get_data_size()
   {
-    return GTID_HEADER_LEN + ((flags2 & FL_GROUP_COMMIT_ID) ? 2 : 0);
+    return GTID_HEADER_LEN + ((flags2 & FL_GROUP_COMMIT_ID) ? 2 : 0) +
+      ((flags2 & FL_DEPENDS) ? 8 : 0);
   }
   bool is_valid() const { return seq_no != 0; }
 #ifdef MYSQL_SERVER
@@ -4337,6 +4458,7 @@ class Rows_log_event : public Log_event
 #endif
 
 #ifdef MYSQL_SERVER
+  bool write();
   virtual bool write_data_header();
   virtual bool write_data_body();
   virtual const char *get_db() { return m_table->s->db.str; }
@@ -4425,7 +4547,26 @@ class Rows_log_event : public Log_event
   uint      m_key_nr;   /* Key number */
   bool master_had_triggers;     /* set after tables opening */
 
+  /*
+    Row of a DELETE or UPDATE event located up front by hash_scan_rows().
+  */
+  struct hash_scan_row
+  {
+    ulong hash;                 /* Hash of the before image columns */
+    const uchar *row;           /* Before image in m_rows_buf */
+    uchar *ref;                 /* Position of the table row, NULL if none */
+    hash_scan_row *next;        /* Next row in event order */
+  };
+  bool      m_hash_scan;        /* find_row() uses m_hash_scan_next */
+  int       m_hash_scan_error;  /* Error from the table scan, if any */
+  hash_scan_row *m_hash_scan_next; /* Row that find_row() locates next */
+  HASH      m_hash_scan_rows;   /* Rows of the event, keyed on the hash */
+  MEM_ROOT  m_hash_scan_root;
+
   int find_key(); // Find a best key to use in find_row()
+  ulong hash_record(); // Hash the before image columns of record[0]
+  void hash_scan_rows(rpl_group_info *);
+  void hash_scan_end();
   int find_row(rpl_group_info *);
   int write_row(rpl_group_info *, const bool);
 
@@ -388,6 +388,8 @@ static DYNAMIC_ARRAY all_options;
 /* Global variables */
 
 bool opt_bin_log, opt_bin_log_used=0, opt_ignore_builtin_innodb= 0;
+my_bool opt_bin_log_compress;
+uint opt_bin_log_compress_min_len;
 my_bool opt_log, debug_assert_if_crashed_table= 0, opt_help= 0;
 my_bool disable_log_notes;
 static my_bool opt_abort;
@@ -528,6 +530,7 @@ ulong max_connections, max_connect_errors;
 ulong extra_max_connections;
 uint max_digest_length= 0;
 ulong slave_retried_transactions;
+ulong slave_rows_hash_scans;
 ulonglong slave_skipped_errors;
 ulong feature_files_opened_with_delayed_keys;
 ulonglong denied_connections;
@@ -573,6 +576,9 @@ ulong opt_slave_domain_parallel_threads= 0;
 ulong opt_slave_parallel_mode= SLAVE_PARALLEL_CONSERVATIVE;
 ulong opt_binlog_commit_wait_count= 0;
 ulong opt_binlog_commit_wait_usec= 0;
+my_bool opt_binlog_track_writesets= FALSE;
+ulong opt_binlog_writeset_history_size= 25000;
+ulong opt_binlog_dump_ring_size= 0;
 ulong opt_slave_parallel_max_queued= 131072;
 my_bool opt_gtid_ignore_duplicates= FALSE;
 
@@ -668,24 +674,27 @@ Le_creator le_creator;
 MYSQL_FILE *bootstrap_file;
 int bootstrap_error;
 
-I_List<THD> threads;
+THD_list server_threads;
 Rpl_filter* cur_rpl_filter;
 Rpl_filter* global_rpl_filter;
 Rpl_filter* binlog_filter;
 
+/*
+  Iteration over server_threads for plugins. The caller must make sure
+  that no THD is added or removed, use THD_list_iterator otherwise.
+*/
+
 THD *first_global_thread()
 {
-  if (threads.is_empty())
-    return NULL;
-  return threads.head();
+  return server_threads.first(0);
 }
 
 THD *next_global_thread(THD *thd)
 {
-  if (threads.is_last(thd))
-    return NULL;
-  struct ilink *next= thd->next;
-  return static_cast<THD*>(next);
+  uint shard= thd->thread_list_shard;
+  if (!server_threads.shards[shard].threads.is_last(thd))
+    return static_cast<THD*>(thd->next);
+  return server_threads.first(shard + 1);
 }
 
 struct system_variables global_system_variables;
@@ -889,7 +898,7 @@ PSI_mutex_key key_BINLOG_LOCK_index, key_BINLOG_LOCK_xid_list,
   key_structure_guard_mutex, key_TABLE_SHARE_LOCK_ha_data,
   key_LOCK_error_messages, key_LOG_INFO_lock,
   key_LOCK_thread_count, key_LOCK_thread_cache,
-  key_PARTITION_LOCK_auto_inc;
+  key_PARTITION_LOCK_auto_inc, key_LOCK_thread_list;
 PSI_mutex_key key_RELAYLOG_LOCK_index;
 PSI_mutex_key key_LOCK_slave_state, key_LOCK_binlog_state,
   key_LOCK_rpl_thread, key_LOCK_rpl_thread_pool, key_LOCK_parallel_entry;
@@ -972,6 +981,7 @@ static PSI_mutex_info all_server_mutexes[]=
   { &key_LOG_INFO_lock, "LOG_INFO::lock", 0},
   { &key_LOCK_thread_count, "LOCK_thread_count", PSI_FLAG_GLOBAL},
   { &key_LOCK_thread_cache, "LOCK_thread_cache", PSI_FLAG_GLOBAL},
+  { &key_LOCK_thread_list, "THD_list::lock", 0},
   { &key_PARTITION_LOCK_auto_inc, "HA_DATA_PARTITION::LOCK_auto_inc", 0},
   { &key_LOCK_slave_state, "LOCK_slave_state", 0},
   { &key_LOCK_binlog_state, "LOCK_binlog_state", 0},
@@ -982,7 +992,8 @@ static PSI_mutex_info all_server_mutexes[]=
 
 PSI_rwlock_key key_rwlock_LOCK_grant, key_rwlock_LOCK_logger,
   key_rwlock_LOCK_sys_init_connect, key_rwlock_LOCK_sys_init_slave,
-  key_rwlock_LOCK_system_variables_hash, key_rwlock_query_cache_query_lock;
+  key_rwlock_LOCK_system_variables_hash, key_rwlock_query_cache_query_lock,
+  key_rwlock_LOCK_binlog_ring;
 
 static PSI_rwlock_info all_server_rwlocks[]=
 {
@@ -994,7 +1005,8 @@ static PSI_rwlock_info all_server_rwlocks[]=
   { &key_rwlock_LOCK_sys_init_connect, "LOCK_sys_init_connect", PSI_FLAG_GLOBAL},
   { &key_rwlock_LOCK_sys_init_slave, "LOCK_sys_init_slave", PSI_FLAG_GLOBAL},
   { &key_rwlock_LOCK_system_variables_hash, "LOCK_system_variables_hash", PSI_FLAG_GLOBAL},
-  { &key_rwlock_query_cache_query_lock, "Query_cache_query::lock", 0}
+  { &key_rwlock_query_cache_query_lock, "Query_cache_query::lock", 0},
+  { &key_rwlock_LOCK_binlog_ring, "Binlog_ring::LOCK_ring", PSI_FLAG_GLOBAL}
 };
 
 #ifdef HAVE_MMAP
@@ -1435,6 +1447,7 @@ int deny_severity = LOG_WARNING;
 #endif
 #ifdef HAVE_QUERY_CACHE
 ulong query_cache_min_res_unit= QUERY_CACHE_MIN_RESULT_DATA_SIZE;
+uint query_cache_partitions= 1;
 Query_cache query_cache;
 #endif
 #ifdef HAVE_SMEM
@@ -1475,8 +1488,9 @@ struct st_VioSSLFd *ssl_acceptor_fd;
 #endif /* HAVE_OPENSSL */
 
 /**
-  Number of currently active user connections. The variable is protected by
-  LOCK_connection_count.
+  Number of currently active user connections. The variables are updated
+  with atomic operations, see inc_connection_count(). LOCK_connection_count
+  protects max_used_connections.
 */
 uint connection_count= 0, extra_connection_count= 0;
 
@@ -1634,9 +1648,7 @@ static void close_connections(void)
   */
 
   THD *tmp;
-  mysql_mutex_lock(&LOCK_thread_count); // For unlink from list
-
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
   while ((tmp=it++))
   {
     DBUG_PRINT("quit",("Informing thread %ld that it's time to die",
@@ -1677,7 +1689,7 @@ static void close_connections(void)
     }
     mysql_mutex_unlock(&tmp->LOCK_thd_data);
   }
-  mysql_mutex_unlock(&LOCK_thread_count); // For unlink from list
+  it.release();
 
   Events::deinit();
   end_slave();
@@ -1705,57 +1717,56 @@ static void close_connections(void)
     client on a blocking read call are aborted.
   */
 
-  for (;;)
+  for (bool found= true; found; )
   {
-    DBUG_PRINT("quit",("Locking LOCK_thread_count"));
-    mysql_mutex_lock(&LOCK_thread_count); // For unlink from list
-    if (!(tmp=threads.get()))
+    /*
+      The THDs are unlinked from the list here, the threads that own them
+      will find them unlinked in unlink_thd().
+    */
+    THD_list_iterator close_it(server_threads);
+    for (found= false; (tmp= close_it++); found= true)
     {
-      DBUG_PRINT("quit",("Unlocking LOCK_thread_count"));
-      mysql_mutex_unlock(&LOCK_thread_count);
-      break;
-    }
+      tmp->unlink();
 #ifndef __bsdi__				// Bug in BSDI kernel
-    if (tmp->vio_ok())
-    {
-      if (global_system_variables.log_warnings)
-        sql_print_warning(ER_DEFAULT(ER_FORCING_CLOSE),my_progname,
-                          tmp->thread_id,
-                          (tmp->main_security_ctx.user ?
-                           tmp->main_security_ctx.user : ""));
-      close_connection(tmp,ER_SERVER_SHUTDOWN);
-    }
+      if (tmp->vio_ok())
+      {
+        if (global_system_variables.log_warnings)
+          sql_print_warning(ER_DEFAULT(ER_FORCING_CLOSE),my_progname,
+                            tmp->thread_id,
+                            (tmp->main_security_ctx.user ?
+                             tmp->main_security_ctx.user : ""));
+        close_connection(tmp,ER_SERVER_SHUTDOWN);
+      }
 #endif
 #ifdef WITH_WSREP
-    /*
-     * WSREP_TODO:
-     *       this code block may turn out redundant. wsrep->disconnect()
-     *       should terminate slave threads gracefully, and we don't need
-     *       to signal them here. 
-     *       The code here makes sure mysqld will not hang during shutdown
-     *       even if wsrep provider has problems in shutting down.
-     */
-    if (WSREP(tmp) && tmp->wsrep_exec_mode==REPL_RECV)
-    {
-      sql_print_information("closing wsrep system thread");
-      tmp->killed= KILL_CONNECTION;
-      MYSQL_CALLBACK(thread_scheduler, post_kill_notification, (tmp));
-      if (tmp->mysys_var)
+      /*
+       * WSREP_TODO:
+       *       this code block may turn out redundant. wsrep->disconnect()
+       *       should terminate slave threads gracefully, and we don't need
+       *       to signal them here. 
+       *       The code here makes sure mysqld will not hang during shutdown
+       *       even if wsrep provider has problems in shutting down.
+       */
+      if (WSREP(tmp) && tmp->wsrep_exec_mode==REPL_RECV)
       {
-        tmp->mysys_var->abort=1;
-        mysql_mutex_lock(&tmp->mysys_var->mutex);
-        if (tmp->mysys_var->current_cond)
+        sql_print_information("closing wsrep system thread");
+        tmp->killed= KILL_CONNECTION;
+        MYSQL_CALLBACK(thread_scheduler, post_kill_notification, (tmp));
+        if (tmp->mysys_var)
         {
-          mysql_mutex_lock(tmp->mysys_var->current_mutex);
-          mysql_cond_broadcast(tmp->mysys_var->current_cond);
-          mysql_mutex_unlock(tmp->mysys_var->current_mutex);
+          tmp->mysys_var->abort=1;
+          mysql_mutex_lock(&tmp->mysys_var->mutex);
+          if (tmp->mysys_var->current_cond)
+          {
+            mysql_mutex_lock(tmp->mysys_var->current_mutex);
+            mysql_cond_broadcast(tmp->mysys_var->current_cond);
+            mysql_mutex_unlock(tmp->mysys_var->current_mutex);
+          }
+          mysql_mutex_unlock(&tmp->mysys_var->mutex);
         }
-        mysql_mutex_unlock(&tmp->mysys_var->mutex);
       }
-    }
 #endif
-    DBUG_PRINT("quit",("Unlocking LOCK_thread_count"));
-    mysql_mutex_unlock(&LOCK_thread_count);
+    }
   }
   /* All threads has now been aborted */
   DBUG_PRINT("quit",("Waiting for threads to die (count=%u)",thread_count));
@@ -2101,6 +2112,7 @@ void clean_up(bool print_message)
 
   injector::free_instance();
   mysql_bin_log.cleanup();
+  binlog_ring.cleanup();
 
   my_tz_free();
   my_dboptions_cache_free();
@@ -2232,6 +2244,7 @@ static void clean_up_mutexes()
   DBUG_ENTER("clean_up_mutexes");
   mysql_rwlock_destroy(&LOCK_grant);
   mysql_mutex_destroy(&LOCK_thread_count);
+  server_threads.destroy();
   mysql_mutex_destroy(&LOCK_thread_cache);
   mysql_mutex_destroy(&LOCK_status);
   mysql_mutex_destroy(&LOCK_show_status);
@@ -2837,9 +2850,7 @@ void dec_connection_count(THD *thd)
 #endif /* WITH_WSREP */
 
   DBUG_ASSERT(*thd->scheduler->connection_count > 0);
-  mysql_mutex_lock(&LOCK_connection_count);
-  (*thd->scheduler->connection_count)--;
-  mysql_mutex_unlock(&LOCK_connection_count);
+  thread_safe_decrement32((int32*) thd->scheduler->connection_count);
 }
 
 
@@ -2849,9 +2860,7 @@ void dec_connection_count(THD *thd)
 
 void delete_running_thd(THD *thd)
 {
-  mysql_mutex_lock(&LOCK_thread_count);
-  thd->unlink();
-  mysql_mutex_unlock(&LOCK_thread_count);
+  server_threads.erase(thd);
 
   delete thd;
   dec_thread_running();
@@ -2889,9 +2898,6 @@ void signal_thd_deleted()
   SYNOPSIS
     unlink_thd()
     thd		 Thread handler
-
-  NOTES
-    LOCK_thread_count is locked and left locked
 */
 
 void unlink_thd(THD *thd)
@@ -2904,16 +2910,7 @@ void unlink_thd(THD *thd)
 
   thd->add_status_to_global();
 
-  mysql_mutex_lock(&LOCK_thread_count);
-  thd->unlink();
-  /*
-    Used by binlog_reset_master.  It would be cleaner to use
-    DEBUG_SYNC here, but that's not possible because the THD's debug
-    sync feature has been shut down at this point.
-  */
-  DBUG_EXECUTE_IF("sleep_after_lock_thread_count_before_delete_thd", sleep(5););
-  mysql_mutex_unlock(&LOCK_thread_count);
-
+  server_threads.erase(thd);
   delete thd;
   thread_safe_decrement32(&thread_count);
 
@@ -2992,9 +2989,7 @@ static bool cache_thread()
       thd->start_utime= thd->thr_create_utime;
 
       /* Link thd into list of all active threads (THD's) */
-      mysql_mutex_lock(&LOCK_thread_count);
-      threads.append(thd);
-      mysql_mutex_unlock(&LOCK_thread_count);
+      server_threads.insert(thd);
       DBUG_RETURN(1);
     }
   }
@@ -4612,6 +4607,7 @@ static int init_thread_environment()
 {
   DBUG_ENTER("init_thread_environment");
   mysql_mutex_init(key_LOCK_thread_count, &LOCK_thread_count, MY_MUTEX_INIT_FAST);
+  server_threads.init();
   mysql_mutex_init(key_LOCK_thread_cache, &LOCK_thread_cache, MY_MUTEX_INIT_FAST);
   mysql_mutex_init(key_LOCK_status, &LOCK_status, MY_MUTEX_INIT_FAST);
   mysql_mutex_init(key_LOCK_show_status, &LOCK_show_status, MY_MUTEX_INIT_SLOW);
@@ -5222,7 +5218,7 @@ static int init_server_components()
 
     /* Now is the time to initialize threads for queries. */
     THD *tmp;
-    I_List_iterator<THD> it(threads);
+    THD_list_iterator it(server_threads);
     while ((tmp= it++))
     {
       if (tmp->wsrep_applier == true)
@@ -5371,6 +5367,10 @@ static int init_server_components()
     unireg_abort(1);
   }
 
+  if (opt_bin_log && opt_binlog_dump_ring_size && !encrypt_binlog &&
+      binlog_ring.init(opt_binlog_dump_ring_size))
+    unireg_abort(1);
+
   if (opt_bin_log)
   {
     /**
@@ -6267,7 +6267,7 @@ static void bootstrap(MYSQL_FILE *file)
   my_net_init(&thd->net,(st_vio*) 0, (void*) 0, MYF(0));
   thd->max_client_packet_length= thd->net.max_packet;
   thd->security_ctx->master_access= ~(ulong)0;
-  thd->thread_id= thd->variables.pseudo_thread_id= thread_id++;
+  thd->thread_id= thd->variables.pseudo_thread_id= next_thread_id();
   thread_count++;                        // Safe as only one thread running
   in_bootstrap= TRUE;
 
@@ -6331,16 +6331,12 @@ void inc_thread_created(void)
    NOTES
      This is only used for debugging, when starting mysqld with
      --thread-handling=no-threads or --one-thread
-
-     When we enter this function, LOCK_thread_count is hold!
 */
 
 void handle_connection_in_main_thread(THD *thd)
 {
-  mysql_mutex_assert_owner(&LOCK_thread_count);
   thread_cache_size=0;			// Safety
-  threads.append(thd);
-  mysql_mutex_unlock(&LOCK_thread_count);
+  server_threads.insert(thd);
   thd->start_utime= microsecond_interval_timer();
   do_handle_one_connection(thd);
 }
@@ -6353,7 +6349,6 @@ void handle_connection_in_main_thread(THD *thd)
 void create_thread_to_handle_connection(THD *thd)
 {
   DBUG_ENTER("create_thread_to_handle_connection");
-  mysql_mutex_assert_owner(&LOCK_thread_count);
 
   /* Check if we can get thread from the cache */
   if (cached_thread_count > wake_thread)
@@ -6362,7 +6357,6 @@ void create_thread_to_handle_connection(THD *thd)
     /* Recheck condition when we have the lock */
     if (cached_thread_count > wake_thread)
     {
-      mysql_mutex_unlock(&LOCK_thread_count);
       /* Get thread from cache */
       thread_cache.push_back(thd);
       wake_thread++;
@@ -6378,7 +6372,7 @@ void create_thread_to_handle_connection(THD *thd)
   /* Create new thread to handle connection */
   int error;
   thread_created++;
-  threads.append(thd);
+  server_threads.insert(thd);
   DBUG_PRINT("info",(("creating thread %lu"), thd->thread_id));
   thd->prior_thr_create_utime= microsecond_interval_timer();
   if ((error= mysql_thread_create(key_thread_one_connection,
@@ -6391,11 +6385,8 @@ void create_thread_to_handle_connection(THD *thd)
                ("Can't create thread to handle request (error %d)",
                 error));
     thd->killed= KILL_CONNECTION;             // Safety
-    mysql_mutex_unlock(&LOCK_thread_count);
 
-    mysql_mutex_lock(&LOCK_connection_count);
-    (*thd->scheduler->connection_count)--;
-    mysql_mutex_unlock(&LOCK_connection_count);
+    dec_connection_count(thd);
 
     statistic_increment(aborted_connects,&LOCK_status);
     statistic_increment(connection_errors_internal, &LOCK_status);
@@ -6405,20 +6396,54 @@ void create_thread_to_handle_connection(THD *thd)
     net_send_error(thd, ER_CANT_CREATE_THREAD, error_message_buff, NULL);
     close_connection(thd, ER_OUT_OF_RESOURCES);
 
-    mysql_mutex_lock(&LOCK_thread_count);
-    thd->unlink();
-    mysql_mutex_unlock(&LOCK_thread_count);
+    server_threads.erase(thd);
     delete thd;
     thread_safe_decrement32(&thread_count);
     return;
     /* purecov: end */
   }
-  mysql_mutex_unlock(&LOCK_thread_count);
   DBUG_PRINT("info",("Thread created"));
   DBUG_VOID_RETURN;
 }
 
 
+/**
+  Count a new connection of the scheduler of thd
+
+  @retval FALSE  OK
+  @retval TRUE   The scheduler has max_connections + 1 connections already
+
+  @note LOCK_connection_count is only taken when max_used_connections
+        grows.
+*/
+
+static bool inc_connection_count(THD *thd)
+{
+  int32 *count= (int32*) thd->scheduler->connection_count;
+  int32 old_count= my_atomic_load32_explicit(count, MY_MEMORY_ORDER_RELAXED);
+  ulong used;
+
+  do
+  {
+    if ((ulong) old_count >= *thd->scheduler->max_connections + 1)
+      return TRUE;
+  } while (!my_atomic_cas32_weak_explicit(count, &old_count, old_count + 1,
+                                          MY_MEMORY_ORDER_RELAXED,
+                                          MY_MEMORY_ORDER_RELAXED));
+
+  used= connection_count + extra_connection_count;
+  if (used > max_used_connections)
+  {
+    mysql_mutex_lock(&LOCK_connection_count);
+    used= connection_count + extra_connection_count;
+    if (used > max_used_connections)
+      max_used_connections= used;
+    mysql_mutex_unlock(&LOCK_connection_count);
+  }
+  return FALSE;
+}
+
+
 /**
   Create new thread to handle incoming connection.
 
@@ -6441,13 +6466,8 @@ static void create_new_thread(THD *thd)
     only (max_connections + 1) connections.
   */
 
-  mysql_mutex_lock(&LOCK_connection_count);
-
-  if (*thd->scheduler->connection_count >=
-      *thd->scheduler->max_connections + 1|| abort_loop)
+  if (abort_loop || inc_connection_count(thd))
   {
-    mysql_mutex_unlock(&LOCK_connection_count);
-
     DBUG_PRINT("error",("Too many connections"));
     close_connection(thd, ER_CON_COUNT_ERROR);
     statistic_increment(denied_connections, &LOCK_status);
@@ -6456,23 +6476,15 @@ static void create_new_thread(THD *thd)
     DBUG_VOID_RETURN;
   }
 
-  ++*thd->scheduler->connection_count;
-
-  if (connection_count + extra_connection_count > max_used_connections)
-    max_used_connections= connection_count + extra_connection_count;
-
-  mysql_mutex_unlock(&LOCK_connection_count);
-
   thread_safe_increment32(&thread_count);
 
   /* Start a new thread to handle connection. */
-  mysql_mutex_lock(&LOCK_thread_count);
   /*
     The initialization of thread_id is done in create_embedded_thd() for
     the embedded library.
     TODO: refactor this to avoid code duplication there
   */
-  thd->thread_id= thd->variables.pseudo_thread_id= thread_id++;
+  thd->thread_id= thd->variables.pseudo_thread_id= next_thread_id();
 
   MYSQL_CALLBACK(thd->scheduler, add_connection, (thd));
 
@@ -7542,6 +7554,9 @@ struct my_option my_long_options[]=
    "effort to avoid any conflicts. \"aggressive\" tries to maximise the "
    "parallelism, possibly at the cost of increased conflict rate. "
    "\"minimal\" only parallelizes the commit steps of transactions. "
+   "\"writeset\" is like \"conservative\", and also applies in parallel "
+   "transactions that changed different keys, as recorded in the binlog "
+   "by a master with binlog_track_writesets=ON. "
    "\"none\" disables parallel apply completely.",
    &opt_slave_parallel_mode, &opt_slave_parallel_mode,
    &slave_parallel_mode_typelib, GET_ENUM | GET_ASK_ADDR, REQUIRED_ARG,
@@ -8277,6 +8292,51 @@ static int show_default_keycache(THD *thd, SHOW_VAR *var, char *buff,
 }
 
 
+#ifdef HAVE_QUERY_CACHE
+static int show_query_cache(THD *thd, SHOW_VAR *var, char *buff,
+                            enum enum_var_type scope)
+{
+  struct st_data {
+    Query_cache_status status;
+    SHOW_VAR var[9];
+  } *data;
+  SHOW_VAR *v;
+
+  data=(st_data *)buff;
+  v= data->var;
+
+  var->type= SHOW_ARRAY;
+  var->value= v;
+
+  /* The statistics of all query cache partitions are summed up */
+  query_cache.get_status(&data->status);
+
+#define set_one_qcache_var(X,Y)         \
+  v->name= X;                           \
+  v->type= SHOW_LONG;                   \
+  v->value= (char*) &data->status.Y;    \
+  v++;
+
+  set_one_qcache_var("free_blocks",       free_memory_blocks);
+  set_one_qcache_var("free_memory",       free_memory);
+  set_one_qcache_var("hits",              hits);
+  set_one_qcache_var("inserts",           inserts);
+  set_one_qcache_var("lowmem_prunes",     lowmem_prunes);
+  set_one_qcache_var("not_cached",        refused);
+  set_one_qcache_var("queries_in_cache",  queries_in_cache);
+  set_one_qcache_var("total_blocks",      total_blocks);
+
+  v->name= 0;
+
+  DBUG_ASSERT((char*)(v+1) <= buff + SHOW_VAR_FUNC_BUFF_SIZE);
+
+#undef set_one_qcache_var
+
+  return 0;
+}
+#endif /*HAVE_QUERY_CACHE*/
+
+
 static int show_memory_used(THD *thd, SHOW_VAR *var, char *buff,
                             enum enum_var_type scope)
 {
@@ -8348,9 +8408,17 @@ SHOW_VAR status_vars[]= {
   {"Aborted_connects",         (char*) &aborted_connects,       SHOW_LONG},
   {"Acl",                      (char*) acl_statistics,          SHOW_ARRAY},
   {"Access_denied_errors",     (char*) offsetof(STATUS_VAR, access_denied_errors), SHOW_LONG_STATUS},
+  {"Binlog_bytes_after_compression", (char*) offsetof(STATUS_VAR, binlog_bytes_after_compression), SHOW_LONGLONG_STATUS},
+  {"Binlog_bytes_before_compression", (char*) offsetof(STATUS_VAR, binlog_bytes_before_compression), SHOW_LONGLONG_STATUS},
   {"Binlog_bytes_written",     (char*) offsetof(STATUS_VAR, binlog_bytes_written), SHOW_LONGLONG_STATUS},
   {"Binlog_cache_disk_use",    (char*) &binlog_cache_disk_use,  SHOW_LONG},
   {"Binlog_cache_use",         (char*) &binlog_cache_use,       SHOW_LONG},
+  {"Binlog_compressed_events", (char*) offsetof(STATUS_VAR, binlog_compressed_events), SHOW_LONGLONG_STATUS},
+  {"Binlog_compression_time",  (char*) offsetof(STATUS_VAR, binlog_compression_time), SHOW_LONGLONG_STATUS},
+  {"Binlog_decompressed_events", (char*) offsetof(STATUS_VAR, binlog_decompressed_events), SHOW_LONGLONG_STATUS},
+  {"Binlog_decompression_time", (char*) offsetof(STATUS_VAR, binlog_decompression_time), SHOW_LONGLONG_STATUS},
+  {"Binlog_dump_ring_hits",    (char*) &binlog_ring.hits,       SHOW_LONGLONG},
+  {"Binlog_dump_ring_misses",  (char*) &binlog_ring.misses,     SHOW_LONGLONG},
   {"Binlog_stmt_cache_disk_use",(char*) &binlog_stmt_cache_disk_use,  SHOW_LONG},
   {"Binlog_stmt_cache_use",    (char*) &binlog_stmt_cache_use,       SHOW_LONG},
   {"Busy_time",                (char*) offsetof(STATUS_VAR, busy_time), SHOW_DOUBLE_STATUS},
@@ -8436,14 +8504,7 @@ SHOW_VAR status_vars[]= {
   {"Rows_read",                (char*) offsetof(STATUS_VAR, rows_read), SHOW_LONGLONG_STATUS},
   {"Rows_tmp_read",            (char*) offsetof(STATUS_VAR, rows_tmp_read), SHOW_LONGLONG_STATUS},
 #ifdef HAVE_QUERY_CACHE
-  {"Qcache_free_blocks",       (char*) &query_cache.free_memory_blocks, SHOW_LONG_NOFLUSH},
-  {"Qcache_free_memory",       (char*) &query_cache.free_memory, SHOW_LONG_NOFLUSH},
-  {"Qcache_hits",              (char*) &query_cache.hits,       SHOW_LONG},
-  {"Qcache_inserts",           (char*) &query_cache.inserts,    SHOW_LONG},
-  {"Qcache_lowmem_prunes",     (char*) &query_cache.lowmem_prunes, SHOW_LONG},
-  {"Qcache_not_cached",        (char*) &query_cache.refused,    SHOW_LONG},
-  {"Qcache_queries_in_cache",  (char*) &query_cache.queries_in_cache, SHOW_LONG_NOFLUSH},
-  {"Qcache_total_blocks",      (char*) &query_cache.total_blocks, SHOW_LONG_NOFLUSH},
+  {"Qcache",                   (char*) &show_query_cache,       SHOW_FUNC},
 #endif /*HAVE_QUERY_CACHE*/
   {"Queries",                  (char*) &show_queries,            SHOW_SIMPLE_FUNC},
   {"Questions",                (char*) offsetof(STATUS_VAR, questions), SHOW_LONG_STATUS},
@@ -8460,6 +8521,7 @@ SHOW_VAR status_vars[]= {
   {"Slave_heartbeat_period",   (char*) &show_heartbeat_period, SHOW_SIMPLE_FUNC},
   {"Slave_received_heartbeats",(char*) &show_slave_received_heartbeats, SHOW_SIMPLE_FUNC},
   {"Slave_retried_transactions",(char*)&slave_retried_transactions, SHOW_LONG},
+  {"Slave_rows_hash_scans",    (char*) &slave_rows_hash_scans, SHOW_LONG},
   {"Slave_running",            (char*) &show_slave_running,     SHOW_SIMPLE_FUNC},
   {"Slave_skipped_errors",     (char*) &slave_skipped_errors, SHOW_LONGLONG},
 #endif
@@ -8737,7 +8799,6 @@ static int mysql_init_variables(void)
   executed_events= 0;
   global_query_id= thread_id= 1L;
   strmov(server_version, MYSQL_SERVER_VERSION);
-  threads.empty();
   thread_cache.empty();
   key_caches.empty();
   if (!(dflt_key_cache= get_or_create_key_cache(default_key_cache_base.str,
@@ -8760,6 +8821,7 @@ static int mysql_init_variables(void)
   report_user= report_password = report_host= 0;	/* TO BE DELETED */
   opt_relay_logname= opt_relaylog_index_name= 0;
   slave_retried_transactions= 0;
+  slave_rows_hash_scans= 0;
   log_bin_basename= NULL;
   log_bin_index= NULL;
 
@@ -9955,6 +10017,9 @@ void refresh_status(THD *thd)
 
   /* Reset the counters of all key caches (default and named). */
   process_key_caches(reset_key_cache_counters, 0);
+#ifdef HAVE_QUERY_CACHE
+  query_cache.reset_status();
+#endif
   flush_status_time= time((time_t*) 0);
   mysql_mutex_unlock(&LOCK_status);
 
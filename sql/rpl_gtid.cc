@@ -2462,3 +2462,119 @@ gtid_waiting::remove_from_wait_queue(gtid_waiting::hash_element *he,
 
   queue_remove(&he->queue, elem->queue_idx);
 }
+
+
+rpl_writeset_history::rpl_writeset_history()
+{
+  my_hash_init(&hash, &my_charset_bin, 1024, offsetof(entry, key),
+               sizeof(uint64), NULL, NULL, HASH_UNIQUE);
+  init_alloc_root(&mem_root, 16384, 0, MYF(0));
+  my_init_dynamic_array(&domains, sizeof(domain), 8, 8, MYF(0));
+}
+
+
+rpl_writeset_history::~rpl_writeset_history()
+{
+  my_hash_free(&hash);
+  free_root(&mem_root, MYF(0));
+  delete_dynamic(&domains);
+}
+
+
+void
+rpl_writeset_history::reset()
+{
+  my_hash_reset(&hash);
+  free_root(&mem_root, MYF(MY_KEEP_PREALLOC));
+  reset_dynamic(&domains);
+}
+
+
+/*
+  Add the writeset of an event group to the history.
+
+  Returns true and the last earlier event group of the domain that the new
+  event group conflicts with in *depends_seq_no. Returns false if the event
+  group must be treated as depending on all earlier event groups: if it has
+  no writeset (writeset == NULL), if the writeset is larger than max_size,
+  if the seq_no is not increasing within the domain, or on out of memory.
+*/
+bool
+rpl_writeset_history::add(uint32 domain_id, uint64 seq_no,
+                          const uint64 *writeset, uint count, ulong max_size,
+                          uint64 *depends_seq_no)
+{
+  domain *d= NULL;
+  uint64 depends;
+  uint i;
+
+  for (i= 0; i < domains.elements; ++i)
+  {
+    domain *e= dynamic_element(&domains, i, domain *);
+    if (e->domain_id == domain_id)
+    {
+      d= e;
+      break;
+    }
+  }
+  if (!d)
+  {
+    domain new_domain;
+    new_domain.domain_id= domain_id;
+    new_domain.last_seq_no= 0;
+    /* Nothing is known about the event groups logged before. */
+    new_domain.barrier_seq_no= seq_no - 1;
+    if (insert_dynamic(&domains, (uchar *)&new_domain))
+      return false;
+    d= dynamic_element(&domains, domains.elements - 1, domain *);
+  }
+
+  if (!writeset || count > max_size || seq_no <= d->last_seq_no)
+  {
+    d->barrier_seq_no= d->last_seq_no= seq_no;
+    return false;
+  }
+
+  if (hash.records + count > max_size)
+  {
+    for (i= 0; i < domains.elements; ++i)
+    {
+      domain *e= dynamic_element(&domains, i, domain *);
+      e->barrier_seq_no= e->last_seq_no;
+    }
+    my_hash_reset(&hash);
+    free_root(&mem_root, MYF(MY_KEEP_PREALLOC));
+  }
+
+  depends= d->barrier_seq_no;
+  d->last_seq_no= seq_no;
+  for (i= 0; i < count; ++i)
+  {
+    uint64 key= writeset[i] + domain_id * 0x9E3779B97F4A7C15ULL;
+    entry *e= (entry *)my_hash_search(&hash, (const uchar *)&key, 0);
+    if (e)
+    {
+      /* The same key may be in the writeset more than once. */
+      if (e->seq_no != seq_no && e->seq_no > depends)
+        depends= e->seq_no;
+      e->seq_no= seq_no;
+    }
+    else
+    {
+      if (!(e= (entry *)alloc_root(&mem_root, sizeof(*e))))
+      {
+        d->barrier_seq_no= seq_no;
+        return false;
+      }
+      e->key= key;
+      e->seq_no= seq_no;
+      if (my_hash_insert(&hash, (uchar *)e))
+      {
+        d->barrier_seq_no= seq_no;
+        return false;
+      }
+    }
+  }
+  *depends_seq_no= depends;
+  return true;
+}
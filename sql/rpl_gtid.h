@@ -301,6 +301,52 @@ struct slave_connection_state
 };
 
 
+/*
+  History of the writesets of the last event groups written to the binlog,
+  to find for @@binlog_track_writesets the last earlier event group in the
+  same domain that an event group conflicts with
+  (Gtid_log_event::depends_seq_no).
+
+  A writeset is a list of hashes of the primary and unique key values that
+  the event group changed. The history maps each hash to the seq_no of the
+  last event group that changed that key. Event groups without a writeset
+  are a barrier: all later event groups in the domain depend on them. When
+  the history grows beyond @@binlog_writeset_history_size it is cleared,
+  which also makes a barrier of the last event group of each domain.
+
+  Protected by LOCK_log.
+*/
+struct rpl_writeset_history
+{
+  struct entry {
+    /* Hash of the key value, mixed with the domain_id. */
+    uint64 key;
+    /* The last event group that changed the key. */
+    uint64 seq_no;
+  };
+  struct domain {
+    uint32 domain_id;
+    /* The seq_no of the last event group of the domain. */
+    uint64 last_seq_no;
+    /* All later event groups depend on at least this one. */
+    uint64 barrier_seq_no;
+  };
+  /* Mapping from key to entry. */
+  HASH hash;
+  /* The entries of the hash are allocated here. */
+  MEM_ROOT mem_root;
+  DYNAMIC_ARRAY domains;
+
+  rpl_writeset_history();
+  ~rpl_writeset_history();
+
+  bool is_empty() const { return domains.elements == 0; }
+  void reset();
+  bool add(uint32 domain_id, uint64 seq_no, const uint64 *writeset,
+           uint count, ulong max_size, uint64 *depends_seq_no);
+};
+
+
 extern bool rpl_slave_state_tostring_helper(String *dest, const rpl_gtid *gtid,
                                             bool *first);
 extern int gtid_check_rpl_slave_state_table(TABLE *table);
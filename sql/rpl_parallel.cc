@@ -963,10 +963,8 @@ handle_rpl_parallel_thread(void *arg)
   my_thread_init();
   thd = new THD;
   thd->thread_stack = (char*)&thd;
-  mysql_mutex_lock(&LOCK_thread_count);
-  thd->thread_id= thd->variables.pseudo_thread_id= thread_id++;
-  threads.append(thd);
-  mysql_mutex_unlock(&LOCK_thread_count);
+  thd->thread_id= thd->variables.pseudo_thread_id= next_thread_id();
+  server_threads.insert(thd);
   set_current_thd(thd);
   pthread_detach_this_thread();
   thd->init_for_queries();
@@ -1365,10 +1363,9 @@ handle_rpl_parallel_thread(void *arg)
   thd->reset_db(NULL, 0);
   thd_proc_info(thd, "Slave worker thread exiting");
   thd->temporary_tables= 0;
-  mysql_mutex_lock(&LOCK_thread_count);
   THD_CHECK_SENTRY(thd);
+  server_threads.erase(thd);
   delete thd;
-  mysql_mutex_unlock(&LOCK_thread_count);
 
   mysql_mutex_lock(&rpt->LOCK_rpl_thread);
   rpt->running= false;
@@ -2594,7 +2591,21 @@ rpl_parallel::do_event(rpl_group_info *serial_rgi, Log_event *ev,
         */
         new_gco= false;
       }
-      else if ((mode >= SLAVE_PARALLEL_OPTIMISTIC) &&
+      else if (mode == SLAVE_PARALLEL_WRITESET &&
+               (gtid_flags & Gtid_log_event::FL_DEPENDS) &&
+               !(flags & group_commit_orderer::FORCE_SWITCH) &&
+               gtid_ev->depends_seq_no < e->current_gco_min_seq_no)
+      {
+        /*
+          The master found that this event group does not conflict with any
+          event group after depends_seq_no, and that one is in an earlier gco.
+          So it is safe to run in parallel with the current batch, once all
+          earlier batches have started to commit, as for conservative mode.
+        */
+        new_gco= false;
+      }
+      else if ((mode == SLAVE_PARALLEL_OPTIMISTIC ||
+                mode == SLAVE_PARALLEL_AGGRESSIVE) &&
                !(flags & group_commit_orderer::FORCE_SWITCH))
       {
         /*
@@ -2667,7 +2678,10 @@ rpl_parallel::do_event(rpl_group_info *serial_rgi, Log_event *ev,
       }
       gco->flags|= force_switch_flag;
       e->current_gco= gco;
+      e->current_gco_min_seq_no= gtid_ev->seq_no;
     }
+    else if (gtid_ev->seq_no < e->current_gco_min_seq_no)
+      e->current_gco_min_seq_no= gtid_ev->seq_no;
     rgi->gco= gco;
 
     qev->rgi= e->current_group_info= rgi;
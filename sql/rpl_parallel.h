@@ -256,6 +256,12 @@ struct rpl_parallel_entry {
   */
   uint32 need_sub_id_signal;
   uint64 last_commit_id;
+  /*
+    The smallest seq_no of the event groups in current_gco. Used in
+    slave_parallel_mode=writeset, where an event group can join current_gco
+    if its Gtid_log_event::depends_seq_no is smaller.
+  */
+  uint64 current_gco_min_seq_no;
   bool active;
   /*
     Set when SQL thread is shutting down, and no more events can be processed,
@@ -302,6 +302,21 @@ The query cache interfaces with the rest of the server code through 7
          the used memory blocks in physical memory order and move all avail-
          able memory to the 'bottom' of the memory.
 
+8. Partitions
+
+When query_cache_partitions > 1 the global query_cache object owns an
+array of Query_cache objects and only dispatches the calls to them. Each
+partition has its own memory pool, hashes and structure_guard_mutex, so
+statements in different partitions never wait for each other.
+  - send_result_to_client() builds the key and hashes the statement text
+    (thd->base_query) to find the partition; store_query() uses the same
+    hash, so a statement is looked up where it was stored.
+  - insert(), end_of_result() and abort() go to the partition remembered
+    in Query_cache_tls::partition by store_query().
+  - A table may be used by queries in every partition, so invalidation
+    locks and searches all partitions one after another.
+  - query_cache_size is divided evenly between the partitions.
+
 
 TODO list:
 
@@ -1073,6 +1088,13 @@ Query_cache::insert(THD *thd, Query_cache_tls *query_cache_tls,
   if (is_disabled() || query_cache_tls->first_query_block == NULL)
     DBUG_VOID_RETURN;
 
+  if (m_partitions)
+  {
+    query_cache_tls->partition->insert(thd, query_cache_tls, packet, length,
+                                       pkt_nr);
+    DBUG_VOID_RETURN;
+  }
+
   QC_DEBUG_SYNC("wait_in_query_cache_insert");
 
   /*
@@ -1111,8 +1133,8 @@ Query_cache::insert(THD *thd, Query_cache_tls *query_cache_tls,
     header->result(result);
     DBUG_PRINT("qcache", ("free query 0x%lx", (ulong) query_block));
     // The following call will remove the lock on query_block
-    query_cache.free_query(query_block);
-    query_cache.refused++;
+    free_query(query_block);
+    refused++;
     // append_result_data no success => we need unlock
     unlock();
     DBUG_VOID_RETURN;
@@ -1136,6 +1158,12 @@ Query_cache::abort(THD *thd, Query_cache_tls *query_cache_tls)
   if (is_disabled() || query_cache_tls->first_query_block == NULL)
     DBUG_VOID_RETURN;
 
+  if (m_partitions)
+  {
+    query_cache_tls->partition->abort(thd, query_cache_tls);
+    DBUG_VOID_RETURN;
+  }
+
   if (try_lock(thd, Query_cache::WAIT))
     DBUG_VOID_RETURN;
 
@@ -1172,6 +1200,12 @@ void Query_cache::end_of_result(THD *thd)
   if (query_cache_tls->first_query_block == NULL)
     DBUG_VOID_RETURN;
 
+  if (m_partitions)
+  {
+    query_cache_tls->partition->end_of_result(thd);
+    DBUG_VOID_RETURN;
+  }
+
   /* Ensure that only complete results are cached. */
   DBUG_ASSERT(thd->get_stmt_da()->is_eof());
 
@@ -1221,9 +1255,9 @@ void Query_cache::end_of_result(THD *thd)
     }
     last_result_block= header->result()->prev;
     allign_size= ALIGN_SIZE(last_result_block->used);
-    len= MY_MAX(query_cache.min_allocation_unit, allign_size);
-    if (last_result_block->length >= query_cache.min_allocation_unit + len)
-      query_cache.split_block(last_result_block,len);
+    len= MY_MAX(min_allocation_unit, allign_size);
+    if (last_result_block->length >= min_allocation_unit + len)
+      split_block(last_result_block,len);
 
     header->found_rows(limit_found_rows);
     header->result()->type= Query_cache_block::RESULT;
@@ -1270,8 +1304,9 @@ Query_cache::Query_cache(ulong query_cache_limit_arg,
   :query_cache_size(0),
    query_cache_limit(query_cache_limit_arg),
    queries_in_cache(0), hits(0), inserts(0), refused(0),
-   total_blocks(0), lowmem_prunes(0),
+   total_blocks(0), lowmem_prunes(0), misses(0),
    m_cache_status(OK),
+   m_partitions(0), m_partition_count(0),
    min_allocation_unit(ALIGN_SIZE(min_allocation_unit_arg)),
    min_result_data_size(ALIGN_SIZE(min_result_data_size_arg)),
    def_query_hash_size(ALIGN_SIZE(def_query_hash_size_arg)),
@@ -1284,6 +1319,14 @@ Query_cache::Query_cache(ulong query_cache_limit_arg,
   set_if_bigger(min_allocation_unit,min_needed);
   this->min_allocation_unit= ALIGN_SIZE(min_allocation_unit);
   set_if_bigger(this->min_result_data_size,min_allocation_unit);
+  /*
+    The partitions are not static objects, so nothing that free_cache()
+    looks at may be left uninitialized.
+  */
+  cache= 0;
+  queries_blocks= 0;
+  my_hash_clear(&queries);
+  my_hash_clear(&tables);
 }
 
 
@@ -1295,6 +1338,23 @@ ulong Query_cache::resize(ulong query_cache_size_arg)
 			query_cache_size_arg));
   DBUG_ASSERT(initialized);
 
+  if (m_partitions)
+  {
+    /* The memory is divided evenly between the partitions */
+    lock_and_suspend();
+    new_query_cache_size= 0;
+    for (uint i= 0; i < m_partition_count; i++)
+      new_query_cache_size+=
+        m_partitions[i].resize(query_cache_size_arg / m_partition_count);
+    query_cache_size= new_query_cache_size;
+    if (new_query_cache_size && global_system_variables.query_cache_type != 0)
+      m_cache_status= OK;
+    else
+      m_cache_status= DISABLED;
+    unlock();
+    DBUG_RETURN(new_query_cache_size);
+  }
+
   lock_and_suspend();
 
   /*
@@ -1350,10 +1410,20 @@ ulong Query_cache::set_min_res_unit(ulong size)
   DBUG_ASSERT(size % 8 == 0);
   if (size < min_allocation_unit)
     size= ALIGN_SIZE(min_allocation_unit);
+  for (uint i= 0; i < m_partition_count; i++)
+    m_partitions[i].set_min_res_unit(size);
   return (min_result_data_size= size);
 }
 
 
+void Query_cache::result_size_limit(ulong limit)
+{
+  for (uint i= 0; i < m_partition_count; i++)
+    m_partitions[i].result_size_limit(limit);
+  query_cache_limit= limit;
+}
+
+
 void Query_cache::store_query(THD *thd, TABLE_LIST *tables_used)
 {
   TABLE_COUNTER_TYPE local_tables;
@@ -1385,6 +1455,12 @@ void Query_cache::store_query(THD *thd, TABLE_LIST *tables_used)
   DBUG_ASSERT(thd->base_query.is_alloced() ||
               thd->base_query.ptr() == thd->query());
 
+  if (m_partitions)
+  {
+    partition(thd)->store_query(thd, tables_used);
+    DBUG_VOID_RETURN;
+  }
+
   tables_type= 0;
   if ((local_tables= is_cacheable(thd, thd->lex, tables_used,
 				  &tables_type)))
@@ -1546,6 +1622,7 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
 	inserts++;
 	queries_in_cache++;
 	thd->query_cache_tls.first_query_block= query_block;
+	thd->query_cache_tls.partition= this;
 	header->writer(&thd->query_cache_tls);
 	header->tables_type(tables_type);
 
@@ -1686,13 +1763,6 @@ size_t build_normalized_name(char *buff, size_t bufflen,
 int
 Query_cache::send_result_to_client(THD *thd, char *org_sql, uint query_length)
 {
-  ulonglong engine_data;
-  Query_cache_query *query;
-#ifndef EMBEDDED_LIBRARY
-  Query_cache_block *first_result_block;
-#endif
-  Query_cache_block *result_block;
-  Query_cache_block_table *block_table, *block_table_end;
   ulong tot_length;
   Query_cache_query_flags flags;
   const char *sql, *sql_end, *found_brace= 0;
@@ -1834,23 +1904,11 @@ Query_cache::send_result_to_client(THD *thd, char *org_sql, uint query_length)
       goto err;
     }
   }
-  /*
-    Try to obtain an exclusive lock on the query cache. If the cache is
-    disabled or if a full cache flush is in progress, the attempt to
-    get the lock is aborted.
 
-    The TIMEOUT parameter indicate that the lock is allowed to timeout.
+  /*
+    The key is built before the cache is locked: the partition serving
+    the statement is chosen by the hash of thd->base_query.
   */
-  if (try_lock(thd, Query_cache::TIMEOUT))
-    goto err;
-
-  if (query_cache_size == 0)
-  {
-    thd->query_cache_is_applicable= 0;            // Query can't be cached
-    goto err_unlock;
-  }
-
-  Query_cache_block *query_block;
   if (thd->variables.query_cache_strip_comments)
   {
     if (found_brace)
@@ -1882,8 +1940,6 @@ Query_cache::send_result_to_client(THD *thd, char *org_sql, uint query_length)
     DBUG_PRINT("qcache", ("No active database"));
   }
 
-  THD_STAGE_INFO(thd, stage_checking_query_cache_for_query);
-
   // fill all gaps between fields with 0 to get repeatable key
   bzero(&flags, QUERY_CACHE_FLAGS_SIZE);
   flags.client_long_flag= MY_TEST(thd->client_capabilities & CLIENT_LONG_FLAG);
@@ -1933,6 +1989,57 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
                           (int)flags.autocommit));
   memcpy((uchar *)(sql + (tot_length - QUERY_CACHE_FLAGS_SIZE)),
 	 (uchar*) &flags, QUERY_CACHE_FLAGS_SIZE);
+
+  DBUG_RETURN(partition(thd)->send_cached_result(thd, sql, tot_length));
+
+err:
+  thd->query_cache_is_applicable= 0;            // Query can't be cached
+  DBUG_RETURN(0);				// Query was not cached
+}
+
+
+/**
+  Look up the statement key built by send_result_to_client() in this
+  partition and send the cached result if there is a usable one.
+
+  @param thd         Pointer to the thread handler
+  @param sql         Statement key: query, database and flags
+  @param tot_length  Length of the key
+
+  @return see send_result_to_client()
+*/
+
+int Query_cache::send_cached_result(THD *thd, const char *sql,
+                                    ulong tot_length)
+{
+  ulonglong engine_data;
+  Query_cache_query *query;
+#ifndef EMBEDDED_LIBRARY
+  Query_cache_block *first_result_block;
+#endif
+  Query_cache_block *result_block;
+  Query_cache_block_table *block_table, *block_table_end;
+  Query_cache_block *query_block;
+  DBUG_ENTER("Query_cache::send_cached_result");
+
+  /*
+    Try to obtain an exclusive lock on the query cache. If the cache is
+    disabled or if a full cache flush is in progress, the attempt to
+    get the lock is aborted.
+
+    The TIMEOUT parameter indicate that the lock is allowed to timeout.
+  */
+  if (try_lock(thd, Query_cache::TIMEOUT))
+    goto err;
+
+  if (query_cache_size == 0)
+  {
+    thd->query_cache_is_applicable= 0;            // Query can't be cached
+    goto err_unlock;
+  }
+
+  THD_STAGE_INFO(thd, stage_checking_query_cache_for_query);
+
   query_block = (Query_cache_block *)  my_hash_search(&queries, (uchar*) sql,
                                                       tot_length);
   /* Quick abort on unlocked data */
@@ -2147,6 +2254,7 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
   DBUG_RETURN(1);				// Result sent to client
 
 err_unlock:
+  misses++;
   unlock();
   MYSQL_QUERY_CACHE_MISS(thd->query());
   /*
@@ -2294,6 +2402,13 @@ void Query_cache::invalidate(THD *thd, char *db)
 
   DBUG_ASSERT(ok_for_lower_case_names(db));
 
+  if (m_partitions)
+  {
+    for (uint i= 0; i < m_partition_count; i++)
+      m_partitions[i].invalidate(thd, db);
+    DBUG_VOID_RETURN;
+  }
+
   bool restart= FALSE;
   /*
     Lock the query cache and queue all invalidation attempts to avoid
@@ -2383,6 +2498,13 @@ void Query_cache::flush()
   if (is_disabled())
     DBUG_VOID_RETURN;
 
+  if (m_partitions)
+  {
+    for (uint i= 0; i < m_partition_count; i++)
+      m_partitions[i].flush();
+    DBUG_VOID_RETURN;
+  }
+
   QC_DEBUG_SYNC("wait_in_query_cache_flush1");
 
   lock_and_suspend();
@@ -2393,7 +2515,7 @@ void Query_cache::flush()
     DUMP(this);
   }
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
   unlock();
   DBUG_VOID_RETURN;
 }
@@ -2416,6 +2538,13 @@ void Query_cache::pack(THD *thd, ulong join_limit, uint iteration_limit)
   if (is_disabled())
     DBUG_VOID_RETURN;
 
+  if (m_partitions)
+  {
+    for (uint i= 0; i < m_partition_count; i++)
+      m_partitions[i].pack(thd, join_limit, iteration_limit);
+    DBUG_VOID_RETURN;
+  }
+
   /*
     If the entire qc is being invalidated we can bail out early
     instead of waiting for the lock.
@@ -2449,6 +2578,15 @@ void Query_cache::destroy()
   }
   else
   {
+    if (m_partitions)
+    {
+      for (uint i= 0; i < m_partition_count; i++)
+        m_partitions[i].destroy();
+      delete [] m_partitions;
+      m_partitions= 0;
+      m_partition_count= 0;
+    }
+
     /* Underlying code expects the lock. */
     lock_and_suspend();
     free_cache();
@@ -2465,6 +2603,9 @@ void Query_cache::destroy()
 
 void Query_cache::disable_query_cache(THD *thd)
 {
+  for (uint i= 0; i < m_partition_count; i++)
+    m_partitions[i].disable_query_cache(thd);
+
   m_cache_status= DISABLE_REQUEST;
   /*
     If there is no requests in progress try to free buffer.
@@ -2476,6 +2617,64 @@ void Query_cache::disable_query_cache(THD *thd)
 }
 
 
+/**
+  Find the partition serving the statement in thd->base_query.
+
+  @note send_result_to_client() and store_query() must agree on the
+  partition of a statement, so only the statement text (without the
+  database and the flags appended to it) is hashed.
+*/
+
+Query_cache *Query_cache::partition(THD *thd)
+{
+  ulong nr1= 1, nr2= 4;
+  if (!m_partitions)
+    return this;
+  my_hash_sort_bin(&my_charset_bin, (uchar*) thd->base_query.ptr(),
+                   thd->base_query.length(), &nr1, &nr2);
+  return m_partitions + nr1 % m_partition_count;
+}
+
+
+/**
+  Sum the statistics of all partitions. The counters are read without
+  locking, like the Qcache_% status variables always were.
+*/
+
+void Query_cache::get_status(Query_cache_status *status)
+{
+  bzero(status, sizeof(*status));
+  for (uint i= 0; i < partition_count(); i++)
+  {
+    Query_cache *part= get_partition(i);
+    status->free_memory+=        part->free_memory;
+    status->queries_in_cache+=   part->queries_in_cache;
+    status->hits+=               part->hits;
+    status->inserts+=            part->inserts;
+    status->refused+=            part->refused;
+    status->free_memory_blocks+= part->free_memory_blocks;
+    status->total_blocks+=       part->total_blocks;
+    status->lowmem_prunes+=      part->lowmem_prunes;
+    status->misses+=             part->misses;
+  }
+}
+
+
+/**
+  Reset the flushable statistics of all partitions (FLUSH STATUS).
+*/
+
+void Query_cache::reset_status()
+{
+  for (uint i= 0; i < partition_count(); i++)
+  {
+    Query_cache *part= get_partition(i);
+    part->hits= part->inserts= part->refused= 0;
+    part->lowmem_prunes= part->misses= 0;
+  }
+}
+
+
 /*****************************************************************************
   init/destroy
 *****************************************************************************/
@@ -2483,6 +2682,30 @@ void Query_cache::disable_query_cache(THD *thd)
 void Query_cache::init()
 {
   DBUG_ENTER("Query_cache::init");
+  init_partition();
+
+  if (query_cache_partitions > 1)
+  {
+    m_partitions= new Query_cache[query_cache_partitions];
+    m_partition_count= query_cache_partitions;
+    for (uint i= 0; i < m_partition_count; i++)
+    {
+      m_partitions[i].query_cache_limit= query_cache_limit;
+      m_partitions[i].min_result_data_size= min_result_data_size;
+      m_partitions[i].init_partition();
+    }
+  }
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Initialize the locks and the state of a single partition of the cache.
+*/
+
+void Query_cache::init_partition()
+{
+  DBUG_ENTER("Query_cache::init_partition");
   mysql_mutex_init(key_structure_guard_mutex,
                    &structure_guard_mutex, MY_MUTEX_INIT_FAST);
   mysql_cond_init(key_COND_cache_status_changed,
@@ -3219,6 +3442,14 @@ void Query_cache::invalidate_table(THD *thd, TABLE *table)
 
 void Query_cache::invalidate_table(THD *thd, uchar * key, uint32  key_length)
 {
+  if (m_partitions)
+  {
+    /* Queries using the table may have been cached in any partition */
+    for (uint i= 0; i < m_partition_count; i++)
+      m_partitions[i].invalidate_table(thd, key, key_length);
+    return;
+  }
+
   DEBUG_SYNC(thd, "wait_in_query_cache_invalidate1");
 
   /*
@@ -4159,7 +4390,7 @@ void Query_cache::pack_cache()
 {
   DBUG_ENTER("Query_cache::pack_cache");
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
 
   uchar *border = 0;
   Query_cache_block *before = 0;
@@ -4191,7 +4422,7 @@ void Query_cache::pack_cache()
     DUMP(this);
   }
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
   DBUG_VOID_RETURN;
 }
 
@@ -287,6 +287,13 @@ struct Query_cache_memory_bin_step
   }
 };
 
+/* Statistics summed over all query cache partitions */
+struct Query_cache_status
+{
+  ulong free_memory, queries_in_cache, hits, inserts, refused,
+    free_memory_blocks, total_blocks, lowmem_prunes, misses;
+};
+
 class Query_cache
 {
 public:
@@ -294,7 +301,7 @@ class Query_cache
   ulong query_cache_size, query_cache_limit;
   /* statistics */
   ulong free_memory, queries_in_cache, hits, inserts, refused,
-    free_memory_blocks, total_blocks, lowmem_prunes;
+    free_memory_blocks, total_blocks, lowmem_prunes, misses;
 
 
 private:
@@ -308,8 +315,21 @@ class Query_cache
   enum Cache_staus {OK, DISABLE_REQUEST, DISABLED};
   Cache_staus m_cache_status;
 
+  /*
+    When query_cache_partitions > 1 the cache is split into independently
+    locked partitions, each of them a complete Query_cache with its own
+    memory, hashes and structure_guard_mutex. Statements are mapped to a
+    partition by the hash of their text; table invalidation is sent to
+    every partition. The object holding the partitions does no caching
+    itself. m_partitions is NULL for a cache that is not split.
+  */
+  Query_cache *m_partitions;
+  uint m_partition_count;
+
   void free_query_internal(Query_cache_block *point);
   void invalidate_table_internal(THD *thd, uchar *key, uint32 key_length);
+  void init_partition();
+  Query_cache *partition(THD *thd);
 
 protected:
   /*
@@ -435,6 +455,7 @@ class Query_cache
                                               uint8 *tables_type);
 
   static my_bool ask_handler_allowance(THD *thd, TABLE_LIST *tables_used);
+  int send_cached_result(THD *thd, const char *key, ulong key_length);
  public:
 
   Query_cache(ulong query_cache_limit = ULONG_MAX,
@@ -452,7 +473,7 @@ class Query_cache
   /* resize query cache (return real query size, 0 if disabled) */
   ulong resize(ulong query_cache_size);
   /* set limit on result size */
-  inline void result_size_limit(ulong limit){query_cache_limit=limit;}
+  void result_size_limit(ulong limit);
   /* set minimal result data allocation unit size */
   ulong set_min_res_unit(ulong size);
 
@@ -531,6 +552,13 @@ class Query_cache
   void unlock(void);
 
   void disable_query_cache(THD *thd);
+
+  /* Partitions of the cache; an unsplit cache is its own only partition */
+  uint partition_count() { return m_partitions ? m_partition_count : 1; }
+  Query_cache *get_partition(uint n)
+  { return m_partitions ? m_partitions + n : this; }
+  void get_status(Query_cache_status *status);
+  void reset_status();
 };
 
 #ifdef HAVE_QUERY_CACHE
@@ -702,9 +702,10 @@ extern "C"
   @param length length of buffer
   @param max_query_len how many chars of query to copy (0 for all)
 
-  @req LOCK_thread_count
+  @req The mutex of the shard of server_threads that holds thd, as locked
+       by THD_list_iterator
   
-  @note LOCK_thread_count mutex is not necessary when the function is invoked on
+  @note The mutex is not necessary when the function is invoked on
    the currently running thread (current_thd) or if the caller in some other
    way guarantees that access to thd->query is serialized.
  
@@ -872,6 +873,7 @@ THD::THD(bool is_wsrep_applier)
    m_idle_psi(NULL),
    thread_id(0),
    os_thread_id(0),
+   thread_list_shard(0),
    global_disable_checkpoint(0),
    failed_com_change_user(0),
    is_fatal_error(0),
@@ -1737,6 +1739,14 @@ void add_to_status(STATUS_VAR *to_var, STATUS_VAR *from_var)
   to_var->rows_sent+=           from_var->rows_sent;
   to_var->rows_tmp_read+=       from_var->rows_tmp_read;
   to_var->binlog_bytes_written+= from_var->binlog_bytes_written;
+  to_var->binlog_compressed_events+= from_var->binlog_compressed_events;
+  to_var->binlog_bytes_before_compression+=
+    from_var->binlog_bytes_before_compression;
+  to_var->binlog_bytes_after_compression+=
+    from_var->binlog_bytes_after_compression;
+  to_var->binlog_compression_time+= from_var->binlog_compression_time;
+  to_var->binlog_decompressed_events+= from_var->binlog_decompressed_events;
+  to_var->binlog_decompression_time+= from_var->binlog_decompression_time;
   to_var->cpu_time+=            from_var->cpu_time;
   to_var->busy_time+=           from_var->busy_time;
   to_var->local_memory_used+=   from_var->local_memory_used;
@@ -1784,6 +1794,20 @@ void add_diff_to_status(STATUS_VAR *to_var, STATUS_VAR *from_var,
   to_var->rows_tmp_read+=        from_var->rows_tmp_read - dec_var->rows_tmp_read;
   to_var->binlog_bytes_written+= from_var->binlog_bytes_written -
                                  dec_var->binlog_bytes_written;
+  to_var->binlog_compressed_events+= from_var->binlog_compressed_events -
+                                     dec_var->binlog_compressed_events;
+  to_var->binlog_bytes_before_compression+=
+    from_var->binlog_bytes_before_compression -
+    dec_var->binlog_bytes_before_compression;
+  to_var->binlog_bytes_after_compression+=
+    from_var->binlog_bytes_after_compression -
+    dec_var->binlog_bytes_after_compression;
+  to_var->binlog_compression_time+= from_var->binlog_compression_time -
+                                    dec_var->binlog_compression_time;
+  to_var->binlog_decompressed_events+= from_var->binlog_decompressed_events -
+                                       dec_var->binlog_decompressed_events;
+  to_var->binlog_decompression_time+= from_var->binlog_decompression_time -
+                                      dec_var->binlog_decompression_time;
   to_var->cpu_time+=             from_var->cpu_time - dec_var->cpu_time;
   to_var->busy_time+=            from_var->busy_time - dec_var->busy_time;
 
@@ -1793,6 +1817,172 @@ void add_diff_to_status(STATUS_VAR *to_var, STATUS_VAR *from_var,
   */
 }
 
+void THD_list::init()
+{
+  for (uint i= 0; i < THD_LIST_SHARDS; i++)
+    mysql_mutex_init(key_LOCK_thread_list, &shards[i].lock,
+                     MY_MUTEX_INIT_FAST);
+}
+
+
+void THD_list::destroy()
+{
+  for (uint i= 0; i < THD_LIST_SHARDS; i++)
+  {
+    shards[i].threads.empty();
+    mysql_mutex_destroy(&shards[i].lock);
+  }
+}
+
+
+/**
+  Link a THD into the list
+
+  @note thd->thread_id should be set, it selects the shard of the THD
+*/
+
+void THD_list::insert(THD *thd)
+{
+  Shard *shard;
+  thd->thread_list_shard= (uint) (thd->thread_id & (THD_LIST_SHARDS - 1));
+  shard= shards + thd->thread_list_shard;
+  /* The lock of the shard goes before LOCK_thd_data, as LOCK_thread_count */
+  mysql_mutex_record_order(&shard->lock, &thd->LOCK_thd_data);
+  mysql_mutex_lock(&shard->lock);
+  shard->threads.append(thd);
+  mysql_mutex_unlock(&shard->lock);
+}
+
+
+/**
+  Unlink a THD from the list
+
+  @note Does nothing if the THD is not linked into the list
+*/
+
+void THD_list::erase(THD *thd)
+{
+  Shard *shard= shards + thd->thread_list_shard;
+  mysql_mutex_lock(&shard->lock);
+  thd->unlink();
+  /*
+    Used by binlog_reset_master.  It would be cleaner to use
+    DEBUG_SYNC here, but that's not possible because the THD's debug
+    sync feature has been shut down at this point.
+  */
+  DBUG_EXECUTE_IF("sleep_after_lock_thread_count_before_delete_thd", sleep(5););
+  mysql_mutex_unlock(&shard->lock);
+}
+
+
+void THD_list::lock_all()
+{
+  for (uint i= 0; i < THD_LIST_SHARDS; i++)
+    mysql_mutex_lock(&shards[i].lock);
+}
+
+
+void THD_list::unlock_all()
+{
+  for (uint i= THD_LIST_SHARDS; i-- > 0; )
+    mysql_mutex_unlock(&shards[i].lock);
+}
+
+
+THD *THD_list::first(uint shard)
+{
+  for (; shard < THD_LIST_SHARDS; shard++)
+  {
+    if (!shards[shard].threads.is_empty())
+      return shards[shard].threads.head();
+  }
+  return NULL;
+}
+
+
+bool THD_list::is_empty()
+{
+  for (uint i= 0; i < THD_LIST_SHARDS; i++)
+  {
+    mysql_mutex_lock(&shards[i].lock);
+    bool empty= shards[i].threads.is_empty();
+    mysql_mutex_unlock(&shards[i].lock);
+    if (!empty)
+      return false;
+  }
+  return true;
+}
+
+
+/**
+  Return the next THD, locking the next shards as needed
+
+  @return The next THD, or NULL at the end of the list
+*/
+
+THD *THD_list_iterator::operator++(int)
+{
+  for (;;)
+  {
+    if (next)
+    {
+      THD *thd= next;
+      I_List<THD> *threads= &list->shards[shard].threads;
+      next= threads->is_last(thd) ? NULL : static_cast<THD*>(thd->next);
+      return thd;
+    }
+    if (locked)
+    {
+      mysql_mutex_unlock(&list->shards[shard].lock);
+      locked= false;
+      shard++;
+    }
+    if (shard >= THD_LIST_SHARDS)
+      return NULL;
+    mysql_mutex_lock(&list->shards[shard].lock);
+    locked= true;
+    if (!list->shards[shard].threads.is_empty())
+      next= list->shards[shard].threads.head();
+  }
+}
+
+
+THD_list_ordered_iterator::THD_list_ordered_iterator(THD_list &list_arg)
+  :list(&list_arg)
+{
+  list->lock_all();
+  for (uint i= 0; i < THD_LIST_SHARDS; i++)
+    next[i]= (list->shards[i].threads.is_empty() ? NULL :
+              list->shards[i].threads.head());
+}
+
+
+/**
+  Return the THD with the highest thread id among the shards
+
+  The THDs are put at the head of their shard as they are created, so
+  every shard is ordered by the thread ids, newest first, and the shards
+  only need to be merged.
+*/
+
+THD *THD_list_ordered_iterator::operator++(int)
+{
+  uint best= THD_LIST_SHARDS;
+  for (uint i= 0; i < THD_LIST_SHARDS; i++)
+  {
+    if (next[i] && (best == THD_LIST_SHARDS ||
+                    next[i]->thread_id > next[best]->thread_id))
+      best= i;
+  }
+  if (best == THD_LIST_SHARDS)
+    return NULL;
+  THD *thd= next[best];
+  next[best]= (list->shards[best].threads.is_last(thd) ? NULL :
+               static_cast<THD*>(thd->next));
+  return thd;
+}
+
+
 #define SECONDS_TO_WAIT_FOR_KILL 2
 #if !defined(__WIN__) && defined(HAVE_SELECT)
 /* my_sleep() can wait for sub second times */
@@ -6162,6 +6352,13 @@ int THD::binlog_write_row(TABLE* table, bool is_trans,
 
   DBUG_ASSERT(is_current_stmt_binlog_format_row() &&
            ((WSREP(this) && wsrep_emulate_bin_log) || mysql_bin_log.is_open()));
+  if (opt_binlog_track_writesets)
+  {
+    int error;
+    if ((error= binlog_record_writeset(table, is_trans, record, false)))
+      return error;
+  }
+
   /*
     Pack records into format for transfer. We are allocating more
     memory than needed, but that doesn't matter.
@@ -6195,6 +6392,14 @@ int THD::binlog_update_row(TABLE* table, bool is_trans,
 {
   DBUG_ASSERT(is_current_stmt_binlog_format_row() &&
             ((WSREP(this) && wsrep_emulate_bin_log) || mysql_bin_log.is_open()));
+  if (opt_binlog_track_writesets)
+  {
+    int error;
+    if ((error= binlog_record_writeset(table, is_trans, before_record,
+                                       true)) ||
+        (error= binlog_record_writeset(table, is_trans, after_record, true)))
+      return error;
+  }
 
   size_t const before_maxlen = max_row_length(table, before_record);
   size_t const after_maxlen  = max_row_length(table, after_record);
@@ -6255,6 +6460,13 @@ int THD::binlog_delete_row(TABLE* table, bool is_trans,
   */
   MY_BITMAP *old_read_set= table->read_set;
 
+  if (opt_binlog_track_writesets)
+  {
+    int error;
+    if ((error= binlog_record_writeset(table, is_trans, record, true)))
+      return error;
+  }
+
   /** 
      This will remove spurious fields required during execution but
      not needed for binlogging. This is done according to the:
@@ -6745,15 +6957,25 @@ int THD::binlog_query(THD::enum_binlog_query_type qtype, char const *query_arg,
       flush the pending rows event if necessary.
     */
     {
-      Query_log_event qinfo(this, query_arg, query_len, is_trans, direct,
-                            suppress_use, errcode);
+      int error;
       /*
         Binlog table maps will be irrelevant after a Query_log_event
         (they are just removed on the slave side) so after the query
         log event is written to the binary log, we pretend that no
         table maps were written.
        */
-      int error= mysql_bin_log.write(&qinfo);
+      if (binlog_should_compress(query_len))
+      {
+        Query_compressed_log_event qinfo(this, query_arg, query_len, is_trans,
+                                         direct, suppress_use, errcode);
+        error= mysql_bin_log.write(&qinfo);
+      }
+      else
+      {
+        Query_log_event qinfo(this, query_arg, query_len, is_trans, direct,
+                              suppress_use, errcode);
+        error= mysql_bin_log.write(&qinfo);
+      }
       binlog_table_maps= 0;
       DBUG_RETURN(error);
     }
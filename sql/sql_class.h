@@ -397,6 +397,7 @@ class MY_LOCALE;
 */
 
 struct Query_cache_block;
+class Query_cache;
 
 struct Query_cache_tls
 {
@@ -405,12 +406,17 @@ struct Query_cache_tls
     functions and methods to maintain proper locking.
   */
   Query_cache_block *first_query_block;
+  /*
+    Query cache partition owning 'first_query_block'. Only the thread
+    which owns this structure sets and reads it.
+  */
+  Query_cache *partition;
   void set_first_query_block(Query_cache_block *first_query_block_arg)
   {
     first_query_block= first_query_block_arg;
   }
 
-  Query_cache_tls() :first_query_block(NULL) {}
+  Query_cache_tls() :first_query_block(NULL), partition(NULL) {}
 };
 
 /* SIGNAL / RESIGNAL / GET DIAGNOSTICS */
@@ -558,6 +564,8 @@ typedef struct system_variables
   ulong max_error_count;
   ulong max_length_for_sort_data;
   ulong max_sort_length;
+  ulong sort_threads;
+  ulong parallel_scan_threads;
   ulong max_tmp_tables;
   ulong max_insert_delayed_threads;
   ulong min_examined_row_limit;
@@ -627,6 +635,7 @@ typedef struct system_variables
   my_bool old_alter_table;
   my_bool old_passwords;
   my_bool big_tables;
+  my_bool group_by_hash;
   my_bool query_cache_strip_comments;
   my_bool sql_log_slow;
   my_bool sql_log_bin;
@@ -791,6 +800,14 @@ typedef struct system_status_var
   ulonglong rows_sent;
   ulonglong rows_tmp_read;
   ulonglong binlog_bytes_written;
+  /* Events logged compressed, see log_bin_compress */
+  ulonglong binlog_compressed_events;
+  ulonglong binlog_bytes_before_compression;
+  ulonglong binlog_bytes_after_compression;
+  ulonglong binlog_compression_time;            /* Time in microseconds */
+  /* Compressed events read from a binary or relay log */
+  ulonglong binlog_decompressed_events;
+  ulonglong binlog_decompression_time;          /* Time in microseconds */
   double last_query_cost;
   double cpu_time, busy_time;
   /* Don't initialize */
@@ -2143,6 +2160,8 @@ class THD :public Statement,
                         const uchar *buf);
   int binlog_update_row(TABLE* table, bool is_transactional,
                         const uchar *old_data, const uchar *new_data);
+  int binlog_record_writeset(TABLE *table, bool is_transactional,
+                             const uchar *record, bool check_read_set);
   static void binlog_prepare_row_images(TABLE* table);
 
   void set_server_id(uint32 sid) { variables.server_id = sid; }
@@ -2629,6 +2648,8 @@ class THD :public Statement,
   pthread_t  real_id;                           /* For debugging */
   my_thread_id  thread_id;
   uint32      os_thread_id;
+  /* The shard of server_threads that the THD is linked into */
+  uint       thread_list_shard;
   uint	     tmp_table, global_disable_checkpoint;
   uint	     server_status,open_options;
   enum enum_thread_type system_thread;
@@ -2792,7 +2813,8 @@ class THD :public Statement,
   /*
     If we do a purge of binary logs, log index info of the threads
     that are currently reading it needs to be adjusted. To do that
-    each thread that is using LOG_INFO needs to adjust the pointer to it
+    each thread that is using LOG_INFO needs to adjust the pointer to it.
+    Protected by LOCK_thd_data.
   */
   LOG_INFO*  current_linfo;
   NET*       slave_net;			// network connection from slave -> m.
@@ -5413,6 +5435,113 @@ inline int handler::ha_update_tmp_row(const uchar *old_data, uchar *new_data)
 }
 
 
+/* Number of shards of THD_list, a power of 2 */
+#define THD_LIST_SHARDS 32
+
+/**
+  The list of all THDs of the server
+
+  The THDs are spread over THD_LIST_SHARDS lists by their thread id, each
+  with its own mutex, so that connecting and disconnecting threads do not
+  serialize on one global mutex. A THD can not be deleted while the mutex
+  of its shard is locked, as it is unlinked with erase() first.
+
+  The THDs are visited with THD_list_iterator, which locks one shard at a
+  time. The list is not a consistent snapshot of all THDs of the server:
+  a THD which is added or removed during the iteration may be missed or
+  seen.
+*/
+
+class THD_list
+{
+public:
+  void init();
+  void destroy();
+  void insert(THD *thd);
+  void erase(THD *thd);
+  bool is_empty();
+  /* Lock all shards, no THD can be added or removed */
+  void lock_all();
+  void unlock_all();
+
+private:
+  friend class THD_list_iterator;
+  friend class THD_list_ordered_iterator;
+  friend THD *first_global_thread();
+  friend THD *next_global_thread(THD *thd);
+  /* The first THD in the shards from the given one on, without locking */
+  THD *first(uint shard);
+  struct Shard
+  {
+    mysql_mutex_t lock;
+    I_List<THD> threads;
+    /* Keep the mutexes of the shards in different cache lines */
+    char pad[64];
+  };
+  Shard shards[THD_LIST_SHARDS];
+};
+
+extern THD_list server_threads;
+
+
+/**
+  Iterator over server_threads
+
+  The THD returned by the iterator can not be deleted until the iterator
+  is advanced again or released, as the mutex of its shard is held. Its
+  LOCK_thd_data may be locked before release() to keep it alive after
+  that.
+*/
+
+class THD_list_iterator
+{
+public:
+  THD_list_iterator(THD_list &list_arg)
+    :list(&list_arg), shard(0), next(NULL), locked(false)
+  {}
+  ~THD_list_iterator() { release(); }
+
+  THD *operator++(int);
+
+  /* Stop the iteration and unlock the current shard */
+  void release()
+  {
+    if (locked)
+      mysql_mutex_unlock(&list->shards[shard].lock);
+    locked= false;
+    shard= THD_LIST_SHARDS;
+  }
+
+private:
+  THD_list *list;
+  uint shard;
+  THD *next;
+  bool locked;
+};
+
+
+/**
+  Iterator over server_threads in the order of the thread ids, newest first
+
+  All shards are locked for the whole iteration, so the THDs are a
+  consistent snapshot, but no thread can connect or disconnect meanwhile.
+*/
+
+class THD_list_ordered_iterator
+{
+public:
+  THD_list_ordered_iterator(THD_list &list_arg);
+  ~THD_list_ordered_iterator() { list->unlock_all(); }
+
+  THD *operator++(int);
+
+private:
+  THD_list *list;
+  /* The next THD of every shard */
+  THD *next[THD_LIST_SHARDS];
+};
+
+
 extern pthread_attr_t *get_connection_attrib(void);
 
 /**
@@ -1451,6 +1451,9 @@ void Explain_table_access::tag_to_json(Json_writer *writer, enum explain_extra_t
     case ET_IMPOSSIBLE_ON_CONDITION:
       writer->add_member("impossible_on_condition").add_bool(true);
       break;
+    case ET_USING_PARALLEL_SCAN:
+      writer->add_member("parallel_scan_threads").add_ll(parallel_scan_threads);
+      break;
     case ET_USING_WHERE_WITH_PUSHED_CONDITION:
       /*
         It would be nice to print the pushed condition, but current Storage
@@ -1767,7 +1770,9 @@ const char * extra_tag_text[]=
 
   "const row not found",
   "unique row not found",
-  "Impossible ON condition"
+  "Impossible ON condition",
+
+  "Using parallel scan" // special handling
 };
 
 
@@ -1834,6 +1839,14 @@ void Explain_table_access::append_tag_name(String *str, enum explain_extra_tag t
         str->append(" (scanning)");
       break;
     }
+    case ET_USING_PARALLEL_SCAN:
+    {
+      char buf[32];
+      str->append(extra_tag_text[tag]);
+      str->append(buf, my_snprintf(buf, sizeof(buf), " (%u threads)",
+                                   parallel_scan_threads));
+      break;
+    }
     default:
      str->append(extra_tag_text[tag]);
   }
@@ -474,6 +474,8 @@ enum explain_extra_tag
   ET_UNIQUE_ROW_NOT_FOUND,
   ET_IMPOSSIBLE_ON_CONDITION,
 
+  ET_USING_PARALLEL_SCAN,
+
   ET_total
 };
 
@@ -690,6 +692,9 @@ class Explain_table_access : public Sql_alloc
   // valid with ET_USING_JOIN_BUFFER
   EXPLAIN_BKA_TYPE bka_type;
 
+  // valid with ET_USING_PARALLEL_SCAN
+  uint parallel_scan_threads;
+
   bool start_dups_weedout;
   bool end_dups_weedout;
   
@@ -337,3 +337,494 @@ void Expression_cache_tmptable::print(String *str, enum_query_type query_type)
 
 const char *Expression_cache_tracker::state_str[3]=
 {"uninitialized", "disabled", "enabled"};
+
+
+/**
+  Initial number of slots of the hash table of Expression_cache_hash
+*/
+#define EXPCACHE_HASH_INITIAL_SLOTS 64
+
+
+/**
+  The value of the entry found in Expression_cache_hash
+
+  @details
+  On a hit the Item_cache returned by the expression cache takes its value
+  from this item, so that the conversions of the value are the ones of
+  the Item_cache of the expression.
+*/
+
+class Expression_cache_value :public Item
+{
+public:
+  longlong int_value;
+  double real_value;
+  my_decimal decimal_value;
+
+  Expression_cache_value(THD *thd, Item *example)
+    :Item(thd), int_value(0), real_value(0.0)
+  {
+    Type_std_attributes::set(example);
+    fixed= 1;
+  }
+  enum Type type() const { return CACHE_ITEM; }
+  double val_real() { return real_value; }
+  longlong val_int() { return int_value; }
+  String *val_str(String *) { return null_value ? NULL : &str_value; }
+  my_decimal *val_decimal(my_decimal *)
+  { return null_value ? NULL : &decimal_value; }
+  void set_str(const char *str, uint32 length, CHARSET_INFO *cs)
+  { str_value.set(str, length, cs); }
+};
+
+
+/**
+  Kind of the packed value of an item, TIME_RESULT for temporal values
+*/
+
+static inline Item_result packed_value_type(Item *item)
+{
+  return item->cmp_type() == TIME_RESULT ? TIME_RESULT : item->result_type();
+}
+
+
+/**
+  Append the value of an item to a packed key or entry value
+
+  @details
+  A NULL byte is followed by 8 bytes for integer, temporal and real
+  values and by a length and the bytes of the string otherwise. Decimals
+  are packed as strings with all their digits. Equal packed values mean
+  equal values; equal values may be packed differently (e.g. 1.5 and
+  1.50), which only costs a cache miss.
+
+  @retval FALSE OK
+  @retval TRUE  Out of memory
+*/
+
+static bool pack_value(String *to, Item *item, String *tmp)
+{
+  uchar buff[8];
+  String *str;
+
+  switch (packed_value_type(item)) {
+  case INT_RESULT:
+    int8store(buff, item->val_int());
+    break;
+  case TIME_RESULT:
+    if (item->type() == Item::CACHE_ITEM)
+    {
+      /* The result of the expression keeps its packed format */
+      int8store(buff, item->val_temporal_packed(item->field_type()));
+      break;
+    }
+    /* Parameters are packed as strings, which can't lose precision */
+    /* fall through */
+  case STRING_RESULT:
+    str= item->val_str(tmp);
+    goto pack_string;
+  case REAL_RESULT:
+  {
+    double nr= item->val_real();
+    float8store(buff, nr);
+    break;
+  }
+  case DECIMAL_RESULT:
+  {
+    my_decimal decimal_buff, *dec= item->val_decimal(&decimal_buff);
+    if (item->null_value)
+      return to->append('\1');
+    str= tmp;
+    if (my_decimal2string(E_DEC_FATAL_ERROR, dec, 0, 0, 0, str))
+      return TRUE;
+    goto pack_string;
+  }
+  case ROW_RESULT:
+    DBUG_ASSERT(0);
+    return TRUE;
+  }
+  if (item->null_value)
+    return to->append('\1');
+  return to->append('\0') || to->append((const char*) buff, sizeof(buff));
+
+pack_string:
+  if (item->null_value)
+    return to->append('\1');
+  int4store(buff, str->length());
+  return (to->append('\0') || to->append((const char*) buff, 4) ||
+          to->append(str->ptr(), str->length()));
+}
+
+
+Expression_cache_hash::Expression_cache_hash(THD *thd_arg,
+                                             List<Item> &dependants,
+                                             Item *value)
+  :thd(thd_arg), tracker(NULL), items(dependants), val(value),
+   cached_result(NULL), entry_value(NULL), key_hash(0), slots(NULL),
+   slot_count(0), entry_count(0), memory_used(0), memory_limit(0),
+   hit(0), miss(0), inited(FALSE), enabled(FALSE)
+{
+  DBUG_ENTER("Expression_cache_hash::Expression_cache_hash");
+  key.set_charset(&my_charset_bin);
+  init_alloc_root(&entries, 8192, 0, MYF(MY_THREAD_SPECIFIC));
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Check if the values of an expression can be stored in this cache
+
+  @param value     the Item_cache of the expression
+*/
+
+bool Expression_cache_hash::is_applicable(Item *value)
+{
+  return value->result_type() != ROW_RESULT;
+}
+
+
+/**
+  Initialize the hash table and the items returning the cached value
+*/
+
+void Expression_cache_hash::init()
+{
+  List_iterator<Item> li(items);
+  Item *item;
+  DBUG_ENTER("Expression_cache_hash::init");
+  DBUG_ASSERT(!inited);
+  inited= TRUE;
+
+  if (items.elements == 0)
+  {
+    DBUG_PRINT("info", ("All parameters were removed by optimizer."));
+    DBUG_VOID_RETURN;
+  }
+  while ((item= li++))
+  {
+    if (item->result_type() == ROW_RESULT)
+    {
+      DBUG_PRINT("error", ("row parameters are not supported"));
+      DBUG_VOID_RETURN;
+    }
+  }
+
+  memory_limit= MY_MIN(thd->variables.tmp_table_size,
+                       thd->variables.max_heap_table_size);
+  if (!(cached_result= Item_cache::get_cache(thd, val)) ||
+      !(entry_value= new (thd->mem_root) Expression_cache_value(thd, val)) ||
+      !(slots= (Hash_slot*) my_malloc(EXPCACHE_HASH_INITIAL_SLOTS *
+                                      sizeof(Hash_slot),
+                                      MYF(MY_ZEROFILL | MY_THREAD_SPECIFIC))))
+  {
+    DBUG_PRINT("error", ("out of memory, caching switched off"));
+    DBUG_VOID_RETURN;
+  }
+  cached_result->setup(thd, val);
+  slot_count= EXPCACHE_HASH_INITIAL_SLOTS;
+  memory_used= slot_count * sizeof(Hash_slot);
+  enabled= TRUE;
+
+  update_tracker();
+  DBUG_VOID_RETURN;
+}
+
+
+Expression_cache_hash::~Expression_cache_hash()
+{
+  /* Add accumulated statistics */
+  statistic_add(subquery_cache_miss, miss, &LOCK_status);
+  statistic_add(subquery_cache_hit, hit, &LOCK_status);
+
+  if (enabled)
+    disable_cache();
+  else
+  {
+    update_tracker();
+    tracker= NULL;
+  }
+  my_free(slots);
+  free_root(&entries, MYF(0));
+}
+
+
+/**
+  Disable cache
+*/
+
+void Expression_cache_hash::disable_cache()
+{
+  enabled= FALSE;
+  clear();
+  update_tracker();
+  if (tracker)
+    tracker->cache= NULL;
+}
+
+
+/**
+  Remove all entries from the cache
+*/
+
+void Expression_cache_hash::clear()
+{
+  if (slots)
+    bzero(slots, slot_count * sizeof(Hash_slot));
+  entry_count= 0;
+  free_root(&entries, MYF(MY_MARK_BLOCKS_FREE));
+  memory_used= slot_count * sizeof(Hash_slot);
+}
+
+
+/**
+  Pack the current values of the parameters into 'key' and hash them
+
+  @retval FALSE OK
+  @retval TRUE  Out of memory
+*/
+
+bool Expression_cache_hash::pack_parameters()
+{
+  List_iterator<Item> li(items);
+  char buff[STRING_BUFFER_USUAL_SIZE];
+  String tmp(buff, sizeof(buff), &my_charset_bin);
+  Item *item;
+  ulong nr1= 1, nr2= 4;
+
+  key.length(0);
+  while ((item= li++))
+  {
+    if (pack_value(&key, item, &tmp))
+      return TRUE;
+  }
+  my_hash_sort_bin(&my_charset_bin, (uchar*) key.ptr(), key.length(),
+                   &nr1, &nr2);
+  key_hash= (uint32) nr1;
+  return FALSE;
+}
+
+
+/**
+  Find the slot of a key in the hash table
+
+  @return The slot with the key, or the empty slot where it can be put
+*/
+
+Expression_cache_hash::Hash_slot *
+Expression_cache_hash::find_slot(uint32 hash, const uchar *key_ptr,
+                                 size_t key_length)
+{
+  ulong mask= slot_count - 1;
+  for (ulong i= hash & mask; ; i= (i + 1) & mask)
+  {
+    Hash_slot *slot= slots + i;
+    if (!slot->entry ||
+        (slot->hash == hash && uint4korr(slot->entry) == key_length &&
+         !memcmp(slot->entry + 8, key_ptr, key_length)))
+      return slot;
+  }
+}
+
+
+/**
+  Double the size of the hash table
+
+  @retval FALSE OK
+  @retval TRUE  Out of memory
+*/
+
+bool Expression_cache_hash::grow()
+{
+  Hash_slot *old_slots= slots;
+  ulong old_count= slot_count;
+
+  if (!(slots= (Hash_slot*) my_malloc(2 * old_count * sizeof(Hash_slot),
+                                      MYF(MY_ZEROFILL | MY_THREAD_SPECIFIC))))
+  {
+    slots= old_slots;
+    return TRUE;
+  }
+  slot_count= 2 * old_count;
+  memory_used+= old_count * sizeof(Hash_slot);
+  for (Hash_slot *slot= old_slots; slot < old_slots + old_count; slot++)
+  {
+    if (slot->entry)
+      *find_slot(slot->hash, slot->entry + 8, uint4korr(slot->entry))= *slot;
+  }
+  my_free(old_slots);
+  return FALSE;
+}
+
+
+/**
+  Check if a given set of parameters of the expression is in the cache
+
+  @param [out] value     the expression value found in the cache if any
+
+  @retval Expression_cache::HIT if the set of parameters is in the cache
+  @retval Expression_cache::MISS - otherwise
+  @retval Expression_cache::ERROR - out of memory
+*/
+
+Expression_cache::result Expression_cache_hash::check_value(Item **value)
+{
+  Hash_slot *slot;
+  const uchar *pos;
+  DBUG_ENTER("Expression_cache_hash::check_value");
+
+  if (!enabled)
+    DBUG_RETURN(MISS);
+  /* Count the lookup as the index read of the temporary table would be */
+  thd->check_limit_rows_examined();
+  if (pack_parameters())
+    DBUG_RETURN(ERROR);
+
+  slot= find_slot(key_hash, (uchar*) key.ptr(), key.length());
+  if (!slot->entry)
+  {
+    if (((++miss) == EXPCACHE_CHECK_HIT_RATIO_AFTER) &&
+        ((double)hit / ((double)hit + miss)) <
+        EXPCACHE_MIN_HIT_RATE_FOR_MEM_TABLE)
+    {
+      DBUG_PRINT("info",
+                 ("Early check: hit rate is not so good to keep the cache"));
+      disable_cache();
+    }
+    DBUG_RETURN(MISS);
+  }
+
+  hit++;
+  /* The value follows the lengths and the key */
+  pos= slot->entry + 8 + key.length();
+  if (*pos++)
+    cached_result->store(NULL);
+  else
+  {
+    switch (packed_value_type(val)) {
+    case TIME_RESULT:
+      ((Item_cache_temporal*) cached_result)->store_packed(sint8korr(pos),
+                                                           val);
+      *value= cached_result;
+      DBUG_RETURN(HIT);
+    case INT_RESULT:
+      entry_value->int_value= sint8korr(pos);
+      break;
+    case REAL_RESULT:
+      float8get(entry_value->real_value, pos);
+      break;
+    case DECIMAL_RESULT:
+      str2my_decimal(E_DEC_FATAL_ERROR, (const char*) pos + 4,
+                     uint4korr(pos), &my_charset_bin,
+                     &entry_value->decimal_value);
+      break;
+    case STRING_RESULT:
+      entry_value->set_str((const char*) pos + 4, uint4korr(pos),
+                           val->collation.collation);
+      break;
+    case ROW_RESULT:
+      DBUG_ASSERT(0);
+    }
+    entry_value->null_value= FALSE;
+    entry_value->unsigned_flag= val->unsigned_flag;
+    cached_result->store(entry_value);
+  }
+  cached_result->cache_value();
+  *value= cached_result;
+  DBUG_RETURN(HIT);
+}
+
+
+/**
+  Put a new entry into the expression cache
+
+  @param value     the result of the expression to be put into the cache
+
+  @details
+  The entry gets the parameters packed by the last check_value(), which
+  was a miss for the same values of the parameters.
+
+  @retval FALSE OK
+  @retval TRUE  Error
+*/
+
+my_bool Expression_cache_hash::put_value(Item *value)
+{
+  char buff[STRING_BUFFER_USUAL_SIZE], value_buff[STRING_BUFFER_USUAL_SIZE];
+  String tmp(buff, sizeof(buff), &my_charset_bin);
+  String packed_value(value_buff, sizeof(value_buff), &my_charset_bin);
+  Hash_slot *slot;
+  uchar *entry;
+  size_t entry_length, grow_length;
+  DBUG_ENTER("Expression_cache_hash::put_value");
+  DBUG_ASSERT(inited);
+
+  if (!enabled)
+  {
+    DBUG_PRINT("info", ("Disabled so behave as we successfully put value"));
+    DBUG_RETURN(FALSE);
+  }
+  thd->check_limit_rows_examined();
+
+  packed_value.length(0);
+  if (pack_value(&packed_value, value, &tmp))
+    goto err;
+
+  entry_length= 8 + key.length() + packed_value.length();
+  /* Keep at least half of the slots empty */
+  grow_length= ((entry_count + 1) * 2 > slot_count ?
+                slot_count * sizeof(Hash_slot) : 0);
+  if (memory_used + entry_length + grow_length > memory_limit)
+  {
+    double hit_rate= ((double)hit / ((double)hit + miss));
+    DBUG_ASSERT(miss > 0);
+    if (hit_rate < EXPCACHE_MIN_HIT_RATE_FOR_MEM_TABLE)
+    {
+      DBUG_PRINT("info", ("hit rate is not so good to keep the cache"));
+      disable_cache();
+      DBUG_RETURN(FALSE);
+    }
+    DBUG_PRINT("info", ("cache is full, starting from scratch"));
+    clear();
+    if (memory_used + entry_length > memory_limit)
+      DBUG_RETURN(FALSE);
+  }
+  else if (grow_length && grow())
+    goto err;
+
+  slot= find_slot(key_hash, (uchar*) key.ptr(), key.length());
+  if (slot->entry)
+    DBUG_RETURN(FALSE);                         // Already put
+  if (!(entry= (uchar*) alloc_root(&entries, entry_length)))
+    goto err;
+  int4store(entry, key.length());
+  int4store(entry + 4, packed_value.length());
+  memcpy(entry + 8, key.ptr(), key.length());
+  memcpy(entry + 8 + key.length(), packed_value.ptr(), packed_value.length());
+  slot->entry= entry;
+  slot->hash= key_hash;
+  entry_count++;
+  memory_used+= entry_length;
+  DBUG_RETURN(FALSE);
+
+err:
+  disable_cache();
+  DBUG_RETURN(TRUE);
+}
+
+
+void Expression_cache_hash::print(String *str, enum_query_type query_type)
+{
+  List_iterator<Item> li(items);
+  Item *item;
+  bool is_first= TRUE;
+
+  str->append('<');
+  while ((item= li++))
+  {
+    if (!is_first)
+      str->append(',');
+    item->print(str, query_type);
+    is_first= FALSE;
+  }
+  str->append('>');
+}
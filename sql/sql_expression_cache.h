@@ -31,6 +31,8 @@
 
 extern ulong subquery_cache_miss, subquery_cache_hit;
 
+class Expression_cache_tracker;
+
 class Expression_cache :public Sql_alloc
 {
 public:
@@ -68,11 +70,18 @@ class Expression_cache :public Sql_alloc
     Save this object's statistics into Expression_cache_tracker object
   */
   virtual void update_tracker()= 0;
+
+  /**
+    Attach EXPLAIN/ANALYZE statistics object
+  */
+  virtual void set_tracker(Expression_cache_tracker *st)= 0;
 };
 
 struct st_table_ref;
 struct st_join_table;
 class Item_field;
+class Item_cache;
+class Expression_cache_value;
 
 
 class Expression_cache_tracker :public Sql_alloc
@@ -156,4 +165,94 @@ class Expression_cache_tmptable :public Expression_cache
   bool inited;
 };
 
+
+/**
+  Implementation of expression cache as an in-memory hash table
+
+  @details
+  The values of the parameters are packed into a key, which is looked up
+  in an open addressing hash table with linear probing. Every entry holds
+  the packed key and the packed value of the expression, so a lookup
+  costs one evaluation of the parameters, one hash and one memcmp().
+
+  The memory used by the entries and the hash table is limited by
+  MIN(tmp_table_size, max_heap_table_size) like the one of the temporary
+  table of Expression_cache_tmptable. When the limit is reached the cache
+  is emptied if the hit rate is good, and switched off otherwise.
+
+  Row values are not supported; Expression_cache_tmptable is used for
+  them.
+*/
+
+class Expression_cache_hash :public Expression_cache
+{
+public:
+  Expression_cache_hash(THD *thd, List<Item> &dependants, Item *value);
+  virtual ~Expression_cache_hash();
+  virtual result check_value(Item **value);
+  virtual my_bool put_value(Item *value);
+
+  void print(String *str, enum_query_type query_type);
+  bool is_inited() { return inited; };
+  void init();
+
+  static bool is_applicable(Item *value);
+
+  void set_tracker(Expression_cache_tracker *st)
+  {
+    tracker= st;
+    update_tracker();
+  }
+  virtual void update_tracker()
+  {
+    if (tracker)
+    {
+      tracker->set(hit, miss, (inited ? (enabled ?
+                                         Expression_cache_tracker::OK :
+                                         Expression_cache_tracker::STOPPED) :
+                               Expression_cache_tracker::UNINITED));
+    }
+  }
+
+private:
+  struct Hash_slot
+  {
+    uchar *entry;
+    uint32 hash;
+  };
+
+  bool pack_parameters();
+  Hash_slot *find_slot(uint32 hash, const uchar *key, size_t key_length);
+  bool grow();
+  void clear();
+  void disable_cache();
+
+  THD *thd;
+  /* EXPALIN/ANALYZE statistics */
+  Expression_cache_tracker *tracker;
+  /* List of parameter items */
+  List<Item> &items;
+  /* Value Item example */
+  Item *val;
+  /* Returned on a hit, holds the value of the found entry */
+  Item_cache *cached_result;
+  /* Source of cached_result for the non-temporal values */
+  Expression_cache_value *entry_value;
+  /* Packed parameters of the last lookup and their hash */
+  String key;
+  uint32 key_hash;
+  /* Open addressing hash table, the size is a power of 2 */
+  Hash_slot *slots;
+  ulong slot_count, entry_count;
+  /* Memory of the entries */
+  MEM_ROOT entries;
+  /* Memory used by slots and entries, and its limit */
+  ulonglong memory_used, memory_limit;
+  /* hit/miss counters */
+  ulong hit, miss;
+  /* Set on if the object has been succesfully initialized with init() */
+  bool inited;
+  bool enabled;
+};
+
 #endif /* SQL_EXPRESSION_CACHE_INCLUDED */
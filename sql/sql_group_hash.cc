@@ -0,0 +1,245 @@
+/*
+   Copyright (c) 2015, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#include <my_global.h>
+#include "sql_base.h"
+#include "sql_select.h"
+#include "sql_group_hash.h"
+#include "key.h"
+
+/* Initial number of slots of the hash table */
+#define GROUP_HASH_INITIAL_SLOTS 256
+
+
+Group_hash_table::Group_hash_table(THD *thd_arg, TABLE *table_arg,
+                                   uint key_length_arg)
+  :thd(thd_arg), table(table_arg), key_length(key_length_arg),
+   slots(NULL), slot_count(0), entry_count(0),
+   first_entry(NULL), last_link(&first_entry),
+   memory_used(0), memory_limit(0)
+{
+  DBUG_ENTER("Group_hash_table::Group_hash_table");
+  init_alloc_root(&entries, 65536, 0, MYF(MY_THREAD_SPECIFIC));
+  DBUG_VOID_RETURN;
+}
+
+
+Group_hash_table::~Group_hash_table()
+{
+  my_free(slots);
+  free_root(&entries, MYF(0));
+}
+
+
+/**
+  Check if the groups of a join can be computed in a Group_hash_table
+
+  @param join      the join
+  @param table     the temporary table with the group key
+
+  @details
+  The groups are kept in memory if group_by_hash is set, the temporary
+  table is an in-memory table without BLOB columns, and every aggregate
+  function is a COUNT, SUM, AVG, MIN, MAX, STD, VARIANCE or BIT_* function
+  without DISTINCT. These functions keep their value in the row of the
+  group, so the row is all there is to keep for a group.
+*/
+
+bool Group_hash_table::is_applicable(JOIN *join, TABLE *table)
+{
+  Item_sum **func_ptr, *func;
+
+  if (!join->thd->variables.group_by_hash ||
+      table->s->db_type() != heap_hton || table->s->blob_fields ||
+      !table->s->keys || table->s->uniques ||
+      !join->tmp_table_param.group_buff)
+    return FALSE;
+
+  for (func_ptr= join->sum_funcs; (func= *func_ptr); func_ptr++)
+  {
+    switch (func->sum_func()) {
+    case Item_sum::COUNT_FUNC:
+    case Item_sum::SUM_FUNC:
+    case Item_sum::AVG_FUNC:
+    case Item_sum::MIN_FUNC:
+    case Item_sum::MAX_FUNC:
+    case Item_sum::STD_FUNC:
+    case Item_sum::VARIANCE_FUNC:
+    case Item_sum::SUM_BIT_FUNC:
+      break;
+    default:
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+
+/**
+  Allocate the slots of the hash table
+
+  @retval FALSE OK
+  @retval TRUE  Out of memory
+*/
+
+bool Group_hash_table::init()
+{
+  DBUG_ENTER("Group_hash_table::init");
+  memory_limit= MY_MIN(thd->variables.tmp_table_size,
+                       thd->variables.max_heap_table_size);
+  if (!(slots= (Hash_slot*) my_malloc(GROUP_HASH_INITIAL_SLOTS *
+                                      sizeof(Hash_slot),
+                                      MYF(MY_WME | MY_ZEROFILL |
+                                          MY_THREAD_SPECIFIC))))
+    DBUG_RETURN(TRUE);
+  slot_count= GROUP_HASH_INITIAL_SLOTS;
+  memory_used= slot_count * sizeof(Hash_slot);
+  DBUG_RETURN(FALSE);
+}
+
+
+/**
+  Remove all groups from the table
+*/
+
+void Group_hash_table::clear()
+{
+  if (slots)
+    bzero(slots, slot_count * sizeof(Hash_slot));
+  entry_count= 0;
+  first_entry= NULL;
+  last_link= &first_entry;
+  free_root(&entries, MYF(MY_MARK_BLOCKS_FREE));
+  memory_used= slot_count * sizeof(Hash_slot);
+}
+
+
+/**
+  Find the slot of a key in the hash table
+
+  @return The slot with the key, or the empty slot where it can be put
+*/
+
+Group_hash_table::Hash_slot *
+Group_hash_table::find_slot(ulong hash, const uchar *key)
+{
+  KEY *key_info= table->key_info;
+  ulong mask= slot_count - 1;
+  for (ulong i= hash & mask; ; i= (i + 1) & mask)
+  {
+    Hash_slot *slot= slots + i;
+    if (!slot->entry ||
+        (slot->hash == hash &&
+         !key_buf_cmp(key_info, key_info->user_defined_key_parts,
+                      entry_key(slot->entry), key)))
+      return slot;
+  }
+}
+
+
+/**
+  Find the row of a group
+
+  @param key     the key image of the group
+  @param hash    hash_key() of the key
+
+  @return The row of the group, or NULL if there is no such group
+*/
+
+uchar *Group_hash_table::find(const uchar *key, ulong hash)
+{
+  Hash_slot *slot= find_slot(hash, key);
+  return slot->entry ? entry_record(slot->entry) : NULL;
+}
+
+
+/**
+  Double the size of the hash table
+
+  @retval FALSE OK
+  @retval TRUE  Out of memory
+*/
+
+bool Group_hash_table::grow()
+{
+  Hash_slot *old_slots= slots;
+  ulong old_count= slot_count;
+
+  if (!(slots= (Hash_slot*) my_malloc(2 * old_count * sizeof(Hash_slot),
+                                      MYF(MY_ZEROFILL | MY_THREAD_SPECIFIC))))
+  {
+    slots= old_slots;
+    return TRUE;
+  }
+  slot_count= 2 * old_count;
+  memory_used+= old_count * sizeof(Hash_slot);
+  ulong mask= slot_count - 1;
+  for (Hash_slot *slot= old_slots; slot < old_slots + old_count; slot++)
+  {
+    if (!slot->entry)
+      continue;
+    /* The keys are known to be different, only an empty slot is needed */
+    ulong i= slot->hash & mask;
+    while (slots[i].entry)
+      i= (i + 1) & mask;
+    slots[i]= *slot;
+  }
+  my_free(old_slots);
+  return FALSE;
+}
+
+
+/**
+  Add a new group to the table
+
+  @param key     the key image of the group, which is not in the table
+  @param hash    hash_key() of the key
+  @param record  the row of the group
+
+  @return The copy of the row in the table, or NULL if the group did not
+          fit into the memory limit of the table or there was no memory.
+*/
+
+uchar *Group_hash_table::insert(const uchar *key, ulong hash,
+                                const uchar *record)
+{
+  size_t entry_length= sizeof(uchar*) + key_length + table->s->reclength;
+  size_t grow_length;
+  Hash_slot *slot;
+  uchar *entry;
+
+  /* Keep at least half of the slots empty */
+  grow_length= ((entry_count + 1) * 2 > slot_count ?
+                slot_count * sizeof(Hash_slot) : 0);
+  if (memory_used + entry_length + grow_length > memory_limit ||
+      (grow_length && grow()))
+    return NULL;
+
+  slot= find_slot(hash, key);
+  DBUG_ASSERT(!slot->entry);
+  if (!(entry= (uchar*) alloc_root(&entries, entry_length)))
+    return NULL;
+  *(uchar**) entry= NULL;
+  memcpy(entry_key(entry), key, key_length);
+  memcpy(entry_record(entry), record, table->s->reclength);
+  *last_link= entry;
+  last_link= (uchar**) entry;
+  slot->entry= entry;
+  slot->hash= hash;
+  entry_count++;
+  memory_used+= entry_length;
+  return entry_record(entry);
+}
@@ -0,0 +1,108 @@
+/*
+   Copyright (c) 2015, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#ifndef SQL_GROUP_HASH_INCLUDED
+#define SQL_GROUP_HASH_INCLUDED
+
+#include "sql_select.h"
+#include "key.h"
+
+/**
+  In-memory hash table of the groups of a GROUP BY query
+
+  The groups are normally computed in the temporary table of the join,
+  which has a unique key over the GROUP BY columns. Every row of the join
+  is looked up in the temporary table with an index read and its group is
+  updated or written through the handler (see end_update()).
+
+  This table keeps the groups in memory instead. An entry holds the key
+  image of a group, as the GROUP BY columns are stored in
+  TMP_TABLE_PARAM::group_buff, and the row of the group in the format of
+  the temporary table. The aggregate functions of a group are updated in
+  the row with the same Item_sum::update_field() calls as for a row read
+  from the temporary table, only without the handler calls.
+
+  The slots of the hash table are an open addressing array with linear
+  probing. The keys are hashed and compared with key_hashnr() and
+  key_buf_cmp(), so that the groups are the ones the unique key of the
+  temporary table would make. The entries are chained in the order of
+  their insertion, and they are written into the temporary table in this
+  order by end_hash_update() when all rows have been read, or when the
+  memory limit of the table has been reached.
+*/
+
+class Group_hash_table :public Sql_alloc
+{
+public:
+  Group_hash_table(THD *thd, TABLE *table, uint key_length);
+  ~Group_hash_table();
+
+  static bool is_applicable(JOIN *join, TABLE *table);
+
+  bool init();
+  uchar *find(const uchar *key, ulong hash);
+  uchar *insert(const uchar *key, ulong hash, const uchar *record);
+  void clear();
+
+  /* Hash value of the key in TMP_TABLE_PARAM::group_buff */
+  ulong hash_key(const uchar *key)
+  {
+    return key_hashnr(table->key_info, table->key_info->user_defined_key_parts,
+                      key);
+  }
+
+  /* Iteration over the rows of the groups in the order of insertion */
+  uchar *first_record()
+  { return first_entry ? entry_record(first_entry) : NULL; }
+  uchar *next_record(uchar *record)
+  {
+    uchar *next= *(uchar**) (record - key_length - sizeof(uchar*));
+    return next ? entry_record(next) : NULL;
+  }
+
+  ulong elements() const { return entry_count; }
+
+private:
+  struct Hash_slot
+  {
+    uchar *entry;
+    ulong hash;
+  };
+
+  /* An entry is the link to the next entry, the key and the row */
+  uchar *entry_key(uchar *entry) { return entry + sizeof(uchar*); }
+  uchar *entry_record(uchar *entry)
+  { return entry + sizeof(uchar*) + key_length; }
+
+  Hash_slot *find_slot(ulong hash, const uchar *key);
+  bool grow();
+
+  THD *thd;
+  /* The temporary table of the join, the rows have its format */
+  TABLE *table;
+  uint key_length;
+  /* Open addressing hash table, the size is a power of 2 */
+  Hash_slot *slots;
+  ulong slot_count, entry_count;
+  /* Chain of the entries in the order of insertion */
+  uchar *first_entry, **last_link;
+  /* Memory of the entries */
+  MEM_ROOT entries;
+  /* Memory used by slots and entries, and its limit */
+  ulonglong memory_used, memory_limit;
+};
+
+#endif /* SQL_GROUP_HASH_INCLUDED */
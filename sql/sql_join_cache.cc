@@ -34,6 +34,23 @@
 
 #define NO_MORE_RECORDS_IN_BUFFER  (uint)(-1)
 
+/*
+  The Bloom filter of a BNLH join cache is checked for at least this
+  number of records of the joined table before it may be turned off
+*/
+#define KEY_FILTER_MIN_CHECKS 1024
+/*
+  The Bloom filter is turned off if it rejects less than 1 of this number
+  of the checked records
+*/
+#define KEY_FILTER_MIN_REJECT_RATIO 8
+
+#if defined(__GNUC__)
+#define join_cache_prefetch(A) __builtin_prefetch((A), 0, 3)
+#else
+#define join_cache_prefetch(A) do { } while(0)
+#endif
+
 static void save_or_restore_used_tabs(JOIN_TAB *join_tab, bool save);
 
 /*****************************************************************************
@@ -2674,6 +2691,7 @@ int JOIN_CACHE_HASHED::init(bool for_explain)
 
   hash_table= 0;
   key_entries= 0;
+  key_filter_size= 0;
 
   key_length= ref->key_length;
 
@@ -2690,7 +2708,7 @@ int JOIN_CACHE_HASHED::init(bool for_explain)
   ref_key_info= join_tab->get_keyinfo_by_key_no(join_tab->ref.key);
   ref_used_key_parts= join_tab->ref.key_parts;
 
-  hash_func= &JOIN_CACHE_HASHED::get_hash_idx_simple;
+  hash_func= &JOIN_CACHE_HASHED::get_key_hash_simple;
   hash_cmp_func= &JOIN_CACHE_HASHED::equal_keys_simple;
 
   KEY_PART_INFO *key_part= ref_key_info->key_part;
@@ -2699,7 +2717,7 @@ int JOIN_CACHE_HASHED::init(bool for_explain)
   {
     if (!key_part->field->eq_cmp_as_binary())
     {
-      hash_func= &JOIN_CACHE_HASHED::get_hash_idx_complex;
+      hash_func= &JOIN_CACHE_HASHED::get_key_hash_complex;
       hash_cmp_func= &JOIN_CACHE_HASHED::equal_keys_complex;
       break;
     }
@@ -2733,6 +2751,10 @@ int JOIN_CACHE_HASHED::init(bool for_explain)
     The function estimates the number of hash table entries in the hash
     table to be used and initializes this hash table within the join buffer
     space.
+    If the flag use_key_filter is set the function also reserves space for
+    the Bloom filter over the keys at the very end of the join buffer.
+    The filter takes one byte per hash entry, that is about 11 bits
+    per record.
 
   RETURN VALUE
     Currently the function always returns 0;
@@ -2745,6 +2767,8 @@ int JOIN_CACHE_HASHED::init_hash_table()
 
   /* Calculate the minimal possible value of size_of_key_ofs greater than 1 */
   uint max_size_of_key_ofs= MY_MAX(2, get_size_of_rec_offset());  
+  /* The space taken by the Bloom filter per record is bounded by 1/0.7 */
+  uint key_filter_space= use_key_filter ? 2 : 0;
   for (size_of_key_ofs= 2;
        size_of_key_ofs <= max_size_of_key_ofs;
        size_of_key_ofs+= 2)
@@ -2755,7 +2779,8 @@ int JOIN_CACHE_HASHED::init_hash_table()
 
     ulong space_per_rec= avg_record_length +
                          avg_aux_buffer_incr +
-                         key_entry_length+size_of_key_ofs;
+                         key_entry_length+size_of_key_ofs+
+                         key_filter_space;
     uint n= buff_size / space_per_rec;
 
     /*
@@ -2763,7 +2788,8 @@ int JOIN_CACHE_HASHED::init_hash_table()
             the number of records in in the join buffer.
     */
     uint max_n= buff_size / (pack_length-length+
-                             key_entry_length+size_of_key_ofs);
+                             key_entry_length+size_of_key_ofs+
+                             key_filter_space);
 
     hash_entries= (uint) (n / 0.7);
     set_if_bigger(hash_entries, 1);
@@ -2773,8 +2799,11 @@ int JOIN_CACHE_HASHED::init_hash_table()
       break;
   }
    
+  key_filter_size= use_key_filter ? hash_entries : 0;
+  key_filter= buff + (buff_size-key_filter_size);
+
   /* Initialize the hash table */ 
-  hash_table= buff + (buff_size-hash_entries*size_of_key_ofs);
+  hash_table= key_filter - hash_entries*size_of_key_ofs;
   cleanup_hash_table();
   curr_key_entry= hash_table;
 
@@ -2840,7 +2869,8 @@ uint JOIN_CACHE_HASHED::get_max_key_addon_space_per_record()
   len= (use_emb_key ?  get_size_of_rec_offset() : ref->key_length) +
         size_of_rec_ofs +    // size of the key chain header
         size_of_rec_ofs +    // >= size of the reference to the next key 
-        2*size_of_rec_ofs;   // >= 2*( size of hash table entry)
+        2*size_of_rec_ofs +  // >= 2*( size of hash table entry)
+        (use_key_filter ? 2 : 0); // >= size of Bloom filter per record
   return len; 
 }    
 
@@ -2892,6 +2922,8 @@ void JOIN_CACHE_HASHED::reset(bool for_writing)
     the record from the partial join.
     If the match flag field of a record contains MATCH_IMPOSSIBLE the key is
     not created for this record. 
+    When the cache has a Bloom filter over the keys a new key is added
+    to the filter as well.
     
   RETURN VALUE
     TRUE    if it has been decided that it should be the last record
@@ -2908,6 +2940,7 @@ bool JOIN_CACHE_HASHED::put_record()
   uchar *link= 0;
   TABLE_REF *ref= &join_tab->ref;
   uchar *next_ref_ptr= pos;
+  ulong hash;
 
   pos+= get_size_of_rec_offset();
   /* Write the record into the join buffer */  
@@ -2928,7 +2961,8 @@ bool JOIN_CACHE_HASHED::put_record()
   }
 
   /* Look for the key in the hash table */
-  if (key_search(key, key_len, &key_ref_ptr))
+  hash= get_key_hash(key, key_len);
+  if (key_search(key, key_len, hash, &key_ref_ptr))
   {
     uchar *last_next_ref_ptr;
     /* 
@@ -2974,6 +3008,8 @@ bool JOIN_CACHE_HASHED::put_record()
     DBUG_ASSERT(last_key_entry >= end_pos);
     /* Increment the counter of key_entries in the hash table */ 
     key_entries++;
+    if (has_key_filter())
+      add_to_key_filter(hash);
   }  
   return is_full;
 }
@@ -3067,6 +3103,7 @@ bool JOIN_CACHE_HASHED::skip_if_not_needed_match()
     key_search()
       key             pointer to the key value
       key_len         key value length
+      hash            hash value of the key calculated by get_key_hash()
       key_ref_ptr OUT position of the reference to the next key from 
                       the hash element for the found key , or
                       a position where the reference to the the hash 
@@ -3085,12 +3122,11 @@ bool JOIN_CACHE_HASHED::skip_if_not_needed_match()
     FALSE   otherwise
 */
 
-bool JOIN_CACHE_HASHED::key_search(uchar *key, uint key_len,
+bool JOIN_CACHE_HASHED::key_search(uchar *key, uint key_len, ulong hash,
                                    uchar **key_ref_ptr) 
 {
   bool is_found= FALSE;
-  uint idx= (this->*hash_func)(key, key_length);
-  uchar *ref_ptr= hash_table+size_of_key_ofs*idx;
+  uchar *ref_ptr= get_hash_entry(hash);
   while (!is_null_key_ref(ref_ptr))
   {
     uchar *next_key;
@@ -3113,21 +3149,22 @@ bool JOIN_CACHE_HASHED::key_search(uchar *key, uint key_len,
   Hash function that considers a key in the hash table as byte array
 
   SYNOPSIS
-    get_hash_idx_simple()
+    get_key_hash_simple()
       key             pointer to the key value
       key_len         key value length
       
   DESCRIPTION
-    The function calculates an index of the hash entry in the hash table
-    of the join buffer for the given key. It considers the key just as
-    a sequence of bytes of the length key_len.
+    The function calculates the hash value for the given key. It considers
+    the key just as a sequence of bytes of the length key_len.
+    The index of the hash entry for the key in the hash table of the join
+    buffer is the remainder of the division of this value by hash_entries.
 
   RETURN VALUE
-    the calculated index of the hash entry for the given key  
+    the calculated hash value of the given key  
 */
 
 inline
-uint JOIN_CACHE_HASHED::get_hash_idx_simple(uchar* key, uint key_len)
+ulong JOIN_CACHE_HASHED::get_key_hash_simple(uchar* key, uint key_len)
 {
   ulong nr= 1;
   ulong nr2= 4;
@@ -3138,7 +3175,7 @@ uint JOIN_CACHE_HASHED::get_hash_idx_simple(uchar* key, uint key_len)
     nr^= (ulong) ((((uint) nr & 63)+nr2)*((uint) *pos))+ (nr << 8);
     nr2+= 3;
   }
-  return nr % hash_entries;
+  return nr;
 }
 
 
@@ -3146,13 +3183,13 @@ uint JOIN_CACHE_HASHED::get_hash_idx_simple(uchar* key, uint key_len)
   Hash function that takes into account collations of the components of the key  
 
   SYNOPSIS
-    get_hash_idx_complex()
+    get_key_hash_complex()
       key             pointer to the key value
       key_len         key value length
       
   DESCRIPTION
-    The function calculates an index of the hash entry in the hash table
-    of the join buffer for the given key. It takes into account that the
+    The function calculates the hash value for the given key. It takes
+    into account that the
     components of the key may be of a varchar type with different collations.
     The function guarantees that the same hash value for any two equal
     keys that may differ as byte sequences.
@@ -3162,14 +3199,75 @@ uint JOIN_CACHE_HASHED::get_hash_idx_simple(uchar* key, uint key_len)
     operation.
 
   RETURN VALUE
-    the calculated index of the hash entry for the given key  
+    the calculated hash value of the given key  
 */
 
 inline
-uint JOIN_CACHE_HASHED::get_hash_idx_complex(uchar *key, uint key_len)
+ulong JOIN_CACHE_HASHED::get_key_hash_complex(uchar *key, uint key_len)
+{
+  return (ulong) key_hashnr(ref_key_info, ref_used_key_parts, key);
+}
+
+
+/*
+  Get the positions of the two bits of the Bloom filter for a key
+
+  DESCRIPTION
+    The hash value of a key is used both to choose the hash entry for the
+    key and to choose the bits of the Bloom filter. To make the bits
+    independent of the hash entry the hash value is mixed first. The two
+    halves of the result give the positions of the two bits set for the key.
+*/
+
+static inline void key_filter_bits(ulong hash, uint filter_bits,
+                                   uint *bit1, uint *bit2)
+{
+  ulonglong h= (ulonglong) hash;
+  h^= h >> 33;
+  h*= 0xff51afd7ed558ccdULL;
+  h^= h >> 33;
+  h*= 0xc4ceb9fe1a85ec53ULL;
+  h^= h >> 33;
+  *bit1= (uint) ((uint32) h % filter_bits);
+  *bit2= (uint) ((uint32) (h >> 32) % filter_bits);
+}
+
+
+/* 
+  Add a key into the Bloom filter over the keys of the join buffer
+
+  SYNOPSIS
+    add_to_key_filter()
+      hash            hash value of the key calculated by get_key_hash()
+*/
+
+void JOIN_CACHE_HASHED::add_to_key_filter(ulong hash)
 {
-  return 
-    (uint) (key_hashnr(ref_key_info, ref_used_key_parts, key) % hash_entries);
+  uint bit1, bit2;
+  key_filter_bits(hash, key_filter_size*8, &bit1, &bit2);
+  key_filter[bit1 / 8]|= (uchar) (1 << (bit1 % 8));
+  key_filter[bit2 / 8]|= (uchar) (1 << (bit2 % 8));
+}
+
+
+/* 
+  Check a key against the Bloom filter over the keys of the join buffer
+
+  SYNOPSIS
+    check_key_filter()
+      hash            hash value of the key calculated by get_key_hash()
+
+  RETURN VALUE
+    FALSE      the key is definitely not in the hash table
+    TRUE       the key may be in the hash table
+*/
+
+bool JOIN_CACHE_HASHED::check_key_filter(ulong hash)
+{
+  uint bit1, bit2;
+  key_filter_bits(hash, key_filter_size*8, &bit1, &bit2);
+  return (key_filter[bit1 / 8] & (1 << (bit1 % 8))) &&
+         (key_filter[bit2 / 8] & (1 << (bit2 % 8)));
 }
 
 
@@ -3239,7 +3337,8 @@ bool JOIN_CACHE_HASHED::equal_keys_complex(uchar *key1, uchar *key2,
       
   DESCRIPTION
     The function cleans up the hash table in the join buffer removing all
-    hash elements from the table. 
+    hash elements from the table. The Bloom filter placed after the hash
+    table is cleared as well.
 
   RETURN VALUE
     none  
@@ -3387,9 +3486,20 @@ int JOIN_TAB_SCAN::next()
       update_virtual_fields(thd, table);
   }
 
-  while (!err && select && (skip_rc= select->skip_record(thd)) <= 0)
+  /*
+    Records that are known to have no matches in the join buffer are
+    skipped before the pushed condition is evaluated for them.
+  */
+  while (!err)
   {
-    if (thd->check_killed() || skip_rc < 0) 
+    if (!cache->skip_record_by_key_filter())
+    {
+      if (!select || (skip_rc= select->skip_record(thd)) > 0)
+        break;
+      if (skip_rc < 0)
+        return 1;
+    }
+    if (thd->check_killed())
       return 1;
     /* 
       Move to the next record if the last retrieved record does not
@@ -3626,6 +3736,35 @@ int JOIN_CACHE_BNL::init(bool for_explain)
 }
 
 
+/*
+  Build the join key for the record of join_tab in the record buffer
+
+  SYNOPSIS
+    build_probe_key()
+
+  DESCRIPTION
+    The function builds the join key value out of the record of join_tab
+    that currently is in the record buffer for this table, places it into
+    key_buff and calculates its hash value. It also prefetches the hash
+    entry for the key so that the entry is likely to be in the CPU cache
+    by the time the hash table is probed.
+
+  RETURN VALUE
+    none
+*/
+
+void JOIN_CACHE_BNLH::build_probe_key()
+{
+  TABLE *table= join_tab->table;
+  TABLE_REF *ref= &join_tab->ref;
+  KEY *keyinfo= join_tab->get_keyinfo_by_key_no(ref->key);
+  key_copy(key_buff, table->record[0], keyinfo, key_length, TRUE);
+  probe_key_hash= get_key_hash(key_buff, key_length);
+  join_cache_prefetch(get_hash_entry(probe_key_hash));
+  probe_key_ready= TRUE;
+}
+
+
 /*
   Get the chain of records from buffer matching the current candidate for join
 
@@ -3634,7 +3773,8 @@ int JOIN_CACHE_BNL::init(bool for_explain)
 
   DESCRIPTION
     This function first build a join key for the record of join_tab that
-    currently is in the join buffer for this table. Then it looks for
+    currently is in the join buffer for this table, unless the key has been
+    already built by skip_record_by_key_filter(). Then it looks for
     the key entry with this key in the hash table of the join cache.
     If such a key entry is found the function returns the pointer to
     the head of the chain of records in the join_buffer that match this
@@ -3648,18 +3788,62 @@ int JOIN_CACHE_BNL::init(bool for_explain)
 uchar *JOIN_CACHE_BNLH::get_matching_chain_by_join_key()
 {
   uchar *key_ref_ptr;
-  TABLE *table= join_tab->table;
-  TABLE_REF *ref= &join_tab->ref;
-  KEY *keyinfo= join_tab->get_keyinfo_by_key_no(ref->key);
   /* Build the join key value out of the record in the record buffer */
-  key_copy(key_buff, table->record[0], keyinfo, key_length, TRUE);
+  if (!probe_key_ready)
+    build_probe_key();
+  probe_key_ready= FALSE;
   /* Look for this key in the join buffer */
-  if (!key_search(key_buff, key_length, &key_ref_ptr))
+  if (!key_search(key_buff, key_length, probe_key_hash, &key_ref_ptr))
     return 0;
   return key_ref_ptr+get_size_of_key_offset();
 }
 
 
+/*
+  Check the record of join_tab against the Bloom filter over the join keys
+
+  SYNOPSIS
+    skip_record_by_key_filter()
+
+  DESCRIPTION
+    This implementation of the virtual function builds the join key for
+    the record of join_tab read into the record buffer and checks it
+    against the Bloom filter over the keys from the join buffer. The
+    function is called by JOIN_TAB_SCAN::next() before the condition pushed
+    to join_tab is evaluated. So the records that have no matches in the
+    join buffer, which is the common case when a large table is joined to
+    a selective set of records, are rejected without evaluating the
+    condition and without probing the hash table. For the records that
+    pass the filter the built key is kept and reused by
+    get_matching_chain_by_join_key().
+    If after KEY_FILTER_MIN_CHECKS checks the filter has rejected less than
+    1/KEY_FILTER_MIN_REJECT_RATIO of the records it is not used until the
+    join buffer is refilled.
+
+  RETURN VALUE
+    TRUE    the record definitely has no matches in the join buffer
+    FALSE   otherwise
+*/
+
+bool JOIN_CACHE_BNLH::skip_record_by_key_filter()
+{
+  probe_key_ready= FALSE;
+  if (!key_filter_enabled)
+    return FALSE;
+  build_probe_key();
+  key_filter_checks++;
+  if (!check_key_filter(probe_key_hash))
+  {
+    key_filter_rejects++;
+    return TRUE;
+  }
+  if (key_filter_checks >= KEY_FILTER_MIN_CHECKS &&
+      key_filter_rejects * KEY_FILTER_MIN_REJECT_RATIO < key_filter_checks)
+    key_filter_enabled= FALSE;
+  return FALSE;
+}
+
+
 /*
   Prepare to iterate over the BNLH join cache buffer to look for matches 
 
@@ -3804,12 +3988,50 @@ void JOIN_CACHE_BNLH::read_next_candidate_for_match(uchar *rec_ptr)
 
 int JOIN_CACHE_BNLH::init(bool for_explain)
 {
+  int rc;
   DBUG_ENTER("JOIN_CACHE_BNLH::init");
 
   if (!(join_tab_scan= new JOIN_TAB_SCAN(join, join_tab)))
     DBUG_RETURN(1);
 
-  DBUG_RETURN(JOIN_CACHE_HASHED::init(for_explain));
+  use_key_filter= TRUE;
+
+  if ((rc= JOIN_CACHE_HASHED::init(for_explain)) || for_explain)
+    DBUG_RETURN(rc);
+
+  /* The buffer was reset before the hash table and the filter were set up */
+  reset(TRUE);
+
+  DBUG_RETURN(0);
+}
+
+
+/* 
+  Reset the buffer of a BNLH join cache for reading/writing
+
+  SYNOPSIS
+    reset()
+      for_writing  if it's TRUE the function reset the buffer for writing
+
+  DESCRIPTION
+    Additionally to what the implementation of the parent class does this
+    function discards the join key built for the record of join_tab and,
+    when the buffer is reset for writing, re-enables the Bloom filter over
+    the keys and resets its counters.
+    
+  RETURN VALUE
+    none
+*/
+
+void JOIN_CACHE_BNLH::reset(bool for_writing)
+{
+  this->JOIN_CACHE_HASHED::reset(for_writing);
+  probe_key_ready= FALSE;
+  if (for_writing)
+  {
+    key_filter_checks= key_filter_rejects= 0;
+    key_filter_enabled= has_key_filter();
+  }
 }
 
 
@@ -497,6 +497,13 @@ class JOIN_CACHE :public Sql_alloc
     skip_next_candidate_for_match and read_next_candidate_for_match.
   */   
   virtual uchar *get_next_candidate_for_match()= 0;
+  /*
+    Shall return TRUE if it is known for sure that the record of the joined
+    table read into the record buffer has no matches in the join buffer.
+    The function is called by the table scan before the condition pushed
+    to the joined table is checked.
+  */
+  virtual bool skip_record_by_key_filter() { return FALSE; }
   /*
     Shall check whether the given record from the join buffer has its match
     flag settings commands to skip the record in the buffer.
@@ -763,7 +770,7 @@ class JOIN_CACHE :public Sql_alloc
 class JOIN_CACHE_HASHED: public JOIN_CACHE
 {
 
-  typedef uint (JOIN_CACHE_HASHED::*Hash_func) (uchar *key, uint key_len);
+  typedef ulong (JOIN_CACHE_HASHED::*Hash_func) (uchar *key, uint key_len);
   typedef bool (JOIN_CACHE_HASHED::*Hash_cmp_func) (uchar *key1, uchar *key2,
                                                     uint key_len);
   
@@ -791,8 +798,16 @@ class JOIN_CACHE_HASHED: public JOIN_CACHE
   /* The offset of the data fields from the beginning of the record fields */
   uint data_fields_offset;
 
-  inline uint get_hash_idx_simple(uchar *key, uint key_len);
-  inline uint get_hash_idx_complex(uchar *key, uint key_len);
+  /*
+    The Bloom filter built over the keys in the hash table. It is placed
+    at the very end of the join buffer right after the hash table and takes
+    key_filter_size bytes. The filter is not built if key_filter_size is 0.
+  */
+  uchar *key_filter;
+  uint key_filter_size;
+
+  inline ulong get_key_hash_simple(uchar *key, uint key_len);
+  inline ulong get_key_hash_complex(uchar *key, uint key_len);
 
   inline bool equal_keys_simple(uchar *key1, uchar *key2, uint key_len);
   inline bool equal_keys_complex(uchar *key1, uchar *key2, uint key_len);
@@ -969,8 +984,40 @@ class JOIN_CACHE_HASHED: public JOIN_CACHE
   */
   bool skip_if_not_needed_match();
 
+  /* 
+    TRUE if the Bloom filter over the keys is to be built. Shall be set
+    before the init method of this class is called.
+  */
+  bool use_key_filter;
+
+  /* Get the position of the hash entry for the key with the hash value */
+  uchar *get_hash_entry(ulong hash)
+  {
+    return hash_table+size_of_key_ofs*(hash % hash_entries);
+  }
+
+  /* Calculate the hash value of a key */
+  ulong get_key_hash(uchar *key, uint key_len)
+  {
+    return (this->*hash_func)(key, key_len);
+  }
+
+  /* Add a key with the given hash value into the Bloom filter */
+  void add_to_key_filter(ulong hash);
+
+  /* Check whether a key with the given hash value may be in the hash table */
+  bool check_key_filter(ulong hash);
+
+  bool has_key_filter() { return key_filter_size != 0; }
+
   /* Search for a key in the hash table of the join buffer */
-  bool key_search(uchar *key, uint key_len, uchar **key_ref_ptr);
+  bool key_search(uchar *key, uint key_len, uchar **key_ref_ptr)
+  {
+    return key_search(key, key_len, get_key_hash(key, key_len), key_ref_ptr);
+  }
+
+  /* Search for a key with an already calculated hash value */
+  bool key_search(uchar *key, uint key_len, ulong hash, uchar **key_ref_ptr);
 
   /* Reallocate the join buffer of a hashed join cache */
   int realloc_buffer();
@@ -980,7 +1027,8 @@ class JOIN_CACHE_HASHED: public JOIN_CACHE
     used to join table 'tab' to the result of joining the previous tables 
     specified by the 'j' parameter.
   */   
-  JOIN_CACHE_HASHED(JOIN *j, JOIN_TAB *tab) :JOIN_CACHE(j, tab) {}
+  JOIN_CACHE_HASHED(JOIN *j, JOIN_TAB *tab)
+    :JOIN_CACHE(j, tab), use_key_filter(FALSE) {}
 
   /* 
     This constructor creates a linked hashed join cache. The cache is to be
@@ -989,7 +1037,7 @@ class JOIN_CACHE_HASHED: public JOIN_CACHE
     cache object to which this cache is linked.
   */   
   JOIN_CACHE_HASHED(JOIN *j, JOIN_TAB *tab, JOIN_CACHE *prev) 
-		    :JOIN_CACHE(j, tab, prev) {}
+		    :JOIN_CACHE(j, tab, prev), use_key_filter(FALSE) {}
 
 public:
 
@@ -1164,12 +1212,35 @@ class JOIN_CACHE_BNLH :public JOIN_CACHE_HASHED
   */
   uchar *next_matching_rec_ref_ptr;
 
+  /*
+    TRUE if key_buff and probe_key_hash contain the join key built for
+    the record currently in the record buffer of join_tab
+  */
+  bool probe_key_ready;
+  /* The hash value of the join key in key_buff */
+  ulong probe_key_hash;
+
+  /* 
+    The number of records of join_tab checked against the Bloom filter and
+    the number of those of them rejected by the filter. The counters are
+    reset each time the join buffer is refilled.
+  */
+  ha_rows key_filter_checks;
+  ha_rows key_filter_rejects;
+  /* FALSE if the Bloom filter is not used for the current join buffer */
+  bool key_filter_enabled;
+
+  /* Build the join key for the record of join_tab and calculate its hash */
+  void build_probe_key();
+
   /*
     Get the chain of records from buffer matching the current candidate
     record for join
   */
   uchar *get_matching_chain_by_join_key();
 
+  bool skip_record_by_key_filter();
+
   bool prepare_look_for_matches(bool skip_last);
 
   uchar *get_next_candidate_for_match();
@@ -1185,7 +1256,8 @@ class JOIN_CACHE_BNLH :public JOIN_CACHE_HASHED
     used to join table 'tab' to the result of joining the previous tables 
     specified by the 'j' parameter.
   */   
-  JOIN_CACHE_BNLH(JOIN *j, JOIN_TAB *tab) : JOIN_CACHE_HASHED(j, tab) {}
+  JOIN_CACHE_BNLH(JOIN *j, JOIN_TAB *tab)
+    : JOIN_CACHE_HASHED(j, tab), probe_key_ready(FALSE) {}
 
   /* 
     This constructor creates a linked BNLH join cache. The cache is to be 
@@ -1194,11 +1266,13 @@ class JOIN_CACHE_BNLH :public JOIN_CACHE_HASHED
     cache object to which this cache is linked.
   */   
   JOIN_CACHE_BNLH(JOIN *j, JOIN_TAB *tab, JOIN_CACHE *prev) 
-    : JOIN_CACHE_HASHED(j, tab, prev) {}
+    : JOIN_CACHE_HASHED(j, tab, prev), probe_key_ready(FALSE) {}
 
   /* Initialize the BNLH cache */       
   int init(bool for_explain);
 
+  void reset(bool for_writing);
+
   enum Join_algorithm get_join_alg() { return BNLH_JOIN_ALG; }
 
   bool is_key_access() { return TRUE; }
@@ -0,0 +1,819 @@
+/* Copyright (c) 2015, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+
+/**
+  @file
+
+  Parallel scan of a table for single-table aggregate queries.
+
+  A query like
+
+  @verbatim
+  SELECT COUNT(*), SUM(a), AVG(a), MIN(b), MAX(b) FROM t1
+  @endverbatim
+
+  reads every row of t1 and folds it into a few aggregate functions. If
+  parallel_scan_threads is greater than 1 such a scan is split into ranges
+  of the first column of the primary key and the ranges are read by
+  several threads. Each thread reads through its own clone of the table
+  handler into its own record buffer and computes partial aggregates over
+  the rows it has read, using its own copies of the Field objects. When
+  all ranges have been read the session thread merges the partial results
+  into the Item_sum objects of the query and sends the result row.
+
+  The session thread takes part in the scan using the table handler itself.
+  The ranges are handed out to the threads one by one, so a thread that
+  got a dense range does not hold up the others. There are several ranges
+  per thread, as the ranges are of equal width in the key value space,
+  which does not have to mean equal number of rows.
+
+  The threads use the handler clones on behalf of the session, under the
+  table lock taken by the session. An engine announces with the
+  HA_CAN_PARALLEL_SCAN table flag that its clones may be used this way.
+  Engines that keep per-transaction state which is not safe to share
+  between threads, like InnoDB, do not set the flag.
+
+  The following queries are scanned in parallel:
+  - the query is a SELECT that reads one base table without locking reads,
+  - the storage engine of the table supports it (HA_CAN_PARALLEL_SCAN),
+  - there is no WHERE, GROUP BY, HAVING or ORDER BY that requires a
+    temporary table,
+  - the table has a primary key whose first column is an integer,
+  - every aggregate function is COUNT(*), COUNT(col), SUM(col), AVG(col),
+    MIN(col) or MAX(col) without DISTINCT, where col is a column of the
+    table. SUM and AVG require a numeric column, MIN and MAX a column that
+    is not a BLOB or a BIT.
+
+  As the rows are added up in a different order, SUM and AVG over
+  floating point columns may differ from the result of a serial scan in
+  the last digits.
+*/
+
+#include <my_global.h>
+#include "sql_priv.h"
+#include "sql_select.h"
+#include "my_atomic.h"
+
+/* The minimal estimated number of rows in a table per scanning thread */
+#define PARALLEL_SCAN_MIN_ROWS_PER_THREAD 10000
+
+/* Number of key ranges per thread */
+#define PARALLEL_SCAN_RANGES_PER_THREAD 4
+
+/* A thread checks if the query has been killed after this many rows */
+#define PARALLEL_SCAN_KILL_CHECK_ROWS 1024
+
+
+/* How one aggregate function is computed by the scanning threads */
+
+enum scan_aggregate_type
+{
+  SCAN_COUNT_ROWS,                              // COUNT(*)
+  SCAN_COUNT,                                   // COUNT(col)
+  SCAN_SUM_INT,
+  SCAN_SUM_REAL,
+  SCAN_SUM_DECIMAL,
+  SCAN_MIN_MAX
+};
+
+
+struct Scan_aggregate
+{
+  Item_sum *item;
+  Field *field;                   // the aggregated column, 0 for COUNT(*)
+  enum scan_aggregate_type type;
+  /* For MIN_MAX: 1 if the least value is looked for, -1 for the greatest */
+  int cmp_sign;
+};
+
+
+/* The partial result of one aggregate function computed by one thread */
+
+struct Scan_partial :public Sql_alloc
+{
+  Field *field;                   // copy of the column in the thread record
+  longlong count;                 // number of rows with non-NULL argument
+  longlong int_sum;               // integer sum not added to dec_sum yet
+  double real_sum;
+  my_decimal dec_sum[2];
+  uint curr_dec_sum;
+  uchar *best;                    // MIN/MAX: the image of the best value
+
+  void add_to_dec_sum(const my_decimal *value)
+  {
+    my_decimal_add(E_DEC_FATAL_ERROR, dec_sum + (curr_dec_sum^1),
+                   value, dec_sum + curr_dec_sum);
+    curr_dec_sum^= 1;
+  }
+  void add_int(longlong value, bool is_unsigned)
+  {
+    if ((is_unsigned && value < 0) ||
+        (value > 0 && int_sum > LONGLONG_MAX - value) ||
+        (value < 0 && int_sum < LONGLONG_MIN - value))
+    {
+      my_decimal tmp;
+      int2my_decimal(E_DEC_FATAL_ERROR, value, is_unsigned, &tmp);
+      add_to_dec_sum(&tmp);
+    }
+    else
+      int_sum+= value;
+  }
+  void flush_int_sum()
+  {
+    my_decimal tmp;
+    int2my_decimal(E_DEC_FATAL_ERROR, int_sum, FALSE, &tmp);
+    add_to_dec_sum(&tmp);
+    int_sum= 0;
+  }
+};
+
+
+struct Parallel_scan;
+
+/* A thread taking part in a parallel scan */
+
+struct Scan_thread
+{
+  Parallel_scan *scan;
+  handler *file;
+  uchar *record;                  // the record buffer of the thread
+  Field *key_field;               // copy of the key column in 'record'
+  Scan_partial *partial;          // one per aggregate function
+  ha_rows rows;
+  ulong ranges;
+  int error;
+  pthread_t id;
+};
+
+
+struct Parallel_scan
+{
+  THD *thd;
+  TABLE *table;
+  KEY *key_info;
+  Field *key_field;
+  bool key_unsigned;
+  Scan_aggregate *aggr;
+  uint aggr_count;
+  /*
+    Range r covers the key values in [range_start(r), range_start(r+1)).
+    The first range has no lower bound and the last one no upper bound.
+  */
+  ulonglong first_key, range_width;
+  uchar *range_keys;              // key images of the range starts
+  uint range_key_length;
+  int32 range_count;
+  volatile int32 next_range;
+  volatile int32 abort;
+};
+
+
+/*
+  Key values are compared as unsigned numbers with the sign bit flipped
+  for signed columns, so that the order of the values is preserved.
+*/
+
+static inline ulonglong key_to_ordered(longlong value, bool is_unsigned)
+{
+  return is_unsigned ? (ulonglong) value :
+                       (ulonglong) value ^ (1ULL << 63);
+}
+
+
+static inline longlong ordered_to_key(ulonglong value, bool is_unsigned)
+{
+  return is_unsigned ? (longlong) value : (longlong) (value ^ (1ULL << 63));
+}
+
+
+static inline ulonglong range_start(Parallel_scan *scan, int32 range)
+{
+  return scan->first_key + scan->range_width * (ulonglong) range;
+}
+
+
+/**
+  Check whether an aggregate function can be computed by a parallel scan.
+
+  @param item   the aggregate function
+  @param table  the scanned table
+  @param aggr   OUT how the function is computed
+
+  @return TRUE if the function can be computed by a parallel scan
+*/
+
+static bool get_scan_aggregate(Item_sum *item, TABLE *table,
+                               Scan_aggregate *aggr)
+{
+  Item *arg;
+  Field *field;
+
+  if (item->get_arg_count() != 1 || item->with_subselect)
+    return FALSE;
+  arg= item->get_arg(0)->real_item();
+  aggr->item= item;
+  aggr->field= 0;
+  aggr->cmp_sign= 1;
+
+  if (item->sum_func() == Item_sum::COUNT_FUNC && arg->basic_const_item())
+  {
+    aggr->type= SCAN_COUNT_ROWS;
+    return TRUE;
+  }
+  if (arg->type() != Item::FIELD_ITEM ||
+      (field= ((Item_field*) arg)->field)->table != table ||
+      field->vcol_info)
+    return FALSE;
+  aggr->field= field;
+
+  switch (item->sum_func()) {
+  case Item_sum::COUNT_FUNC:
+    aggr->type= SCAN_COUNT;
+    return TRUE;
+  case Item_sum::SUM_FUNC:
+  case Item_sum::AVG_FUNC:
+    if (field->type() == MYSQL_TYPE_BIT || field->cmp_type() != field->result_type())
+      return FALSE;
+    switch (field->result_type()) {
+    case INT_RESULT:
+      aggr->type= SCAN_SUM_INT;
+      return TRUE;
+    case REAL_RESULT:
+      aggr->type= SCAN_SUM_REAL;
+      return TRUE;
+    case DECIMAL_RESULT:
+      aggr->type= SCAN_SUM_DECIMAL;
+      return TRUE;
+    default:
+      return FALSE;
+    }
+  case Item_sum::MAX_FUNC:
+    aggr->cmp_sign= -1;
+    /* fall through */
+  case Item_sum::MIN_FUNC:
+    if ((field->flags & BLOB_FLAG) || field->type() == MYSQL_TYPE_BIT)
+      return FALSE;
+    aggr->type= SCAN_MIN_MAX;
+    return TRUE;
+  default:
+    return FALSE;
+  }
+}
+
+
+/**
+  Choose the number of threads to scan the table of a join in parallel.
+
+  The function is called by JOIN::optimize() when the query plan has been
+  built for a join that reads one table and has aggregate functions but no
+  GROUP BY. It checks whether the join computes only aggregate functions that can be computed by a parallel scan, see the
+  description at the top of the file.
+
+  @param join  the join
+
+  @return The number of threads to scan the table with, or 0 if the table
+          is to be scanned as usual.
+*/
+
+uint parallel_scan_threads(JOIN *join)
+{
+  THD *thd= join->thd;
+  JOIN_TAB *tab= join->join_tab;
+  TABLE *table;
+  List_iterator_fast<Item> it(join->all_fields);
+  Scan_aggregate aggr;
+  Item *item;
+  uint threads= (uint) thd->variables.parallel_scan_threads;
+  ha_rows rows;
+
+  if (threads <= 1 ||
+      thd->lex->sql_command != SQLCOM_SELECT ||
+      thd->variables.tx_isolation == ISO_SERIALIZABLE ||
+      thd->locked_tables_mode || thd->in_sub_stmt ||
+      join->table_count != 1 || join->const_tables ||
+      join->mixed_implicit_grouping ||
+      join->group_list || join->having ||
+      join->procedure || join->need_tmp || join->conds ||
+      join->select_lex->olap != UNSPECIFIED_OLAP_TYPE ||
+      tab->type != JT_ALL || tab->select_cond ||
+      (tab->select && tab->select->quick) ||
+      tab->bush_children || tab->use_join_cache ||
+      !(table= tab->table) ||
+      table->s->tmp_table != NO_TMP_TABLE || table->vfield ||
+      (table->reginfo.lock_type != TL_READ &&
+       table->reginfo.lock_type != TL_READ_HIGH_PRIORITY) ||
+      !(table->file->ha_table_flags() & HA_CAN_PARALLEL_SCAN) ||
+      table->s->primary_key == MAX_KEY)
+    return 0;
+
+  KEY *key_info= table->key_info + table->s->primary_key;
+  Field *key_field= key_info->key_part[0].field;
+  if (key_field->cmp_type() != INT_RESULT ||
+      key_field->type() == MYSQL_TYPE_BIT ||
+      key_field->real_maybe_null() ||
+      !(table->file->index_flags(table->s->primary_key, 0, 1) &
+        HA_READ_ORDER))
+    return 0;
+
+  /* Every item must be an aggregate, a constant or an expression of them */
+  while ((item= it++))
+  {
+    if (item->type() == Item::SUM_FUNC_ITEM)
+    {
+      if (!get_scan_aggregate((Item_sum*) item, table, &aggr))
+        return 0;
+    }
+    else if (!item->with_sum_func && !item->const_item())
+      return 0;
+  }
+
+  rows= table->file->stats.records;
+  set_if_smaller(threads, rows / PARALLEL_SCAN_MIN_ROWS_PER_THREAD);
+  return threads > 1 ? threads : 0;
+}
+
+
+/* Add the row read into the record buffer of a thread to its aggregates */
+
+static void scan_add_row(Scan_thread *thread)
+{
+  Parallel_scan *scan= thread->scan;
+  for (uint i= 0; i < scan->aggr_count; i++)
+  {
+    Scan_aggregate *aggr= scan->aggr + i;
+    Scan_partial *partial= thread->partial + i;
+    Field *field= partial->field;
+
+    if (aggr->type == SCAN_COUNT_ROWS)
+    {
+      partial->count++;
+      continue;
+    }
+    if (field->is_null())
+      continue;
+    switch (aggr->type) {
+    case SCAN_COUNT:
+      break;
+    case SCAN_SUM_INT:
+      partial->add_int(field->val_int(), MY_TEST(field->flags & UNSIGNED_FLAG));
+      break;
+    case SCAN_SUM_REAL:
+      partial->real_sum+= field->val_real();
+      break;
+    case SCAN_SUM_DECIMAL:
+    {
+      my_decimal value;
+      partial->add_to_dec_sum(field->val_decimal(&value));
+      break;
+    }
+    case SCAN_MIN_MAX:
+      if (partial->count &&
+          field->cmp(field->ptr, partial->best) * aggr->cmp_sign >= 0)
+        break;
+      memcpy(partial->best, field->ptr, field->pack_length());
+      break;
+    case SCAN_COUNT_ROWS:
+      DBUG_ASSERT(0);
+    }
+    partial->count++;
+  }
+}
+
+
+/**
+  Read a row for a scanning thread.
+
+  The engine methods are called directly, as the ha_ wrappers update
+  the statistics of the session and the status of the table, which are
+  shared by all threads of the scan.
+
+  @param file  the handler of the thread
+  @param buf   the record buffer of the thread
+  @param key   key image to start the range at, 0 for the first row of
+               the index
+  @param next  read the next row in the index instead
+
+  @return 0 or a handler error code
+*/
+
+int parallel_scan_read(handler *file, uchar *buf, const uchar *key, bool next)
+{
+  if (next)
+    return file->index_next(buf);
+  if (!key)
+    return file->index_first(buf);
+  return file->index_read_map(buf, key, (key_part_map) 1, HA_READ_KEY_OR_NEXT);
+}
+
+
+/**
+  Read one key range and add its rows to the aggregates of a thread.
+
+  @return 0 or a handler error code
+*/
+
+static int scan_range(Scan_thread *thread, int32 range)
+{
+  Parallel_scan *scan= thread->scan;
+  handler *file= thread->file;
+  bool last= range == scan->range_count - 1;
+  ulonglong end= last ? 0 : range_start(scan, range + 1);
+  int error;
+
+  thread->ranges++;
+  if (range == 0)
+    error= parallel_scan_read(file, thread->record, 0, FALSE);
+  else
+    error= parallel_scan_read(file, thread->record,
+                              scan->range_keys +
+                              range * scan->range_key_length, FALSE);
+
+  while (!error)
+  {
+    if (!last &&
+        key_to_ordered(thread->key_field->val_int(), scan->key_unsigned) >=
+        end)
+      break;
+    scan_add_row(thread);
+    if (!(++thread->rows % PARALLEL_SCAN_KILL_CHECK_ROWS) &&
+        (scan->thd->killed || my_atomic_load32(&scan->abort)))
+      return HA_ERR_ABORTED_BY_USER;
+    error= parallel_scan_read(file, thread->record, 0, TRUE);
+  }
+  if (error == HA_ERR_END_OF_FILE || error == HA_ERR_KEY_NOT_FOUND)
+    error= 0;
+  return error;
+}
+
+
+/* Read the ranges of the scan until there are none left */
+
+static void scan_ranges(Scan_thread *thread)
+{
+  Parallel_scan *scan= thread->scan;
+  int32 range;
+
+  while (!thread->error &&
+         (range= my_atomic_add32(&scan->next_range, 1)) < scan->range_count)
+  {
+    if ((thread->error= scan_range(thread, range)))
+      my_atomic_store32(&scan->abort, 1);
+  }
+  for (uint i= 0; i < scan->aggr_count; i++)
+  {
+    if (thread->partial[i].int_sum)
+      thread->partial[i].flush_int_sum();
+  }
+}
+
+
+pthread_handler_t parallel_scan_thread(void *arg)
+{
+  my_thread_init();
+  /* The fields of the table may be read only on behalf of its session */
+  set_current_thd(((Scan_thread*) arg)->scan->thd);
+  scan_ranges((Scan_thread*) arg);
+  my_thread_end();
+  return 0;
+}
+
+
+/**
+  Prepare a thread for a parallel scan.
+
+  A clone of the table handler is created for every thread except the
+  first one, which is the session thread and uses the handler of the table.
+
+  @return TRUE on error
+*/
+
+static bool init_scan_thread(Parallel_scan *scan, Scan_thread *thread,
+                             uint thread_no)
+{
+  THD *thd= scan->thd;
+  TABLE *table= scan->table;
+  my_ptrdiff_t diff;
+  int error;
+
+  bzero(thread, sizeof(*thread));
+  thread->scan= scan;
+  if (!(thread->record= (uchar*) thd->alloc(table->s->rec_buff_length)) ||
+      !(thread->partial= new (thd->mem_root) Scan_partial[scan->aggr_count]))
+    return TRUE;
+  diff= (my_ptrdiff_t) (thread->record - table->record[0]);
+  memcpy(thread->record, table->s->default_values, table->s->reclength);
+  if (!(thread->key_field= scan->key_field->clone(thd->mem_root, diff)))
+    return TRUE;
+
+  for (uint i= 0; i < scan->aggr_count; i++)
+  {
+    Scan_partial *partial= thread->partial + i;
+    Field *field= scan->aggr[i].field;
+    partial->count= partial->int_sum= 0;
+    partial->real_sum= 0.0;
+    partial->curr_dec_sum= 0;
+    my_decimal_set_zero(partial->dec_sum);
+    partial->field= 0;
+    partial->best= 0;
+    if (field &&
+        (!(partial->field= field->clone(thd->mem_root, diff)) ||
+         !(partial->best= (uchar*) thd->alloc(field->pack_length()))))
+      return TRUE;
+  }
+
+  if (thread_no == 0)
+  {
+    thread->file= table->file;
+    return FALSE;
+  }
+  if (!(thread->file= table->file->clone(table->s->normalized_path.str,
+                                         thd->mem_root)))
+  {
+    my_error(ER_OUT_OF_RESOURCES, MYF(0));
+    return TRUE;
+  }
+  if ((error= thread->file->ha_external_lock(thd, F_RDLCK)))
+  {
+    thread->file->print_error(error, MYF(0));
+    thread->file->ha_close();
+    thread->file= 0;
+    return TRUE;
+  }
+  if ((error= thread->file->ha_index_init(table->s->primary_key, 1)))
+  {
+    thread->file->print_error(error, MYF(0));
+    thread->file->ha_external_lock(thd, F_UNLCK);
+    thread->file->ha_close();
+    thread->file= 0;
+    return TRUE;
+  }
+  return FALSE;
+}
+
+
+static void end_scan_thread(Scan_thread *thread)
+{
+  handler *file= thread->file;
+  if (!file || file == thread->scan->table->file)
+    return;
+  file->ha_index_end();
+  file->ha_external_lock(thread->scan->thd, F_UNLCK);
+  file->ha_close();
+  delete file;
+}
+
+
+/* Merge the partial results of all threads into the aggregate functions */
+
+static void merge_scan_results(Parallel_scan *scan, Scan_thread *threads,
+                               uint thread_count)
+{
+  TABLE *table= scan->table;
+  for (uint i= 0; i < scan->aggr_count; i++)
+  {
+    Scan_aggregate *aggr= scan->aggr + i;
+    Item_sum *item= aggr->item;
+
+    item->clear();
+    for (uint t= 0; t < thread_count; t++)
+    {
+      Scan_partial *partial= threads[t].partial + i;
+      switch (aggr->type) {
+      case SCAN_COUNT_ROWS:
+        if (!aggr->item->get_arg(0)->is_null())
+          ((Item_sum_count*) item)->direct_add(partial->count);
+        break;
+      case SCAN_COUNT:
+        ((Item_sum_count*) item)->direct_add(partial->count);
+        break;
+      case SCAN_SUM_INT:
+      case SCAN_SUM_DECIMAL:
+        ((Item_sum_sum*) item)->direct_add(partial->count ?
+                                           partial->dec_sum +
+                                           partial->curr_dec_sum : 0);
+        if (item->sum_func() == Item_sum::AVG_FUNC)
+          ((Item_sum_avg*) item)->count+= partial->count;
+        break;
+      case SCAN_SUM_REAL:
+        ((Item_sum_sum*) item)->direct_add(partial->real_sum,
+                                           partial->count == 0);
+        if (item->sum_func() == Item_sum::AVG_FUNC)
+          ((Item_sum_avg*) item)->count+= partial->count;
+        break;
+      case SCAN_MIN_MAX:
+        if (!partial->count)
+          break;
+        /* Let the item compare the value as if it was read by a scan */
+        memcpy(aggr->field->ptr, partial->best, aggr->field->pack_length());
+        aggr->field->set_notnull();
+        item->add();
+        break;
+      }
+    }
+  }
+  table->status= 0;
+}
+
+
+/**
+  Compute the aggregate functions of a join by a parallel scan of its table
+  and send the result row.
+
+  The function is called by do_select() instead of sub_select() when
+  parallel_scan_threads() has chosen a parallel scan for the join.
+
+  @param join  the join
+  @param tab   the join tab of the scanned table
+
+  @return The state of the nested loop join, as sub_select() would return
+          after the end of records has been processed.
+*/
+
+enum_nested_loop_state join_parallel_scan(JOIN *join, JOIN_TAB *tab)
+{
+  THD *thd= join->thd;
+  TABLE *table= tab->table;
+  Parallel_scan scan;
+  Scan_thread *threads= 0;
+  Item_sum **func_ptr, *func;
+  uint thread_count= tab->parallel_scan_threads, started= 0, i;
+  ulonglong last_key;
+  my_bitmap_map *old_map;
+  ha_rows rows= 0;
+  ulong ranges= 0;
+  int error;
+  enum_nested_loop_state rc= NESTED_LOOP_OK;
+  DBUG_ENTER("join_parallel_scan");
+
+  scan.thd= thd;
+  scan.table= table;
+  scan.key_info= table->key_info + table->s->primary_key;
+  scan.key_field= scan.key_info->key_part[0].field;
+  scan.key_unsigned= MY_TEST(scan.key_field->flags & UNSIGNED_FLAG);
+  scan.next_range= 0;
+  scan.abort= 0;
+  scan.aggr_count= 0;
+  for (func_ptr= join->sum_funcs; *func_ptr; func_ptr++)
+    scan.aggr_count++;
+  if (!(scan.aggr= (Scan_aggregate*) thd->alloc(scan.aggr_count *
+                                                 sizeof(Scan_aggregate))))
+    DBUG_RETURN(NESTED_LOOP_ERROR);
+  for (i= 0, func_ptr= join->sum_funcs; (func= *func_ptr); func_ptr++, i++)
+  {
+    bool supported= get_scan_aggregate(func, table, scan.aggr + i);
+    DBUG_ASSERT(supported);
+    if (!supported)
+      DBUG_RETURN(NESTED_LOOP_ERROR);
+  }
+
+  tab->tracker->on_scan_init();
+  bitmap_set_bit(table->read_set, scan.key_field->field_index);
+  if ((error= table->file->ha_index_init(table->s->primary_key, 1)))
+    goto err;
+
+  /* Find the range of the key values */
+  if ((error= table->file->ha_index_first(table->record[0])))
+  {
+    table->file->ha_index_end();
+    if (error != HA_ERR_END_OF_FILE && error != HA_ERR_KEY_NOT_FOUND)
+      goto err;
+    thread_count= 0;                            // Empty table
+    goto send;
+  }
+  scan.first_key= key_to_ordered(scan.key_field->val_int(), scan.key_unsigned);
+  if ((error= table->file->ha_index_last(table->record[0])))
+  {
+    table->file->ha_index_end();
+    goto err;
+  }
+  last_key= key_to_ordered(scan.key_field->val_int(), scan.key_unsigned);
+
+  scan.range_count= (int32) (thread_count * PARALLEL_SCAN_RANGES_PER_THREAD);
+  if (last_key - scan.first_key < (ulonglong) scan.range_count)
+    scan.range_count= (int32) (last_key - scan.first_key) + 1;
+  scan.range_width= (last_key - scan.first_key) / scan.range_count + 1;
+  set_if_smaller(thread_count, (uint) scan.range_count);
+
+  /* The key images are made here, as Field::store() is not thread safe */
+  scan.range_key_length= scan.key_info->key_part[0].length;
+  if (!(scan.range_keys= (uchar*) thd->alloc(scan.range_count *
+                                             scan.range_key_length)))
+  {
+    table->file->ha_index_end();
+    DBUG_RETURN(NESTED_LOOP_ERROR);
+  }
+  old_map= dbug_tmp_use_all_columns(table, table->write_set);
+  for (int32 range= 1; range < scan.range_count; range++)
+  {
+    scan.key_field->store(ordered_to_key(range_start(&scan, range),
+                                         scan.key_unsigned),
+                          scan.key_unsigned);
+    scan.key_field->get_key_image(scan.range_keys +
+                                  range * scan.range_key_length,
+                                  scan.range_key_length, Field::itRAW);
+  }
+  dbug_tmp_restore_column_map(table->write_set, old_map);
+
+  if (!(threads= (Scan_thread*) thd->alloc(thread_count *
+                                           sizeof(Scan_thread))))
+  {
+    table->file->ha_index_end();
+    DBUG_RETURN(NESTED_LOOP_ERROR);
+  }
+  for (i= 0; i < thread_count; i++)
+  {
+    if (init_scan_thread(&scan, threads + i, i))
+      break;
+  }
+  if (i < thread_count)
+  {
+    while (i-- > 1)
+      end_scan_thread(threads + i);
+    table->file->ha_index_end();
+    DBUG_RETURN(NESTED_LOOP_ERROR);
+  }
+
+  /* threads[0] is the session thread; fewer threads do the same work */
+  for (i= 1; i < thread_count; i++)
+  {
+    if (!mysql_thread_create(0, /* Not instrumented */
+                             &threads[i].id, NULL, parallel_scan_thread,
+                             threads + i))
+      started= i;
+    else
+      break;
+  }
+  scan_ranges(threads);
+  for (i= 1; i <= started; i++)
+    pthread_join(threads[i].id, NULL);
+
+  error= 0;
+  for (i= 0; i < thread_count; i++)
+  {
+    if (threads[i].error && !error)
+    {
+      error= threads[i].error;
+      if (error != HA_ERR_ABORTED_BY_USER)
+        threads[i].file->print_error(error, MYF(0));
+    }
+    rows+= threads[i].rows;
+    ranges+= threads[i].ranges;
+  }
+  for (i= 1; i < thread_count; i++)
+    end_scan_thread(threads + i);
+  table->file->ha_index_end();
+
+  thd->status_var.ha_read_key_count+= ranges;
+  thd->status_var.ha_read_next_count+= rows;
+  tab->tracker->r_rows+= rows;
+  tab->tracker->r_rows_after_where+= rows;
+  join->join_examined_rows+= rows;
+
+  if (thd->check_killed())
+  {
+    thd->send_kill_message();
+    DBUG_RETURN(NESTED_LOOP_KILLED);
+  }
+  if (error)
+    DBUG_RETURN(NESTED_LOOP_ERROR);
+
+send:
+  merge_scan_results(&scan, threads, thread_count);
+  if (!rows)
+  {
+    List_iterator_fast<Item> it(*join->fields);
+    Item *item;
+    /* No rows for the aggregate functions, see end_send_group() */
+    join->clear();
+    join->no_rows_in_result_called= 1;
+    while ((item= it++))
+      item->no_rows_in_result();
+  }
+  if (join->do_send_rows)
+  {
+    if ((error= join->result->send_data(*join->fields)) > 0)
+      rc= NESTED_LOOP_ERROR;
+    else if (error == 0)
+      join->send_records++;
+  }
+  else
+    join->send_records++;
+  DBUG_RETURN(rc);
+
+err:
+  table->file->print_error(error, MYF(0));
+  DBUG_RETURN(NESTED_LOOP_ERROR);
+}
@@ -8067,8 +8067,7 @@ void add_join_natural(TABLE_LIST *a, TABLE_LIST *b, List<String> *using_fields,
 THD *find_thread_by_id(longlong id, bool query_id)
 {
   THD *tmp;
-  mysql_mutex_lock(&LOCK_thread_count); // For unlink from list
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
   while ((tmp=it++))
   {
     if (tmp->get_command() == COM_DAEMON)
@@ -8079,7 +8078,7 @@ THD *find_thread_by_id(longlong id, bool query_id)
       break;
     }
   }
-  mysql_mutex_unlock(&LOCK_thread_count);
+  it.release();
   return tmp;
 }
 
@@ -8093,7 +8092,7 @@ THD *find_thread_by_id(longlong id, bool query_id)
   @param type                   Type of id: thread id or query id
 
   @note
-    This is written such that we have a short lock on LOCK_thread_count
+    This is written such that we have a short lock on server_threads
 */
 
 uint
@@ -8152,7 +8151,7 @@ kill_one_thread(THD *thd, longlong id, killed_state kill_signal, killed_type typ
   @param only_kill_query        Should it kill the query or the connection
 
   @note
-    This is written such that we have a short lock on LOCK_thread_count
+    This is written such that we have a short lock on server_threads
 
     If we can't kill all threads because of security issues, no threads
     are killed.
@@ -8173,32 +8172,40 @@ static uint kill_threads_for_user(THD *thd, LEX_USER *user,
   DBUG_PRINT("enter", ("user: %s  signal: %u", user->user.str,
                        (uint) kill_signal));
 
-  mysql_mutex_lock(&LOCK_thread_count); // For unlink from list
-  I_List_iterator<THD> it(threads);
-  while ((tmp=it++))
   {
-    if (!tmp->security_ctx->user)
-      continue;
     /*
-      Check that hostname (if given) and user name matches.
-
-      host.str[0] == '%' means that host name was not given. See sql_yacc.yy
+      All shards are locked for the whole scan, as LOCK_thd_data of the
+      found threads is kept and must not be followed by a shard lock.
     */
-    if (((user->host.str[0] == '%' && !user->host.str[1]) ||
-         !strcmp(tmp->security_ctx->host_or_ip, user->host.str)) &&
-        !strcmp(tmp->security_ctx->user, user->user.str))
+    THD_list_ordered_iterator it(server_threads);
+    while ((tmp=it++))
     {
-      if (!(thd->security_ctx->master_access & SUPER_ACL) &&
-          !thd->security_ctx->user_matches(tmp->security_ctx))
+      if (!tmp->security_ctx->user)
+        continue;
+      /*
+        Check that hostname (if given) and user name matches.
+
+        host.str[0] == '%' means that host name was not given. See
+        sql_yacc.yy
+      */
+      if (((user->host.str[0] == '%' && !user->host.str[1]) ||
+           !strcmp(tmp->security_ctx->host_or_ip, user->host.str)) &&
+          !strcmp(tmp->security_ctx->user, user->user.str))
       {
-        mysql_mutex_unlock(&LOCK_thread_count);
-        DBUG_RETURN(ER_KILL_DENIED_ERROR);
+        if (!(thd->security_ctx->master_access & SUPER_ACL) &&
+            !thd->security_ctx->user_matches(tmp->security_ctx))
+        {
+          List_iterator_fast<THD> it2(threads_to_kill);
+          THD *ptr;
+          while ((ptr= it2++))
+            mysql_mutex_unlock(&ptr->LOCK_thd_data);
+          DBUG_RETURN(ER_KILL_DENIED_ERROR);
+        }
+        if (!threads_to_kill.push_back(tmp, thd->mem_root))
+          mysql_mutex_lock(&tmp->LOCK_thd_data); // Lock from delete
       }
-      if (!threads_to_kill.push_back(tmp, thd->mem_root))
-        mysql_mutex_lock(&tmp->LOCK_thd_data); // Lock from delete
     }
   }
-  mysql_mutex_unlock(&LOCK_thread_count);
   if (!threads_to_kill.is_empty())
   {
     List_iterator_fast<THD> it2(threads_to_kill);
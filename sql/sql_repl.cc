@@ -502,12 +502,11 @@ void adjust_linfo_offsets(my_off_t purge_offset)
 {
   THD *tmp;
 
-  mysql_mutex_lock(&LOCK_thread_count);
-  I_List_iterator<THD> it(threads);
-
+  THD_list_iterator it(server_threads);
   while ((tmp=it++))
   {
     LOG_INFO* linfo;
+    mysql_mutex_lock(&tmp->LOCK_thd_data);
     if ((linfo = tmp->current_linfo))
     {
       mysql_mutex_lock(&linfo->lock);
@@ -522,8 +521,8 @@ void adjust_linfo_offsets(my_off_t purge_offset)
 	linfo->index_file_offset -= purge_offset;
       mysql_mutex_unlock(&linfo->lock);
     }
+    mysql_mutex_unlock(&tmp->LOCK_thd_data);
   }
-  mysql_mutex_unlock(&LOCK_thread_count);
 }
 
 
@@ -533,23 +532,21 @@ bool log_in_use(const char* log_name)
   THD *tmp;
   bool result = 0;
 
-  mysql_mutex_lock(&LOCK_thread_count);
-  I_List_iterator<THD> it(threads);
-
+  THD_list_iterator it(server_threads);
   while ((tmp=it++))
   {
     LOG_INFO* linfo;
+    mysql_mutex_lock(&tmp->LOCK_thd_data);
     if ((linfo = tmp->current_linfo))
     {
       mysql_mutex_lock(&linfo->lock);
       result = !memcmp(log_name, linfo->log_file_name, log_name_len);
       mysql_mutex_unlock(&linfo->lock);
-      if (result)
-	break;
     }
+    mysql_mutex_unlock(&tmp->LOCK_thd_data);
+    if (result)
+      break;
   }
-
-  mysql_mutex_unlock(&LOCK_thread_count);
   return result;
 }
 
@@ -2181,9 +2178,9 @@ static int init_binlog_sender(binlog_send_info *info,
   linfo->pos= *pos;
 
   // note: publish that we use file, before we open it
-  mysql_mutex_lock(&LOCK_thread_count);
+  mysql_mutex_lock(&thd->LOCK_thd_data);
   thd->current_linfo= linfo;
-  mysql_mutex_unlock(&LOCK_thread_count);
+  mysql_mutex_unlock(&thd->LOCK_thd_data);
 
   if (check_start_offset(info, linfo->log_file_name, *pos))
     return 1;
@@ -2624,7 +2621,19 @@ static int send_events(binlog_send_info *info, IO_CACHE* log, LOG_INFO* linfo,
       return 1;
 
     info->last_pos= linfo->pos;
-    error= Log_event::read_log_event(log, packet, info->fdev,
+    if (binlog_ring.enabled() &&
+        binlog_ring.read_event(linfo->log_file_name, linfo->pos, end_pos,
+                               packet,
+                               opt_master_verify_checksum ?
+                               info->current_checksum_alg :
+                               BINLOG_CHECKSUM_ALG_OFF))
+    {
+      /* Keep the file position in step for the next read from the file */
+      my_b_seek(log, linfo->pos + packet->length() - ev_offset);
+      error= 0;
+    }
+    else
+      error= Log_event::read_log_event(log, packet, info->fdev,
                        opt_master_verify_checksum ? info->current_checksum_alg
                                                   : BINLOG_CHECKSUM_ALG_OFF);
     linfo->pos= my_b_tell(log);
@@ -2922,9 +2931,9 @@ void mysql_binlog_send(THD* thd, char* log_ident, my_off_t pos,
     mysql_file_close(file, MYF(MY_WME));
   }
 
-  mysql_mutex_lock(&LOCK_thread_count);
+  mysql_mutex_lock(&thd->LOCK_thd_data);
   thd->current_linfo = 0;
-  mysql_mutex_unlock(&LOCK_thread_count);
+  mysql_mutex_unlock(&thd->LOCK_thd_data);
   thd->variables.max_allowed_packet= old_max_allowed_packet;
   delete info->fdev;
 
@@ -3385,8 +3394,7 @@ int reset_slave(THD *thd, Master_info* mi)
 
 void kill_zombie_dump_threads(uint32 slave_server_id)
 {
-  mysql_mutex_lock(&LOCK_thread_count);
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
   THD *tmp;
 
   while ((tmp=it++))
@@ -3398,7 +3406,7 @@ void kill_zombie_dump_threads(uint32 slave_server_id)
       break;
     }
   }
-  mysql_mutex_unlock(&LOCK_thread_count);
+  it.release();
   if (tmp)
   {
     /*
@@ -3946,9 +3954,9 @@ bool mysql_show_binlog_events(THD* thd)
       goto err;
     }
 
-    mysql_mutex_lock(&LOCK_thread_count);
+    mysql_mutex_lock(&thd->LOCK_thd_data);
     thd->current_linfo = &linfo;
-    mysql_mutex_unlock(&LOCK_thread_count);
+    mysql_mutex_unlock(&thd->LOCK_thd_data);
 
     if ((file=open_binlog(&log, linfo.log_file_name, &errmsg)) < 0)
       goto err;
@@ -4080,9 +4088,9 @@ bool mysql_show_binlog_events(THD* thd)
   else
     my_eof(thd);
 
-  mysql_mutex_lock(&LOCK_thread_count);
+  mysql_mutex_lock(&thd->LOCK_thd_data);
   thd->current_linfo = 0;
-  mysql_mutex_unlock(&LOCK_thread_count);
+  mysql_mutex_unlock(&thd->LOCK_thd_data);
   thd->variables.max_allowed_packet= old_max_allowed_packet;
   DBUG_RETURN(ret);
 }
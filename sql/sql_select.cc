@@ -53,6 +53,7 @@
 #include "log_slow.h"
 #include "sql_derived.h"
 #include "sql_statistics.h"
+#include "sql_group_hash.h"
 
 #include "debug_sync.h"          // DEBUG_SYNC
 #include <m_ctype.h>
@@ -183,6 +184,8 @@ static enum_nested_loop_state
 end_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
 static enum_nested_loop_state
 end_unique_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
+static enum_nested_loop_state
+end_hash_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
 
 static int test_if_group_changed(List<Cached_item> &list);
 static int join_read_const_table(THD *thd, JOIN_TAB *tab, POSITION *pos);
@@ -2023,6 +2026,9 @@ JOIN::optimize_inner()
     }
   }
 
+  if (table_count == 1 && implicit_grouping && !outer_ref_cond)
+    join_tab->parallel_scan_threads= parallel_scan_threads(this);
+
   error= 0;
 
   tmp_having= having;
@@ -17764,7 +17770,12 @@ Next_select_func setup_end_select_func(JOIN *join)
     if (table->group && tmp_tbl->sum_func_count && 
         !tmp_tbl->precomputed_group_by)
     {
-      if (table->s->keys)
+      if (table->s->keys && Group_hash_table::is_applicable(join, table))
+      {
+	DBUG_PRINT("info",("Using end_hash_update"));
+	end_select=end_hash_update;
+      }
+      else if (table->s->keys)
       {
 	DBUG_PRINT("info",("Using end_update"));
 	end_select=end_update;
@@ -17871,6 +17882,18 @@ do_select(JOIN *join,List<Item> *fields,TABLE *table,Procedure *procedure)
   }
   /* Set up select_end */
   Next_select_func end_select= setup_end_select_func(join);
+  if (end_select == end_hash_update)
+  {
+    join->group_hash= new Group_hash_table(join->thd, table,
+                                           join->tmp_table_param.group_length);
+    if (!join->group_hash || join->group_hash->init())
+    {
+      /* Not enough memory, look up the groups in the table instead */
+      delete join->group_hash;
+      join->group_hash= 0;
+      end_select= end_update;
+    }
+  }
   if (join->table_count)
   {
     join->join_tab[join->top_join_tab_count - 1].next_select= end_select;
@@ -17930,17 +17953,25 @@ do_select(JOIN *join,List<Item> *fields,TABLE *table,Procedure *procedure)
                           dbug_serve_apcs(join->thd, 1);
                    );
 
-    if (join->outer_ref_cond && !join->outer_ref_cond->val_int())
-      error= NESTED_LOOP_NO_MORE_ROWS;
+    if (join_tab->parallel_scan_threads)
+      error= join_parallel_scan(join, join_tab);
     else
-      error= sub_select(join,join_tab,0);
-    if ((error == NESTED_LOOP_OK || error == NESTED_LOOP_NO_MORE_ROWS) &&
-        join->thd->killed != ABORT_QUERY)
-      error= sub_select(join,join_tab,1);
+    {
+      if (join->outer_ref_cond && !join->outer_ref_cond->val_int())
+        error= NESTED_LOOP_NO_MORE_ROWS;
+      else
+        error= sub_select(join,join_tab,0);
+      if ((error == NESTED_LOOP_OK || error == NESTED_LOOP_NO_MORE_ROWS) &&
+          join->thd->killed != ABORT_QUERY)
+        error= sub_select(join,join_tab,1);
+    }
     if (error == NESTED_LOOP_QUERY_LIMIT)
       error= NESTED_LOOP_OK;                    /* select_limit used */
   }
 
+  delete join->group_hash;
+  join->group_hash= 0;
+
   join->thd->limit_found_rows= join->send_records;
 
   if (error == NESTED_LOOP_NO_MORE_ROWS || join->thd->killed == ABORT_QUERY)
@@ -19665,6 +19696,33 @@ end_write(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
 }
 
 
+/**
+  Store the GROUP BY columns of the current row in the key of the group
+  index, TMP_TABLE_PARAM::group_buff
+*/
+
+static void store_group_key(TABLE *table)
+{
+  for (ORDER *group=table->group ; group ; group=group->next)
+  {
+    Item *item= *group->item;
+    if (group->fast_field_copier_setup != group->field)
+    {
+      DBUG_PRINT("info", ("new setup 0x%lx -> 0x%lx",
+                          (ulong)group->fast_field_copier_setup,
+                          (ulong)group->field));
+      group->fast_field_copier_setup= group->field;
+      group->fast_field_copier_func=
+        item->setup_fast_field_copier(group->field);
+    }
+    item->save_org_in_field(group->field, group->fast_field_copier_func);
+    /* Store in the used key if the field was 0 */
+    if (item->maybe_null)
+      group->buff[-1]= (char) group->field->is_null();
+  }
+}
+
+
 /*
   @brief
     Perform a GROUP BY operation over rows coming in arbitrary order. 
@@ -19681,7 +19739,6 @@ end_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
 	   bool end_of_records)
 {
   TABLE *table=join->tmp_table;
-  ORDER   *group;
   int	  error;
   DBUG_ENTER("end_update");
 
@@ -19690,24 +19747,7 @@ end_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
 
   join->found_records++;
   copy_fields(&join->tmp_table_param);		// Groups are copied twice.
-  /* Make a key of group index */
-  for (group=table->group ; group ; group=group->next)
-  {
-    Item *item= *group->item;
-    if (group->fast_field_copier_setup != group->field)
-    {
-      DBUG_PRINT("info", ("new setup 0x%lx -> 0x%lx",
-                          (ulong)group->fast_field_copier_setup,
-                          (ulong)group->field));
-      group->fast_field_copier_setup= group->field;
-      group->fast_field_copier_func=
-        item->setup_fast_field_copier(group->field);
-    }
-    item->save_org_in_field(group->field, group->fast_field_copier_func);
-    /* Store in the used key if the field was 0 */
-    if (item->maybe_null)
-      group->buff[-1]= (char) group->field->is_null();
-  }
+  store_group_key(table);
   if (!table->file->ha_index_read_map(table->record[1],
                                       join->tmp_table_param.group_buff,
                                       HA_WHOLE_KEY,
@@ -19754,6 +19794,123 @@ end_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
 }
 
 
+/**
+  Write the row of a group from table->record[0] into the temporary table
+
+  @detail
+    Converts the table to an on-disk table when it is full, and continues
+    with end_unique_update() then, as end_update() does.
+*/
+
+static bool write_group_row(JOIN *join, TABLE *table)
+{
+  int error;
+  if ((error= table->file->ha_write_tmp_row(table->record[0])))
+  {
+    if (create_internal_tmp_table_from_heap(join->thd, table,
+                                            join->tmp_table_param.start_recinfo,
+                                            &join->tmp_table_param.recinfo,
+                                            error, 0, NULL))
+      return TRUE;                              // Not a table_is_full error
+    /* Change method to update rows */
+    if ((error= table->file->ha_index_init(0, 0)))
+    {
+      table->file->print_error(error, MYF(0));
+      return TRUE;
+    }
+    join->join_tab[join->top_join_tab_count-1].next_select=end_unique_update;
+  }
+  return FALSE;
+}
+
+
+/**
+  Move the groups from join->group_hash into the temporary table
+*/
+
+static bool flush_group_hash(JOIN *join)
+{
+  TABLE *table= join->tmp_table;
+  Group_hash_table *hash= join->group_hash;
+  uchar *record;
+
+  for (record= hash->first_record(); record; record= hash->next_record(record))
+  {
+    memcpy(table->record[0], record, table->s->reclength);
+    if (write_group_row(join, table))
+      return TRUE;
+  }
+  hash->clear();
+  return FALSE;
+}
+
+
+/**
+  @brief
+    Perform a GROUP BY operation over rows coming in arbitrary order.
+
+    This is done by looking up the group in join->group_hash and updating
+    its row in memory. The groups are written into the temporary table when
+    all rows have been read.
+
+  @detail
+    When the hash table is full, its groups are written into the temporary
+    table and the remaining rows are grouped by end_update().
+*/
+
+static enum_nested_loop_state
+end_hash_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
+                bool end_of_records)
+{
+  TABLE *table=join->tmp_table;
+  Group_hash_table *hash= join->group_hash;
+  uchar *key= join->tmp_table_param.group_buff;
+  uchar *record;
+  ulong hash_value;
+  DBUG_ENTER("end_hash_update");
+
+  if (end_of_records)
+    DBUG_RETURN(flush_group_hash(join) ? NESTED_LOOP_ERROR : NESTED_LOOP_OK);
+
+  join->found_records++;
+  copy_fields(&join->tmp_table_param);		// Groups are copied twice.
+  store_group_key(table);
+  hash_value= hash->hash_key(key);
+  if ((record= hash->find(key, hash_value)))
+  {						/* Update old group */
+    memcpy(table->record[0], record, table->s->reclength);
+    update_tmptable_sum_func(join->sum_funcs,table);
+    memcpy(record, table->record[0], table->s->reclength);
+    goto end;
+  }
+
+  init_tmptable_sum_functions(join->sum_funcs);
+  if (copy_funcs(join->tmp_table_param.items_to_copy, join->thd))
+    DBUG_RETURN(NESTED_LOOP_ERROR);           /* purecov: inspected */
+  if (!hash->insert(key, hash_value, table->record[0]))
+  {
+    /*
+      The hash table is full. Write the new group and the groups in the
+      hash table into the temporary table and look up the groups of the
+      remaining rows there.
+    */
+    JOIN_TAB *last_tab= join->join_tab + join->top_join_tab_count - 1;
+    if (write_group_row(join, table) || flush_group_hash(join))
+      DBUG_RETURN(NESTED_LOOP_ERROR);
+    if (last_tab->next_select == end_hash_update)
+      last_tab->next_select= end_update;
+  }
+  join->send_records++;
+end:
+  if (join->thd->check_killed())
+  {
+    join->thd->send_kill_message();
+    DBUG_RETURN(NESTED_LOOP_KILLED);             /* purecov: inspected */
+  }
+  DBUG_RETURN(NESTED_LOOP_OK);
+}
+
+
 /** Like end_update, but this is done with unique constraints instead of keys.  */
 
 static enum_nested_loop_state
@@ -24213,6 +24370,12 @@ void JOIN_TAB::save_explain_data(Explain_table_access *eta,
         eta->push_extra(ET_USING_MRR);
     }
 
+    if (parallel_scan_threads)
+    {
+      eta->push_extra(ET_USING_PARALLEL_SCAN);
+      eta->parallel_scan_threads= parallel_scan_threads;
+    }
+
     if (distinct & test_all_bits(prefix_tables, join->select_list_used_tables))
       eta->push_extra(ET_DISTINCT);
     if (loosescan_match_tab)
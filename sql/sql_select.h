@@ -198,6 +198,7 @@ int rr_sequential_and_unpack(READ_RECORD *info);
 class JOIN_CACHE;
 class SJ_TMP_TABLE;
 class JOIN_TAB_RANGE;
+class Group_hash_table;
 
 typedef struct st_join_table {
   st_join_table() {}                          /* Remove gcc warning */
@@ -339,6 +340,11 @@ typedef struct st_join_table {
   bool          idx_cond_fact_out;
   bool          use_join_cache;
   uint          used_join_cache_level;
+  /*
+    If not 0, the number of threads that scan the table in parallel and
+    compute the aggregate functions of the query (see sql_parallel_scan.cc)
+  */
+  uint          parallel_scan_threads;
   ulong         join_buffer_size_limit;
   JOIN_CACHE	*cache;
   /*
@@ -1143,6 +1149,8 @@ class JOIN :public Sql_alloc
   TABLE    *exec_tmp_table1, *exec_tmp_table2;
   THD	   *thd;
   Item_sum  **sum_funcs, ***sum_funcs_end;
+  /** The groups computed by end_hash_update() during do_select() */
+  Group_hash_table *group_hash;
   /** second copy of sumfuncs (for queries with 2 temporary tables */
   Item_sum  **sum_funcs2, ***sum_funcs_end2;
   Procedure *procedure;
@@ -1353,6 +1361,7 @@ class JOIN :public Sql_alloc
     join_examined_rows= 0;
     exec_tmp_table1= 0;
     exec_tmp_table2= 0;
+    group_hash= 0;
     sortorder= 0;
     table_reexec[0]= 0;
     join_tab_reexec= 0;
@@ -1600,6 +1609,10 @@ bool simple_pred(Item_func *func_item, Item **args, bool *inv_order);
 int opt_sum_query(THD* thd,
                   List<TABLE_LIST> &tables, List<Item> &all_fields, COND *conds);
 
+/* functions from sql_parallel_scan.cc */
+uint parallel_scan_threads(JOIN *join);
+enum_nested_loop_state join_parallel_scan(JOIN *join, JOIN_TAB *tab);
+
 /* from sql_delete.cc, used by opt_range.cc */
 extern "C" int refpos_order_cmp(void* arg, const void *a,const void *b);
 
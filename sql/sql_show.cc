@@ -2325,7 +2325,7 @@ static int show_create_view(THD *thd, TABLE_LIST *table, String *buff)
   returns for each thread: thread id, user, host, db, command, info
 ****************************************************************************/
 
-class thread_info :public ilink {
+class thread_info {
 public:
   static void *operator new(size_t size, MEM_ROOT *mem_root) throw ()
   { return alloc_root(mem_root, size); }
@@ -2342,6 +2342,18 @@ class thread_info :public ilink {
   double progress;
 };
 
+
+/*
+  The threads are listed by server_threads in the order of its shards.
+  Show them in the order of their ids, that is, oldest first.
+*/
+
+static int thread_info_cmp(thread_info * const *a, thread_info * const *b)
+{
+  return ((*a)->thread_id < (*b)->thread_id ? -1 :
+          (*a)->thread_id > (*b)->thread_id ? 1 : 0);
+}
+
 static const char *thread_state_info(THD *tmp)
 {
 #ifndef EMBEDDED_LIBRARY
@@ -2370,7 +2382,7 @@ void mysqld_list_processes(THD *thd,const char *user, bool verbose)
 {
   Item *field;
   List<Item> field_list;
-  I_List<thread_info> thread_infos;
+  Dynamic_array<thread_info*> thread_infos(thd->mem_root);
   ulong max_query_length= (verbose ? thd->variables.max_allowed_packet :
 			   PROCESS_LIST_WIDTH);
   Protocol *protocol= thd->protocol;
@@ -2422,8 +2434,7 @@ void mysqld_list_processes(THD *thd,const char *user, bool verbose)
   if (thd->killed)
     DBUG_VOID_RETURN;
 
-  mysql_mutex_lock(&LOCK_thread_count); // For unlink from list
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
   THD *tmp;
   while ((tmp=it++))
   {
@@ -2497,15 +2508,16 @@ void mysqld_list_processes(THD *thd,const char *user, bool verbose)
       thread_infos.append(thd_info);
     }
   }
-  mysql_mutex_unlock(&LOCK_thread_count);
+  it.release();
 
-  thread_info *thd_info;
   ulonglong now= microsecond_interval_timer();
   char buff[20];                                // For progress
   String store_buffer(buff, sizeof(buff), system_charset_info);
 
-  while ((thd_info=thread_infos.get()))
+  thread_infos.sort(thread_info_cmp);
+  for (size_t i= 0; i < thread_infos.elements(); i++)
   {
+    thread_info *thd_info= thread_infos.at(i);
     protocol->prepare_for_resend();
     protocol->store((ulonglong) thd_info->thread_id);
     protocol->store(thd_info->user, system_charset_info);
@@ -2800,11 +2812,10 @@ int fill_schema_processlist(THD* thd, TABLE_LIST* tables, COND* cond)
   user= thd->security_ctx->master_access & PROCESS_ACL ?
         NullS : thd->security_ctx->priv_user;
 
-  mysql_mutex_lock(&LOCK_thread_count);
-
   if (!thd->killed)
   {
-    I_List_iterator<THD> it(threads);
+    /* Newest first, as the rows were always shown */
+    THD_list_ordered_iterator it(server_threads);
     THD* tmp;
 
     while ((tmp= it++))
@@ -2928,14 +2939,10 @@ int fill_schema_processlist(THD* thd, TABLE_LIST* tables, COND* cond)
       table->field[16]->store(tmp->os_thread_id);
 
       if (schema_table_store_record(thd, table))
-      {
-        mysql_mutex_unlock(&LOCK_thread_count);
         DBUG_RETURN(1);
-      }
     }
   }
 
-  mysql_mutex_unlock(&LOCK_thread_count);
   DBUG_RETURN(0);
 }
 
@@ -3350,10 +3357,8 @@ void calc_sum_of_all_status(STATUS_VAR *to)
 {
   DBUG_ENTER("calc_sum_of_all_status");
 
-  /* Ensure that thread id not killed during loop */
-  mysql_mutex_lock(&LOCK_thread_count); // For unlink from list
-
-  I_List_iterator<THD> it(threads);
+  /* The iterator ensures that a thread is not deleted while it is read */
+  THD_list_iterator it(server_threads);
   THD *tmp;
 
   /* Get global values as base */
@@ -3366,7 +3371,6 @@ void calc_sum_of_all_status(STATUS_VAR *to)
       add_to_status(to, &tmp->status_var);
   }
   
-  mysql_mutex_unlock(&LOCK_thread_count);
   DBUG_VOID_RETURN;
 }
 
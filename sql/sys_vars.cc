@@ -1167,6 +1167,21 @@ static Sys_var_mybool Sys_trust_function_creators(
        GLOBAL_VAR(trust_function_creators),
        CMD_LINE(OPT_ARG), DEFAULT(FALSE));
 
+static Sys_var_mybool Sys_log_bin_compress(
+       "log_bin_compress",
+       "Store queries and rows in the binary log compressed, in the events "
+       "where they are at least log_bin_compress_min_len bytes long",
+       GLOBAL_VAR(opt_bin_log_compress),
+       CMD_LINE(OPT_ARG), DEFAULT(FALSE));
+
+static Sys_var_uint Sys_log_bin_compress_min_len(
+       "log_bin_compress_min_len",
+       "Minimum length of the query or the rows of an event for the event "
+       "to be stored compressed in the binary log",
+       GLOBAL_VAR(opt_bin_log_compress_min_len),
+       CMD_LINE(REQUIRED_ARG), VALID_RANGE(10, 1024*1024), DEFAULT(256),
+       BLOCK_SIZE(1));
+
 static Sys_var_charptr Sys_log_error(
        "log_error",
        "Log errors to file (instead of stdout).  If file name is not specified "
@@ -1980,7 +1995,8 @@ Sys_var_slave_parallel_mode::global_value_ptr(THD *thd,
 
 /* The order here must match enum_slave_parallel_mode in mysqld.h. */
 static const char *slave_parallel_mode_names[] = {
-  "none", "minimal", "conservative", "optimistic", "aggressive", NULL
+  "none", "minimal", "conservative", "optimistic", "aggressive", "writeset",
+  NULL
 };
 export TYPELIB slave_parallel_mode_typelib = {
   array_elements(slave_parallel_mode_names)-1,
@@ -1998,6 +2014,9 @@ static Sys_var_slave_parallel_mode Sys_slave_parallel_mode(
        "effort to avoid any conflicts. \"aggressive\" tries to maximise the "
        "parallelism, possibly at the cost of increased conflict rate. "
        "\"minimal\" only parallelizes the commit steps of transactions. "
+       "\"writeset\" is like \"conservative\", and also applies in parallel "
+       "transactions that changed different keys, as recorded in the binlog "
+       "by a master with binlog_track_writesets=ON. "
        "\"none\" disables parallel apply completely.",
        GLOBAL_VAR(opt_slave_parallel_mode), NO_CMD_LINE,
        slave_parallel_mode_names, DEFAULT(SLAVE_PARALLEL_CONSERVATIVE));
@@ -2079,6 +2098,40 @@ static Sys_var_ulong Sys_binlog_commit_wait_usec(
        VALID_RANGE(0, ULONG_MAX), DEFAULT(100000), BLOCK_SIZE(1));
 
 
+static Sys_var_mybool Sys_binlog_track_writesets(
+       "binlog_track_writesets",
+       "Record with the GTID of each transaction written to the binlog the "
+       "last earlier transaction that changed a row with the same primary or "
+       "unique key value. A slave with slave_parallel_mode=writeset then "
+       "applies in parallel transactions that do not conflict, even if they "
+       "did not group commit on the master. Transactions on tables without "
+       "a primary key or referenced by a foreign key, or that are not logged "
+       "in row format, are applied after all earlier transactions.",
+       GLOBAL_VAR(opt_binlog_track_writesets), CMD_LINE(OPT_ARG),
+       DEFAULT(FALSE));
+
+
+static Sys_var_ulong Sys_binlog_writeset_history_size(
+       "binlog_writeset_history_size",
+       "The number of key values for which binlog_track_writesets remembers "
+       "the last transaction that changed them. When more are changed, the "
+       "history is cleared, and the following transactions are applied "
+       "after all transactions before that point. A transaction that changes "
+       "more key values is applied after all earlier transactions.",
+       GLOBAL_VAR(opt_binlog_writeset_history_size), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 1024*1024*1024), DEFAULT(25000), BLOCK_SIZE(1));
+
+
+static Sys_var_ulong Sys_binlog_dump_ring_size(
+       "binlog_dump_ring_size",
+       "Size in bytes of an in-memory copy of the most recently written part "
+       "of the binary log. Binlog dump threads for slaves that are close to "
+       "the end of the log send events from it instead of reading them back "
+       "from the file. 0 disables it. Not used when encrypt_binlog is set.",
+       READ_ONLY GLOBAL_VAR(opt_binlog_dump_ring_size), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 1024*1024*1024), DEFAULT(0), BLOCK_SIZE(4096));
+
+
 static bool fix_max_join_size(sys_var *self, THD *thd, enum_var_type type)
 {
   SV *sv= type == OPT_GLOBAL ? &global_system_variables : &thd->variables;
@@ -2328,6 +2381,14 @@ static Sys_var_ulong Sys_optimizer_use_condition_selectivity(
        SESSION_VAR(optimizer_use_condition_selectivity), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(1, 5), DEFAULT(1), BLOCK_SIZE(1));
 
+static Sys_var_ulong Sys_parallel_scan_threads(
+       "parallel_scan_threads",
+       "Maximum number of threads used to scan the table of a single-table "
+       "query that computes COUNT, SUM, AVG, MIN or MAX over all its rows. "
+       "1 means that such tables are scanned by the session thread only",
+       SESSION_VAR(parallel_scan_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 64), DEFAULT(1), BLOCK_SIZE(1));
+
 /** Warns about deprecated value 63 */
 static bool fix_optimizer_search_depth(sys_var *self, THD *thd,
                                        enum_var_type type)
@@ -2766,6 +2827,14 @@ static Sys_var_ulong Sys_query_cache_min_res_unit(
        BLOCK_SIZE(8), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
        ON_UPDATE(fix_qcache_min_res_unit));
 
+static Sys_var_uint Sys_query_cache_partitions(
+       "query_cache_partitions",
+       "Number of independently locked partitions the query cache is split "
+       "into. Statements are assigned to a partition by the hash of their "
+       "text and query_cache_size is divided evenly between the partitions",
+       READ_ONLY GLOBAL_VAR(query_cache_partitions), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 64), DEFAULT(1), BLOCK_SIZE(1));
+
 static const char *query_cache_type_names[]= { "OFF", "ON", "DEMAND", 0 };
 
 static bool check_query_cache_type(sys_var *self, THD *thd, set_var *var)
@@ -2981,6 +3050,13 @@ static Sys_var_ulonglong Sys_sort_buffer(
        VALID_RANGE(MIN_SORT_MEMORY, SIZE_T_MAX), DEFAULT(MAX_SORT_MEMORY),
        BLOCK_SIZE(1));
 
+static Sys_var_ulong Sys_sort_threads(
+       "sort_threads",
+       "Maximum number of threads one filesort may use to sort the sort "
+       "buffer and to merge the sorted chunks",
+       SESSION_VAR(sort_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 64), DEFAULT(1), BLOCK_SIZE(1));
+
 export ulonglong expand_sql_mode(ulonglong sql_mode)
 {
   if (sql_mode & MODE_ANSI)
@@ -3297,6 +3373,21 @@ static Sys_var_uint Sys_threadpool_stall_limit(
   NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0), 
   ON_UPDATE(fix_threadpool_stall_limit)
 );
+static Sys_var_mybool Sys_threadpool_work_stealing(
+ "thread_pool_work_stealing",
+ "If a thread group has no work, its worker threads take queued requests "
+ "from the other thread groups before they go idle.",
+  GLOBAL_VAR(threadpool_work_stealing), CMD_LINE(OPT_ARG), DEFAULT(TRUE)
+);
+static Sys_var_mybool Sys_threadpool_io_uring(
+ "thread_pool_io_uring",
+ "Use io_uring instead of epoll for the network IO of the thread pool. "
+ "The requests of the clients are read into the connection buffers "
+ "together with the wait for them, and the submissions of a thread group "
+ "are batched. Linux only, epoll is used if io_uring is not available.",
+  READ_ONLY GLOBAL_VAR(threadpool_io_uring), CMD_LINE(OPT_ARG),
+  DEFAULT(FALSE)
+);
 #endif /* !WIN32 */
 static Sys_var_uint Sys_threadpool_max_threads(
   "thread_pool_max_threads",
@@ -3903,6 +3994,14 @@ static Sys_var_ulong Sys_default_week_format(
        SESSION_VAR(default_week_format), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(0, 7), DEFAULT(0), BLOCK_SIZE(1));
 
+static Sys_var_mybool Sys_group_by_hash(
+       "group_by_hash",
+       "Compute the groups of GROUP BY in an in-memory hash table instead "
+       "of looking them up in the temporary table. The groups are moved "
+       "to the temporary table when the hash table grows beyond "
+       "tmp_table_size",
+       SESSION_VAR(group_by_hash), CMD_LINE(OPT_ARG), DEFAULT(FALSE));
+
 static Sys_var_ulonglong Sys_group_concat_max_len(
        "group_concat_max_len",
        "The maximum length of the result of function  GROUP_CONCAT()",
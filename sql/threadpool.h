@@ -23,6 +23,8 @@ extern uint threadpool_max_size;
 extern uint threadpool_stall_limit;  /* time interval in 10 ms units for stall checks*/
 extern uint threadpool_max_threads;  /* Maximum threads in pool */
 extern uint threadpool_oversubscribe;  /* Maximum active threads in group */
+extern my_bool threadpool_work_stealing; /* Idle groups take queued events */
+extern my_bool threadpool_io_uring; /* Network IO with io_uring on Linux */
 
 
 
@@ -57,6 +59,30 @@ struct TP_STATISTICS
 
 extern TP_STATISTICS tp_stats;
 
+/*
+  Statistics of a thread group, see INFORMATION_SCHEMA.THREAD_POOL_GROUPS
+*/
+struct TP_GROUP_STATISTICS
+{
+  int connections;
+  int threads;
+  int active_threads;
+  uint queue_length;
+  bool has_listener;
+  bool is_stalled;
+  /* Number of events taken from the queue, by any group */
+  ulonglong dequeues;
+  /* Total time in microseconds the dequeued events waited in the queue */
+  ulonglong queue_wait_time;
+  /* Number of events the workers took from the queues of other groups */
+  ulonglong steals;
+  /* Number of events the workers of other groups took from the queue */
+  ulonglong stolen;
+};
+
+extern uint tp_get_group_count();
+extern void tp_get_group_statistics(uint group, TP_GROUP_STATISTICS *stats);
+
 
 /* Functions to set threadpool parameters */
 extern void tp_set_min_threads(uint val);
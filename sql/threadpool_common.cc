@@ -34,6 +34,8 @@ uint threadpool_max_size;
 uint threadpool_stall_limit;
 uint threadpool_max_threads;
 uint threadpool_oversubscribe;
+my_bool threadpool_work_stealing;
+my_bool threadpool_io_uring;
 
 /* Stats */
 TP_STATISTICS tp_stats;
@@ -0,0 +1,119 @@
+/* Copyright (C) 2015 MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+/*
+  INFORMATION_SCHEMA.THREAD_POOL_GROUPS, the state and the statistics of
+  the thread groups of the pool-of-threads scheduler.
+*/
+
+#include <my_global.h>
+#include <sql_class.h>
+#include <sql_parse.h>          // check_global_access
+#include <sql_acl.h>            // PROCESS_ACL
+#include <table.h>              // ST_SCHEMA_TABLE
+#include <sql_show.h>           // schema_table_store_record
+#include <threadpool.h>
+#include <mysql/plugin.h>
+
+#define COLUMN_GROUP_ID 0
+#define COLUMN_CONNECTIONS 1
+#define COLUMN_THREADS 2
+#define COLUMN_ACTIVE_THREADS 3
+#define COLUMN_QUEUE_LENGTH 4
+#define COLUMN_HAS_LISTENER 5
+#define COLUMN_IS_STALLED 6
+#define COLUMN_DEQUEUES 7
+#define COLUMN_QUEUE_WAIT_TIME 8
+#define COLUMN_STEALS 9
+#define COLUMN_STOLEN 10
+
+static ST_FIELD_INFO groups_fields[]=
+{
+  {"GROUP_ID", MY_INT32_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0, 0},
+  {"CONNECTIONS", MY_INT32_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0, 0},
+  {"THREADS", MY_INT32_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0, 0},
+  {"ACTIVE_THREADS", MY_INT32_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0, 0},
+  {"QUEUE_LENGTH", MY_INT32_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0, 0},
+  {"HAS_LISTENER", 1, MYSQL_TYPE_TINY, 0, 0, 0, 0},
+  {"IS_STALLED", 1, MYSQL_TYPE_TINY, 0, 0, 0, 0},
+  {"DEQUEUES", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"QUEUE_WAIT_TIME", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"STEALS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"STOLEN", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, 0}
+};
+
+static int groups_fill_table(THD *thd, TABLE_LIST *tables, COND *cond)
+{
+  TABLE *table= tables->table;
+
+  if (check_global_access(thd, PROCESS_ACL, true))
+    return 0;
+
+#ifndef EMBEDDED_LIBRARY
+  /* The table is empty unless thread_handling is pool-of-threads */
+  for (uint i= 0; i < tp_get_group_count(); i++)
+  {
+    TP_GROUP_STATISTICS stats;
+    tp_get_group_statistics(i, &stats);
+
+    table->field[COLUMN_GROUP_ID]->store(i, 1);
+    table->field[COLUMN_CONNECTIONS]->store(stats.connections, 0);
+    table->field[COLUMN_THREADS]->store(stats.threads, 0);
+    table->field[COLUMN_ACTIVE_THREADS]->store(stats.active_threads, 0);
+    table->field[COLUMN_QUEUE_LENGTH]->store(stats.queue_length, 1);
+    table->field[COLUMN_HAS_LISTENER]->store(stats.has_listener, 1);
+    table->field[COLUMN_IS_STALLED]->store(stats.is_stalled, 1);
+    table->field[COLUMN_DEQUEUES]->store(stats.dequeues, 1);
+    table->field[COLUMN_QUEUE_WAIT_TIME]->store(stats.queue_wait_time, 1);
+    table->field[COLUMN_STEALS]->store(stats.steals, 1);
+    table->field[COLUMN_STOLEN]->store(stats.stolen, 1);
+
+    if (schema_table_store_record(thd, table))
+      return 1;
+  }
+#endif
+  return 0;
+}
+
+static int groups_plugin_init(void *p)
+{
+  ST_SCHEMA_TABLE *schema= (ST_SCHEMA_TABLE *)p;
+
+  schema->fields_info= groups_fields;
+  schema->fill_table= groups_fill_table;
+  return 0;
+}
+
+static struct st_mysql_information_schema thread_pool_info_plugin=
+{ MYSQL_INFORMATION_SCHEMA_INTERFACE_VERSION };
+
+maria_declare_plugin(thread_pool_info)
+{
+  MYSQL_INFORMATION_SCHEMA_PLUGIN,
+  &thread_pool_info_plugin,
+  "THREAD_POOL_GROUPS",
+  "MariaDB Corporation",
+  "Statistics of the thread groups of the thread pool.",
+  PLUGIN_LICENSE_GPL,
+  groups_plugin_init,         /* Plugin Init          */
+  0,                          /* Plugin Deinit        */
+  0x0100,                     /* version, hex         */
+  NULL,                       /* status variables     */
+  NULL,                       /* system variables     */
+  "1.0",                      /* version as a string  */
+  MariaDB_PLUGIN_MATURITY_EXPERIMENTAL
+}
+maria_declare_plugin_end;
@@ -32,6 +32,12 @@
 #ifdef __linux__
 #include <sys/epoll.h>
 typedef struct epoll_event native_event;
+#ifdef HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <poll.h>
+#endif
 #elif defined(HAVE_KQUEUE)
 #include <sys/event.h>
 typedef struct kevent native_event;
@@ -58,10 +64,16 @@ static bool threadpool_started= false;
 #ifdef HAVE_PSI_INTERFACE
 static PSI_mutex_key key_group_mutex;
 static PSI_mutex_key key_timer_mutex;
+#ifdef HAVE_IO_URING
+static PSI_mutex_key key_ring_mutex;
+#endif
 static PSI_mutex_info mutex_list[]=
 {
   { &key_group_mutex, "group_mutex", 0},
-  { &key_timer_mutex, "timer_mutex", PSI_FLAG_GLOBAL}
+  { &key_timer_mutex, "timer_mutex", PSI_FLAG_GLOBAL},
+#ifdef HAVE_IO_URING
+  { &key_ring_mutex, "ring_mutex", 0}
+#endif
 };
 
 static PSI_cond_key key_worker_cond;
@@ -108,14 +120,37 @@ typedef I_P_List<worker_thread_t, I_P_List_adapter<worker_thread_t,
                  >
 worker_list_t;
 
+/**
+  A read from a socket that is done by the poll descriptor, together
+  with the wait for the socket to become readable (io_poll_start_recv()).
+*/
+struct io_recv_t
+{
+  /* Data of the event, returned by native_event_get_userdata() */
+  void *data;
+  char *buf;
+  size_t length;
+  /* Return value of the read, the number of bytes or -errno */
+  ssize_t result;
+};
+
 struct connection_t
 {
 
   THD *thd;
   thread_group_t *thread_group;
+  /*
+    Group of the worker thread that handles the current event. It differs
+    from thread_group if the event was stolen from the queue of the group.
+  */
+  thread_group_t *worker_group;
   connection_t *next_in_queue;
   connection_t **prev_in_queue;
   ulonglong abs_wait_timeout;
+  /* Time when the connection was put into the queue */
+  ulonglong enqueue_time;
+  /* Read of the next request, if the poll descriptor can do the reads */
+  io_recv_t recv;
   bool logged_in;
   bool bound_to_poll_descriptor;
   bool waiting;
@@ -125,7 +160,7 @@ typedef I_P_List<connection_t,
                      I_P_List_adapter<connection_t,
                                       &connection_t::next_in_queue,
                                       &connection_t::prev_in_queue>,
-                     I_P_List_null_counter,
+                     I_P_List_counter,
                      I_P_List_fast_push_back<connection_t> >
 connection_queue_t;
 
@@ -147,6 +182,11 @@ struct thread_group_t
   int  shutdown_pipe[2];
   bool shutdown;
   bool stalled;
+  /* Statistics for INFORMATION_SCHEMA.THREAD_POOL_GROUPS */
+  ulonglong dequeue_count;
+  ulonglong queue_wait_time;
+  ulonglong steal_count;
+  ulonglong stolen_count;
   
 } MY_ALIGNED(512);
 
@@ -184,6 +224,7 @@ static void connection_abort(connection_t *connection);
 static void set_wait_timeout(connection_t *connection);
 static void set_next_timeout_check(ulonglong abstime);
 static void print_pool_blocked_message(bool);
+static void wake_sibling_thread(thread_group_t *thread_group);
 
 /**
  Asynchronous network IO.
@@ -230,6 +271,25 @@ static void print_pool_blocked_message(bool);
 
  
  On Linux: epoll_wait()
+
+ - io_poll_close(int pollfd)
+ Closes an io_poll descriptor
+
+ - io_poll_can_recv(int pollfd)
+ - io_poll_start_recv(int pollfd, int fd, io_recv_t *recv)
+ The same as io_poll_start_read(), but the data is also read from the
+ socket into recv->buf when it becomes readable, and recv->result is set
+ to the result of the read. Saves the read system call in the worker
+ thread. Only available if io_poll_can_recv() is true for the descriptor.
+ On Linux with thread_pool_io_uring: IORING_OP_RECV
+
+ Linux has a second implementation on top of io_uring, that is used if
+ thread_pool_io_uring is set. Descriptors are watched with one-shot
+ IORING_OP_POLL_ADD requests, or read with IORING_OP_RECV requests. The
+ requests are put into the submission queue of the ring of the group,
+ and are submitted together by the next io_poll_wait() on the ring.
+ Only if a thread is blocked in io_poll_wait() on the ring, the thread
+ that adds a request submits it at once.
 */
 
 #if defined (__linux__)
@@ -237,15 +297,351 @@ static void print_pool_blocked_message(bool);
 /* Early 2.6 kernel did not have EPOLLRDHUP */
 #define EPOLLRDHUP 0
 #endif
+#ifdef HAVE_IO_URING
+/* Number of entries in the submission queue of a ring */
+#define IO_URING_ENTRIES 256
+/* Rings are only used for poll descriptors below this number */
+#define IO_URING_MAX_POLLFD 4096
+
+/* Tag in the user data of a request that has an io_recv_t */
+#define IO_URING_RECV_TAG 1
+
+struct io_uring_ring_t
+{
+  int fd;
+  mysql_mutex_t mutex;
+  /* Requests that were queued, but not submitted yet */
+  uint to_submit;
+  /* Number of threads that wait for completions in io_uring_enter() */
+  uint waiters;
+  /* Submission queue */
+  unsigned *sq_head, *sq_tail, *sq_mask, *sq_entries, *sq_flags, *sq_array;
+  struct io_uring_sqe *sqes;
+  /* Completion queue */
+  unsigned *cq_head, *cq_tail, *cq_mask;
+  struct io_uring_cqe *cqes;
+  void *sq_ptr, *cq_ptr;
+  size_t sq_size, cq_size;
+};
+
+/* Rings by poll descriptor, NULL for epoll descriptors */
+static io_uring_ring_t *io_uring_rings[IO_URING_MAX_POLLFD];
+
+
+static int io_uring_enter(int fd, uint to_submit, uint min_complete,
+                          uint flags)
+{
+  int ret;
+  do
+  {
+    ret= (int) syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+                       NULL, 0);
+  }
+  while (ret == -1 && errno == EINTR);
+  return ret;
+}
+
+
+static void io_uring_destroy(io_uring_ring_t *ring)
+{
+  if (ring->sqes)
+    munmap(ring->sqes, *ring->sq_entries * sizeof(struct io_uring_sqe));
+  if (ring->cq_ptr && ring->cq_ptr != ring->sq_ptr)
+    munmap(ring->cq_ptr, ring->cq_size);
+  if (ring->sq_ptr)
+    munmap(ring->sq_ptr, ring->sq_size);
+  close(ring->fd);
+  mysql_mutex_destroy(&ring->mutex);
+  my_free(ring);
+}
+
+
+/**
+  Create an io_uring instance and map its queues.
+
+  @return the descriptor of the ring, or -1 if io_uring cannot be used
+*/
+
+static int io_uring_create()
+{
+  struct io_uring_params params;
+  io_uring_ring_t *ring;
+  int fd;
+
+  bzero(&params, sizeof(params));
+  fd= (int) syscall(__NR_io_uring_setup, IO_URING_ENTRIES, &params);
+  if (fd < 0)
+    return -1;
+  /*
+    Completions must not be lost if the completion queue overflows,
+    there can be a request for every connection of the group.
+  */
+  if (!(params.features & IORING_FEAT_NODROP) ||
+      !(params.features & IORING_FEAT_SINGLE_MMAP) ||
+      fd >= IO_URING_MAX_POLLFD ||
+      !(ring= (io_uring_ring_t *) my_malloc(sizeof(io_uring_ring_t),
+                                            MYF(MY_ZEROFILL))))
+  {
+    close(fd);
+    errno= ENOSYS;
+    return -1;
+  }
+  ring->fd= fd;
+  mysql_mutex_init(key_ring_mutex, &ring->mutex, NULL);
+
+  ring->sq_size= params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->cq_size= params.cq_off.cqes +
+                 params.cq_entries * sizeof(struct io_uring_cqe);
+  ring->sq_size= ring->cq_size= MY_MAX(ring->sq_size, ring->cq_size);
+  ring->sq_ptr= mmap(0, ring->sq_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (ring->sq_ptr == MAP_FAILED)
+  {
+    ring->sq_ptr= NULL;
+    io_uring_destroy(ring);
+    return -1;
+  }
+  ring->cq_ptr= ring->sq_ptr;
+  ring->sqes= (struct io_uring_sqe *)
+    mmap(0, params.sq_entries * sizeof(struct io_uring_sqe),
+         PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+         IORING_OFF_SQES);
+  if (ring->sqes == MAP_FAILED)
+  {
+    ring->sqes= NULL;
+    io_uring_destroy(ring);
+    return -1;
+  }
+
+  char *sq= (char *) ring->sq_ptr;
+  ring->sq_head= (unsigned *) (sq + params.sq_off.head);
+  ring->sq_tail= (unsigned *) (sq + params.sq_off.tail);
+  ring->sq_mask= (unsigned *) (sq + params.sq_off.ring_mask);
+  ring->sq_entries= (unsigned *) (sq + params.sq_off.ring_entries);
+  ring->sq_flags= (unsigned *) (sq + params.sq_off.flags);
+  ring->sq_array= (unsigned *) (sq + params.sq_off.array);
+  char *cq= (char *) ring->cq_ptr;
+  ring->cq_head= (unsigned *) (cq + params.cq_off.head);
+  ring->cq_tail= (unsigned *) (cq + params.cq_off.tail);
+  ring->cq_mask= (unsigned *) (cq + params.cq_off.ring_mask);
+  ring->cqes= (struct io_uring_cqe *) (cq + params.cq_off.cqes);
+
+  io_uring_rings[fd]= ring;
+  return fd;
+}
+
+
+static io_uring_ring_t *io_uring_get(int pollfd)
+{
+  return pollfd >= 0 && pollfd < IO_URING_MAX_POLLFD ?
+         io_uring_rings[pollfd] : NULL;
+}
+
+
+/**
+  Queue a request on the ring.
+
+  The request is submitted by the next io_uring_wait() on the ring, or at
+  once if a thread is blocked in io_uring_wait() on the ring.
+*/
+
+static int io_uring_queue(io_uring_ring_t *ring, uint8 opcode, int fd,
+                          void *buf, size_t length, ulonglong user_data)
+{
+  uint submit= 0;
+  mysql_mutex_lock(&ring->mutex);
+
+  unsigned tail= *ring->sq_tail;
+  if (tail - my_atomic_load32_explicit(ring->sq_head, MY_MEMORY_ORDER_ACQUIRE)
+      == *ring->sq_entries)
+  {
+    /* The submission queue is full, submit the queued requests now */
+    if (io_uring_enter(ring->fd, ring->to_submit, 0, 0) < 0)
+    {
+      mysql_mutex_unlock(&ring->mutex);
+      return -1;
+    }
+    ring->to_submit= 0;
+  }
+
+  unsigned index= tail & *ring->sq_mask;
+  struct io_uring_sqe *sqe= &ring->sqes[index];
+  bzero(sqe, sizeof(*sqe));
+  sqe->opcode= opcode;
+  sqe->fd= fd;
+  if (opcode == IORING_OP_POLL_ADD)
+  {
+    uint32 events= POLLIN | POLLERR | POLLRDHUP;
+#ifdef WORDS_BIGENDIAN
+    /* The kernel expects the halfwords swapped on big-endian */
+    events= (events << 16) | (events >> 16);
+#endif
+    sqe->poll32_events= events;
+  }
+  else
+  {
+    sqe->addr= (ulonglong) (size_t) buf;
+    sqe->len= (uint) length;
+  }
+  sqe->user_data= user_data;
+  ring->sq_array[index]= index;
+  my_atomic_store32_explicit(ring->sq_tail, tail + 1,
+                             MY_MEMORY_ORDER_RELEASE);
+  ring->to_submit++;
+
+  if (ring->waiters)
+  {
+    submit= ring->to_submit;
+    ring->to_submit= 0;
+  }
+  mysql_mutex_unlock(&ring->mutex);
+
+  if (submit && io_uring_enter(ring->fd, submit, 0, 0) < 0)
+    return -1;
+  return 0;
+}
+
+
+/**
+  Move completions from the completion queue of the ring to native events.
+  Must be called with the mutex of the ring.
+*/
+
+static int io_uring_reap(io_uring_ring_t *ring, native_event *events,
+                         int maxevents)
+{
+  unsigned head= *ring->cq_head;
+  unsigned tail= my_atomic_load32_explicit(ring->cq_tail,
+                                           MY_MEMORY_ORDER_ACQUIRE);
+  int count= 0;
+
+  for (; head != tail && count < maxevents; head++)
+  {
+    struct io_uring_cqe *cqe= &ring->cqes[head & *ring->cq_mask];
+    ulonglong user_data= cqe->user_data;
+    void *data;
+
+    if (cqe->res == -ECANCELED)
+      continue;
+    if (user_data & IO_URING_RECV_TAG)
+    {
+      io_recv_t *recv= (io_recv_t *) (size_t) (user_data & ~IO_URING_RECV_TAG);
+      recv->result= cqe->res;
+      data= recv->data;
+    }
+    else
+      data= (void *) (size_t) user_data;
+
+    events[count].data.u64= 0;
+    events[count].data.ptr= data;
+    events[count].events= EPOLLIN;
+    count++;
+  }
+  my_atomic_store32_explicit(ring->cq_head, head, MY_MEMORY_ORDER_RELEASE);
+  return count;
+}
+
+
+/**
+  Submit the queued requests and get completions.
+
+  Only a timeout of 0 (do not wait) or -1 (wait for a completion) is
+  supported.
+*/
+
+static int io_uring_wait(io_uring_ring_t *ring, native_event *events,
+                         int maxevents, int timeout_ms)
+{
+  DBUG_ASSERT(timeout_ms == 0 || timeout_ms == -1);
+  for (;;)
+  {
+    mysql_mutex_lock(&ring->mutex);
+    int count= io_uring_reap(ring, events, maxevents);
+    bool overflow= (my_atomic_load32_explicit(ring->sq_flags,
+                                              MY_MEMORY_ORDER_RELAXED) &
+                    IORING_SQ_CQ_OVERFLOW);
+    if (count || (!timeout_ms && !ring->to_submit && !overflow))
+    {
+      mysql_mutex_unlock(&ring->mutex);
+      return count;
+    }
+    uint to_submit= ring->to_submit;
+    ring->to_submit= 0;
+    if (timeout_ms)
+      ring->waiters++;
+    mysql_mutex_unlock(&ring->mutex);
+
+    /*
+      Submit the queued requests. An overflown completion queue is flushed
+      with IORING_ENTER_GETEVENTS.
+    */
+    int ret= io_uring_enter(ring->fd, to_submit, timeout_ms ? 1 : 0,
+                            (timeout_ms || overflow) ?
+                            IORING_ENTER_GETEVENTS : 0);
+    if (timeout_ms)
+    {
+      mysql_mutex_lock(&ring->mutex);
+      ring->waiters--;
+      mysql_mutex_unlock(&ring->mutex);
+    }
+    if (ret < 0)
+      return -1;
+    if (!timeout_ms)
+    {
+      mysql_mutex_lock(&ring->mutex);
+      count= io_uring_reap(ring, events, maxevents);
+      mysql_mutex_unlock(&ring->mutex);
+      return count;
+    }
+  }
+}
+#endif /* HAVE_IO_URING */
+
+
 static int io_poll_create()
 {
+#ifdef HAVE_IO_URING
+  static bool warning_printed= false;
+  if (threadpool_io_uring)
+  {
+    int fd= io_uring_create();
+    if (fd >= 0)
+      return fd;
+    if (!warning_printed)
+    {
+      warning_printed= true;
+      sql_print_warning("Thread pool can not use io_uring (errno=%d), "
+                        "using epoll", errno);
+    }
+  }
+#endif
   return epoll_create(1);
 }
 
 
+static int io_poll_close(int pollfd)
+{
+#ifdef HAVE_IO_URING
+  if (io_uring_ring_t *ring= io_uring_get(pollfd))
+  {
+    io_uring_rings[pollfd]= NULL;
+    io_uring_destroy(ring);
+    return 0;
+  }
+#endif
+  return close(pollfd);
+}
+
+
 int io_poll_associate_fd(int pollfd, int fd, void *data)
 {
   struct epoll_event ev;
+#ifdef HAVE_IO_URING
+  /* A ring has no set of descriptors, every read is a new request */
+  if (io_uring_ring_t *ring= io_uring_get(pollfd))
+    return io_uring_queue(ring, IORING_OP_POLL_ADD, fd, NULL, 0,
+                          (ulonglong) (size_t) data);
+#endif
   ev.data.u64= 0; /* Keep valgrind happy */
   ev.data.ptr= data;
   ev.events=  EPOLLIN|EPOLLET|EPOLLERR|EPOLLRDHUP|EPOLLONESHOT;
@@ -257,6 +653,11 @@ int io_poll_associate_fd(int pollfd, int fd, void *data)
 int io_poll_start_read(int pollfd, int fd, void *data)
 {
   struct epoll_event ev;
+#ifdef HAVE_IO_URING
+  if (io_uring_ring_t *ring= io_uring_get(pollfd))
+    return io_uring_queue(ring, IORING_OP_POLL_ADD, fd, NULL, 0,
+                          (ulonglong) (size_t) data);
+#endif
   ev.data.u64= 0; /* Keep valgrind happy */
   ev.data.ptr= data;
   ev.events=  EPOLLIN|EPOLLET|EPOLLERR|EPOLLRDHUP|EPOLLONESHOT;
@@ -266,10 +667,19 @@ int io_poll_start_read(int pollfd, int fd, void *data)
 int io_poll_disassociate_fd(int pollfd, int fd)
 {
   struct epoll_event ev;
+#ifdef HAVE_IO_URING
+  /*
+    Nothing to do for a ring, the descriptor is only known to it while
+    a one-shot request is pending, and it is never disassociated then.
+  */
+  if (io_uring_get(pollfd))
+    return 0;
+#endif
   return epoll_ctl(pollfd, EPOLL_CTL_DEL,  fd, &ev);
 }
 
 
+
 /*
  Wrapper around epoll_wait.
  NOTE - in case of EINTR, it restarts with original timeout. Since we use
@@ -279,6 +689,10 @@ int io_poll_wait(int pollfd, native_event *native_events, int maxevents,
               int timeout_ms)
 {
   int ret;
+#ifdef HAVE_IO_URING
+  if (io_uring_ring_t *ring= io_uring_get(pollfd))
+    return io_uring_wait(ring, native_events, maxevents, timeout_ms);
+#endif
   do 
   {
     ret = epoll_wait(pollfd, native_events, maxevents, timeout_ms);
@@ -313,6 +727,11 @@ int io_poll_create()
   return kqueue();
 }
 
+static int io_poll_close(int pollfd)
+{
+  return close(pollfd);
+}
+
 int io_poll_start_read(int pollfd, int fd, void *data)
 {
   struct kevent ke;
@@ -369,6 +788,11 @@ static int io_poll_create()
   return port_create();
 }
 
+static int io_poll_close(int pollfd)
+{
+  return close(pollfd);
+}
+
 int io_poll_start_read(int pollfd, int fd, void *data)
 {
   return port_associate(pollfd, PORT_SOURCE_FD, fd, POLLIN, data);
@@ -411,6 +835,32 @@ static void* native_event_get_userdata(native_event *event)
 #endif
 
 
+static bool io_poll_can_recv(int pollfd)
+{
+#ifdef HAVE_IO_URING
+  return io_uring_get(pollfd) != NULL;
+#else
+  return false;
+#endif
+}
+
+
+static int io_poll_start_recv(int pollfd, int fd, io_recv_t *recv)
+{
+#ifdef HAVE_IO_URING
+  if (io_uring_ring_t *ring= io_uring_get(pollfd))
+  {
+    DBUG_ASSERT(!((size_t) recv & IO_URING_RECV_TAG));
+    recv->result= 0;
+    return io_uring_queue(ring, IORING_OP_RECV, fd, recv->buf, recv->length,
+                          (ulonglong) (size_t) recv | IO_URING_RECV_TAG);
+  }
+#endif
+  DBUG_ASSERT(0);
+  return -1;
+}
+
+
 /* Dequeue element from a workqueue */
 
 static connection_t *queue_get(thread_group_t *thread_group)
@@ -421,11 +871,55 @@ static connection_t *queue_get(thread_group_t *thread_group)
   if (c)
   {
     thread_group->queue.remove(c);
+    thread_group->dequeue_count++;
+    ulonglong now= microsecond_interval_timer();
+    if (now > c->enqueue_time)
+      thread_group->queue_wait_time+= now - c->enqueue_time;
   }
   DBUG_RETURN(c);  
 }
 
 
+/**
+  Take an event from the queue of another group
+
+  Called by a worker of an idle group before it goes to sleep. The groups
+  are visited from the next one on, and a group whose mutex is taken is
+  skipped rather than waited for, the worker will sleep instead.
+
+  @param thread_group - the group of the worker, its mutex is not held
+
+  @return connection with pending event, or NULL
+*/
+
+static connection_t *steal_event(thread_group_t *thread_group)
+{
+  DBUG_ENTER("steal_event");
+  uint count= group_count;
+  uint own= (uint) (thread_group - all_groups);
+
+  for (uint i= 1; i < count; i++)
+  {
+    thread_group_t *group= &all_groups[(own + i) % count];
+    /* Read without the mutex, it is only a hint */
+    if (group->queue.is_empty())
+      continue;
+    if (mysql_mutex_trylock(&group->mutex))
+      continue;
+    connection_t *connection= NULL;
+    if (!group->shutdown && !group->queue.is_empty())
+    {
+      connection= queue_get(group);
+      group->stolen_count++;
+    }
+    mysql_mutex_unlock(&group->mutex);
+    if (connection)
+      DBUG_RETURN(connection);
+  }
+  DBUG_RETURN(NULL);
+}
+
+
 /* 
   Handle wait timeout : 
   Find connections that have been idle for too long and kill them.
@@ -436,8 +930,7 @@ static void timeout_check(pool_timer_t *timer)
 {
   DBUG_ENTER("timeout_check");
   
-  mysql_mutex_lock(&LOCK_thread_count);
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
 
   /* Reset next timeout check, it will be recalculated in the loop below */
   my_atomic_fas64((volatile int64*)&timer->next_timeout_check, ULONGLONG_MAX);
@@ -471,7 +964,6 @@ static void timeout_check(pool_timer_t *timer)
       set_next_timeout_check(connection->abs_wait_timeout);
     }
   }
-  mysql_mutex_unlock(&LOCK_thread_count);
   DBUG_VOID_RETURN;
 }
 
@@ -710,15 +1202,19 @@ static connection_t * listener(worker_thread_t *current_thread,
     */
     
     bool listener_picks_event= thread_group->queue.is_empty();
+    DBUG_EXECUTE_IF("threadpool_queue_all_events",
+                    listener_picks_event= false;);
     
     /* 
       If listener_picks_event is set, listener thread will handle first event, 
       and put the rest into the queue. If listener_pick_event is not set, all 
       events go to the queue.
     */
+    ulonglong now= microsecond_interval_timer();
     for(int i=(listener_picks_event)?1:0; i < cnt ; i++)
     {
       connection_t *c= (connection_t *)native_event_get_userdata(&ev[i]);
+      c->enqueue_time= now;
       thread_group->queue.push_back(c);
     }
     
@@ -755,6 +1251,14 @@ static connection_t * listener(worker_thread_t *current_thread,
         }
       }
     }
+    else if (threadpool_work_stealing)
+    {
+      /*
+        The active threads of the group are busy with other connections,
+        let an idle worker of another group take the queued events.
+      */
+      wake_sibling_thread(thread_group);
+    }
     mysql_mutex_unlock(&thread_group->mutex);
   }
 
@@ -918,10 +1422,9 @@ int thread_group_init(thread_group_t *thread_group, pthread_attr_t* thread_attr)
 
 void thread_group_destroy(thread_group_t *thread_group)
 {
-  mysql_mutex_destroy(&thread_group->mutex);
   if (thread_group->pollfd != -1)
   {
-    close(thread_group->pollfd);
+    io_poll_close(thread_group->pollfd);
     thread_group->pollfd= -1;
   }
   for(int i=0; i < 2; i++)
@@ -933,7 +1436,15 @@ void thread_group_destroy(thread_group_t *thread_group)
     }
   }
   if (my_atomic_add32(&shutdown_group_count, -1) == 1)
+  {
+    /*
+      The mutex of a group is used by the workers of the other groups
+      (see steal_event()), so it is destroyed after the last group.
+    */
+    for (uint i= 0; i < threadpool_max_size; i++)
+      mysql_mutex_destroy(&all_groups[i].mutex);
     my_free(all_groups);
+  }
 }
 
 /**
@@ -955,6 +1466,39 @@ static int wake_thread(thread_group_t *thread_group)
 }
 
 
+/**
+  Wake or create a worker in another group, so that it steals queued
+  events of this group (see steal_event()).
+
+  Only a group that has no active threads is asked, so that the number
+  of active threads in the pool stays about the number of groups. The
+  mutexes of the other groups are only tried, not waited for.
+
+  @param thread_group - the group with queued events, its mutex is held
+*/
+
+static void wake_sibling_thread(thread_group_t *thread_group)
+{
+  uint count= group_count;
+  uint own= (uint) (thread_group - all_groups);
+
+  for (uint i= 1; i < count; i++)
+  {
+    thread_group_t *group= &all_groups[(own + i) % count];
+    /* Read without the mutex, it is only a hint */
+    if (group->active_thread_count || !group->connection_count)
+      continue;
+    if (mysql_mutex_trylock(&group->mutex))
+      continue;
+    bool woken= (!group->shutdown && !group->active_thread_count &&
+                 !wake_or_create_thread(group));
+    mysql_mutex_unlock(&group->mutex);
+    if (woken)
+      return;
+  }
+}
+
+
 /**
   Initiate shutdown for thread group.
 
@@ -1017,6 +1561,7 @@ static void queue_put(thread_group_t *thread_group, connection_t *connection)
   DBUG_ENTER("queue_put");
 
   mysql_mutex_lock(&thread_group->mutex);
+  connection->enqueue_time= microsecond_interval_timer();
   thread_group->queue.push_back(connection);
 
   if (thread_group->active_thread_count == 0)
@@ -1064,6 +1609,7 @@ connection_t *get_event(worker_thread_t *current_thread,
   DBUG_ENTER("get_event");
   connection_t *connection = NULL;
   int err=0;
+  bool steal_tried= false;
 
   mysql_mutex_lock(&thread_group->mutex);
   DBUG_ASSERT(thread_group->active_thread_count >= 0);
@@ -1113,6 +1659,26 @@ connection_t *get_event(worker_thread_t *current_thread,
       }
     }
 
+    /*
+      The group has nothing to do. Before sleeping, take an event that
+      waits in the queue of another group. The own queue is checked once
+      more afterwards, as events may have been queued meanwhile.
+    */
+    if (!oversubscribed && threadpool_work_stealing && !steal_tried &&
+        group_count > 1)
+    {
+      steal_tried= true;
+      mysql_mutex_unlock(&thread_group->mutex);
+      connection= steal_event(thread_group);
+      mysql_mutex_lock(&thread_group->mutex);
+      if (connection)
+      {
+        thread_group->steal_count++;
+        break;
+      }
+      continue;
+    }
+
     /* And now, finally sleep */ 
     current_thread->woken = false; /* wake() sets this to true */
 
@@ -1134,6 +1700,7 @@ connection_t *get_event(worker_thread_t *current_thread,
       err = mysql_cond_wait(&current_thread->cond, &thread_group->mutex);
     }
     thread_group->active_thread_count++;
+    steal_tried= false;
     
     if (!current_thread->woken)
     {
@@ -1169,7 +1736,6 @@ void wait_begin(thread_group_t *thread_group)
   thread_group->active_thread_count--;
   
   DBUG_ASSERT(thread_group->active_thread_count >=0);
-  DBUG_ASSERT(thread_group->connection_count > 0);
  
   if ((thread_group->active_thread_count == 0) && 
      (thread_group->queue.is_empty() || !thread_group->listener))
@@ -1211,10 +1777,15 @@ connection_t *alloc_connection(THD *thd)
   if (connection)
   {
     connection->thd = thd;
+    connection->worker_group= NULL;
     connection->waiting= false;
     connection->logged_in= false;
     connection->bound_to_poll_descriptor= false;
     connection->abs_wait_timeout= ULONGLONG_MAX;
+    connection->recv.data= connection;
+    connection->recv.buf= NULL;
+    connection->recv.length= 0;
+    connection->recv.result= 0;
   }
   DBUG_RETURN(connection);
 }
@@ -1229,8 +1800,7 @@ void tp_add_connection(THD *thd)
 {
   DBUG_ENTER("tp_add_connection");
   
-  threads.append(thd);
-  mysql_mutex_unlock(&LOCK_thread_count);
+  server_threads.insert(thd);
   connection_t *connection= alloc_connection(thd);
   if (connection)
   {
@@ -1294,7 +1864,7 @@ void tp_wait_begin(THD *thd, int type)
   {
     DBUG_ASSERT(!connection->waiting);
     connection->waiting= true;
-    wait_begin(connection->thread_group);
+    wait_begin(connection->worker_group);
   }
   DBUG_VOID_RETURN;
 }
@@ -1314,7 +1884,7 @@ void tp_wait_end(THD *thd)
   {
     DBUG_ASSERT(connection->waiting);
     connection->waiting = false;
-    wait_end(connection->thread_group);
+    wait_end(connection->worker_group);
   }
   DBUG_VOID_RETURN;
 }
@@ -1397,7 +1967,8 @@ static int change_group(connection_t *c,
 
 static int start_io(connection_t *connection)
 { 
-  int fd = mysql_socket_getfd(connection->thd->net.vio->mysql_socket);
+  Vio *vio= connection->thd->net.vio;
+  int fd = mysql_socket_getfd(vio->mysql_socket);
 
   /*
     Usually, connection will stay in the same group for the entire
@@ -1424,9 +1995,28 @@ static int start_io(connection_t *connection)
   if (!connection->bound_to_poll_descriptor)
   {
     connection->bound_to_poll_descriptor= true;
-    return io_poll_associate_fd(group->pollfd, fd, connection);
+    if (!io_poll_can_recv(group->pollfd))
+      return io_poll_associate_fd(group->pollfd, fd, connection);
   }
-  
+
+  /*
+    If the poll descriptor can read, the next request is read into the
+    read buffer of the Vio object. Not for SSL, it has its own buffering.
+  */
+  if (io_poll_can_recv(group->pollfd))
+  {
+    if (!connection->recv.buf && !vio_buff_enable(vio))
+    {
+      connection->recv.buf= vio->read_buffer;
+      connection->recv.length= VIO_READ_BUFFER_SIZE;
+    }
+    if (connection->recv.buf)
+    {
+      DBUG_ASSERT(!vio->has_data(vio));
+      return io_poll_start_recv(group->pollfd, fd, &connection->recv);
+    }
+  }
+
   return io_poll_start_read(group->pollfd, fd, connection);
 }
 
@@ -1445,6 +2035,12 @@ static void handle_event(connection_t *connection)
   }
   else 
   {
+    /* Pass the data that the poll descriptor has read to the Vio object */
+    if (connection->recv.result > 0)
+    {
+      vio_buff_fill(connection->thd->net.vio, connection->recv.result);
+      connection->recv.result= 0;
+    }
     err= threadpool_process_request(connection->thd);
   }
 
@@ -1493,6 +2089,8 @@ static void *worker_main(void *param)
     if (!connection)
       break;
     this_thread.event_count++;
+    /* The waits of the connection are accounted to the group of the worker */
+    connection->worker_group= thread_group;
     handle_event(connection);
   }
 
@@ -1628,6 +2226,41 @@ int tp_get_idle_thread_count()
 }
 
 
+/**
+  Number of thread groups in use, for INFORMATION_SCHEMA.THREAD_POOL_GROUPS
+*/
+
+uint tp_get_group_count()
+{
+  return threadpool_started ? group_count : 0;
+}
+
+
+/**
+  Get the statistics of a thread group.
+
+  The counters are read under the mutex of the group, so that they are
+  consistent with each other.
+*/
+
+void tp_get_group_statistics(uint i, TP_GROUP_STATISTICS *stats)
+{
+  thread_group_t *group= &all_groups[i];
+  mysql_mutex_lock(&group->mutex);
+  stats->connections= group->connection_count;
+  stats->threads= group->thread_count;
+  stats->active_threads= group->active_thread_count;
+  stats->queue_length= group->queue.elements();
+  stats->has_listener= group->listener != NULL;
+  stats->is_stalled= group->stalled;
+  stats->dequeues= group->dequeue_count;
+  stats->queue_wait_time= group->queue_wait_time;
+  stats->steals= group->steal_count;
+  stats->stolen= group->stolen_count;
+  mysql_mutex_unlock(&group->mutex);
+}
+
+
 /* Report threadpool problems */
 
 /** 
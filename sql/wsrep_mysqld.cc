@@ -1751,8 +1751,8 @@ pthread_handler_t start_wsrep_THD(void *arg)
     goto error;
   }
 
+  thd->thread_id= next_thread_id();
   mysql_mutex_lock(&LOCK_thread_count);
-  thd->thread_id=thread_id++;
 
   if (wsrep_gtid_mode)
   {
@@ -1763,7 +1763,7 @@ pthread_handler_t start_wsrep_THD(void *arg)
   thd->real_id=pthread_self(); // Keep purify happy
   thread_count++;
   thread_created++;
-  threads.append(thd);
+  server_threads.insert(thd);
 
   my_net_init(&thd->net,(st_vio*) 0, thd, MYF(0));
 
@@ -1866,6 +1866,7 @@ pthread_handler_t start_wsrep_THD(void *arg)
   my_thread_end();
   if (thread_handling > SCHEDULER_ONE_THREAD_PER_CONNECTION)
   {
+    server_threads.erase(thd);
     mysql_mutex_lock(&LOCK_thread_count);
     delete thd;
     thread_count--;
@@ -1934,7 +1935,7 @@ static bool have_client_connections()
 {
   THD *tmp;
 
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
   while ((tmp=it++))
   {
     DBUG_PRINT("quit",("Informing thread %ld that it's time to die",
@@ -1970,9 +1971,8 @@ static void wsrep_close_thread(THD *thd)
 static my_bool have_committing_connections()
 {
   THD *tmp;
-  mysql_mutex_lock(&LOCK_thread_count); // For unlink from list
 
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
   while ((tmp=it++))
   {
     if (!is_client_connection(tmp))
@@ -1983,7 +1983,6 @@ static my_bool have_committing_connections()
       return TRUE;
     }
   }
-  mysql_mutex_unlock(&LOCK_thread_count);
   return FALSE;
 }
 
@@ -2018,8 +2017,9 @@ void wsrep_close_client_connections(my_bool wait_to_end)
   bool kill_cached_threads_saved= kill_cached_threads;
   kill_cached_threads= true; // prevent future threads caching
   mysql_cond_broadcast(&COND_thread_cache); // tell cached threads to die
+  mysql_mutex_unlock(&LOCK_thread_count);
 
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
   while ((tmp=it++))
   {
     DBUG_PRINT("quit",("Informing thread %ld that it's time to die",
@@ -2041,17 +2041,16 @@ void wsrep_close_client_connections(my_bool wait_to_end)
     WSREP_DEBUG("closing connection %ld", tmp->thread_id);
     wsrep_close_thread(tmp);
   }
-  mysql_mutex_unlock(&LOCK_thread_count);
+  it.release();
 
   if (thread_count)
     sleep(2);                               // Give threads time to die
 
-  mysql_mutex_lock(&LOCK_thread_count);
   /*
     Force remaining threads to die by closing the connection to the client
   */
 
-  I_List_iterator<THD> it2(threads);
+  THD_list_iterator it2(server_threads);
   while ((tmp=it2++))
   {
 #ifndef __bsdi__				// Bug in BSDI kernel
@@ -2064,10 +2063,13 @@ void wsrep_close_client_connections(my_bool wait_to_end)
     }
 #endif
   }
+  it2.release();
 
   DBUG_PRINT("quit",("Waiting for threads to die (count=%u)",thread_count));
   WSREP_DEBUG("waiting for client connections to close: %u", thread_count);
 
+  mysql_mutex_lock(&LOCK_thread_count);
+
   while (wait_to_end && have_client_connections())
   {
     mysql_cond_wait(&COND_thread_count, &LOCK_thread_count);
@@ -2092,9 +2094,8 @@ void wsrep_close_applier(THD *thd)
 void wsrep_close_threads(THD *thd)
 {
   THD *tmp;
-  mysql_mutex_lock(&LOCK_thread_count); // For unlink from list
 
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
   while ((tmp=it++))
   {
     DBUG_PRINT("quit",("Informing thread %ld that it's time to die",
@@ -2106,8 +2107,6 @@ void wsrep_close_threads(THD *thd)
       wsrep_close_thread (tmp);
     }
   }
-
-  mysql_mutex_unlock(&LOCK_thread_count);
 }
 
 void wsrep_wait_appliers_close(THD *thd)
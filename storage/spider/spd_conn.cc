@@ -39,6 +39,19 @@
 
 extern ulong *spd_db_att_thread_id;
 
+/*
+  The server takes thread ids with an atomic increment, LOCK_thread_count
+  is only held for the servers that do not.
+*/
+static ulong spider_next_thread_id()
+{
+#if SIZEOF_LONG == 4
+  return (ulong) my_atomic_add32((int32 *) spd_db_att_thread_id, 1);
+#else
+  return (ulong) my_atomic_add64((int64 *) spd_db_att_thread_id, 1);
+#endif
+}
+
 extern handlerton *spider_hton_ptr;
 extern SPIDER_DBTON spider_dbton[SPIDER_DBTON_SIZE];
 pthread_mutex_t spider_conn_id_mutex;
@@ -2239,7 +2252,7 @@ void *spider_bg_conn_action(
     DBUG_RETURN(NULL);
   }
   pthread_mutex_lock(&LOCK_thread_count);
-  thd->thread_id = (*spd_db_att_thread_id)++;
+  thd->thread_id = spider_next_thread_id();
   pthread_mutex_unlock(&LOCK_thread_count);
 #ifdef HAVE_PSI_INTERFACE
   mysql_thread_set_psi_id(thd->thread_id);
@@ -2751,7 +2764,7 @@ void *spider_bg_sts_action(
     DBUG_RETURN(NULL);
   }
   pthread_mutex_lock(&LOCK_thread_count);
-  thd->thread_id = (*spd_db_att_thread_id)++;
+  thd->thread_id = spider_next_thread_id();
   pthread_mutex_unlock(&LOCK_thread_count);
 #ifdef HAVE_PSI_INTERFACE
   mysql_thread_set_psi_id(thd->thread_id);
@@ -3139,7 +3152,7 @@ void *spider_bg_crd_action(
     DBUG_RETURN(NULL);
   }
   pthread_mutex_lock(&LOCK_thread_count);
-  thd->thread_id = (*spd_db_att_thread_id)++;
+  thd->thread_id = spider_next_thread_id();
   pthread_mutex_unlock(&LOCK_thread_count);
 #ifdef HAVE_PSI_INTERFACE
   mysql_thread_set_psi_id(thd->thread_id);
@@ -3634,7 +3647,7 @@ void *spider_bg_mon_action(
     DBUG_RETURN(NULL);
   }
   pthread_mutex_lock(&LOCK_thread_count);
-  thd->thread_id = (*spd_db_att_thread_id)++;
+  thd->thread_id = spider_next_thread_id();
   pthread_mutex_unlock(&LOCK_thread_count);
 #ifdef HAVE_PSI_INTERFACE
   mysql_thread_set_psi_id(thd->thread_id);
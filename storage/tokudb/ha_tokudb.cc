@@ -174,8 +174,7 @@ static inline uint32_t get_len_of_offsets(KEY_AND_COL_INFO* kc_info, TABLE_SHARE
 
 #ifdef NOT_USED
 static int get_thread_query_string(my_thread_id id, String &qs) {
-  mysql_mutex_lock(&LOCK_thread_count);
-  I_List_iterator<THD> it(threads);
+  THD_list_iterator it(server_threads);
   THD* tmp;
   while ((tmp= it++))
   {
@@ -194,7 +193,6 @@ static int get_thread_query_string(my_thread_id id, String &qs) {
       break;
     }
   }
-  mysql_mutex_unlock(&LOCK_thread_count);
   return 0;
 }
 #endif
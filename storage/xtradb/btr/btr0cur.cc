@@ -903,7 +903,7 @@ btr_cur_search_to_nth_level(
 
 	if (has_search_latch) {
 
-		rw_lock_s_lock(btr_search_get_latch(cursor->index));
+		btr_search_s_lock(cursor->index);
 	}
 
 	return err;
@@ -2247,7 +2247,7 @@ btr_cur_update_in_place(
 			btr_search_update_hash_on_delete(cursor);
 		}
 
-		rw_lock_x_lock(btr_search_get_latch(cursor->index));
+		btr_search_x_lock(cursor->index);
 	}
 
 	row_upd_rec_in_place(rec, index, offsets, update, page_zip);
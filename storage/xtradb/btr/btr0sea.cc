@@ -81,6 +81,9 @@ UNIV_INTERN byte		btr_sea_pad2[64];
 /** The adaptive hash index */
 UNIV_INTERN btr_search_sys_t*	btr_search_sys;
 
+/** Statistics of the adaptive hash index partitions */
+UNIV_INTERN btr_search_part_stats_t*	btr_search_part_stats;
+
 #ifdef UNIV_PFS_RWLOCK
 /* Key to register btr_search_sys with performance schema */
 UNIV_INTERN mysql_pfs_key_t	btr_search_latch_key;
@@ -147,7 +150,7 @@ btr_search_check_free_space_in_heap(
 	if (heap->free_block == NULL) {
 		buf_block_t*	block = buf_block_alloc(NULL);
 
-		rw_lock_x_lock(btr_search_get_latch(index));
+		btr_search_x_lock(index);
 
 		if (heap->free_block == NULL) {
 			heap->free_block = block;
@@ -193,6 +196,10 @@ btr_search_sys_create(
 	btr_search_sys->hash_tables = (hash_table_t **)
 		mem_alloc(sizeof(hash_table_t *) * btr_search_index_num);
 
+	btr_search_part_stats = static_cast<btr_search_part_stats_t*>(
+		mem_zalloc(sizeof(btr_search_part_stats_t)
+			   * btr_search_index_num));
+
 	for (i = 0; i < btr_search_index_num; i++) {
 
 		rw_lock_create(btr_search_latch_key,
@@ -205,6 +212,21 @@ btr_search_sys_create(
 		btr_search_sys->hash_tables[i]->adaptive = TRUE;
 #endif /* UNIV_AHI_DEBUG || UNIV_DEBUG */
 	}
+
+	/* Hide the INFORMATION_SCHEMA.INNODB_METRICS counters of the
+	partitions that are not in use */
+	ut_a(btr_search_index_num <= MONITOR_AHI_N_PARTITIONS);
+
+	for (i = MONITOR_OVLD_AHI_PARTITION_FIRST
+		     + btr_search_index_num * MONITOR_AHI_PARTITION_N_COUNTERS;
+	     i <= MONITOR_OVLD_AHI_PARTITION_LAST; i++) {
+
+		monitor_info_t*	monitor_info
+			= srv_mon_get_info(static_cast<monitor_id_t>(i));
+
+		monitor_info->monitor_type = static_cast<monitor_type_t>(
+			monitor_info->monitor_type | MONITOR_HIDDEN);
+	}
 }
 
 /*****************************************************************//**
@@ -231,6 +253,9 @@ btr_search_sys_free(void)
 
 	mem_free(btr_search_sys->hash_tables);
 
+	mem_free(btr_search_part_stats);
+	btr_search_part_stats = NULL;
+
 	mem_free(btr_search_sys);
 	btr_search_sys = NULL;
 }
@@ -376,7 +401,7 @@ btr_search_info_get_ref_count(
 	ut_ad(!rw_lock_own(btr_search_get_latch(index), RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
-	rw_lock_s_lock(btr_search_get_latch(index));
+	btr_search_s_lock(index);
 	ret = info->ref_count;
 	rw_lock_s_unlock(btr_search_get_latch(index));
 
@@ -702,7 +727,7 @@ btr_search_info_update_slow(
 		btr_search_n_hash_fail++;
 #endif /* UNIV_SEARCH_PERF_STAT */
 
-		rw_lock_x_lock(btr_search_get_latch(cursor->index));
+		btr_search_x_lock(cursor->index);
 
 		btr_search_update_hash_ref(info, block, cursor);
 
@@ -951,7 +976,7 @@ btr_search_guess_on_hash(
 	cursor->flag = BTR_CUR_HASH;
 
 	if (UNIV_LIKELY(!has_search_latch)) {
-		rw_lock_s_lock(btr_search_get_latch(index));
+		btr_search_s_lock(index);
 
 		if (UNIV_UNLIKELY(!btr_search_enabled)) {
 			goto failure_unlock;
@@ -1057,6 +1082,7 @@ btr_search_guess_on_hash(
 	meanwhile! Thus it might not be a bug. */
 #endif
 	info->last_hash_succ = TRUE;
+	btr_search_get_part_stats(index)->n_hits++;
 
 #ifdef UNIV_SEARCH_PERF_STAT
 	btr_search_n_succ++;
@@ -1081,6 +1107,7 @@ btr_search_guess_on_hash(
 	}
 failure:
 	cursor->flag = BTR_CUR_HASH_FAIL;
+	btr_search_get_part_stats(index)->n_misses++;
 
 #ifdef UNIV_SEARCH_PERF_STAT
 	info->n_hash_fail++;
@@ -1141,7 +1168,7 @@ btr_search_drop_page_hash_index(
 	ut_ad(!rw_lock_own(btr_search_get_latch(index), RW_LOCK_SHARED));
 	ut_ad(!rw_lock_own(btr_search_get_latch(index), RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
-	rw_lock_s_lock(btr_search_get_latch(index));
+	btr_search_s_lock(index);
 
 	if (UNIV_UNLIKELY(index != block->index)) {
 
@@ -1239,7 +1266,7 @@ btr_search_drop_page_hash_index(
 		mem_heap_free(heap);
 	}
 
-	rw_lock_x_lock(btr_search_get_latch(index));
+	btr_search_x_lock(index);
 
 	if (UNIV_UNLIKELY(!block->index)) {
 		/* Someone else has meanwhile dropped the hash index */
@@ -1377,7 +1404,7 @@ btr_search_build_page_hash_index(
 	      || rw_lock_own(&(block->lock), RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
-	rw_lock_s_lock(btr_search_get_latch(index));
+	btr_search_s_lock(index);
 
 	if (!btr_search_enabled) {
 		rw_lock_s_unlock(btr_search_get_latch(index));
@@ -1491,7 +1518,7 @@ btr_search_build_page_hash_index(
 
 	btr_search_check_free_space_in_heap(index);
 
-	rw_lock_x_lock(btr_search_get_latch(index));
+	btr_search_x_lock(index);
 
 	if (UNIV_UNLIKELY(!btr_search_enabled)) {
 		goto exit_func;
@@ -1562,7 +1589,7 @@ btr_search_move_or_delete_hash_entries(
 	ut_ad(rw_lock_own(&(new_block->lock), RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
-	rw_lock_s_lock(btr_search_get_latch(index));
+	btr_search_s_lock(index);
 
 	ut_a(!new_block->index || new_block->index == index);
 	ut_a(!block->index || block->index == index);
@@ -1650,7 +1677,7 @@ btr_search_update_hash_on_delete(
 		mem_heap_free(heap);
 	}
 
-	rw_lock_x_lock(btr_search_get_latch(cursor->index));
+	btr_search_x_lock(cursor->index);
 
 	if (block->index) {
 		ut_a(block->index == index);
@@ -1700,7 +1727,7 @@ btr_search_update_hash_node_on_insert(
 	ut_a(cursor->index == index);
 	ut_a(!dict_index_is_ibuf(index));
 
-	rw_lock_x_lock(btr_search_get_latch(cursor->index));
+	btr_search_x_lock(cursor->index);
 
 	if (!block->index) {
 
@@ -1807,7 +1834,7 @@ btr_search_update_hash_on_insert(
 	} else {
 		if (left_side) {
 
-			rw_lock_x_lock(btr_search_get_latch(index));
+			btr_search_x_lock(index);
 
 			locked = TRUE;
 
@@ -1825,7 +1852,7 @@ btr_search_update_hash_on_insert(
 
 		if (!locked) {
 
-			rw_lock_x_lock(btr_search_get_latch(index));
+			btr_search_x_lock(index);
 
 			locked = TRUE;
 
@@ -1847,7 +1874,7 @@ btr_search_update_hash_on_insert(
 		if (!left_side) {
 
 			if (!locked) {
-				rw_lock_x_lock(btr_search_get_latch(index));
+				btr_search_x_lock(index);
 
 				locked = TRUE;
 
@@ -1866,7 +1893,7 @@ btr_search_update_hash_on_insert(
 
 		if (!locked) {
 
-			rw_lock_x_lock(btr_search_get_latch(index));
+			btr_search_x_lock(index);
 
 			locked = TRUE;
 
@@ -365,8 +365,9 @@ buf_pool_get_oldest_modification(void)
 	lsn_t		oldest_lsn = 0;
 
 	/* When we traverse all the flush lists we don't want another
-	thread to add a dirty page to any flush list. */
-	if (srv_buf_pool_instances > 1)
+	thread to add a dirty page to any flush list. Log space is reserved
+	while holding the same mutex, so any page modified below an lsn
+	read before this is already in a flush list. */
 	log_flush_order_mutex_enter();
 
 	for (i = 0; i < srv_buf_pool_instances; i++) {
@@ -390,7 +391,6 @@ buf_pool_get_oldest_modification(void)
 		}
 	}
 
-	if (srv_buf_pool_instances > 1)
 	log_flush_order_mutex_exit();
 
 	/* The returned answer may be out of date: the flush_list can
@@ -2754,6 +2754,69 @@ buf_wait_for_read(buf_block_t* block, trx_t* trx)
 	}
 }
 
+#ifdef PAGE_ATOMIC_REF_COUNT
+/********************************************************************//**
+Buffer-fixes a resident page without acquiring the page_hash latch or the
+block mutex. The candidate block is taken from buf_pool->hot_pages[] and
+validated again after it has been buffer-fixed.
+@return	buffer-fixed block, or NULL if page_hash must be searched */
+static
+buf_block_t*
+buf_page_hash_get_optimistic(
+/*=========================*/
+	buf_pool_t*		buf_pool,	/*!< in: buffer pool instance */
+	ulint			space,		/*!< in: space id */
+	ulint			offset,		/*!< in: page number */
+	ulint			fold,		/*!< in: buf_page_address_fold(
+						space, offset) */
+	const prio_rw_lock_t*	hash_lock)	/*!< in: page_hash latch
+						for fold */
+{
+	buf_block_t*	block;
+	ib_uint32_t	fix_count;
+
+	block = buf_pool->hot_pages[fold & (BUF_POOL_HOT_PAGES - 1)];
+
+	if (block == NULL) {
+		return(NULL);
+	}
+
+	/* Only join a buffer-fix that some other thread holds. A block
+	that is not buffer-fixed may be evicted or reused at any time,
+	and its buf_fix_count may then be reset by a plain store, so it
+	must not be buffer-fixed without holding hash_lock. The block
+	descriptor itself stays valid, because buf_pool->chunks are
+	never freed while the buffer pool is in use. */
+	fix_count = block->page.buf_fix_count;
+
+	if (fix_count == 0
+	    || buf_block_get_state(block) != BUF_BLOCK_FILE_PAGE
+	    || block->page.space != space
+	    || block->page.offset != offset
+	    || !os_compare_and_swap_uint32(&block->page.buf_fix_count,
+					   fix_count, fix_count + 1)) {
+
+		return(NULL);
+	}
+
+	/* The compare-and-swap is a full memory barrier. Between the
+	reads above and the buffer-fix, the block may have been evicted
+	and reused for another page. Validate it again, and give up if
+	a page_hash writer could be changing it at the moment. */
+	if (rw_lock_get_writer(hash_lock) != RW_LOCK_NOT_LOCKED
+	    || buf_block_get_state(block) != BUF_BLOCK_FILE_PAGE
+	    || block->page.space != space
+	    || block->page.offset != offset) {
+
+		buf_block_unfix(block);
+
+		return(NULL);
+	}
+
+	return(block);
+}
+#endif /* PAGE_ATOMIC_REF_COUNT */
+
 /********************************************************************//**
 This is the general function used to get access to a database page.
 @return	pointer to the block or NULL */
@@ -2825,6 +2888,16 @@ buf_page_get_gen(
 	fold = buf_page_address_fold(space, offset);
 	hash_lock = buf_page_hash_lock_get(buf_pool, fold);
 loop:
+#ifdef PAGE_ATOMIC_REF_COUNT
+	fix_block = buf_page_hash_get_optimistic(
+		buf_pool, space, offset, fold, hash_lock);
+
+	if (fix_block != NULL) {
+		block = fix_block;
+		goto got_block;
+	}
+#endif /* PAGE_ATOMIC_REF_COUNT */
+
 	block = guess;
 
 	rw_lock_s_lock(hash_lock);
@@ -2996,6 +3069,18 @@ buf_page_get_gen(
 		fix_block = block;
 	}
 
+#ifdef PAGE_ATOMIC_REF_COUNT
+	if (buf_block_get_state(fix_block) == BUF_BLOCK_FILE_PAGE) {
+		buf_block_t**	hot = &buf_pool->hot_pages[
+			fold & (BUF_POOL_HOT_PAGES - 1)];
+
+		/* Avoid dirtying the cache line if the slot is current */
+		if (*hot != fix_block) {
+			*hot = fix_block;
+		}
+	}
+#endif /* PAGE_ATOMIC_REF_COUNT */
+
 	buf_block_fix(fix_block);
 
 	/* Now safe to release page_hash mutex */
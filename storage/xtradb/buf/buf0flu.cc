@@ -78,6 +78,23 @@ the blocks on free list. If LRU list is very small then we can end up
 in thrashing. */
 #define BUF_LRU_MIN_LEN		256
 
+/** A flush batch is used as a throughput sample by the adaptive flushing
+controller only if it wrote at least this many pages */
+#define BUF_FLUSH_ADAPT_MIN_BATCH	16
+
+/** Smallest LRU scan depth chosen by the adaptive flushing controller,
+the same as the minimum value of innodb_lru_scan_depth */
+#define BUF_FLUSH_ADAPT_MIN_LRU_DEPTH	100
+
+/** Interval in milliseconds between two runs of the adaptive flushing
+controller */
+#define BUF_FLUSH_ADAPT_INTERVAL	1000
+
+/** Write throughput in pages per second measured by the adaptive flushing
+controller for all buffer pool instances, or 0 if no flush batch has been
+measured yet. Written only by the LRU manager thread. */
+static ulint	buf_flush_measured_io_capacity = 0;
+
 /* @} */
 
 /******************************************************************//**
@@ -701,6 +718,54 @@ buf_flush_relocate_on_flush_list(
 	buf_flush_list_mutex_exit(buf_pool);
 }
 
+/********************************************************************//**
+Takes a throughput sample for the adaptive flushing controller when a
+flush batch has ended. The sample covers the time from the start of the
+batch to the completion of its last write. */
+static
+void
+buf_flush_batch_measure(
+/*====================*/
+	buf_pool_t*	buf_pool,	/*!< in/out: buffer pool instance */
+	buf_flush_t	flush_type)	/*!< in: type of the ended batch */
+{
+	ib_uint64_t	usec;
+	ulint		n_pages = buf_pool->batch_written[flush_type];
+	ulint		rate;
+
+	ut_ad(mutex_own(&buf_pool->flush_state_mutex));
+
+	buf_pool->batch_written[flush_type] = 0;
+
+	/* Single page flushes are not batches. The time of a short
+	batch is dominated by the latency of a single write and says
+	little about the throughput of the device. */
+	if (flush_type == BUF_FLUSH_SINGLE_PAGE
+	    || n_pages < BUF_FLUSH_ADAPT_MIN_BATCH) {
+
+		return;
+	}
+
+	usec = ut_time_us(NULL) - buf_pool->batch_start_us[flush_type];
+
+	if (usec == 0) {
+		usec = 1;
+	}
+
+	rate = static_cast<ulint>(n_pages * 1000000ULL / usec);
+
+	if (buf_pool->io_pages_per_sec == 0) {
+		buf_pool->io_pages_per_sec = rate;
+		buf_pool->io_batch_us = static_cast<ulint>(usec);
+	} else {
+		/* Moving average, with a weight of 1/8 for the new sample */
+		buf_pool->io_pages_per_sec
+			= (7 * buf_pool->io_pages_per_sec + rate) / 8;
+		buf_pool->io_batch_us = static_cast<ulint>(
+			(7 * buf_pool->io_batch_us + usec) / 8);
+	}
+}
+
 /********************************************************************//**
 Updates the flush system data structures when a write is completed. */
 UNIV_INTERN
@@ -719,6 +784,7 @@ buf_flush_write_complete(
 	buf_page_set_io_fix(bpage, BUF_IO_NONE);
 
 	buf_pool->n_flush[flush_type]--;
+	buf_pool->batch_written[flush_type]++;
 
 #ifdef UNIV_MTFLUSH_DEBUG
 	fprintf(stderr, "n pending flush %lu\n",
@@ -730,6 +796,8 @@ buf_flush_write_complete(
 
 		/* The running flush batch has ended */
 
+		buf_flush_batch_measure(buf_pool, flush_type);
+
 		os_event_set(buf_pool->no_flush[flush_type]);
 	}
 
@@ -1437,6 +1505,63 @@ buf_flush_page_and_try_neighbors(
 	return(flushed);
 }
 
+/*********************************************************************//**
+Returns the LRU scan depth of a buffer pool instance: the number of free
+pages that LRU batches try to keep in the free list, and the number of
+pages at the tail of the LRU list that they scan.
+@return innodb_lru_scan_depth, or the depth chosen for the instance by the
+adaptive flushing controller if innodb_adaptive_io_capacity=ON */
+UNIV_INTERN
+ulint
+buf_flush_LRU_scan_depth(
+/*=====================*/
+	const buf_pool_t*	buf_pool)	/*!< in: buffer pool instance */
+{
+	ulint	depth = buf_pool->LRU_scan_depth;
+
+	if (srv_adaptive_io_capacity && depth != 0) {
+		return(depth);
+	}
+
+	return(srv_LRU_scan_depth);
+}
+
+/*********************************************************************//**
+Returns the number of pages per second that background flushing should
+write, the equivalent of innodb_io_capacity.
+@return innodb_io_capacity, or half of the measured write throughput if
+innodb_adaptive_io_capacity=ON */
+static
+ulint
+buf_flush_io_capacity(void)
+/*=======================*/
+{
+	if (srv_adaptive_io_capacity && buf_flush_measured_io_capacity) {
+		/* Leave half of the measured throughput to page reads
+		and to the writes of the redo log */
+		return(ut_max(buf_flush_measured_io_capacity / 2, 100));
+	}
+
+	return(srv_io_capacity);
+}
+
+/*********************************************************************//**
+Returns the number of pages per second that background flushing may write
+when it falls behind, the equivalent of innodb_io_capacity_max.
+@return innodb_io_capacity_max, or the measured write throughput if
+innodb_adaptive_io_capacity=ON */
+static
+ulint
+buf_flush_max_io_capacity(void)
+/*===========================*/
+{
+	if (srv_adaptive_io_capacity && buf_flush_measured_io_capacity) {
+		return(2 * buf_flush_io_capacity());
+	}
+
+	return(srv_max_io_capacity);
+}
+
 /*******************************************************************//**
 This utility moves the uncompressed frames of pages to the free list.
 Note that this function does not actually flush any data to disk. It
@@ -1464,7 +1589,7 @@ buf_free_from_unzip_LRU_list_batch(
 
 	block = UT_LIST_GET_LAST(buf_pool->unzip_LRU);
 	while (block != NULL && count < max
-	       && free_len < srv_LRU_scan_depth
+	       && free_len < buf_flush_LRU_scan_depth(buf_pool)
 	       && lru_len > UT_LIST_GET_LEN(buf_pool->LRU) / 10) {
 
 		ib_mutex_t*	block_mutex = buf_page_get_mutex(&block->page);
@@ -1530,6 +1655,7 @@ buf_flush_LRU_list_batch(
 	ulint		lru_position = 0;
 	ulint		max_lru_position;
 	ulint		max_scanned_pages;
+	ulint		scan_depth;
 	ulint		free_len = UT_LIST_GET_LEN(buf_pool->free);
 	ulint		lru_len = UT_LIST_GET_LEN(buf_pool->LRU);
 
@@ -1539,13 +1665,14 @@ buf_flush_LRU_list_batch(
 
 	ut_ad(mutex_own(&buf_pool->LRU_list_mutex));
 
-	max_scanned_pages = limited_scan ? srv_LRU_scan_depth : lru_len * max;
-	max_lru_position = ut_min(srv_LRU_scan_depth, lru_len);
+	scan_depth = buf_flush_LRU_scan_depth(buf_pool);
+	max_scanned_pages = limited_scan ? scan_depth : lru_len * max;
+	max_lru_position = ut_min(scan_depth, lru_len);
 
 	bpage = UT_LIST_GET_LAST(buf_pool->LRU);
 	while (bpage != NULL
 	       && (srv_cleaner_eviction_factor ? n->evicted : n->flushed) < max
-	       && free_len < srv_LRU_scan_depth
+	       && free_len < scan_depth
 	       && lru_len > BUF_LRU_MIN_LEN
 	       && lru_position < max_lru_position
 	       && scanned < max_scanned_pages) {
@@ -1888,6 +2015,8 @@ buf_flush_start(
 	}
 
 	buf_pool->init_flush[flush_type] = TRUE;
+	buf_pool->batch_start_us[flush_type] = ut_time_us(NULL);
+	buf_pool->batch_written[flush_type] = 0;
 
 	mutex_exit(&buf_pool->flush_state_mutex);
 
@@ -1913,6 +2042,8 @@ buf_flush_end(
 
 		/* The running flush batch has ended */
 
+		buf_flush_batch_measure(buf_pool, flush_type);
+
 		os_event_set(buf_pool->no_flush[flush_type]);
 	}
 
@@ -2006,6 +2137,51 @@ buf_flush_LRU(
 	return(true);
 }
 
+/*******************************************************************//**
+Divides a flush list flush among the buffer pool instances. With
+innodb_adaptive_io_capacity=ON every instance flushes a share proportional
+to its number of dirty pages, otherwise all instances flush an equal
+share. */
+UNIV_INTERN
+void
+buf_flush_list_batch_sizes(
+/*=======================*/
+	ulint		min_n,		/*!< in: wished minimum number of
+					pages flushed in total, or ULINT_MAX
+					to flush everything up to the
+					lsn limit */
+	ulint*		n_pages)	/*!< out: wished minimum number of
+					pages flushed from each buffer pool
+					instance */
+{
+	ib_uint64_t	n_dirty = 0;
+
+	if (srv_adaptive_io_capacity && min_n != ULINT_MAX) {
+
+		for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+			/* A dirty read is good enough here */
+			n_dirty += UT_LIST_GET_LEN(
+				buf_pool_from_array(i)->flush_list);
+		}
+	}
+
+	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+
+		if (min_n == ULINT_MAX) {
+			n_pages[i] = ULINT_MAX;
+		} else if (n_dirty == 0) {
+			n_pages[i] = (min_n + srv_buf_pool_instances - 1)
+				/ srv_buf_pool_instances;
+		} else {
+			ib_uint64_t	n = UT_LIST_GET_LEN(
+				buf_pool_from_array(i)->flush_list);
+
+			n_pages[i] = static_cast<ulint>(
+				(min_n * n + n_dirty - 1) / n_dirty);
+		}
+	}
+}
+
 /*******************************************************************//**
 This utility flushes dirty blocks from the end of the flush list of
 all buffer pool instances.
@@ -2033,6 +2209,7 @@ buf_flush_list(
 	ulint		i;
 
 	ulint		requested_pages[MAX_BUFFER_POOLS];
+	ulint		min_pages[MAX_BUFFER_POOLS];
 	bool		active_instance[MAX_BUFFER_POOLS];
 	ulint		remaining_instances = srv_buf_pool_instances;
 	bool		timeout = false;
@@ -2042,25 +2219,26 @@ buf_flush_list(
 		return(buf_mtflu_flush_list(min_n, lsn_limit, n_processed));
 	}
 
+	/* Spread the flushing amongst the buffer pool instances. When
+	min_n is ULINT_MAX we need to flush everything up to the lsn
+	limit so no limit here. */
+	buf_flush_list_batch_sizes(min_n, min_pages);
+
 	for (i = 0; i < srv_buf_pool_instances; i++) {
 		requested_pages[i] = 0;
-		active_instance[i] = true;
+		active_instance[i] = min_pages[i] > 0;
+
+		if (!active_instance[i]) {
+			remaining_instances--;
+		}
 	}
 
 	if (n_processed) {
 		*n_processed = 0;
 	}
 
-	if (min_n != ULINT_MAX) {
-		/* Ensure that flushing is spread evenly amongst the
-		buffer pool instances. When min_n is ULINT_MAX
-		we need to flush everything up to the lsn limit
-		so no limit here. */
-		min_n = (min_n + srv_buf_pool_instances - 1)
-			 / srv_buf_pool_instances;
-		if (lsn_limit != LSN_MAX) {
-			flush_start_time = ut_time_ms();
-		}
+	if (min_n != ULINT_MAX && lsn_limit != LSN_MAX) {
+		flush_start_time = ut_time_ms();
 	}
 
 	/* Flush to lsn_limit in all buffer pool instances */
@@ -2086,7 +2264,7 @@ buf_flush_list(
 
 				chunk_size = ut_min(
 					srv_cleaner_flush_chunk_size,
-					min_n - requested_pages[i]);
+					min_pages[i] - requested_pages[i]);
 
 				buf_pool = buf_pool_from_array(i);
 
@@ -2110,7 +2288,7 @@ buf_flush_list(
 
 				requested_pages[i] += chunk_size;
 
-				if (requested_pages[i] >= min_n
+				if (requested_pages[i] >= min_pages[i]
 				    || !n.flushed) {
 
 					active_instance[i] = false;
@@ -2250,7 +2428,8 @@ Clears up tail of the LRU lists:
 * Put replaceable pages at the tail of LRU to the free list
 * Flush dirty pages at the tail of LRU to the disk
 The depth to which we scan each buffer pool is controlled by dynamic
-config parameter innodb_LRU_scan_depth.
+config parameter innodb_LRU_scan_depth, or by the adaptive flushing
+controller if innodb_adaptive_io_capacity=ON.
 @return total pages flushed */
 UNIV_INTERN
 ulint
@@ -2260,14 +2439,13 @@ buf_flush_LRU_tail(void)
 	ulint	total_flushed = 0;
 	ulint	start_time = ut_time_ms();
 	ulint	scan_depth[MAX_BUFFER_POOLS];
+	ulint	free_list_lwm[MAX_BUFFER_POOLS];
 	ulint	requested_pages[MAX_BUFFER_POOLS];
 	bool	active_instance[MAX_BUFFER_POOLS];
 	bool	limited_scan[MAX_BUFFER_POOLS];
 	ulint	previous_evicted[MAX_BUFFER_POOLS];
 	ulint	remaining_instances = srv_buf_pool_instances;
 	ulint	lru_chunk_size = srv_cleaner_lru_chunk_size;
-	ulint	free_list_lwm = srv_LRU_scan_depth / 100
-		* srv_cleaner_free_list_lwm;
 
 	if(buf_mtflu_init_done())
 	{
@@ -2277,8 +2455,10 @@ buf_flush_LRU_tail(void)
 	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
 
 		const buf_pool_t* buf_pool = buf_pool_from_array(i);
+		ulint		depth = buf_flush_LRU_scan_depth(buf_pool);
 
-		scan_depth[i] = ut_min(srv_LRU_scan_depth,
+		free_list_lwm[i] = depth / 100 * srv_cleaner_free_list_lwm;
+		scan_depth[i] = ut_min(depth,
 				       UT_LIST_GET_LEN(buf_pool->LRU));
 		requested_pages[i] = 0;
 		active_instance[i] = true;
@@ -2299,7 +2479,7 @@ buf_flush_LRU_tail(void)
 				continue;
 			}
 
-			ulint free_len = free_list_lwm;
+			ulint free_len = free_list_lwm[i];
 			buf_pool_t* buf_pool = buf_pool_from_array(i);
 
 			do {
@@ -2364,7 +2544,7 @@ buf_flush_LRU_tail(void)
 						n.evicted);
 				}
 			} while (active_instance[i]
-				 && free_len <= free_list_lwm);
+				 && free_len <= free_list_lwm[i]);
 		}
 	}
 
@@ -2584,12 +2764,13 @@ page_cleaner_flush_pages_if_needed(void)
 
 	/* Cap the maximum IO capacity that we are going to use by
 	max_io_capacity. */
-	n_pages = PCT_IO(pct_total);
+	n_pages = static_cast<ulint>(
+		buf_flush_io_capacity() * (pct_total / 100.0));
 	if (age < log_get_max_modified_age_async())
 		n_pages = (n_pages + avg_page_rate) / 2;
 
-	if (n_pages > srv_max_io_capacity) {
-		n_pages = srv_max_io_capacity;
+	if (n_pages > buf_flush_max_io_capacity()) {
+		n_pages = buf_flush_max_io_capacity();
 	}
 
 	if (last_pages && cur_lsn - last_lsn > lsn_avg_rate / 2) {
@@ -2675,7 +2856,13 @@ page_cleaner_adapt_lru_sleep_time(
 				time for LRU flushes  */
 {
 	ulint free_len = buf_get_total_free_list_length();
-	ulint max_free_len = srv_LRU_scan_depth * srv_buf_pool_instances;
+	ulint max_free_len = 0;
+
+	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+
+		max_free_len += buf_flush_LRU_scan_depth(
+			buf_pool_from_array(i));
+	}
 
 	if (free_len < max_free_len / 100) {
 
@@ -2697,6 +2884,90 @@ page_cleaner_adapt_lru_sleep_time(
 	}
 }
 
+/*********************************************************************//**
+Adaptive flushing controller, run about once a second by the LRU manager
+thread when innodb_adaptive_io_capacity=ON.
+The I/O capacity of background flushing is derived from the write
+throughput measured for the flush batches of all buffer pool instances.
+The LRU scan depth of each instance is doubled when threads had to wait
+for a free page since the previous run, and reduced by 1/8 when the free
+list is well stocked, so that it settles at the smallest depth that keeps
+the free list from running empty. */
+static
+void
+page_cleaner_adapt_flush_batches(void)
+/*==================================*/
+{
+	ulint	rate_sum = 0;
+	ulint	batch_us_sum = 0;
+	ulint	n_measured = 0;
+	ulint	depth_sum = 0;
+
+	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+		ulint		n_waits = buf_pool->n_free_waits;
+		ulint		depth = buf_pool->LRU_scan_depth;
+		ulint		max_depth = ut_max(buf_pool->curr_size / 4,
+						   BUF_FLUSH_ADAPT_MIN_LRU_DEPTH);
+
+		if (depth == 0) {
+			depth = srv_LRU_scan_depth;
+		}
+
+		if (n_waits != buf_pool->n_free_waits_old) {
+
+			/* The free list ran empty: LRU batches must
+			free more pages ahead of demand */
+			depth *= 2;
+		} else if (UT_LIST_GET_LEN(buf_pool->free) > depth / 2) {
+
+			/* The free list is well stocked: LRU batches
+			evict and write more pages than needed */
+			depth -= depth / 8;
+		}
+
+		buf_pool->n_free_waits_old = n_waits;
+
+		depth = ut_min(ut_max(depth, BUF_FLUSH_ADAPT_MIN_LRU_DEPTH),
+			       max_depth);
+		buf_pool->LRU_scan_depth = depth;
+		depth_sum += depth;
+
+		mutex_enter(&buf_pool->flush_state_mutex);
+
+		if (buf_pool->io_pages_per_sec) {
+			rate_sum += buf_pool->io_pages_per_sec;
+			batch_us_sum += buf_pool->io_batch_us;
+			n_measured++;
+		}
+
+		mutex_exit(&buf_pool->flush_state_mutex);
+	}
+
+	if (n_measured) {
+		/* Without multi-threaded flushing the batches of the
+		instances run one after another, so the throughput of the
+		device is that of one batch times the number of batches
+		that can run at the same time. */
+		ulint	n_parallel = srv_use_mtflush
+			? ut_min(static_cast<ulint>(srv_mtflush_threads),
+				 srv_buf_pool_instances)
+			: 1;
+
+		buf_flush_measured_io_capacity
+			= rate_sum / n_measured * n_parallel;
+
+		MONITOR_SET(MONITOR_FLUSH_BATCH_TIME_AVG,
+			    batch_us_sum / n_measured);
+	}
+
+	MONITOR_SET(MONITOR_FLUSH_IO_CAPACITY_MEASURED,
+		    buf_flush_measured_io_capacity);
+	MONITOR_SET(MONITOR_FLUSH_IO_CAPACITY, buf_flush_io_capacity());
+	MONITOR_SET(MONITOR_LRU_SCAN_DEPTH, depth_sum);
+}
+
 /*********************************************************************//**
 Get the desired page cleaner thread sleep time for flush list flushes.
 @return desired sleep time */
@@ -2782,7 +3053,7 @@ DECLARE_THREAD(buf_flush_page_cleaner_thread)(
 			page_cleaner_flush_pages_if_needed();
 		} else if (srv_idle_flush_pct) {
 			n_flushed = page_cleaner_do_flush_batch(
-							PCT_IO(100),
+							buf_flush_io_capacity(),
 							LSN_MAX);
 
 			if (n_flushed) {
@@ -2884,6 +3155,7 @@ DECLARE_THREAD(buf_flush_lru_manager_thread)(
 			os_thread_create */
 {
 	ulint	next_loop_time = ut_time_ms() + 1000;
+	ulint	next_adapt_time = next_loop_time;
 	ulint	lru_sleep_time = srv_cleaner_max_lru_time;
 
 #ifdef UNIV_PFS_THREAD
@@ -2911,6 +3183,15 @@ DECLARE_THREAD(buf_flush_lru_manager_thread)(
 
 		page_cleaner_sleep_if_needed(next_loop_time);
 
+		if (srv_adaptive_io_capacity
+		    && ut_time_ms() >= next_adapt_time) {
+
+			page_cleaner_adapt_flush_batches();
+
+			next_adapt_time = ut_time_ms()
+				+ BUF_FLUSH_ADAPT_INTERVAL;
+		}
+
 		page_cleaner_adapt_lru_sleep_time(&lru_sleep_time);
 
 		next_loop_time = ut_time_ms() + lru_sleep_time;
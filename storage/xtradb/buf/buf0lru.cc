@@ -1343,6 +1343,7 @@ buf_LRU_get_free_block(
 	ulint		flush_failures	= 0;
 	ibool		mon_value_was	= FALSE;
 	ibool		started_monitor	= FALSE;
+	bool		counted_wait	= false;
 
 	ut_ad(!mutex_own(&buf_pool->LRU_list_mutex));
 
@@ -1366,6 +1367,13 @@ buf_LRU_get_free_block(
 		return(block);
 	}
 
+	if (!counted_wait) {
+		/* Tell the adaptive flushing controller that LRU
+		batches are not keeping up */
+		os_atomic_increment_ulint(&buf_pool->n_free_waits, 1);
+		counted_wait = true;
+	}
+
 	if (srv_empty_free_list_algorithm == SRV_EMPTY_FREE_LIST_BACKOFF
 	    && buf_lru_manager_is_active
 	    && (srv_shutdown_state == SRV_SHUTDOWN_NONE
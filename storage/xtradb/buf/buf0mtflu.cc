@@ -211,7 +211,9 @@ buf_mtflu_flush_pool_instance(
         	buf_pool_mutex_enter(work_item->wr.buf_pool);
         	work_item->wr.min = UT_LIST_GET_LEN(work_item->wr.buf_pool->LRU);
         	buf_pool_mutex_exit(work_item->wr.buf_pool);
-        	work_item->wr.min = ut_min(srv_LRU_scan_depth,work_item->wr.min);
+        	work_item->wr.min = ut_min(
+			buf_flush_LRU_scan_depth(work_item->wr.buf_pool),
+			work_item->wr.min);
     	}
 
 	buf_flush_batch(work_item->wr.buf_pool,
@@ -537,8 +539,9 @@ buf_mtflu_flush_work_items(
 	flush_counters_t *per_pool_cnt,	/*!< out: Number of pages
 					flushed or evicted /instance */
 	buf_flush_t flush_type,		/*!< in: Type of flush */
-	ulint min_n,			/*!< in: Wished minimum number of
-					blocks to be flushed */
+	const ulint* min_n,		/*!< in: Wished minimum number of
+					blocks to be flushed from each
+					instance */
 	lsn_t lsn_limit)		/*!< in: All blocks whose
 					oldest_modification is smaller than
 					this should be flushed (if their
@@ -563,7 +566,7 @@ buf_mtflu_flush_work_items(
 		work_item[i].tsk = MT_WRK_WRITE;
 		work_item[i].wr.buf_pool = buf_pool_from_array(i);
 		work_item[i].wr.flush_type = flush_type;
-		work_item[i].wr.min = min_n;
+		work_item[i].wr.min = min_n[i];
 		work_item[i].wr.lsn_limit = lsn_limit;
 		work_item[i].wi_status = WRK_ITEM_UNSET;
 		work_item[i].wheap = work_heap;
@@ -632,25 +635,22 @@ buf_mtflu_flush_list(
 	ulint				i;
 	bool				success = true;
 	flush_counters_t		cnt[MTFLUSH_MAX_WORKER];
+	ulint				min_pages[MAX_BUFFER_POOLS];
 
 	if (n_processed) {
 		*n_processed = 0;
 	}
 
-	if (min_n != ULINT_MAX) {
-		/* Ensure that flushing is spread evenly amongst the
-		buffer pool instances. When min_n is ULINT_MAX
-		we need to flush everything up to the lsn limit
-		so no limit here. */
-		min_n = (min_n + srv_buf_pool_instances - 1)
-			 / srv_buf_pool_instances;
-	}
+	/* Spread the flushing amongst the buffer pool instances. When
+	min_n is ULINT_MAX we need to flush everything up to the lsn
+	limit so no limit here. */
+	buf_flush_list_batch_sizes(min_n, min_pages);
 
 	/* This lock is to safequard against re-entry if any. */
 	os_fast_mutex_lock(&mtflush_mtx);
 	buf_mtflu_flush_work_items(srv_buf_pool_instances,
                 cnt, BUF_FLUSH_LIST,
-                min_n, lsn_limit);
+                min_pages, lsn_limit);
 	os_fast_mutex_unlock(&mtflush_mtx);
 
 	for (i = 0; i < srv_buf_pool_instances; i++) {
@@ -695,6 +695,7 @@ buf_mtflu_flush_LRU_tail(void)
 {
 	ulint	total_flushed=0, i;
 	flush_counters_t	cnt[MTFLUSH_MAX_WORKER];
+	ulint	scan_depth[MAX_BUFFER_POOLS];
 
 	ut_a(buf_mtflu_init_done());
 
@@ -703,10 +704,15 @@ buf_mtflu_flush_LRU_tail(void)
 		return (total_flushed);
 	}
 
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		scan_depth[i] = buf_flush_LRU_scan_depth(
+			buf_pool_from_array(i));
+	}
+
 	/* This lock is to safeguard against re-entry if any */
 	os_fast_mutex_lock(&mtflush_mtx);
 	buf_mtflu_flush_work_items(srv_buf_pool_instances,
-		cnt, BUF_FLUSH_LRU, srv_LRU_scan_depth, 0);
+		cnt, BUF_FLUSH_LRU, scan_depth, 0);
 	os_fast_mutex_unlock(&mtflush_mtx);
 
 	for (i = 0; i < srv_buf_pool_instances; i++) {
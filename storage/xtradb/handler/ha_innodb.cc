@@ -434,6 +434,11 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 #  endif /* !HAVE_ATOMIC_BUILTINS */
 	{&log_bmp_sys_mutex_key, "log_bmp_sys_mutex", 0},
 	{&log_sys_mutex_key, "log_sys_mutex", 0},
+	{&log_write_mutex_key, "log_write_mutex", 0},
+	{&log_flush_mutex_key, "log_flush_mutex", 0},
+#  ifndef HAVE_ATOMIC_BUILTINS_64
+	{&log_lsn_mutex_key, "log_lsn_mutex", 0},
+#  endif /* !HAVE_ATOMIC_BUILTINS_64 */
 #  ifdef UNIV_MEM_DEBUG
 	{&mem_hash_mutex_key, "mem_hash_mutex", 0},
 #  endif /* UNIV_MEM_DEBUG */
@@ -459,7 +464,8 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	{&buf_dblwr_mutex_key, "buf_dblwr_mutex", 0},
 	{&trx_undo_mutex_key, "trx_undo_mutex", 0},
 	{&srv_sys_mutex_key, "srv_sys_mutex", 0},
-	{&lock_sys_mutex_key, "lock_mutex", 0},
+	{&lock_sys_rec_mutex_key, "lock_rec_mutex", 0},
+	{&lock_sys_table_mutex_key, "lock_table_mutex", 0},
 	{&lock_sys_wait_mutex_key, "lock_wait_mutex", 0},
 	{&trx_mutex_key, "trx_mutex", 0},
 	{&srv_sys_tasks_mutex_key, "srv_threads_mutex", 0},
@@ -505,7 +511,8 @@ static PSI_rwlock_info all_innodb_rwlocks[] = {
 	{&index_tree_rw_lock_key, "index_tree_rw_lock", 0},
 	{&index_online_log_key, "index_online_log", 0},
 	{&dict_table_stats_key, "dict_table_stats", 0},
-	{&hash_table_rw_lock_key, "hash_table_locks", 0}
+	{&hash_table_rw_lock_key, "hash_table_locks", 0},
+	{&lock_sys_latch_key, "lock_sys_latch", 0}
 };
 # endif /* UNIV_PFS_RWLOCK */
 
@@ -524,6 +531,9 @@ static PSI_thread_info	all_innodb_threads[] = {
 	{&buf_page_cleaner_thread_key, "page_cleaner_thread", 0},
 	{&buf_lru_manager_thread_key, "lru_manager_thread", 0},
 	{&recv_writer_thread_key, "recv_writer_thread", 0},
+	{&recv_apply_thread_key, "recv_apply_thread", 0},
+	{&log_writer_thread_key, "log_writer_thread", 0},
+	{&log_flusher_thread_key, "log_flusher_thread", 0},
 	{&srv_log_tracking_thread_key, "srv_redo_log_follow_thread", 0}
 };
 # endif /* UNIV_PFS_THREAD */
@@ -2916,6 +2926,7 @@ ha_innobase::ha_innobase(
 		  HA_CAN_FULLTEXT_EXT | HA_CAN_EXPORT),
 	start_of_scan(0),
 	num_write_row(0),
+	ignore_dup_key(false),
 	ha_partition_stats(NULL)
 {}
 
@@ -14855,8 +14866,12 @@ ha_innobase::extra(
 	case HA_EXTRA_INSERT_WITH_UPDATE:
 		thd_to_trx(ha_thd())->duplicates |= TRX_DUP_IGNORE;
 		break;
+	case HA_EXTRA_IGNORE_DUP_KEY:
+		ignore_dup_key = true;
+		break;
 	case HA_EXTRA_NO_IGNORE_DUP_KEY:
 		thd_to_trx(ha_thd())->duplicates &= ~TRX_DUP_IGNORE;
+		ignore_dup_key = false;
 		break;
 	case HA_EXTRA_WRITE_CAN_REPLACE:
 		thd_to_trx(ha_thd())->duplicates |= TRX_DUP_REPLACE;
@@ -14891,9 +14906,94 @@ ha_innobase::reset()
 	/* This is a statement level counter. */
 	prebuilt->autoinc_last_value = 0;
 
+	if (prebuilt->bulk) {
+		/* end_bulk_insert() was not called */
+		row_merge_bulk_free(prebuilt->bulk);
+		prebuilt->bulk = NULL;
+	}
+
 	return(0);
 }
 
+/******************************************************************//**
+MySQL calls this before LOAD DATA and other inserts of many rows. For
+LOAD DATA into an empty table, we only insert the clustered index
+records row by row. The secondary index entries are buffered, and
+end_bulk_insert() sorts and inserts them like in index creation. */
+UNIV_INTERN
+void
+ha_innobase::start_bulk_insert(
+/*===========================*/
+	ha_rows	rows,	/*!< in: number of rows to insert, or 0 if
+			not known */
+	uint	flags)	/*!< in: HA_CREATE_UNIQUE_INDEX_BY_SORT, or 0 */
+{
+	THD*	thd = ha_thd();
+	trx_t*	trx = prebuilt->trx;
+
+	DBUG_ENTER("ha_innobase::start_bulk_insert");
+
+	ut_ad(prebuilt->bulk == NULL);
+
+	/* With IGNORE or REPLACE, a duplicate must be found when its
+	row is inserted. Triggers could read the secondary indexes. */
+	if (srv_read_only_mode
+	    || thd_sql_command(thd) != SQLCOM_LOAD
+	    || trx != thd_to_trx(thd)
+	    || ignore_dup_key
+	    || trx->duplicates
+	    || trx->fake_changes
+	    || table->triggers != NULL
+#ifdef WITH_WSREP
+	    || wsrep_on(thd)
+#endif /* WITH_WSREP */
+	    ) {
+		DBUG_VOID_RETURN;
+	}
+
+	prebuilt->bulk = row_merge_bulk_start(trx, prebuilt->table, table);
+
+	DBUG_VOID_RETURN;
+}
+
+/******************************************************************//**
+Inserts the secondary index entries of a bulk insert that was started
+by start_bulk_insert().
+@return	0 or error number */
+UNIV_INTERN
+int
+ha_innobase::end_bulk_insert()
+/*==========================*/
+{
+	row_merge_bulk_t*	bulk = prebuilt->bulk;
+	dberr_t			error;
+	int			err;
+
+	DBUG_ENTER("ha_innobase::end_bulk_insert");
+
+	if (bulk == NULL) {
+		DBUG_RETURN(0);
+	}
+
+	prebuilt->bulk = NULL;
+
+	prebuilt->trx->op_info = "inserting secondary index entries";
+
+	error = row_merge_bulk_finish(bulk, prebuilt->trx);
+
+	prebuilt->trx->op_info = "";
+
+	err = convert_error_code_to_mysql(
+		error, prebuilt->table->flags, user_thd);
+
+	if (err) {
+		/* The caller reports the error with print_error() */
+		my_errno = err;
+	}
+
+	DBUG_RETURN(err);
+}
+
 /******************************************************************//**
 MySQL calls this function at the start of each SQL statement inside LOCK
 TABLES. Inside LOCK TABLES the ::external_lock method does not work to
@@ -19658,6 +19758,13 @@ static MYSQL_SYSVAR_BOOL(adaptive_flushing, srv_adaptive_flushing,
   "Attempt flushing dirty pages to avoid IO bursts at checkpoints.",
   NULL, NULL, TRUE);
 
+static MYSQL_SYSVAR_BOOL(adaptive_io_capacity, srv_adaptive_io_capacity,
+  PLUGIN_VAR_NOCMDARG,
+  "Size the flush list and LRU flush batches of every buffer pool instance"
+  " from the measured write throughput and free page waits, instead of"
+  " innodb_io_capacity and innodb_lru_scan_depth.",
+  NULL, NULL, FALSE);
+
 static MYSQL_SYSVAR_ULONG(flushing_avg_loops,
   srv_flushing_avg_loops,
   PLUGIN_VAR_RQCMDARG,
@@ -19746,9 +19853,9 @@ static MYSQL_SYSVAR_BOOL(adaptive_hash_index, btr_search_enabled,
 reasons. This limitation can be easily removed later. */
 static MYSQL_SYSVAR_ULINT(adaptive_hash_index_partitions, btr_search_index_num,
   PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
-  "Number of InnoDB adaptive hash index partitions (default 1: disable "
-  "partitioning)",
-  NULL, NULL, 1, 1, sizeof(ulint) * 8, 0);
+  "Number of InnoDB adaptive hash index partitions, selected by index id, "
+  "each with its own latch and hash table (1 disables partitioning)",
+  NULL, NULL, 8, 1, sizeof(ulint) * 8, 0);
 
 static MYSQL_SYSVAR_ULONG(replication_delay, srv_replication_delay,
   PLUGIN_VAR_RQCMDARG,
@@ -20109,6 +20216,11 @@ static MYSQL_SYSVAR_ULONG(sort_buffer_size, srv_sort_buf_size,
   "Memory buffer size for index creation",
   NULL, NULL, 1048576, 65536, 64<<20, 0);
 
+static MYSQL_SYSVAR_ULONG(merge_sort_threads, srv_merge_sort_threads,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of threads merging the sorted runs of an index in index creation",
+  NULL, NULL, 4, 1, 64, 0);
+
 static MYSQL_SYSVAR_ULONGLONG(online_alter_log_max_size, srv_online_max_size,
   PLUGIN_VAR_RQCMDARG,
   "Maximum modification log file size for online index creation",
@@ -20134,6 +20246,11 @@ static MYSQL_SYSVAR_ULONG(force_recovery, srv_force_recovery,
   "Helps to save your data in case the disk image of the database becomes corrupt.",
   NULL, NULL, 0, 0, 6, 0);
 
+static MYSQL_SYSVAR_ULONG(recovery_apply_threads, srv_recovery_apply_threads,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of threads applying the redo log records to the pages in crash recovery.",
+  NULL, NULL, 4, 1, 64, 0);
+
 #ifndef DBUG_OFF
 static MYSQL_SYSVAR_ULONG(force_recovery_crash, srv_force_recovery_crash,
   PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
@@ -20784,6 +20901,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(use_global_flush_log_at_trx_commit),
   MYSQL_SYSVAR(flush_method),
   MYSQL_SYSVAR(force_recovery),
+  MYSQL_SYSVAR(recovery_apply_threads),
 #ifndef DBUG_OFF
   MYSQL_SYSVAR(force_recovery_crash),
 #endif /* !DBUG_OFF */
@@ -20814,6 +20932,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(max_dirty_pages_pct_lwm),
   MYSQL_SYSVAR(adaptive_flushing_lwm),
   MYSQL_SYSVAR(adaptive_flushing),
+  MYSQL_SYSVAR(adaptive_io_capacity),
   MYSQL_SYSVAR(flushing_avg_loops),
   MYSQL_SYSVAR(max_purge_lag),
   MYSQL_SYSVAR(max_purge_lag_delay),
@@ -20844,6 +20963,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(strict_mode),
   MYSQL_SYSVAR(support_xa),
   MYSQL_SYSVAR(sort_buffer_size),
+  MYSQL_SYSVAR(merge_sort_threads),
   MYSQL_SYSVAR(online_alter_log_max_size),
   MYSQL_SYSVAR(sync_spin_loops),
   MYSQL_SYSVAR(spin_wait_delay),
@@ -99,6 +99,9 @@ class ha_innobase: public handler
 					ROW_SEL_EXACT, ROW_SEL_EXACT_PREFIX,
 					or undefined */
 	uint		num_write_row;	/*!< number of write_row() calls */
+	bool		ignore_dup_key;	/*!< true between
+					HA_EXTRA_IGNORE_DUP_KEY and
+					HA_EXTRA_NO_IGNORE_DUP_KEY */
 
 	ha_statistics*	ha_partition_stats; /*!< stats of the partition owner
 					handler (if there is one) */
@@ -148,6 +151,8 @@ class ha_innobase: public handler
 	my_bool is_fake_change_enabled(THD *thd);
 
 	int write_row(uchar * buf);
+	void start_bulk_insert(ha_rows rows, uint flags);
+	int end_bulk_insert();
 	int update_row(const uchar * old_data, uchar * new_data);
 	int delete_row(const uchar * buf);
 	bool was_semi_consistent_read();
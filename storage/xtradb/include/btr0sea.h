@@ -230,6 +230,60 @@ btr_search_index_init(
 	dict_index_t*	index)	/*!< in: index */
 	__attribute__((nonnull));
 
+/** Statistics of one adaptive hash index partition. The counters are
+not protected by any latch and may be slightly inaccurate. */
+struct btr_search_part_stats_t {
+	ulint	n_hits;		/*!< number of successful hash searches */
+	ulint	n_misses;	/*!< number of failed hash searches */
+	ulint	n_latch_waits;	/*!< number of times the partition latch
+				was found held in a conflicting mode
+				when it was requested */
+	byte	pad[CACHE_LINE_SIZE - 3 * sizeof(ulint)];
+				/*!< padding to keep the counters of
+				different partitions on different
+				cache lines */
+};
+
+/********************************************************************//**
+Returns the statistics of the adaptive hash index partition of an index.
+@return the statistics of the partition */
+UNIV_INLINE
+btr_search_part_stats_t*
+btr_search_get_part_stats(
+/*======================*/
+	const dict_index_t*	index)	/*!< in: index */
+	__attribute__((pure,warn_unused_result));
+
+/********************************************************************//**
+NOTE! Use the corresponding macro btr_search_s_lock(), not directly this
+function! Latches the adaptive hash index partition of an index in shared
+mode, counting the request in n_latch_waits of the partition if the latch
+is held in exclusive mode. */
+UNIV_INLINE
+void
+btr_search_s_lock_func(
+/*===================*/
+	const dict_index_t*	index,	/*!< in: index */
+	const char*		file,	/*!< in: file name */
+	ulint			line);	/*!< in: line in file */
+/********************************************************************//**
+NOTE! Use the corresponding macro btr_search_x_lock(), not directly this
+function! Latches the adaptive hash index partition of an index in
+exclusive mode, counting the request in n_latch_waits of the partition if
+the latch is held in any mode. */
+UNIV_INLINE
+void
+btr_search_x_lock_func(
+/*===================*/
+	const dict_index_t*	index,	/*!< in: index */
+	const char*		file,	/*!< in: file name */
+	ulint			line);	/*!< in: line in file */
+
+#define btr_search_s_lock(index)				\
+	btr_search_s_lock_func((index), __FILE__, __LINE__)
+#define btr_search_x_lock(index)				\
+	btr_search_x_lock_func((index), __FILE__, __LINE__)
+
 /********************************************************************//**
 Latches all adaptive hash index latches in exclusive mode.  */
 UNIV_INLINE
@@ -332,6 +386,10 @@ struct btr_search_sys_t{
 /** The adaptive hash index */
 extern btr_search_sys_t*	btr_search_sys;
 
+/** Statistics of the adaptive hash index partitions, indexed by the
+partition number */
+extern btr_search_part_stats_t*	btr_search_part_stats;
+
 #ifdef UNIV_SEARCH_PERF_STAT
 /** Number of successful adaptive hash index lookups */
 extern ulint	btr_search_n_succ;
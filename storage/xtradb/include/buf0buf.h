@@ -82,6 +82,9 @@ Created 11/5/1995 Heikki Tuuri
 					buffer pool watches */
 #define MAX_PAGE_HASH_LOCKS	1024	/*!< The maximum number of
 					page_hash locks */
+#define BUF_POOL_HOT_PAGES	1024	/*!< Number of slots in
+					buf_pool->hot_pages[]; must be a
+					power of two */
 
 extern	buf_pool_t*	buf_pool_ptr;	/*!< The buffer pools
 					of the database */
@@ -2014,6 +2017,16 @@ struct buf_pool_t{
 					whose frames are allocated to the
 					zip buddy system,
 					indexed by block->frame */
+#ifdef PAGE_ATOMIC_REF_COUNT
+	buf_block_t*	hot_pages[BUF_POOL_HOT_PAGES];
+					/*!< blocks recently found in
+					page_hash, indexed by the page
+					address fold. A hint for the
+					optimistic lookup in
+					buf_page_get_gen(), which validates
+					the block after buffer-fixing it;
+					accessed without any latch */
+#endif /* PAGE_ATOMIC_REF_COUNT */
 	ulint		n_pend_reads;	/*!< number of pending read
 					operations.  Accessed atomically */
 	ulint		n_pend_unzip;	/*!< number of pending decompressions.
@@ -2097,6 +2110,40 @@ struct buf_pool_t{
 					buffer pool. Accessed atomically. */
 	/* @} */
 
+	/** @name Adaptive flushing (innodb_adaptive_io_capacity) */
+	/* @{ */
+
+	ib_uint64_t	batch_start_us[BUF_FLUSH_N_TYPES];
+					/*!< ut_time_us() when the running
+					flush batch of each type was started;
+					protected by flush_state_mutex */
+	ulint		batch_written[BUF_FLUSH_N_TYPES];
+					/*!< number of pages of the running
+					flush batch whose write has completed;
+					protected by flush_state_mutex */
+	ulint		io_pages_per_sec;
+					/*!< write throughput of flush batches,
+					a moving average over the batches
+					measured so far, or 0 before the
+					first one; protected by
+					flush_state_mutex */
+	ulint		io_batch_us;	/*!< moving average of the time in
+					microseconds from the start of a flush
+					batch to the completion of its last
+					write; protected by flush_state_mutex */
+	ulint		LRU_scan_depth;	/*!< LRU scan depth of this instance
+					when innodb_adaptive_io_capacity=ON;
+					written only by the LRU manager
+					thread */
+	ulint		n_free_waits;	/*!< number of times that a thread
+					found the free list empty in
+					buf_LRU_get_free_block(); updated
+					atomically */
+	ulint		n_free_waits_old;
+					/*!< n_free_waits when the LRU scan
+					depth was last adjusted */
+	/* @} */
+
 	/** @name LRU replacement algorithm fields */
 	/* @{ */
 
@@ -222,6 +222,35 @@ UNIV_INTERN
 void
 buf_flush_wait_LRU_batch_end(void);
 /*==============================*/
+/*********************************************************************//**
+Returns the LRU scan depth of a buffer pool instance: the number of free
+pages that LRU batches try to keep in the free list, and the number of
+pages at the tail of the LRU list that they scan.
+@return innodb_lru_scan_depth, or the depth chosen for the instance by the
+adaptive flushing controller if innodb_adaptive_io_capacity=ON */
+UNIV_INTERN
+ulint
+buf_flush_LRU_scan_depth(
+/*=====================*/
+	const buf_pool_t*	buf_pool)	/*!< in: buffer pool instance */
+	__attribute__((nonnull, warn_unused_result));
+/*******************************************************************//**
+Divides a flush list flush among the buffer pool instances. With
+innodb_adaptive_io_capacity=ON every instance flushes a share proportional
+to its number of dirty pages, otherwise all instances flush an equal
+share. */
+UNIV_INTERN
+void
+buf_flush_list_batch_sizes(
+/*=======================*/
+	ulint		min_n,		/*!< in: wished minimum number of
+					pages flushed in total, or ULINT_MAX
+					to flush everything up to the
+					lsn limit */
+	ulint*		n_pages)	/*!< out: wished minimum number of
+					pages flushed from each buffer pool
+					instance */
+	__attribute__((nonnull));
 
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 /******************************************************************//**
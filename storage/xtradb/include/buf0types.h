@@ -26,9 +26,15 @@ Created 11/17/1995 Heikki Tuuri
 #ifndef buf0types_h
 #define buf0types_h
 
-#if defined(INNODB_PAGE_ATOMIC_REF_COUNT) && defined(HAVE_ATOMIC_BUILTINS)
+/* Test the build flags rather than HAVE_ATOMIC_BUILTINS, which is only
+defined once os0sync.h has been included, so that buf_page_t has the same
+layout in every compilation unit */
+#if defined(INNODB_PAGE_ATOMIC_REF_COUNT)			\
+	&& (defined(HAVE_IB_GCC_ATOMIC_BUILTINS)		\
+	    || defined(HAVE_IB_SOLARIS_ATOMICS)			\
+	    || defined(HAVE_WINDOWS_ATOMICS))
 #define PAGE_ATOMIC_REF_COUNT
-#endif /* INNODB_PAGE_ATOMIC_REF_COUNT && HAVE_ATOMIC_BUILTINS */
+#endif /* INNODB_PAGE_ATOMIC_REF_COUNT && atomic builtins */
 
 /** Buffer page (uncompressed or compressed) */
 struct buf_page_t;
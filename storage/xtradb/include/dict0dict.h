@@ -840,6 +840,18 @@ dict_table_n_rows_dec(
 /*==================*/
 	dict_table_t*	table)	/*!< in/out: table */
 	__attribute__((nonnull));
+/********************************************************************//**
+Add to the number of undo log records of the table that are waiting
+for purge. Atomic where supported, otherwise not protected by any latch;
+the number is approximate. */
+UNIV_INLINE
+void
+dict_table_purge_pending_add(
+/*=========================*/
+	dict_table_t*	table,	/*!< in/out: table */
+	lint		n)	/*!< in: number of records, negative
+				when records leave the purge queue */
+	__attribute__((nonnull));
 #ifdef UNIV_DEBUG
 /********************************************************************//**
 Gets the nth column of a table.
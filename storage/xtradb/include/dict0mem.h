@@ -1274,6 +1274,24 @@ struct dict_table_t{
 				/*!< Has persistent stats error beein
 				already printed for this table ? */
 				/* @} */
+	/*----------------------*/
+				/**!< Purge statistics. These are
+				approximate and only count the undo
+				log records written or purged since
+				the table was loaded into the
+				dictionary cache. */
+				/* @{ */
+	lint		purge_pending;
+				/*!< number of update or delete undo
+				log records of this table that have
+				not been purged yet; modified with
+				dict_table_purge_pending_add() */
+	ib_uint64_t	n_purged;
+				/*!< number of undo log records of
+				this table handed to the purge
+				threads; protected by
+				dict_sys->mutex */
+				/* @} */
 	/*----------------------*/
 				/**!< The following fields are used by the
 				AUTOINC code.  The actual collection of
@@ -38,6 +38,7 @@ Created 5/7/1996 Heikki Tuuri
 #include "hash0hash.h"
 #include "srv0srv.h"
 #include "ut0vec.h"
+#include "sync0rw.h"
 
 #ifdef UNIV_DEBUG
 extern ibool	lock_print_waits;
@@ -479,6 +480,18 @@ lock_table(
 	que_thr_t*	thr)	/*!< in: query thread */
 	__attribute__((nonnull, warn_unused_result));
 /*********************************************************************//**
+Locks the specified database table in X mode if no other transaction
+holds or waits for a lock on it. Unlike lock_table(), never waits.
+@return	DB_SUCCESS, or DB_LOCK_WAIT if the lock could not be granted */
+UNIV_INTERN
+dberr_t
+lock_table_x_nowait(
+/*================*/
+	dict_table_t*	table,	/*!< in/out: database table
+				in dictionary cache */
+	trx_t*		trx)	/*!< in/out: transaction */
+	__attribute__((nonnull, warn_unused_result));
+/*********************************************************************//**
 Creates a table IX lock object for a resurrected transaction. */
 UNIV_INTERN
 void
@@ -929,13 +942,45 @@ struct lock_op_t{
 	enum lock_mode	mode;	/*!< lock mode */
 };
 
-/** The lock system struct */
+/** Number of partitions of the record lock hash table, each protected
+by its own mutex in lock_sys_t::rec_mutexes */
+#define LOCK_REC_PARTITIONS	64
+
+/** Number of mutexes in lock_sys_t::table_mutexes */
+#define LOCK_TABLE_PARTITIONS	16
+
+/** The lock system struct
+
+The locks are protected by lock_sys->latch. A thread holding it in X mode
+may access any lock queue, this is needed for example for deadlock
+detection and for moving the locks of records between pages.
+
+The common operations, which only access the lock queue of one page or of
+one table and never wait, run in S mode: setting a record lock when the
+queue of the page has no conflicting requests, checking for conflicts of an
+insert, setting an IS or IX table lock and releasing the locks of a
+committing transaction. In S mode, the record lock queues of the pages are
+protected by the mutex of their partition of the hash table, selected by
+the hash value of the page (lock_rec_hash()) in rec_mutexes, and the table
+lock queues by the mutex of the table in table_mutexes. An S mode operation
+that finds a conflicting request releases the latch and retries in X mode;
+lock waits are only enqueued in X mode. */
 struct lock_sys_t{
-	ib_mutex_t	mutex;			/*!< Mutex protecting the
+	rw_lock_t	latch;			/*!< Latch protecting the
 						locks */
+	ib_mutex_t	rec_mutexes[LOCK_REC_PARTITIONS];
+						/*!< Mutexes protecting the
+						partitions of rec_hash when
+						latch is held in S mode */
+	ib_mutex_t	table_mutexes[LOCK_TABLE_PARTITIONS];
+						/*!< Mutexes protecting the
+						table lock queues when latch
+						is held in S mode */
 	hash_table_t*	rec_hash;		/*!< hash table of the record
 						locks */
-	ulint		rec_num;
+	ulint		rec_num;		/*!< number of record locks,
+						updated with atomic
+						operations */
 	ib_mutex_t	wait_mutex;		/*!< Mutex protecting the
 						next two fields */
 	srv_slot_t*	waiting_threads;	/*!< Array  of user threads
@@ -950,7 +995,7 @@ struct lock_sys_t{
 						/*!< TRUE if rollback of all
 						recovered transactions is
 						complete. Protected by
-						lock_sys->mutex */
+						lock_sys->latch in X mode */
 
 	ulint		n_lock_max_wait_time;	/*!< Max wait time */
 
@@ -966,20 +1011,46 @@ struct lock_sys_t{
 /** The lock system */
 extern lock_sys_t*	lock_sys;
 
-/** Test if lock_sys->mutex can be acquired without waiting. */
-#define lock_mutex_enter_nowait() mutex_enter_nowait(&lock_sys->mutex)
+/** Test if lock_sys->latch can be acquired in X mode without waiting.
+@return 0 if the latch was acquired */
+#define lock_mutex_enter_nowait()			\
+	(!rw_lock_x_lock_nowait(&lock_sys->latch))
 
-/** Test if lock_sys->mutex is owned. */
-#define lock_mutex_own() mutex_own(&lock_sys->mutex)
+/** Test if lock_sys->latch is owned in X mode. */
+#define lock_mutex_own()				\
+	(rw_lock_get_writer(&lock_sys->latch) == RW_LOCK_EX	\
+	 && lock_sys->latch.recursive			\
+	 && os_thread_eq(lock_sys->latch.writer_thread,	\
+			 os_thread_get_curr_id()))
 
-/** Acquire the lock_sys->mutex. */
+/** Acquire the lock_sys->latch in X mode. */
 #define lock_mutex_enter() do {			\
-	mutex_enter(&lock_sys->mutex);		\
+	rw_lock_x_lock(&lock_sys->latch);	\
 } while (0)
 
-/** Release the lock_sys->mutex. */
+/** Release the lock_sys->latch from X mode. */
 #define lock_mutex_exit() do {			\
-	mutex_exit(&lock_sys->mutex);		\
+	rw_lock_x_unlock(&lock_sys->latch);	\
+} while (0)
+
+/** Test if lock_sys->latch is held in S mode. Without UNIV_SYNC_DEBUG
+this only tells that some thread holds it. */
+#ifdef UNIV_SYNC_DEBUG
+# define lock_mutex_own_shared()			\
+	rw_lock_own(&lock_sys->latch, RW_LOCK_SHARED)
+#else
+# define lock_mutex_own_shared()			\
+	(rw_lock_get_reader_count(&lock_sys->latch) > 0)
+#endif /* UNIV_SYNC_DEBUG */
+
+/** Acquire the lock_sys->latch in S mode. */
+#define lock_mutex_enter_shared() do {		\
+	rw_lock_s_lock(&lock_sys->latch);	\
+} while (0)
+
+/** Release the lock_sys->latch from S mode. */
+#define lock_mutex_exit_shared() do {		\
+	rw_lock_s_unlock(&lock_sys->latch);	\
 } while (0)
 
 /** Test if lock_sys->wait_mutex is owned. */
@@ -77,6 +77,8 @@ extern log_checksum_func_t log_checksum_algorithm_ptr;
 #define LOG_WAIT_ONE_GROUP	92
 #define	LOG_WAIT_ALL_GROUPS	93
 /* @} */
+/** Number of events in log_t::write_events and log_t::flush_events */
+#define LOG_N_WAIT_EVENTS	32
 /** Maximum number of log groups in log_group_t::checkpoint_buf */
 #define LOG_MAX_N_GROUPS	32
 
@@ -102,23 +104,6 @@ log_calc_where_lsn_is(
 	ib_int64_t	log_file_size);		/*!< in: log file size
 						(including the header) */
 #ifndef UNIV_HOTBACKUP
-/************************************************************//**
-Writes to the log the string given. The log must be released with
-log_release.
-@return	end lsn of the log record, zero if did not succeed */
-UNIV_INLINE
-lsn_t
-log_reserve_and_write_fast(
-/*=======================*/
-	const void*	str,	/*!< in: string */
-	ulint		len,	/*!< in: string length */
-	lsn_t*		start_lsn);/*!< out: start lsn of the log record */
-/***********************************************************************//**
-Releases the log mutex. */
-UNIV_INLINE
-void
-log_release(void);
-/*=============*/
 /***********************************************************************//**
 Checks if there is need for a log buffer flush or a new checkpoint, and does
 this if yes. Any database operation should call this when it has modified
@@ -128,39 +113,38 @@ UNIV_INLINE
 void
 log_free_check(void);
 /*================*/
-/**************************************************************************//**
-Locks the log mutex and opens the log for log_write_low. The log must be closed
-with log_close and released with log_release.
-@return start lsn of the log record */
-UNIV_INLINE
-lsn_t
-log_reserve_and_open(
-/*=================*/
-	ulint	len);	/*!< in: length of data to be catenated */
 /************************************************************//**
-Opens the log for log_write_low. The log must be closed with log_close.
-@return	start lsn of the log record */
+Opens the log for log_write_low: reserves space for len bytes of log
+records at the end of the log. Does not wait: the space in the log
+buffer is waited for in log_write_low. The log must be closed with
+log_close.
+@return	start lsn of the log records */
 UNIV_INTERN
 lsn_t
 log_open(
 /*=====*/
-	ulint	len);	/*!< in: length of data to be catenated */
+	ulint	len,		/*!< in: length of data to be catenated */
+	lsn_t*	end_lsn);	/*!< out: end lsn of the log records */
 /************************************************************//**
-Writes to the log the string given. It is assumed that the caller holds the
-log mutex. */
+Writes to the log the string given, in the space reserved with log_open.
+Several threads may copy to the log buffer at the same time.
+@return	lsn where the next string of the reserved space starts */
 UNIV_INTERN
-void
+lsn_t
 log_write_low(
 /*==========*/
-	byte*	str,		/*!< in: string */
-	ulint	str_len);	/*!< in: string length */
+	const byte*	str,	/*!< in: string */
+	ulint		str_len,/*!< in: string length */
+	lsn_t		lsn,	/*!< in: lsn where to write the string */
+	lsn_t		end_lsn);/*!< in: end lsn of the reserved space */
 /************************************************************//**
-Closes the log.
-@return	lsn */
+Closes the log: checks if a log flush or a checkpoint is needed after the
+log records ending at end_lsn were written. */
 UNIV_INTERN
-lsn_t
-log_close(void);
-/*===========*/
+void
+log_close(
+/*======*/
+	lsn_t	end_lsn);	/*!< in: end lsn returned by log_open */
 /************************************************************//**
 Gets the current lsn.
 @return	current lsn */
@@ -204,6 +188,34 @@ UNIV_INTERN
 void
 log_init(void);
 /*==========*/
+/******************************************************//**
+Starts the log buffer at an lsn, after the log has been initialized,
+recovered or created. The caller must own log_sys->mutex. */
+UNIV_INTERN
+void
+log_buf_start(
+/*==========*/
+	lsn_t		lsn,		/*!< in: current lsn */
+	lsn_t		written_lsn,	/*!< in: the log is on disk up to
+					this lsn; either lsn or the start of
+					its log block */
+	const byte*	block);		/*!< in: the log block of lsn, or
+					NULL to initialize an empty block */
+/******************************************************//**
+Creates the log writer and log flusher threads. From then on, the log
+buffer is written and flushed to the log files by these threads. */
+UNIV_INTERN
+void
+log_threads_start(void);
+/*===================*/
+/******************************************************//**
+Writes and flushes the whole log buffer and stops the log writer and
+log flusher threads. From then on, log_write_up_to() does the writes
+and flushes itself. */
+UNIV_INTERN
+void
+log_threads_stop(void);
+/*==================*/
 /******************************************************************//**
 Inits a log group to the log system. */
 UNIV_INTERN
@@ -452,10 +464,13 @@ log_group_write_buf(
 	lsn_t		start_lsn,	/*!< in: start lsn of the buffer; must
 					be divisible by
 					OS_FILE_LOG_BLOCK_SIZE */
-	ulint		new_data_offset);/*!< in: start offset of new data in
+	ulint		new_data_offset,/*!< in: start offset of new data in
 					buf: this parameter is used to decide
 					if we have to write a new log file
 					header */
+	bool		encrypt);	/*!< in: whether to encrypt the
+					blocks; the caller must own
+					log_sys->mutex then */
 /********************************************************//**
 Sets the field values in group to correspond to a given lsn. For this function
 to work, the values must already be correctly initialized to correspond to
@@ -860,35 +875,47 @@ struct log_t{
 	byte		pad[64];	/*!< padding to prevent other memory
 					update hotspots from residing on the
 					same memory cache line */
-	lsn_t		lsn;		/*!< log sequence number */
-	ulint		buf_free;	/*!< first free offset within the log
-					buffer */
+	lsn_t		lsn;		/*!< log sequence number: the end of
+					the log space reserved so far by
+					log_open(), which advances it with a
+					compare-and-swap; the log buffer
+					contents may be incomplete below
+					this lsn while mini-transactions are
+					still copying their log records */
+	byte		lsn_pad[64];	/*!< padding to keep the lsn alone on
+					its cache line */
 #ifndef UNIV_HOTBACKUP
+# ifndef HAVE_ATOMIC_BUILTINS_64
+	ib_mutex_t	lsn_mutex;	/*!< mutex protecting lsn and buf_fill
+					where 64-bit atomic operations are not
+					available; nothing is latched while
+					holding it */
+# endif /* !HAVE_ATOMIC_BUILTINS_64 */
 	ib_prio_mutex_t		mutex;		/*!< mutex protecting the log */
 
 	ib_mutex_t		log_flush_order_mutex;/*!< mutex to serialize access to
 					the flush list when we are putting
 					dirty blocks in the list. The idea
-					behind this mutex is to be able
-					to release log_sys->mutex during
-					mtr_commit and still ensure that
-					insertions in the flush_list happen
-					in the LSN order. */
+					behind this mutex is that log space
+					is reserved in log_open() while
+					holding it, so that insertions in
+					the flush_list happen in the LSN
+					order. */
 #endif /* !UNIV_HOTBACKUP */
 	byte*		buf_ptr;	/* unaligned log buffer */
-	byte*		buf;		/*!< log buffer */
+	byte*		buf;		/*!< log buffer: a ring of log blocks
+					where the block of an lsn is at
+					(lsn % buf_size) */
 	ulint		buf_size;	/*!< log buffer size in bytes */
+	ulint*		buf_fill;	/*!< for each block of buf, the number
+					of its bytes which have been copied
+					there; a block can be written to
+					the log files when its count equals
+					OS_FILE_LOG_BLOCK_SIZE, or the lsn
+					within the block for the last one */
 	ulint		max_buf_free;	/*!< recommended maximum value of
-					buf_free, after which the buffer is
-					flushed */
- #ifdef UNIV_LOG_DEBUG
-	ulint		old_buf_free;	/*!< value of buf free when log was
-					last time opened; only in the debug
-					version */
-	ib_uint64_t	old_lsn;	/*!< value of lsn when log was
-					last time opened; only in the
-					debug version */
-#endif /* UNIV_LOG_DEBUG */
+					lsn - write_lsn, after which the
+					buffer is written */
 	ibool		check_flush_or_checkpoint;
 					/*!< this is set to TRUE when there may
 					be need to flush the log buffer, or
@@ -904,15 +931,31 @@ struct log_t{
 #ifndef UNIV_HOTBACKUP
 	/** The fields involved in the log buffer flush @{ */
 
-	ulint		buf_next_to_write;/*!< first offset in the log buffer
-					where the byte content may not exist
-					written to file, e.g., the start
-					offset of a log record catenated
-					later; this is advanced when a flush
-					operation is completed to all the log
-					groups */
-	volatile bool	is_extending;	/*!< this is set to true during extend
-					the log buffer size */
+	ib_mutex_t	write_mutex;	/*!< serializes the writes of the log
+					buffer to the log files; protects
+					write_buf */
+	ib_mutex_t	flush_mutex;	/*!< serializes the flushes of the
+					log files to disk */
+	byte*		write_buf_ptr;	/*!< unaligned write_buf */
+	byte*		write_buf;	/*!< the blocks to write are copied
+					here from buf and completed with
+					their header and checksum, so that
+					buf can be filled meanwhile */
+	lsn_t		write_req_lsn;	/*!< the log writer thread has been
+					requested to write the log up to
+					this lsn */
+	lsn_t		flush_req_lsn;	/*!< the log flusher thread has been
+					requested to flush the log up to
+					this lsn */
+	os_event_t	writer_event;	/*!< wakes up the log writer thread */
+	os_event_t	flusher_event;	/*!< wakes up the log flusher thread */
+	os_event_t	write_events[LOG_N_WAIT_EVENTS];
+					/*!< a thread waiting for write_lsn to
+					reach an lsn waits for the event of
+					the log block of the lsn; the event is
+					set when write_lsn passes the block */
+	os_event_t	flush_events[LOG_N_WAIT_EVENTS];
+					/*!< the same for flushed_to_disk_lsn */
 	lsn_t		written_to_some_lsn;
 					/*!< first log sequence number not yet
 					written to any log group; for this to
@@ -935,43 +978,13 @@ struct log_t{
 					flushed_to_disk_lsn or
 					write_lsn which are always
 					up-to-date and accurate. */
-	lsn_t		write_lsn;	/*!< end lsn for the current running
-					write */
-	ulint		write_end_offset;/*!< the data in buffer has
-					been written up to this offset
-					when the current write ends:
-					this field will then be copied
-					to buf_next_to_write */
-	lsn_t		current_flush_lsn;/*!< end lsn for the current running
-					write + flush operation */
+	lsn_t		write_lsn;	/*!< the log has been written to the
+					log files up to this lsn */
 	lsn_t		flushed_to_disk_lsn;
 					/*!< how far we have written the log
 					AND flushed to disk */
 	ulint		n_pending_writes;/*!< number of currently
 					pending flushes or writes */
-	/* NOTE on the 'flush' in names of the fields below: starting from
-	4.0.14, we separate the write of the log file and the actual fsync()
-	or other method to flush it to disk. The names below shhould really
-	be 'flush_or_write'! */
-	os_event_t	no_flush_event;	/*!< this event is in the reset state
-					when a flush or a write is running;
-					a thread should wait for this without
-					owning the log mutex, but NOTE that
-					to set or reset this event, the
-					thread MUST own the log mutex! */
-	ibool		one_flushed;	/*!< during a flush, this is
-					first FALSE and becomes TRUE
-					when one log group has been
-					written or flushed */
-	os_event_t	one_flushed_event;/*!< this event is reset when the
-					flush or write has not yet completed
-					for any log group; e.g., this means
-					that a transaction has been committed
-					when this is set; a thread should wait
-					for this without owning the log mutex,
-					but NOTE that to set or reset this
-					event, the thread MUST own the log
-					mutex! */
 	ulint		n_log_ios;	/*!< number of log i/os initiated thus
 					far */
 	ulint		n_log_ios_old;	/*!< number of log i/o's at the
@@ -398,6 +398,11 @@ compare to, new_val is the value to swap in. */
 #  define os_compare_and_swap_uint32(ptr, old_val, new_val) \
 	os_compare_and_swap(ptr, old_val, new_val)
 
+# ifdef HAVE_IB_GCC_ATOMIC_BUILTINS_64
+#  define os_compare_and_swap_uint64(ptr, old_val, new_val) \
+	os_compare_and_swap(ptr, old_val, new_val)
+# endif
+
 # ifdef HAVE_IB_ATOMIC_PTHREAD_T_GCC
 #  define os_compare_and_swap_thread_id(ptr, old_val, new_val) \
 	os_compare_and_swap(ptr, old_val, new_val)
@@ -499,6 +504,9 @@ compare to, new_val is the value to swap in. */
 # define os_compare_and_swap_lint(ptr, old_val, new_val) \
 	((lint) atomic_cas_ulong((ulong_t*) ptr, old_val, new_val) == old_val)
 
+# define os_compare_and_swap_uint64(ptr, old_val, new_val) \
+	(atomic_cas_64((uint64_t*) ptr, old_val, new_val) == old_val)
+
 # ifdef HAVE_IB_ATOMIC_PTHREAD_T_SOLARIS
 #  if SIZEOF_PTHREAD_T == 4
 #   define os_compare_and_swap_thread_id(ptr, old_val, new_val) \
@@ -629,6 +637,14 @@ compare to, new_val is the value to swap in. */
 # define os_compare_and_swap_lint(ptr, old_val, new_val) \
 	(win_cmp_and_xchg_lint(ptr, new_val, old_val) == old_val)
 
+# ifndef _WIN32
+#  define os_compare_and_swap_uint64(ptr, old_val, new_val)		\
+	((ib_uint64_t) InterlockedCompareExchange64(			\
+		(volatile ib_int64_t*) ptr,				\
+		(ib_int64_t) new_val,					\
+		(ib_int64_t) old_val) == (ib_uint64_t) old_val)
+# endif
+
 /* windows thread objects can always be passed to windows atomic functions */
 # define os_compare_and_swap_thread_id(ptr, old_val, new_val) \
 	(win_cmp_and_xchg_dword(ptr, new_val, old_val) == old_val)
@@ -788,6 +804,25 @@ architecture. Disable memory barrier for Intel architecture for now. */
 	"Memory barrier is not used"
 #endif
 
+/** Barriers for lock-free readers that validate what they read with a
+version number, such as read_view_open_now(). Unlike os_rmb and os_wmb
+these are never no-ops: on x86, where the hardware does not reorder
+loads with loads or stores with stores, they keep the compiler from
+doing it. */
+#if defined(HAVE_IB_GCC_ATOMIC_THREAD_FENCE)
+# define os_rmb_strict	__atomic_thread_fence(__ATOMIC_ACQUIRE)
+# define os_wmb_strict	__atomic_thread_fence(__ATOMIC_RELEASE)
+#elif defined(HAVE_IB_GCC_SYNC_SYNCHRONISE)
+# define os_rmb_strict	__sync_synchronize()
+# define os_wmb_strict	__sync_synchronize()
+#elif defined(__WIN__)
+# define os_rmb_strict	MemoryBarrier()
+# define os_wmb_strict	MemoryBarrier()
+#else
+# define os_rmb_strict	os_rmb
+# define os_wmb_strict	os_wmb
+#endif
+
 #ifndef UNIV_NONINL
 #include "os0sync.ic"
 #endif
@@ -38,22 +38,23 @@ Created 2/16/1997 Heikki Tuuri
 
 /*********************************************************************//**
 Opens a read view where exactly the transactions serialized before this
-point in time are seen in the view.
+point in time are seen in the view. This does not normally acquire
+trx_sys->mutex. The view is put on trx_sys->view_list when it is
+created, and stays there until read_view_free().
 @return	own: read view struct */
 UNIV_INTERN
 read_view_t*
 read_view_open_now(
 /*===============*/
 	trx_id_t	cr_trx_id,	/*!< in: trx_id of creating
-					transaction, or 0 used in purge */
+					transaction, or 0 if the transaction
+					does not modify anything */
 	read_view_t*&	view);		/*!< in,out: pre-allocated view array or
 					NULL if a new one needs to be created */
 
 /*********************************************************************//**
-Clones a read view object. This function will allocate space for two read
-views contiguously, one identical in size and content as @param view (starting
-at returned pointer) and another view immediately following the trx_ids array.
-The second view will have space for an extra trx_id_t element.
+Clones a read view object. The view must have been pinned with
+read_view_pin(). The clone is not open and not on trx_sys->view_list.
 @return	read view struct */
 UNIV_INTERN
 read_view_t*
@@ -63,14 +64,50 @@ read_view_clone(
 	read_view_t*&		prebuilt_clone);/*!< in,out: prebuilt view or
 						NULL */
 /*********************************************************************//**
-Insert the view in the proper order into the trx_sys->view_list. The
-read view list is ordered by read_view_t::low_limit_no in descending order. */
+Opens a view made by read_view_clone(), and puts it on trx_sys->view_list
+unless it is already there. The caller must own trx_sys->mutex. */
 UNIV_INTERN
 void
 read_view_add(
 /*==========*/
 	read_view_t*	view);		/*!< in: view to add to */
 /*********************************************************************//**
+Keeps an open view on trx_sys->view_list from being closed, so that it
+can be read by another thread than its owner. Waits if the view is being
+opened. The caller must own trx_sys->mutex.
+@return	true if the view was open and is now pinned */
+UNIV_INTERN
+bool
+read_view_pin(
+/*==========*/
+	read_view_t*	view);		/*!< in/out: read view */
+/*********************************************************************//**
+Releases a view that was pinned with read_view_pin(). */
+UNIV_INTERN
+void
+read_view_unpin(
+/*============*/
+	read_view_t*	view);		/*!< in/out: read view */
+/*********************************************************************//**
+Finds the oldest open view on trx_sys->view_list and pins it. The
+caller must own trx_sys->mutex, and release the view with
+read_view_unpin().
+@return	the oldest open view, or NULL if no view is open */
+UNIV_INTERN
+read_view_t*
+read_view_pin_oldest(
+/*=================*/
+	ulint*	n_open);		/*!< out: number of open views, or
+					NULL */
+/*********************************************************************//**
+Counts the open views on trx_sys->view_list. The caller must own
+trx_sys->mutex.
+@return	number of open views */
+UNIV_INTERN
+ulint
+read_view_count_open(void);
+/*======================*/
+/*********************************************************************//**
 Makes a copy of the oldest existing read view, or opens a new. The view
 must be closed with ..._close.
 @return	own: read view struct */
@@ -84,16 +121,16 @@ read_view_purge_open(
 	read_view_t*&	view);		/*!< in,out: pre-allocated view array or
 					NULL if a new one needs to be created */
 /*********************************************************************//**
-Remove a read view from the trx_sys->view_list. */
-UNIV_INLINE
+Closes a read view that was opened by read_view_open_now() or
+read_view_add(). The view stays on trx_sys->view_list. */
+UNIV_INTERN
 void
-read_view_remove(
-/*=============*/
-	read_view_t*	view,		/*!< in: read view, can be 0 */
-	bool		own_mutex);	/*!< in: true if caller owns the
-					trx_sys_t::mutex */
+read_view_close(
+/*============*/
+	read_view_t*	view);		/*!< in: read view, can be 0 */
 /*********************************************************************//**
-Frees memory allocated by a read view. */
+Frees memory allocated by a read view, and removes it from
+trx_sys->view_list. */
 UNIV_INTERN
 void
 read_view_free(
@@ -195,10 +232,28 @@ struct read_view_t{
 	trx_id_t	creator_trx_id;
 				/*!< trx id of creating transaction, or
 				0 used in purge */
+	volatile ulint	state;	/*!< READ_VIEW_CLOSED, READ_VIEW_OPENING,
+				READ_VIEW_OPEN or READ_VIEW_PINNED; changed
+				with atomic operations */
+	bool		in_view_list;
+				/*!< true if the view is on
+				trx_sys->view_list */
 	UT_LIST_NODE_T(read_view_t) view_list;
 				/*!< List of read views in trx_sys */
 };
 
+/** Read view states. The owner of a view opens and closes it without
+trx_sys->mutex; threads that read the views of others, such as purge,
+hold trx_sys->mutex and pin the view while they read it. @{ */
+#define READ_VIEW_CLOSED	0	/*!< The view is not in use */
+#define READ_VIEW_OPENING	1	/*!< read_view_open_now() is copying
+					the snapshot to the view */
+#define READ_VIEW_OPEN		2	/*!< The view is in use */
+#define READ_VIEW_PINNED	3	/*!< The view is in use, and being
+					read by another thread; it cannot be
+					closed until read_view_unpin() */
+/* @} */
+
 /** Read view types @{ */
 #define VIEW_NORMAL		1	/*!< Normal consistent read view
 					where transaction does not see changes
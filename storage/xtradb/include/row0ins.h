@@ -216,6 +216,11 @@ struct ins_node_t{
 				entry_list and sys fields are stored here;
 				if this is NULL, entry list should be created
 				and buffers for sys fields in row allocated */
+	bool		defer_sec;
+				/*!< true if only the clustered index
+				entry is to be inserted; the caller
+				buffers the secondary index entries
+				(see row_merge_bulk_add()) */
 	ulint		magic_n;
 };
 
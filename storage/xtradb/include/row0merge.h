@@ -397,7 +397,11 @@ row_merge_sort(
 	const float		pct_cost, /*!< in: current progress percent */
 	fil_space_crypt_t*	crypt_data,/*!< in: table crypt data */
 	row_merge_block_t*	crypt_block, /*!< in: crypt buf or NULL */
-	ulint			space)	   /*!< in: space id */
+	ulint			space,	   /*!< in: space id */
+	ulint			n_threads) /*!< in: number of threads
+					   merging the runs; a unique index
+					   with duplicate reporting is merged
+					   in one thread */
 	__attribute__((nonnull(1,2,3,4,5)));
 /*********************************************************************//**
 Allocate a sort buffer.
@@ -461,4 +465,55 @@ row_merge_read_rec(
 	row_merge_block_t*	crypt_block, /*!< in: crypt buf or NULL */
 	ulint			space)	   /*!< in: space id */
 	__attribute__((nonnull(1,2,3,4,6,7,8), warn_unused_result));
+
+/** Secondary index entries of a bulk insert into an empty table. The
+entries are sorted like in index creation, and inserted when the
+statement ends. */
+struct row_merge_bulk_t;
+
+/*********************************************************************//**
+Start a bulk insert into a table. The table must be empty and no other
+transaction may hold locks on it; it is X-locked by trx. After this,
+the rows should be inserted with ins_node_t::defer_sec set.
+@return bulk insert state, or NULL if a bulk insert is not possible */
+UNIV_INTERN
+row_merge_bulk_t*
+row_merge_bulk_start(
+/*=================*/
+	trx_t*		trx,		/*!< in/out: transaction */
+	dict_table_t*	table,		/*!< in/out: table to insert into */
+	struct TABLE*	mysql_table)	/*!< in/out: MySQL table, for
+					reporting duplicate key values */
+	__attribute__((nonnull, warn_unused_result));
+/*********************************************************************//**
+Buffer the secondary index entries of a row that was inserted into the
+clustered index.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+row_merge_bulk_add(
+/*===============*/
+	row_merge_bulk_t*	bulk,	/*!< in/out: bulk insert state */
+	const dtuple_t*		row,	/*!< in: inserted row */
+	trx_t*			trx)	/*!< in/out: transaction */
+	__attribute__((nonnull, warn_unused_result));
+/*********************************************************************//**
+Sort the buffered secondary index entries and insert them into the
+indexes, and free the bulk insert state.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+row_merge_bulk_finish(
+/*==================*/
+	row_merge_bulk_t*	bulk,	/*!< in,own: bulk insert state */
+	trx_t*			trx)	/*!< in/out: transaction */
+	__attribute__((nonnull, warn_unused_result));
+/*********************************************************************//**
+Free a bulk insert state without inserting the buffered entries. */
+UNIV_INTERN
+void
+row_merge_bulk_free(
+/*================*/
+	row_merge_bulk_t*	bulk)	/*!< in,own: bulk insert state */
+	__attribute__((nonnull));
 #endif /* row0merge.h */
@@ -43,6 +43,7 @@ struct SysIndexCallback;
 extern ibool row_rollback_on_timeout;
 
 struct row_prebuilt_t;
+struct row_merge_bulk_t;
 
 /*******************************************************************//**
 Frees the blob heap in prebuilt when no longer needed. */
@@ -736,6 +737,10 @@ struct row_prebuilt_t {
 	ins_node_t*	ins_node;	/*!< Innobase SQL insert node
 					used to perform inserts
 					to the table */
+	row_merge_bulk_t* bulk;		/*!< secondary index entries of
+					a bulk insert into an empty
+					table, or NULL; see
+					ha_innobase::start_bulk_insert() */
 	byte*		ins_upd_rec_buff;/*!< buffer for storing data converted
 					to the Innobase format from the MySQL
 					format */
@@ -102,6 +102,12 @@ enum monitor_type_t {
 #define	MIN_RESERVED		((mon_type_t) (IB_UINT64_MAX >> 1))
 #define	MAX_RESERVED		(~MIN_RESERVED)
 
+/** Maximum number of Adaptive Hash Index partitions that have their own
+counters; this is the maximum of innodb_adaptive_hash_index_partitions */
+#define MONITOR_AHI_N_PARTITIONS		64
+/** Number of counters of each Adaptive Hash Index partition */
+#define MONITOR_AHI_PARTITION_N_COUNTERS	3
+
 /** This enumeration defines internal monitor identifier used internally
 to identify each particular counter. Its value indexes into two arrays,
 one is the "innodb_counter_value" array which records actual monitor
@@ -186,6 +192,9 @@ enum monitor_id_t {
 	MONITOR_FLUSH_LSN_AVG_RATE,
 	MONITOR_FLUSH_PCT_FOR_DIRTY,
 	MONITOR_FLUSH_PCT_FOR_LSN,
+	MONITOR_FLUSH_IO_CAPACITY,
+	MONITOR_FLUSH_IO_CAPACITY_MEASURED,
+	MONITOR_FLUSH_BATCH_TIME_AVG,
 	MONITOR_FLUSH_SYNC_WAITS,
 	MONITOR_FLUSH_ADAPTIVE_TOTAL_PAGE,
 	MONITOR_FLUSH_ADAPTIVE_COUNT,
@@ -210,6 +219,7 @@ enum monitor_id_t {
 	MONITOR_LRU_SINGLE_FLUSH_SCANNED_PER_CALL,
 	MONITOR_LRU_SINGLE_FLUSH_FAILURE_COUNT,
 	MONITOR_LRU_GET_FREE_SEARCH,
+	MONITOR_LRU_SCAN_DEPTH,
 	MONITOR_LRU_SEARCH_SCANNED,
 	MONITOR_LRU_SEARCH_SCANNED_NUM_CALL,
 	MONITOR_LRU_SEARCH_SCANNED_PER_CALL,
@@ -354,6 +364,13 @@ enum monitor_id_t {
 	MONITOR_ADAPTIVE_HASH_ROW_REMOVED,
 	MONITOR_ADAPTIVE_HASH_ROW_REMOVE_NOT_FOUND,
 	MONITOR_ADAPTIVE_HASH_ROW_UPDATED,
+	/* MONITOR_AHI_PARTITION_N_COUNTERS counters for each of the
+	MONITOR_AHI_N_PARTITIONS Adaptive Hash Index partitions:
+	hits, misses and latch waits */
+	MONITOR_OVLD_AHI_PARTITION_FIRST,
+	MONITOR_OVLD_AHI_PARTITION_LAST = MONITOR_OVLD_AHI_PARTITION_FIRST
+		+ MONITOR_AHI_N_PARTITIONS * MONITOR_AHI_PARTITION_N_COUNTERS
+		- 1,
 
 	/* Tablespace related counters */
 	MONITOR_MODULE_FIL_SYSTEM,
@@ -412,6 +429,7 @@ enum monitor_id_t {
 	MONITOR_BACKGROUND_DROP_TABLE,
 	MONITOR_ONLINE_CREATE_INDEX,
 	MONITOR_PENDING_ALTER_TABLE,
+	MONITOR_BULK_LOAD_ROWS,
 
 	MONITOR_MODULE_ICP,
 	MONITOR_ICP_ATTEMPTS,
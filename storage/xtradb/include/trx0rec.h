@@ -71,6 +71,18 @@ trx_undo_rec_get_extern_storage(
 /*============================*/
 	const trx_undo_rec_t*	undo_rec);	/*!< in: undo log record */
 /**********************************************************************//**
+Determines if purge has to process an update undo log record, that is,
+if it delete-marks a record, changes an ordering field of a secondary
+index or frees an externally stored field.
+@return	true if purge has work to do for the record */
+UNIV_INTERN
+bool
+trx_undo_rec_needs_purge(
+/*=====================*/
+	const trx_undo_rec_t*	undo_rec)	/*!< in: update undo log
+						record */
+	__attribute__((nonnull, warn_unused_result));
+/**********************************************************************//**
 Reads the undo log record number.
 @return	undo no */
 UNIV_INLINE
@@ -186,6 +186,21 @@ UNIV_INLINE
 trx_id_t
 trx_sys_get_max_trx_id(void);
 /*========================*/
+/*****************************************************************//**
+Starts a change of the state that read views are copied from:
+trx_sys->descriptors, max_trx_id and serial_min_no. Readers that see
+trx_sys->descr_version change, or see it odd, copy again. The caller
+must own trx_sys->mutex. */
+UNIV_INLINE
+void
+trx_sys_snapshot_change_start(void);
+/*===============================*/
+/*****************************************************************//**
+Ends a change started with trx_sys_snapshot_change_start(). */
+UNIV_INLINE
+void
+trx_sys_snapshot_change_end(void);
+/*=============================*/
 
 /*************************************************************//**
 Find a slot for a given trx ID in a descriptors array.
@@ -653,6 +668,9 @@ identifier is added to this 64-bit constant. */
 /* @} */
 
 #define TRX_DESCR_ARRAY_INITIAL_SIZE 	1000
+/** Maximum number of times the descriptors array can be enlarged. It
+doubles every time, so this is never reached. */
+#define TRX_DESCR_N_RETIRED		32
 
 #ifndef UNIV_HOTBACKUP
 /** The transaction system central memory data structure. */
@@ -674,11 +692,30 @@ struct trx_sys_t{
 	trx_id_t	max_trx_id;	/*!< The smallest number not yet
 					assigned as a transaction id or
 					transaction number */
+	trx_id_t	serial_min_no;	/*!< trx->no of the first transaction
+					in trx_serial_list, or TRX_ID_MAX if
+					the list is empty */
 	char		pad1[64];	/*!< Ensure max_trx_id does not share
 					cache line with other fields. */
+	volatile ulint	descr_version;	/*!< Incremented before and after
+					every change of descriptors,
+					max_trx_id and serial_min_no, so
+					that it is odd while they change.
+					read_view_open_now() copies them
+					without trx_sys->mutex and checks
+					that this did not change meanwhile */
+	char		pad_version[64];/*!< Ensure descr_version does not
+					share cache line with other fields */
 	trx_id_t*	descriptors;	/*!< Array of trx descriptors */
 	ulint		descr_n_max;	/*!< The current size of the descriptors
 					array. */
+	trx_id_t*	descr_retired[TRX_DESCR_N_RETIRED];
+					/*!< Arrays that descriptors pointed to
+					before it was enlarged. They are only
+					freed at shutdown, because a read view
+					may still be copying from them. */
+	ulint		descr_n_retired;/*!< Number of used elements in
+					descr_retired */
 	char		pad2[64];	/*!< Ensure static descriptor fields
 					do not share cache lines with
 					descr_n_used */
@@ -738,8 +775,10 @@ struct trx_sys_t{
 					transactions), protected by
 					rseg->mutex */
 	UT_LIST_BASE_NODE_T(read_view_t) view_list;
-					/*!< List of read views sorted
-					on trx no, biggest first */
+					/*!< List of the read views of
+					transactions and cursors. A view stays
+					on the list while it is closed and
+					opened again; see read_view_t::state */
 };
 
 /** When a trx id which is zero modulo this number (which must be a power of
@@ -392,9 +392,16 @@ static lock_stack_t*	lock_stack;
 static const ulint	lock_types = UT_ARR_SIZE(lock_compatibility_matrix);
 #endif /* UNIV_DEBUG */
 
+#ifdef UNIV_PFS_RWLOCK
+/* Key to register rwlock with performance schema */
+UNIV_INTERN mysql_pfs_key_t	lock_sys_latch_key;
+#endif /* UNIV_PFS_RWLOCK */
+
 #ifdef UNIV_PFS_MUTEX
 /* Key to register mutex with performance schema */
-UNIV_INTERN mysql_pfs_key_t	lock_sys_mutex_key;
+UNIV_INTERN mysql_pfs_key_t	lock_sys_rec_mutex_key;
+/* Key to register mutex with performance schema */
+UNIV_INTERN mysql_pfs_key_t	lock_sys_table_mutex_key;
 /* Key to register mutex with performance schema */
 UNIV_INTERN mysql_pfs_key_t	lock_sys_wait_mutex_key;
 #endif /* UNIV_PFS_MUTEX */
@@ -432,6 +439,168 @@ lock_rec_validate_page(
 /* The lock system */
 UNIV_INTERN lock_sys_t*	lock_sys	= NULL;
 
+/*********************************************************************//**
+Gets the mutex of the partition of the record lock hash table that
+contains the lock queue of a page.
+@return	partition mutex */
+UNIV_INLINE
+ib_mutex_t*
+lock_rec_get_mutex(
+/*===============*/
+	ulint	hash)	/*!< in: lock_rec_hash() of the page */
+{
+	return(&lock_sys->rec_mutexes[hash % LOCK_REC_PARTITIONS]);
+}
+
+/*********************************************************************//**
+Gets the mutex that protects the lock queue of a table when
+lock_sys->latch is held in S mode.
+@return	table lock queue mutex */
+UNIV_INLINE
+ib_mutex_t*
+lock_table_get_mutex(
+/*=================*/
+	const dict_table_t*	table)	/*!< in: table */
+{
+	return(&lock_sys->table_mutexes[table->id % LOCK_TABLE_PARTITIONS]);
+}
+
+/*********************************************************************//**
+Checks if the locks of a transaction may be set and released holding
+lock_sys->latch in S mode. With Galera replication, a brute force
+transaction may cancel the lock requests of other transactions anywhere,
+so the locks of replicated transactions are always handled in X mode.
+@return	whether S mode may be used */
+UNIV_INLINE
+bool
+lock_trx_use_partitions(
+/*====================*/
+	const trx_t*	trx)	/*!< in: transaction */
+{
+#ifdef WITH_WSREP
+	return(!wsrep_thd_is_wsrep(trx->mysql_thd));
+#else
+	return(true);
+#endif /* WITH_WSREP */
+}
+
+/*********************************************************************//**
+Latches the record lock queue of a page: lock_sys->latch in S mode and
+the mutex of the partition of the page, or lock_sys->latch in X mode if
+the transaction cannot use the partitions.
+@return	the partition mutex, or NULL if lock_sys->latch is held in X mode */
+static
+ib_mutex_t*
+lock_rec_queue_enter(
+/*=================*/
+	const trx_t*	trx,	/*!< in: transaction */
+	ulint		hash)	/*!< in: lock_rec_hash() of the page */
+{
+	ib_mutex_t*	mutex;
+
+	if (!lock_trx_use_partitions(trx)) {
+		lock_mutex_enter();
+		return(NULL);
+	}
+
+	mutex = lock_rec_get_mutex(hash);
+
+	lock_mutex_enter_shared();
+	mutex_enter(mutex);
+
+	return(mutex);
+}
+
+/*********************************************************************//**
+Latches the lock queue of a table, like lock_rec_queue_enter().
+@return	the table mutex, or NULL if lock_sys->latch is held in X mode */
+static
+ib_mutex_t*
+lock_table_queue_enter(
+/*===================*/
+	const trx_t*		trx,	/*!< in: transaction */
+	const dict_table_t*	table)	/*!< in: table */
+{
+	ib_mutex_t*	mutex;
+
+	if (!lock_trx_use_partitions(trx)) {
+		lock_mutex_enter();
+		return(NULL);
+	}
+
+	mutex = lock_table_get_mutex(table);
+
+	lock_mutex_enter_shared();
+	mutex_enter(mutex);
+
+	return(mutex);
+}
+
+/*********************************************************************//**
+Releases the latches of lock_rec_queue_enter() or lock_table_queue_enter(). */
+static
+void
+lock_queue_exit(
+/*============*/
+	ib_mutex_t*	mutex)	/*!< in: the returned partition or table
+				mutex, or NULL */
+{
+	if (mutex != NULL) {
+		mutex_exit(mutex);
+		lock_mutex_exit_shared();
+	} else {
+		lock_mutex_exit();
+	}
+}
+
+#ifdef UNIV_DEBUG
+/*********************************************************************//**
+Checks if the record lock queue of a page is latched by this thread.
+@return	TRUE if the queue may be accessed */
+static
+bool
+lock_rec_queue_own(
+/*===============*/
+	ulint	hash)	/*!< in: lock_rec_hash() of the page */
+{
+	return(lock_mutex_own()
+	       || (lock_mutex_own_shared()
+		   && mutex_own(lock_rec_get_mutex(hash))));
+}
+
+/*********************************************************************//**
+Checks if the lock queue of a table is latched by this thread.
+@return	TRUE if the queue may be accessed */
+static
+bool
+lock_table_queue_own(
+/*=================*/
+	const dict_table_t*	table)	/*!< in: table */
+{
+	return(lock_mutex_own()
+	       || (lock_mutex_own_shared()
+		   && mutex_own(lock_table_get_mutex(table))));
+}
+
+/*********************************************************************//**
+Checks if the queue of a lock is latched by this thread.
+@return	TRUE if the queue may be accessed */
+static
+bool
+lock_queue_own(
+/*===========*/
+	const lock_t*	lock)	/*!< in: record or table lock */
+{
+	if (lock_get_type_low(lock) == LOCK_REC) {
+		return(lock_rec_queue_own(
+			       lock_rec_hash(lock->un_member.rec_lock.space,
+					     lock->un_member.rec_lock.page_no)));
+	}
+
+	return(lock_table_queue_own(lock->un_member.tab_lock.table));
+}
+#endif /* UNIV_DEBUG */
+
 /** We store info on the latest deadlock error to this buffer. InnoDB
 Monitor will then fetch it and print */
 UNIV_INTERN ibool	lock_deadlock_found = FALSE;
@@ -625,7 +794,17 @@ lock_sys_create(
 
 	lock_sys->last_slot = lock_sys->waiting_threads;
 
-	mutex_create(lock_sys_mutex_key, &lock_sys->mutex, SYNC_LOCK_SYS);
+	rw_lock_create(lock_sys_latch_key, &lock_sys->latch, SYNC_LOCK_SYS);
+
+	for (ulint i = 0; i < LOCK_REC_PARTITIONS; i++) {
+		mutex_create(lock_sys_rec_mutex_key,
+			     &lock_sys->rec_mutexes[i], SYNC_LOCK_PARTITION);
+	}
+
+	for (ulint i = 0; i < LOCK_TABLE_PARTITIONS; i++) {
+		mutex_create(lock_sys_table_mutex_key,
+			     &lock_sys->table_mutexes[i], SYNC_LOCK_PARTITION);
+	}
 
 	mutex_create(lock_sys_wait_mutex_key,
 		     &lock_sys->wait_mutex, SYNC_LOCK_WAIT_SYS);
@@ -655,7 +834,16 @@ lock_sys_close(void)
 
 	hash_table_free(lock_sys->rec_hash);
 
-	mutex_free(&lock_sys->mutex);
+	rw_lock_free(&lock_sys->latch);
+
+	for (ulint i = 0; i < LOCK_REC_PARTITIONS; i++) {
+		mutex_free(&lock_sys->rec_mutexes[i]);
+	}
+
+	for (ulint i = 0; i < LOCK_TABLE_PARTITIONS; i++) {
+		mutex_free(&lock_sys->table_mutexes[i]);
+	}
+
 	mutex_free(&lock_sys->wait_mutex);
 
 	mem_free(lock_stack);
@@ -875,7 +1063,7 @@ lock_reset_lock_and_trx_wait(
 {
 	ut_ad(lock->trx->lock.wait_lock == lock);
 	ut_ad(lock_get_wait(lock));
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_own(lock));
 
 	lock->trx->lock.wait_lock = NULL;
 	lock->type_mode &= ~LOCK_WAIT;
@@ -1256,7 +1444,7 @@ lock_rec_get_next_on_page_const(
 	ulint	space;
 	ulint	page_no;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_own(lock));
 	ut_ad(lock_get_type_low(lock) == LOCK_REC);
 
 	space = lock->un_member.rec_lock.space;
@@ -1305,7 +1493,7 @@ lock_rec_get_first_on_page_addr(
 {
 	lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_queue_own(lock_rec_hash(space, page_no)));
 
 	for (lock = static_cast<lock_t*>(
 			HASH_GET_FIRST(lock_sys->rec_hash,
@@ -1357,10 +1545,10 @@ lock_rec_get_first_on_page(
 	ulint	space	= buf_block_get_space(block);
 	ulint	page_no	= buf_block_get_page_no(block);
 
-	ut_ad(lock_mutex_own());
-
 	hash = buf_block_get_lock_hash_val(block);
 
+	ut_ad(lock_rec_queue_own(hash));
+
 	for (lock = static_cast<lock_t*>(
 			HASH_GET_FIRST( lock_sys->rec_hash, hash));
 	     lock != NULL;
@@ -1386,7 +1574,7 @@ lock_rec_get_next(
 	ulint	heap_no,/*!< in: heap number of the record */
 	lock_t*	lock)	/*!< in: lock */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_own(lock));
 
 	do {
 		ut_ad(lock_get_type_low(lock) == LOCK_REC);
@@ -1421,7 +1609,7 @@ lock_rec_get_first(
 {
 	lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_queue_own(buf_block_get_lock_hash_val(block)));
 
 	for (lock = lock_rec_get_first_on_page(block); lock;
 	     lock = lock_rec_get_next_on_page(lock)) {
@@ -2014,7 +2202,7 @@ lock_rec_create(
 	ulint		n_bytes;
 	const page_t*	page;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_queue_own(buf_block_get_lock_hash_val(block)));
 	ut_ad(caller_owns_trx_mutex == trx_mutex_own(trx));
 	ut_ad(dict_index_is_clust(index) || !dict_index_is_online_ddl(index));
 
@@ -2065,7 +2253,7 @@ lock_rec_create(
 	lock->requested_time = ut_time();
 	lock->wait_time = 0;
 
-	index->table->n_rec_locks++;
+	os_atomic_increment_ulint(&index->table->n_rec_locks, 1);
 
 	ut_ad(index->table->n_ref_count > 0 || !index->table->can_be_evicted);
 
@@ -2152,7 +2340,7 @@ lock_rec_create(
 		    lock_rec_fold(space, page_no), lock);
 #endif /* WITH_WSREP */
 
-	lock_sys->rec_num++;
+	os_atomic_increment_ulint(&lock_sys->rec_num, 1);
 
 	if (!caller_owns_trx_mutex) {
 		trx_mutex_enter(trx);
@@ -2169,8 +2357,8 @@ lock_rec_create(
 		trx_mutex_exit(trx);
 	}
 
-	MONITOR_INC(MONITOR_RECLOCK_CREATED);
-	MONITOR_INC(MONITOR_NUM_RECLOCK);
+	MONITOR_ATOMIC_INC(MONITOR_RECLOCK_CREATED);
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK);
 	return(lock);
 }
 
@@ -2481,7 +2669,7 @@ lock_rec_lock_fast(
 	trx_t*			trx;
 	enum lock_rec_req_status status = LOCK_REC_SUCCESS;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_queue_own(buf_block_get_lock_hash_val(block)));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_X
@@ -2635,7 +2823,9 @@ Tries to lock the specified record in the mode requested. If not immediately
 possible, enqueues a waiting lock request. This is a low-level function
 which does NOT look at implicit locks! Checks lock compatibility within
 explicit locks. This function sets a normal next-key lock, or in the case
-of a page supremum record, a gap type lock.
+of a page supremum record, a gap type lock. The common cases are handled
+holding lock_sys->latch in S mode and the partition mutex of the page; the
+others, which may need to wait and check for deadlocks, in X mode.
 @return	DB_SUCCESS, DB_SUCCESS_LOCKED_REC, DB_LOCK_WAIT, DB_DEADLOCK,
 or DB_QUE_THR_SUSPENDED */
 static
@@ -2655,7 +2845,11 @@ lock_rec_lock(
 	dict_index_t*		index,	/*!< in: index of record */
 	que_thr_t*		thr)	/*!< in: query thread */
 {
-	ut_ad(lock_mutex_own());
+	ib_mutex_t*		mutex;
+	enum lock_rec_req_status status;
+	dberr_t			err = DB_ERROR;
+
+	ut_ad(!lock_mutex_own());
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_X
@@ -2668,20 +2862,37 @@ lock_rec_lock(
 
 	ut_ad(dict_index_is_clust(index) || !dict_index_is_online_ddl(index));
 
+	mutex = lock_rec_queue_enter(thr_get_trx(thr),
+				     buf_block_get_lock_hash_val(block));
+
 	/* We try a simplified and faster subroutine for the most
 	common cases */
-	switch (lock_rec_lock_fast(impl, mode, block, heap_no, index, thr)) {
+	status = lock_rec_lock_fast(impl, mode, block, heap_no, index, thr);
+
+	if (status == LOCK_REC_FAIL && mutex != NULL) {
+		/* The request may have to wait: retry in X mode */
+		lock_queue_exit(mutex);
+		lock_mutex_enter();
+		mutex = NULL;
+	}
+
+	switch (status) {
 	case LOCK_REC_SUCCESS:
-		return(DB_SUCCESS);
+		err = DB_SUCCESS;
+		break;
 	case LOCK_REC_SUCCESS_CREATED:
-		return(DB_SUCCESS_LOCKED_REC);
+		err = DB_SUCCESS_LOCKED_REC;
+		break;
 	case LOCK_REC_FAIL:
-		return(lock_rec_lock_slow(impl, mode, block,
-					  heap_no, index, thr));
+		err = lock_rec_lock_slow(impl, mode, block,
+					 heap_no, index, thr);
+		break;
 	}
 
-	ut_error;
-	return(DB_ERROR);
+	lock_queue_exit(mutex);
+
+	ut_ad(err != DB_ERROR);
+	return(err);
 }
 
 /*********************************************************************//**
@@ -2700,7 +2911,7 @@ lock_rec_has_to_wait_in_queue(
 	ulint		bit_mask;
 	ulint		bit_offset;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_own(wait_lock));
 	ut_ad(lock_get_wait(wait_lock));
 	ut_ad(lock_get_type_low(wait_lock) == LOCK_REC);
 
@@ -2736,14 +2947,14 @@ lock_rec_has_to_wait_in_queue(
 
 /*************************************************************//**
 Grants a lock to a waiting lock request and releases the waiting transaction.
-The caller must hold lock_sys->mutex but not lock->trx->mutex. */
+The caller must have latched the lock queue but not hold lock->trx->mutex. */
 static
 void
 lock_grant(
 /*=======*/
 	lock_t*	lock)	/*!< in/out: waiting lock request */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_own(lock));
 
 	lock_reset_lock_and_trx_wait(lock);
 
@@ -2854,7 +3065,7 @@ lock_rec_dequeue_from_page(
 	lock_t*		lock;
 	trx_lock_t*	trx_lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_own(in_lock));
 	ut_ad(lock_get_type_low(in_lock) == LOCK_REC);
 	/* We may or may not be holding in_lock->trx->mutex here. */
 
@@ -2863,16 +3074,16 @@ lock_rec_dequeue_from_page(
 	space = in_lock->un_member.rec_lock.space;
 	page_no = in_lock->un_member.rec_lock.page_no;
 
-	in_lock->index->table->n_rec_locks--;
+	os_atomic_decrement_ulint(&in_lock->index->table->n_rec_locks, 1);
 
 	HASH_DELETE(lock_t, hash, lock_sys->rec_hash,
 		    lock_rec_fold(space, page_no), in_lock);
-	lock_sys->rec_num--;
+	os_atomic_decrement_ulint(&lock_sys->rec_num, 1);
 
 	UT_LIST_REMOVE(trx_locks, trx_lock->trx_locks, in_lock);
 
-	MONITOR_INC(MONITOR_RECLOCK_REMOVED);
-	MONITOR_DEC(MONITOR_NUM_RECLOCK);
+	MONITOR_ATOMIC_INC(MONITOR_RECLOCK_REMOVED);
+	MONITOR_ATOMIC_DEC(MONITOR_NUM_RECLOCK);
 
 	/* Check if waiting locks in the queue can now be granted: grant
 	locks if there are no conflicting locks ahead. Stop at the first
@@ -2914,16 +3125,16 @@ lock_rec_discard(
 	space = in_lock->un_member.rec_lock.space;
 	page_no = in_lock->un_member.rec_lock.page_no;
 
-	in_lock->index->table->n_rec_locks--;
+	os_atomic_decrement_ulint(&in_lock->index->table->n_rec_locks, 1);
 
 	HASH_DELETE(lock_t, hash, lock_sys->rec_hash,
 		    lock_rec_fold(space, page_no), in_lock);
-	lock_sys->rec_num--;
+	os_atomic_decrement_ulint(&lock_sys->rec_num, 1);
 
 	UT_LIST_REMOVE(trx_locks, trx_lock->trx_locks, in_lock);
 
-	MONITOR_INC(MONITOR_RECLOCK_REMOVED);
-	MONITOR_DEC(MONITOR_NUM_RECLOCK);
+	MONITOR_ATOMIC_INC(MONITOR_RECLOCK_REMOVED);
+	MONITOR_ATOMIC_DEC(MONITOR_NUM_RECLOCK);
 }
 
 /*************************************************************//**
@@ -4611,7 +4822,7 @@ lock_table_create(
 	lock_t*	lock;
 
 	ut_ad(table && trx);
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_table_queue_own(table));
 	ut_ad(trx_mutex_own(trx));
 
 	/* Non-locking autocommit read-only transactions should not set
@@ -4708,8 +4919,8 @@ lock_table_create(
 
 	ib_vector_push(lock->trx->lock.table_locks, &lock);
 
-	MONITOR_INC(MONITOR_TABLELOCK_CREATED);
-	MONITOR_INC(MONITOR_NUM_TABLELOCK);
+	MONITOR_ATOMIC_INC(MONITOR_TABLELOCK_CREATED);
+	MONITOR_ATOMIC_INC(MONITOR_NUM_TABLELOCK);
 
 	return(lock);
 }
@@ -4724,7 +4935,7 @@ lock_table_pop_autoinc_locks(
 /*=========================*/
 	trx_t*	trx)	/*!< in/out: transaction that owns the AUTOINC locks */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_mutex_own() || lock_mutex_own_shared());
 	ut_ad(!ib_vector_is_empty(trx->autoinc_locks));
 
 	/* Skip any gaps, gaps are NULL lock entries in the
@@ -4752,7 +4963,7 @@ lock_table_remove_autoinc_lock(
 	lock_t*	autoinc_lock;
 	lint	i = ib_vector_size(trx->autoinc_locks) - 1;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_own(lock));
 	ut_ad(lock_get_mode(lock) == LOCK_AUTO_INC);
 	ut_ad(lock_get_type_low(lock) & LOCK_TABLE);
 	ut_ad(!ib_vector_is_empty(trx->autoinc_locks));
@@ -4804,7 +5015,7 @@ lock_table_remove_low(
 	trx_t*		trx;
 	dict_table_t*	table;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_own(lock));
 
 	trx = lock->trx;
 	table = lock->un_member.tab_lock.table;
@@ -4841,8 +5052,8 @@ lock_table_remove_low(
 	UT_LIST_REMOVE(trx_locks, trx->lock.trx_locks, lock);
 	UT_LIST_REMOVE(un_member.tab_lock.locks, table->locks, lock);
 
-	MONITOR_INC(MONITOR_TABLELOCK_REMOVED);
-	MONITOR_DEC(MONITOR_NUM_TABLELOCK);
+	MONITOR_ATOMIC_INC(MONITOR_TABLELOCK_REMOVED);
+	MONITOR_ATOMIC_DEC(MONITOR_NUM_TABLELOCK);
 }
 
 /*********************************************************************//**
@@ -4980,7 +5191,7 @@ lock_table_other_has_incompatible(
 {
 	const lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_table_queue_own(table));
 
 	for (lock = UT_LIST_GET_LAST(table->locks);
 	     lock != NULL;
@@ -5030,6 +5241,7 @@ lock_table(
 	trx_t*		trx;
 	dberr_t		err;
 	const lock_t*	wait_for;
+	ib_mutex_t*	mutex;
 
 	ut_ad(table && thr);
 
@@ -5056,7 +5268,15 @@ lock_table(
 		return(DB_SUCCESS);
 	}
 
-	lock_mutex_enter();
+	/* Intention locks can be set in S mode of lock_sys->latch if
+	there is no conflicting request */
+
+	if (mode == LOCK_IS || mode == LOCK_IX) {
+		mutex = lock_table_queue_enter(trx, table);
+	} else {
+		lock_mutex_enter();
+		mutex = NULL;
+	}
 
 	DBUG_EXECUTE_IF("fatal-semaphore-timeout",
 		{ os_thread_sleep(3600000000); });
@@ -5072,6 +5292,16 @@ lock_table(
 		trx, LOCK_WAIT, table, mode);
 #endif
 
+	if (wait_for != NULL && mutex != NULL) {
+		/* The request has to wait: retry in X mode */
+		lock_queue_exit(mutex);
+		lock_mutex_enter();
+		mutex = NULL;
+
+		wait_for = lock_table_other_has_incompatible(
+			trx, LOCK_WAIT, table, mode);
+	}
+
 	trx_mutex_enter(trx);
 
 	/* Another trx has a request on the table in an incompatible
@@ -5095,13 +5325,53 @@ lock_table(
 		err = DB_SUCCESS;
 	}
 
-	lock_mutex_exit();
+	lock_queue_exit(mutex);
 
 	trx_mutex_exit(trx);
 
 	return(err);
 }
 
+/*********************************************************************//**
+Locks the specified database table in X mode if no other transaction
+holds or waits for a lock on it. Unlike lock_table(), never waits.
+@return	DB_SUCCESS, or DB_LOCK_WAIT if the lock could not be granted */
+UNIV_INTERN
+dberr_t
+lock_table_x_nowait(
+/*================*/
+	dict_table_t*	table,	/*!< in/out: database table
+				in dictionary cache */
+	trx_t*		trx)	/*!< in/out: transaction */
+{
+	dberr_t	err;
+
+	if (lock_table_has(trx, table, LOCK_X)) {
+
+		return(DB_SUCCESS);
+	}
+
+	lock_mutex_enter();
+
+	if (lock_table_other_has_incompatible(
+		    trx, LOCK_WAIT, table, LOCK_X)) {
+		err = DB_LOCK_WAIT;
+	} else {
+		trx_mutex_enter(trx);
+#ifdef WITH_WSREP
+		lock_table_create(NULL, table, LOCK_X, trx);
+#else
+		lock_table_create(table, LOCK_X, trx);
+#endif
+		trx_mutex_exit(trx);
+		err = DB_SUCCESS;
+	}
+
+	lock_mutex_exit();
+
+	return(err);
+}
+
 /*********************************************************************//**
 Creates a table IX lock object for a resurrected transaction. */
 UNIV_INTERN
@@ -5147,7 +5417,7 @@ lock_table_has_to_wait_in_queue(
 	const dict_table_t*	table;
 	const lock_t*		lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_own(wait_lock));
 	ut_ad(lock_get_wait(wait_lock));
 
 	table = wait_lock->un_member.tab_lock.table;
@@ -5179,7 +5449,7 @@ lock_table_dequeue(
 {
 	lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_own(in_lock));
 	ut_a(lock_get_type_low(in_lock) == LOCK_TABLE);
 
 	lock = UT_LIST_GET_NEXT(un_member.tab_lock.locks, in_lock);
@@ -5222,6 +5492,7 @@ lock_rec_unlock(
 	lock_t*		first_lock;
 	lock_t*		lock;
 	ulint		heap_no;
+	ib_mutex_t*	mutex;
 	const char*	stmt;
 	size_t		stmt_len;
 
@@ -5233,7 +5504,7 @@ lock_rec_unlock(
 
 	heap_no = page_rec_get_heap_no(rec);
 
-	lock_mutex_enter();
+	mutex = lock_rec_queue_enter(trx, buf_block_get_lock_hash_val(block));
 	trx_mutex_enter(trx);
 
 	first_lock = lock_rec_get_first(block, heap_no);
@@ -5248,7 +5519,7 @@ lock_rec_unlock(
 		}
 	}
 
-	lock_mutex_exit();
+	lock_queue_exit(mutex);
 	trx_mutex_exit(trx);
 
 	stmt = innobase_get_stmt(trx->mysql_thd, &stmt_len);
@@ -5280,7 +5551,7 @@ lock_rec_unlock(
 		}
 	}
 
-	lock_mutex_exit();
+	lock_queue_exit(mutex);
 	trx_mutex_exit(trx);
 }
 
@@ -5291,13 +5562,15 @@ static
 void
 lock_release(
 /*=========*/
-	trx_t*	trx)	/*!< in/out: transaction */
+	trx_t*	trx,	/*!< in/out: transaction */
+	bool	shared)	/*!< in: true if lock_sys->latch is held in
+			S mode, false if in X mode */
 {
 	lock_t*		lock;
 	ulint		count = 0;
 	trx_id_t	max_trx_id;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(shared ? lock_mutex_own_shared() : lock_mutex_own());
 	ut_ad(!trx_mutex_own(trx));
 
 	max_trx_id = trx_sys_get_max_trx_id();
@@ -5306,6 +5579,20 @@ lock_release(
 	     lock != NULL;
 	     lock = UT_LIST_GET_LAST(trx->lock.trx_locks)) {
 
+		ib_mutex_t*	mutex = NULL;
+
+		if (shared) {
+			/* Latch the queue of the lock */
+			mutex = lock_get_type_low(lock) == LOCK_REC
+				? lock_rec_get_mutex(lock_rec_hash(
+					lock->un_member.rec_lock.space,
+					lock->un_member.rec_lock.page_no))
+				: lock_table_get_mutex(
+					lock->un_member.tab_lock.table);
+
+			mutex_enter(mutex);
+		}
+
 		if (lock_get_type_low(lock) == LOCK_REC) {
 
 #ifdef UNIV_DEBUG
@@ -5352,13 +5639,21 @@ lock_release(
 			lock_table_dequeue(lock);
 		}
 
+		if (mutex != NULL) {
+			mutex_exit(mutex);
+		}
+
 		if (count == LOCK_RELEASE_INTERVAL) {
-			/* Release the  mutex for a while, so that we
+			/* Release the latch for a while, so that we
 			do not monopolize it */
 
-			lock_mutex_exit();
-
-			lock_mutex_enter();
+			if (shared) {
+				lock_mutex_exit_shared();
+				lock_mutex_enter_shared();
+			} else {
+				lock_mutex_exit();
+				lock_mutex_enter();
+			}
 
 			count = 0;
 		}
@@ -6288,7 +6583,7 @@ lock_rec_queue_validate(
 
 		ut_ad(lock_mutex_own());
 		/* trx_id cannot be committed until lock_mutex_exit()
-		because lock_trx_release_locks() acquires lock_sys->mutex */
+		because lock_trx_release_locks() acquires lock_sys->latch */
 
 		if (trx_desc != NULL
 		    && lock_rec_other_has_expl_req(LOCK_S, 0, LOCK_WAIT,
@@ -6628,6 +6923,7 @@ lock_rec_insert_check_and_lock(
 	dberr_t		err;
 	ulint		next_rec_heap_no;
 	ibool		inherit_in = *inherit;
+	ib_mutex_t*	mutex;
 #ifdef WITH_WSREP
 	lock_t*		c_lock=NULL;
 #endif
@@ -6652,7 +6948,7 @@ lock_rec_insert_check_and_lock(
 	next_rec = page_rec_get_next_const(rec);
 	next_rec_heap_no = page_rec_get_heap_no(next_rec);
 
-	lock_mutex_enter();
+	mutex = lock_rec_queue_enter(trx, buf_block_get_lock_hash_val(block));
 	/* Because this code is invoked for a running transaction by
 	the thread that is serving the transaction, it is not necessary
 	to hold trx->mutex here. */
@@ -6664,10 +6960,19 @@ lock_rec_insert_check_and_lock(
 
 	lock = lock_rec_get_first(block, next_rec_heap_no);
 
+	if (lock != NULL && mutex != NULL) {
+		/* The insert may have to wait: retry in X mode */
+		lock_queue_exit(mutex);
+		lock_mutex_enter();
+		mutex = NULL;
+
+		lock = lock_rec_get_first(block, next_rec_heap_no);
+	}
+
 	if (UNIV_LIKELY(lock == NULL)) {
 		/* We optimize CPU time usage in the simplest case */
 
-		lock_mutex_exit();
+		lock_queue_exit(mutex);
 
 		if (inherit_in && !dict_index_is_clust(index)) {
 			/* Update the page max trx id field */
@@ -6815,7 +7120,7 @@ lock_rec_convert_impl_to_expl(
 		mutex_exit(&trx_sys->mutex);
 
 		/* trx_id cannot be committed until lock_mutex_exit()
-		because lock_trx_release_locks() acquires lock_sys->mutex */
+		because lock_trx_release_locks() acquires lock_sys->latch */
 
 		if (impl_trx_desc != NULL
 		    && !lock_rec_has_expl(LOCK_X | LOCK_REC_NOT_GAP, block,
@@ -6884,7 +7189,6 @@ lock_clust_rec_modify_check_and_lock(
 
 	lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 
-	lock_mutex_enter();
 	trx_t*		trx = thr_get_trx(thr);
 	trx->current_lock_mutex_owner = trx->mysql_thd;
 	ut_ad(lock_table_has(trx, index->table, LOCK_IX));
@@ -6892,10 +7196,9 @@ lock_clust_rec_modify_check_and_lock(
 	err = lock_rec_lock(TRUE, LOCK_X | LOCK_REC_NOT_GAP,
 			    block, heap_no, index, thr);
 
-	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK_REQ);
 
 	trx->current_lock_mutex_owner = NULL;
-	lock_mutex_exit();
 
 	ut_ad(lock_rec_queue_validate(FALSE, block, rec, index, offsets));
 
@@ -6951,7 +7254,6 @@ lock_sec_rec_modify_check_and_lock(
 	transaction had modified this secondary index record. */
 
 	trx_t* trx = thr_get_trx(thr);
-	lock_mutex_enter();
 	trx->current_lock_mutex_owner = trx->mysql_thd;
 
 	ut_ad(lock_table_has(trx, index->table, LOCK_IX));
@@ -6959,10 +7261,9 @@ lock_sec_rec_modify_check_and_lock(
 	err = lock_rec_lock(TRUE, LOCK_X | LOCK_REC_NOT_GAP,
 			    block, heap_no, index, thr);
 
-	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK_REQ);
 
 	trx->current_lock_mutex_owner = NULL;
-	lock_mutex_exit();
 
 #ifdef UNIV_DEBUG
 	{
@@ -7062,7 +7363,6 @@ lock_sec_rec_read_check_and_lock(
 	}
 
 	trx_t* trx = thr_get_trx(thr);
-	lock_mutex_enter();
 	trx->current_lock_mutex_owner = trx->mysql_thd;
 
 	ut_ad(mode != LOCK_X
@@ -7073,10 +7373,9 @@ lock_sec_rec_read_check_and_lock(
 	err = lock_rec_lock(FALSE, mode | gap_mode,
 			    block, heap_no, index, thr);
 
-	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK_REQ);
 
 	trx->current_lock_mutex_owner = NULL;
-	lock_mutex_exit();
 
 	ut_ad(lock_rec_queue_validate(FALSE, block, rec, index, offsets));
 
@@ -7145,7 +7444,6 @@ lock_clust_rec_read_check_and_lock(
 		lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 	}
 
-	lock_mutex_enter();
 	trx_t* trx = thr_get_trx(thr);
 	trx->current_lock_mutex_owner = trx->mysql_thd;
 
@@ -7157,10 +7455,9 @@ lock_clust_rec_read_check_and_lock(
 	err = lock_rec_lock(FALSE, mode | gap_mode,
 			    block, heap_no, index, thr);
 
-	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK_REQ);
 
 	trx->current_lock_mutex_owner = NULL;
-	lock_mutex_exit();
 
 	ut_ad(lock_rec_queue_validate(FALSE, block, rec, index, offsets));
 
@@ -7602,11 +7899,20 @@ lock_trx_release_locks(
 	}
 
 	/* The transition of trx->state to TRX_STATE_COMMITTED_IN_MEMORY
-	is protected by both the lock_sys->mutex and the trx->mutex.
+	is protected by both the lock_sys->latch and the trx->mutex.
 	We also lock trx_sys->mutex, because state transition to
 	TRX_STATE_COMMITTED_IN_MEMORY must be atomic with removing trx
-	from the descriptors array. */
-	lock_mutex_enter();
+	from the descriptors array. The S mode of lock_sys->latch is
+	enough for this and for releasing the locks: whoever needs the
+	transaction to stay active holds lock_sys->latch in X mode. */
+	bool	shared = lock_trx_use_partitions(trx);
+
+	if (shared) {
+		lock_mutex_enter_shared();
+	} else {
+		lock_mutex_enter();
+	}
+
 	mutex_enter(&trx_sys->mutex);
 	trx_mutex_enter(trx);
 
@@ -7647,9 +7953,13 @@ lock_trx_release_locks(
 
 	mutex_exit(&trx_sys->mutex);
 
-	lock_release(trx);
+	lock_release(trx, shared);
 
-	lock_mutex_exit();
+	if (shared) {
+		lock_mutex_exit_shared();
+	} else {
+		lock_mutex_exit();
+	}
 }
 
 /*********************************************************************//**
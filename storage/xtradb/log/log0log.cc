@@ -105,8 +105,25 @@ UNIV_INTERN mysql_pfs_key_t	archive_lock_key;
 #ifdef UNIV_PFS_MUTEX
 UNIV_INTERN mysql_pfs_key_t	log_sys_mutex_key;
 UNIV_INTERN mysql_pfs_key_t	log_flush_order_mutex_key;
+UNIV_INTERN mysql_pfs_key_t	log_write_mutex_key;
+UNIV_INTERN mysql_pfs_key_t	log_flush_mutex_key;
+# ifndef HAVE_ATOMIC_BUILTINS_64
+UNIV_INTERN mysql_pfs_key_t	log_lsn_mutex_key;
+# endif /* !HAVE_ATOMIC_BUILTINS_64 */
 #endif /* UNIV_PFS_MUTEX */
 
+#ifdef UNIV_PFS_THREAD
+UNIV_INTERN mysql_pfs_key_t	log_writer_thread_key;
+UNIV_INTERN mysql_pfs_key_t	log_flusher_thread_key;
+#endif /* UNIV_PFS_THREAD */
+
+/** Whether the log writer thread is running */
+static bool		log_writer_thread_active = false;
+/** Whether the log flusher thread is running */
+static bool		log_flusher_thread_active = false;
+/** Set by log_threads_stop() to make the log threads exit */
+static bool		log_threads_shutdown = false;
+
 #ifdef UNIV_DEBUG
 UNIV_INTERN ibool	log_do_write = TRUE;
 #endif /* UNIV_DEBUG */
@@ -127,6 +144,10 @@ UNIV_INTERN ulint       log_disable_checkpoint_active= 0;
 /* A margin for free space in the log buffer before a log entry is catenated */
 #define LOG_BUF_WRITE_MARGIN	(4 * OS_FILE_LOG_BLOCK_SIZE)
 
+/* Number of bytes of log records in a log block */
+#define LOG_BLOCK_DATA_SIZE	\
+	(OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_HDR_SIZE - LOG_BLOCK_TRL_SIZE)
+
 /* Margins for free space in the log buffer after a log entry is catenated */
 #define LOG_BUF_FLUSH_RATIO	2
 #define LOG_BUF_FLUSH_MARGIN	(LOG_BUF_WRITE_MARGIN + 4 * UNIV_PAGE_SIZE)
@@ -155,10 +176,6 @@ the previous */
 /* This parameter controls asynchronous writing to the archive */
 #define LOG_ARCHIVE_RATIO_ASYNC		16
 
-/* Codes used in unlocking flush latches */
-#define LOG_UNLOCK_NONE_FLUSHED_LOCK	1
-#define LOG_UNLOCK_FLUSH_LOCK		2
-
 /* States of an archiving operation */
 #define	LOG_ARCHIVE_READ	1
 #define	LOG_ARCHIVE_WRITE	2
@@ -188,17 +205,19 @@ log_buf_pool_get_oldest_modification(void)
 /*======================================*/
 {
 	lsn_t	lsn;
+	lsn_t	oldest_lsn;
 
 	ut_ad(mutex_own(&(log_sys->mutex)));
 
-	lsn = buf_pool_get_oldest_modification();
+	/* Read the lsn first: the log space of the mini-transactions
+	which dirty pages is reserved while holding log_flush_order_mutex,
+	which buf_pool_get_oldest_modification() acquires too. */
 
-	if (!lsn) {
+	lsn = log_get_lsn();
 
-		lsn = log_sys->lsn;
-	}
+	oldest_lsn = buf_pool_get_oldest_modification();
 
-	return(lsn);
+	return(oldest_lsn ? oldest_lsn : lsn);
 }
 
 /****************************************************************//**
@@ -251,322 +270,307 @@ log_check_tracking_margin(
 	return tracked_lsn_age + lsn_advance > log_sys->max_checkpoint_age;
 }
 
-/** Extends the log buffer.
-@param[in] len	requested minimum size in bytes */
+/************************************************************//**
+Calculates the end lsn of log records of a given length written at an lsn,
+skipping the log block trailers and headers on the way.
+@return	end lsn */
 static
-void
-log_buffer_extend(
-	ulint	len)
+lsn_t
+log_calc_end_lsn(
+/*=============*/
+	lsn_t	lsn,	/*!< in: start lsn */
+	ulint	len)	/*!< in: length of the log records */
 {
-	ulint	move_start;
-	ulint	move_end;
-	byte*	tmp_buf = static_cast<byte *>(alloca(OS_FILE_LOG_BLOCK_SIZE));
-
-	mutex_enter(&(log_sys->mutex));
+	ulint	avail;
 
-	while (log_sys->is_extending) {
-		/* Another thread is trying to extend already.
-		Needs to wait for. */
-		mutex_exit(&(log_sys->mutex));
+	avail = OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE
+		- (ulint) (lsn % OS_FILE_LOG_BLOCK_SIZE);
 
-		log_buffer_flush_to_disk();
+	if (len < avail) {
 
-		mutex_enter(&(log_sys->mutex));
-
-		if (srv_log_buffer_size > len / UNIV_PAGE_SIZE) {
-			/* Already extended enough by the others */
-			mutex_exit(&(log_sys->mutex));
-			return;
-		}
+		return(lsn + len);
 	}
 
-	log_sys->is_extending = true;
-
-	while (log_sys->n_pending_writes != 0
-	       || ut_calc_align_down(log_sys->buf_free,
-				     OS_FILE_LOG_BLOCK_SIZE)
-		  != ut_calc_align_down(log_sys->buf_next_to_write,
-					OS_FILE_LOG_BLOCK_SIZE)) {
-		/* Buffer might have >1 blocks to write still. */
-		mutex_exit(&(log_sys->mutex));
+	/* A log block which becomes exactly full is followed by the header
+	of the next block, like in any other block boundary */
 
-		log_buffer_flush_to_disk();
+	len -= avail;
+	lsn += avail + LOG_BLOCK_TRL_SIZE + LOG_BLOCK_HDR_SIZE;
 
-		mutex_enter(&(log_sys->mutex));
-	}
+	return(lsn + (len / LOG_BLOCK_DATA_SIZE) * OS_FILE_LOG_BLOCK_SIZE
+	       + len % LOG_BLOCK_DATA_SIZE);
+}
 
-	move_start = ut_calc_align_down(
-		log_sys->buf_free,
-		OS_FILE_LOG_BLOCK_SIZE);
-	move_end = log_sys->buf_free;
+/************************************************************//**
+Reads an lsn field of log_sys which is only updated while holding
+log_sys->mutex, without acquiring the mutex where possible.
+@return	value of the field */
+UNIV_INLINE
+lsn_t
+log_read_lsn(
+/*=========*/
+	lsn_t*	field)	/*!< in: log_sys->write_lsn, flushed_to_disk_lsn,
+			write_req_lsn or flush_req_lsn */
+{
+#ifdef HAVE_ATOMIC_BUILTINS_64
+	return(os_atomic_increment_uint64(field, 0));
+#else
+	lsn_t	lsn;
 
-	/* store the last log block in buffer */
-	ut_memcpy(tmp_buf, log_sys->buf + move_start,
-		  move_end - move_start);
+	mutex_enter(&log_sys->mutex);
+	lsn = *field;
+	mutex_exit(&log_sys->mutex);
 
-	log_sys->buf_free -= move_start;
-	log_sys->buf_next_to_write -= move_start;
+	return(lsn);
+#endif /* HAVE_ATOMIC_BUILTINS_64 */
+}
 
-	/* reallocate log buffer */
-	srv_log_buffer_size = len / UNIV_PAGE_SIZE + 1;
-	mem_free(log_sys->buf_ptr);
-	log_sys->buf_ptr = static_cast<byte*>(
-		mem_zalloc(LOG_BUFFER_SIZE + OS_FILE_LOG_BLOCK_SIZE));
-	log_sys->buf = static_cast<byte*>(
-		ut_align(log_sys->buf_ptr, OS_FILE_LOG_BLOCK_SIZE));
-	log_sys->buf_size = LOG_BUFFER_SIZE;
-	log_sys->max_buf_free = log_sys->buf_size / LOG_BUF_FLUSH_RATIO
-		- LOG_BUF_FLUSH_MARGIN;
+/************************************************************//**
+Gets the fill counter of the log buffer block of an lsn.
+@return	pointer to log_sys->buf_fill[] */
+UNIV_INLINE
+ulint*
+log_buf_get_fill(
+/*=============*/
+	lsn_t	lsn)	/*!< in: lsn */
+{
+	return(log_sys->buf_fill
+	       + (ulint) (lsn % log_sys->buf_size) / OS_FILE_LOG_BLOCK_SIZE);
+}
 
-	/* restore the last log block */
-	ut_memcpy(log_sys->buf, tmp_buf, move_end - move_start);
+/************************************************************//**
+Adds copied bytes to the fill counter of a log buffer block. */
+UNIV_INLINE
+void
+log_buf_add_fill(
+/*=============*/
+	lsn_t	block_lsn,	/*!< in: start lsn of the log block */
+	ulint	n)		/*!< in: number of bytes copied */
+{
+	/* The mutex is only used where there are no atomic builtins,
+	and then log_sys->lsn_mutex exists */
+	os_atomic_inc_ulint(&log_sys->lsn_mutex,
+			    log_buf_get_fill(block_lsn), n);
+}
 
-	ut_ad(log_sys->is_extending);
-	log_sys->is_extending = false;
+/************************************************************//**
+Reads the fill counter of a log buffer block.
+@return	number of bytes of the block copied to log_sys->buf */
+UNIV_INLINE
+ulint
+log_buf_read_fill(
+/*==============*/
+	lsn_t	block_lsn)	/*!< in: start lsn of the log block */
+{
+#ifdef HAVE_ATOMIC_BUILTINS
+	return(os_atomic_increment_ulint(log_buf_get_fill(block_lsn), 0));
+#else
+	ulint	fill;
 
-	mutex_exit(&(log_sys->mutex));
+	mutex_enter(&log_sys->lsn_mutex);
+	fill = *log_buf_get_fill(block_lsn);
+	mutex_exit(&log_sys->lsn_mutex);
 
-	ib_logf(IB_LOG_LEVEL_INFO,
-		"innodb_log_buffer_size was extended to %lu.",
-		LOG_BUFFER_SIZE);
+	return(fill);
+#endif /* HAVE_ATOMIC_BUILTINS */
 }
 
 /************************************************************//**
-Opens the log for log_write_low. The log must be closed with log_close.
-@return	start lsn of the log record */
-UNIV_INTERN
-lsn_t
-log_open(
-/*=====*/
-	ulint	len)	/*!< in: length of data to be catenated */
+Advances log_sys->lsn if it has not changed.
+@return	true if log_sys->lsn was old_lsn and is now new_lsn */
+UNIV_INLINE
+bool
+log_cas_lsn(
+/*========*/
+	lsn_t	old_lsn,	/*!< in: expected value of log_sys->lsn */
+	lsn_t	new_lsn)	/*!< in: new value of log_sys->lsn */
 {
-	log_t*	log			= log_sys;
-	ulint	len_upper_limit;
-#ifdef UNIV_LOG_ARCHIVE
-	lsn_t	archived_lsn_age;
-	ulint	dummy;
-#endif /* UNIV_LOG_ARCHIVE */
-	ulint	count			= 0;
-	ulint	tcount			= 0;
+#ifdef HAVE_ATOMIC_BUILTINS_64
+	return(os_compare_and_swap_uint64(&log_sys->lsn, old_lsn, new_lsn));
+#else
+	bool	swapped;
 
-	if (len >= log->buf_size / 2) {
-		DBUG_EXECUTE_IF("ib_log_buffer_is_short_crash",
-				DBUG_SUICIDE(););
+	mutex_enter(&log_sys->lsn_mutex);
 
-		/* log_buffer is too small. try to extend instead of crash. */
-		ib_logf(IB_LOG_LEVEL_WARN,
-			"The transaction log size is too large"
-			" for innodb_log_buffer_size (%lu >= %lu / 2). "
-			"Trying to extend it.",
-			len, LOG_BUFFER_SIZE);
+	swapped = (log_sys->lsn == old_lsn);
 
-		log_buffer_extend((len + 1) * 2);
+	if (swapped) {
+		log_sys->lsn = new_lsn;
 	}
-loop:
-	ut_ad(!recv_no_log_write);
 
-	if (log->is_extending) {
+	mutex_exit(&log_sys->lsn_mutex);
 
-		mutex_exit(&(log->mutex));
+	return(swapped);
+#endif /* HAVE_ATOMIC_BUILTINS_64 */
+}
 
-		/* Log buffer size is extending. Writing up to the next block
-		should wait for the extending finished. */
+/************************************************************//**
+Waits until a log block can be copied to log_sys->buf, that is, until the
+block which used the same space of the ring buffer before it has been
+written to the log files. */
+static
+void
+log_buf_wait_for_space(
+/*===================*/
+	lsn_t	block_lsn)	/*!< in: start lsn of the log block */
+{
+	lsn_t	limit;
 
-		os_thread_sleep(100000);
+	ut_ad(block_lsn % OS_FILE_LOG_BLOCK_SIZE == 0);
 
-		ut_ad(++count < 50);
+	if (block_lsn < log_sys->buf_size) {
 
-		goto loop;
+		return;
 	}
 
-	/* Calculate an upper limit for the space the string may take in the
-	log buffer */
-
-	len_upper_limit = LOG_BUF_WRITE_MARGIN + (5 * len) / 4;
-
-	if (log->buf_free + len_upper_limit > log->buf_size) {
-
-		mutex_exit(&(log->mutex));
-
-		/* Not enough free space, do a syncronous flush of the log
-		buffer */
+	limit = block_lsn - log_sys->buf_size + OS_FILE_LOG_BLOCK_SIZE;
 
-		log_buffer_flush_to_disk();
+	if (log_read_lsn(&log_sys->write_lsn) >= limit) {
 
-		srv_stats.log_waits.inc();
-
-		ut_ad(++count < 50);
-
-		mutex_enter(&(log->mutex));
-
-		goto loop;
+		return;
 	}
 
-#ifdef UNIV_LOG_ARCHIVE
-	if (log->archiving_state != LOG_ARCH_OFF) {
-
-		archived_lsn_age = log->lsn - log->archived_lsn;
-		if (archived_lsn_age + len_upper_limit
-		    > log->max_archived_lsn_age) {
-			/* Not enough free archived space in log groups: do a
-			synchronous archive write batch: */
+	srv_stats.log_waits.inc();
 
-			mutex_exit(&(log->mutex));
-
-			ut_ad(len_upper_limit <= log->max_archived_lsn_age);
-
-			log_archive_do(TRUE, &dummy);
-
-			ut_ad(++count < 50);
-
-			mutex_enter(&(log->mutex));
-
-			goto loop;
-		}
-	}
-#endif /* UNIV_LOG_ARCHIVE */
+	log_write_up_to(limit, LOG_WAIT_ALL_GROUPS, FALSE);
 
-	if (log_check_tracking_margin(len_upper_limit) &&
-		(++tcount + count < 50)) {
+	ut_ad(log_sys->write_lsn >= limit);
+}
 
-		/* This log write would violate the untracked LSN free space
-		margin.  Limit this to 50 retries as there might be situations
-		where we have no choice but to proceed anyway, i.e. if the log
-		is about to be overflown, log tracking or not. */
-		mutex_exit(&(log->mutex));
+/************************************************************//**
+Opens the log for log_write_low: reserves space for len bytes of log
+records at the end of the log. Does not wait: the space in the log
+buffer is waited for in log_write_low. The log must be closed with
+log_close.
+@return	start lsn of the log records */
+UNIV_INTERN
+lsn_t
+log_open(
+/*=====*/
+	ulint	len,		/*!< in: length of data to be catenated */
+	lsn_t*	end_lsn)	/*!< out: end lsn of the log records */
+{
+	lsn_t	start_lsn;
+	lsn_t	lsn;
 
-		os_thread_sleep(10000);
+	ut_ad(!recv_no_log_write);
 
-		mutex_enter(&(log->mutex));
+	do {
+		start_lsn = log_get_lsn();
+		lsn = log_calc_end_lsn(start_lsn, len);
+	} while (lsn != start_lsn && !log_cas_lsn(start_lsn, lsn));
 
-		goto loop;
-	}
+	*end_lsn = lsn;
 
-#ifdef UNIV_LOG_DEBUG
-	log->old_buf_free = log->buf_free;
-	log->old_lsn = log->lsn;
-#endif
-	return(log->lsn);
+	return(start_lsn);
 }
 
 /************************************************************//**
-Writes to the log the string given. It is assumed that the caller holds the
-log mutex. */
+Writes to the log the string given, in the space reserved with log_open.
+Several threads may copy to the log buffer at the same time.
+@return	lsn where the next string of the reserved space starts */
 UNIV_INTERN
-void
+lsn_t
 log_write_low(
 /*==========*/
-	byte*	str,		/*!< in: string */
-	ulint	str_len)	/*!< in: string length */
+	const byte*	str,	/*!< in: string */
+	ulint		str_len,/*!< in: string length */
+	lsn_t		lsn,	/*!< in: lsn where to write the string */
+	lsn_t		end_lsn)/*!< in: end lsn of the reserved space */
 {
-	log_t*	log	= log_sys;
-	ulint	len;
-	ulint	data_len;
-	byte*	log_block;
-
-	ut_ad(mutex_own(&(log->mutex)));
-part_loop:
 	ut_ad(!recv_no_log_write);
-	/* Calculate a part length */
 
-	data_len = (log->buf_free % OS_FILE_LOG_BLOCK_SIZE) + str_len;
+	while (str_len > 0) {
+		lsn_t	block_lsn;
+		byte*	log_block;
+		ulint	offset;
+		ulint	len;
 
-	if (data_len <= OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE) {
+		ut_ad(lsn < end_lsn);
 
-		/* The string fits within the current log block */
+		block_lsn = ut_uint64_align_down(lsn, OS_FILE_LOG_BLOCK_SIZE);
+		offset = (ulint) (lsn - block_lsn);
 
-		len = str_len;
-	} else {
-		data_len = OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE;
+		ut_ad(offset >= LOG_BLOCK_HDR_SIZE);
+		ut_ad(offset < OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE);
 
-		len = OS_FILE_LOG_BLOCK_SIZE
-			- (log->buf_free % OS_FILE_LOG_BLOCK_SIZE)
-			- LOG_BLOCK_TRL_SIZE;
-	}
+		len = ut_min(str_len, OS_FILE_LOG_BLOCK_SIZE
+			     - LOG_BLOCK_TRL_SIZE - offset);
 
-	ut_memcpy(log->buf + log->buf_free, str, len);
+		log_buf_wait_for_space(block_lsn);
 
-	str_len -= len;
-	str = str + len;
+		log_block = log_sys->buf
+			+ (ulint) (block_lsn % log_sys->buf_size);
 
-	log_block = static_cast<byte*>(
-		ut_align_down(
-			log->buf + log->buf_free, OS_FILE_LOG_BLOCK_SIZE));
+		ut_memcpy(log_block + offset, str, len);
 
-	log_block_set_data_len(log_block, data_len);
+		str += len;
+		str_len -= len;
+		lsn += len;
+		offset += len;
 
-	if (data_len == OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE) {
-		/* This block became full */
-		log_block_set_data_len(log_block, OS_FILE_LOG_BLOCK_SIZE);
-		log_block_set_checkpoint_no(log_block,
-					    log_sys->next_checkpoint_no);
-		len += LOG_BLOCK_HDR_SIZE + LOG_BLOCK_TRL_SIZE;
+		if (offset < OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE) {
 
-		log->lsn += len;
+			log_buf_add_fill(block_lsn, len);
 
-		/* Initialize the next block header */
-		log_block_init(log_block + OS_FILE_LOG_BLOCK_SIZE, log->lsn);
-	} else {
-		log->lsn += len;
-	}
+			continue;
+		}
+
+		/* This block became full: the trailer of the block and the
+		header of the next block belong to the reserved space. Set
+		the first record group of the next block before counting
+		its header. */
+
+		log_buf_add_fill(block_lsn, len + LOG_BLOCK_TRL_SIZE);
+
+		block_lsn += OS_FILE_LOG_BLOCK_SIZE;
 
-	log->buf_free += len;
+		log_buf_wait_for_space(block_lsn);
 
-	ut_ad(log->buf_free <= log->buf_size);
+		log_block = log_sys->buf
+			+ (ulint) (block_lsn % log_sys->buf_size);
 
-	if (str_len > 0) {
-		goto part_loop;
+		log_block_set_first_rec_group(
+			log_block,
+			end_lsn < block_lsn + OS_FILE_LOG_BLOCK_SIZE
+			? (ulint) (end_lsn - block_lsn) : 0);
+
+		log_buf_add_fill(block_lsn, LOG_BLOCK_HDR_SIZE);
+
+		lsn = block_lsn + LOG_BLOCK_HDR_SIZE;
 	}
 
 	srv_stats.log_write_requests.inc();
+
+	return(lsn);
 }
 
 /************************************************************//**
-Closes the log.
-@return	lsn */
+Closes the log: checks if a log flush or a checkpoint is needed after the
+log records ending at end_lsn were written. */
 UNIV_INTERN
-lsn_t
-log_close(void)
-/*===========*/
+void
+log_close(
+/*======*/
+	lsn_t	end_lsn)	/*!< in: end lsn returned by log_open */
 {
-	byte*		log_block;
-	ulint		first_rec_group;
 	lsn_t		oldest_lsn;
-	lsn_t		lsn;
 	lsn_t		tracked_lsn;
 	lsn_t		tracked_lsn_age;
 	log_t*		log	= log_sys;
 	lsn_t		checkpoint_age;
 
-	ut_ad(mutex_own(&(log->mutex)));
 	ut_ad(!recv_no_log_write);
 
-	lsn = log->lsn;
-
-	log_block = static_cast<byte*>(
-		ut_align_down(
-			log->buf + log->buf_free, OS_FILE_LOG_BLOCK_SIZE));
-
-	first_rec_group = log_block_get_first_rec_group(log_block);
-
-	if (first_rec_group == 0) {
-		/* We initialized a new log block which was not written
-		full by the current mtr: the next mtr log record group
-		will start within this block at the offset data_len */
-
-		log_block_set_first_rec_group(
-			log_block, log_block_get_data_len(log_block));
-	}
-
-	if (log->buf_free > log->max_buf_free) {
+	if (end_lsn - log_read_lsn(&log->write_lsn) > log->max_buf_free) {
 
 		log->check_flush_or_checkpoint = TRUE;
 	}
 
 	if (srv_track_changed_pages) {
 
-		tracked_lsn = log_get_tracked_lsn();
-		tracked_lsn_age = lsn - tracked_lsn;
+		tracked_lsn = log_get_tracked_lsn_peek();
+		tracked_lsn_age = end_lsn - tracked_lsn;
 
 		if (tracked_lsn_age >= log->log_group_capacity) {
 
@@ -577,10 +581,25 @@ log_close(void)
 				"tracking thread at LSN " LSN_PF "\n",
 				tracked_lsn);
 			srv_track_changed_pages = FALSE;
+		} else if (tracked_lsn_age > log->max_checkpoint_age) {
+
+			/* log_check_margins() waits for the log tracking
+			thread to catch up */
+			log->check_flush_or_checkpoint = TRUE;
 		}
 	}
 
-	checkpoint_age = lsn - log->last_checkpoint_lsn;
+#ifdef UNIV_LOG_ARCHIVE
+	if (log->archiving_state != LOG_ARCH_OFF
+	    && end_lsn - log->archived_lsn > log->max_archived_lsn_age_async) {
+
+		log->check_flush_or_checkpoint = TRUE;
+	}
+#endif /* UNIV_LOG_ARCHIVE */
+
+	checkpoint_age = end_lsn - log->last_checkpoint_lsn;
+
+	MONITOR_SET(MONITOR_LSN_CHECKPOINT_AGE, checkpoint_age);
 
 	if (checkpoint_age >= log->log_group_capacity) {
 		/* TODO: split btr_store_big_rec_extern_fields() into small
@@ -613,25 +632,17 @@ log_close(void)
 
 	if (checkpoint_age <= log->max_modified_age_sync) {
 
-		goto function_exit;
+		return;
 	}
 
 	oldest_lsn = buf_pool_get_oldest_modification();
 
 	if (!oldest_lsn
-	    || lsn - oldest_lsn > log->max_modified_age_sync
+	    || end_lsn - oldest_lsn > log->max_modified_age_sync
 	    || checkpoint_age > log->max_checkpoint_age_async) {
 
 		log->check_flush_or_checkpoint = TRUE;
 	}
-function_exit:
-
-#ifdef UNIV_LOG_DEBUG
-	log_check_log_recs(log->buf + log->old_buf_free,
-			   log->buf_free - log->old_buf_free, log->old_lsn);
-#endif
-
-	return(lsn);
 }
 
 /******************************************************//**
@@ -642,34 +653,42 @@ void
 log_pad_current_log_block(void)
 /*===========================*/
 {
-	byte		b		= MLOG_DUMMY_RECORD;
+	byte		b[64];
 	ulint		pad_length;
-	ulint		i;
+	lsn_t		start_lsn;
+	lsn_t		end_lsn;
 	lsn_t		lsn;
 
-	/* We retrieve lsn only because otherwise gcc crashed on HP-UX */
-	lsn = log_reserve_and_open(OS_FILE_LOG_BLOCK_SIZE);
+	memset(b, MLOG_DUMMY_RECORD, sizeof b);
 
-	pad_length = OS_FILE_LOG_BLOCK_SIZE
-		- (log_sys->buf_free % OS_FILE_LOG_BLOCK_SIZE)
-		- LOG_BLOCK_TRL_SIZE;
-	if (pad_length
-	    == (OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_HDR_SIZE
-		- LOG_BLOCK_TRL_SIZE)) {
+	/* Reserve the rest of the current block; the length depends on the
+	lsn at which the reservation succeeds */
+	do {
+		start_lsn = log_get_lsn();
 
-		pad_length = 0;
-	}
+		pad_length = OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE
+			- (ulint) (start_lsn % OS_FILE_LOG_BLOCK_SIZE);
 
-	for (i = 0; i < pad_length; i++) {
-		log_write_low(&b, 1);
-	}
+		if (pad_length == LOG_BLOCK_DATA_SIZE) {
 
-	lsn = log_sys->lsn;
+			return;
+		}
+
+		end_lsn = log_calc_end_lsn(start_lsn, pad_length);
+	} while (!log_cas_lsn(start_lsn, end_lsn));
+
+	ut_a(end_lsn % OS_FILE_LOG_BLOCK_SIZE == LOG_BLOCK_HDR_SIZE);
 
-	log_close();
-	log_release();
+	for (lsn = start_lsn; pad_length > 0; ) {
+		ulint	len = ut_min(pad_length, sizeof b);
 
-	ut_a(lsn % OS_FILE_LOG_BLOCK_SIZE == LOG_BLOCK_HDR_SIZE);
+		lsn = log_write_low(b, len, lsn, end_lsn);
+		pad_length -= len;
+	}
+
+	ut_ad(lsn == end_lsn);
+
+	log_close(end_lsn);
 }
 
 /******************************************************//**
@@ -682,7 +701,8 @@ log_group_get_capacity(
 /*===================*/
 	const log_group_t*	group)	/*!< in: log group */
 {
-	ut_ad(mutex_own(&(log_sys->mutex)));
+	ut_ad(mutex_own(&log_sys->mutex)
+	      || mutex_own(&log_sys->write_mutex));
 
 	return((group->file_size - LOG_FILE_HDR_SIZE) * group->n_files);
 }
@@ -699,7 +719,8 @@ log_group_calc_size_offset(
 					log group */
 	const log_group_t*	group)	/*!< in: log group */
 {
-	ut_ad(mutex_own(&(log_sys->mutex)));
+	ut_ad(mutex_own(&log_sys->mutex)
+	      || mutex_own(&log_sys->write_mutex));
 
 	return(offset - LOG_FILE_HDR_SIZE * (1 + offset / group->file_size));
 }
@@ -716,7 +737,8 @@ log_group_calc_real_offset(
 					log group */
 	const log_group_t*	group)	/*!< in: log group */
 {
-	ut_ad(mutex_own(&(log_sys->mutex)));
+	ut_ad(mutex_own(&log_sys->mutex)
+	      || mutex_own(&log_sys->write_mutex));
 
 	return(offset + LOG_FILE_HDR_SIZE
 	       * (1 + offset / (group->file_size - LOG_FILE_HDR_SIZE)));
@@ -738,7 +760,8 @@ log_group_calc_lsn_offset(
 	lsn_t	group_size;
 	lsn_t	offset;
 
-	ut_ad(mutex_own(&(log_sys->mutex)));
+	ut_ad(mutex_own(&log_sys->mutex)
+	      || mutex_own(&log_sys->write_mutex));
 
 	gr_lsn = group->lsn;
 
@@ -939,6 +962,56 @@ log_calc_max_ages(void)
 	return(success);
 }
 
+/******************************************************//**
+Resets the log buffer to start from the given lsn. The caller must own
+log_sys->mutex, and the log writer and flusher threads must not be running. */
+UNIV_INTERN
+void
+log_buf_start(
+/*==========*/
+	lsn_t		lsn,		/*!< in: lsn of the end of the log */
+	lsn_t		written_lsn,	/*!< in: lsn up to which the log is
+					in the log files */
+	const byte*	block)		/*!< in: the last log block, which
+					contains lsn, or NULL to start from
+					an empty block */
+{
+	lsn_t	block_lsn	= ut_uint64_align_down(lsn,
+						       OS_FILE_LOG_BLOCK_SIZE);
+	byte*	log_block	= log_sys->buf
+		+ (ulint) (block_lsn % log_sys->buf_size);
+
+	ut_ad(mutex_own(&log_sys->mutex));
+	ut_ad(!log_writer_thread_active);
+	ut_ad(!log_flusher_thread_active);
+	ut_ad(lsn % OS_FILE_LOG_BLOCK_SIZE >= LOG_BLOCK_HDR_SIZE);
+	ut_ad(written_lsn <= lsn);
+
+	memset(log_sys->buf_fill, 0,
+	       log_sys->buf_size / OS_FILE_LOG_BLOCK_SIZE * sizeof(ulint));
+
+	if (block) {
+		ut_memcpy(log_block, block, OS_FILE_LOG_BLOCK_SIZE);
+	} else {
+		log_block_init(log_block, block_lsn);
+	}
+
+	if (log_block_get_first_rec_group(log_block) == 0) {
+		log_block_set_first_rec_group(
+			log_block, (ulint) (lsn - block_lsn));
+	}
+
+	*log_buf_get_fill(block_lsn) = (ulint) (lsn - block_lsn);
+
+	log_sys->lsn = lsn;
+	log_sys->write_lsn = written_lsn;
+	log_sys->written_to_some_lsn = written_lsn;
+	log_sys->written_to_all_lsn = written_lsn;
+	log_sys->flushed_to_disk_lsn = written_lsn;
+	log_sys->write_req_lsn = written_lsn;
+	log_sys->flush_req_lsn = written_lsn;
+}
+
 /******************************************************//**
 Initializes the log. */
 UNIV_INTERN
@@ -954,6 +1027,17 @@ log_init(void)
 		     &log_sys->log_flush_order_mutex,
 		     SYNC_LOG_FLUSH_ORDER);
 
+	mutex_create(log_write_mutex_key, &log_sys->write_mutex,
+		     SYNC_LOG_WRITE);
+
+	mutex_create(log_flush_mutex_key, &log_sys->flush_mutex,
+		     SYNC_LOG_FLUSH);
+
+#ifndef HAVE_ATOMIC_BUILTINS_64
+	mutex_create(log_lsn_mutex_key, &log_sys->lsn_mutex,
+		     SYNC_NO_ORDER_CHECK);
+#endif /* !HAVE_ATOMIC_BUILTINS_64 */
+
 	mutex_enter(&(log_sys->mutex));
 
 	/* Start the lsn from one log block from zero: this way every
@@ -971,7 +1055,16 @@ log_init(void)
 		ut_align(log_sys->buf_ptr, OS_FILE_LOG_BLOCK_SIZE));
 
 	log_sys->buf_size = LOG_BUFFER_SIZE;
-	log_sys->is_extending = false;
+
+	log_sys->buf_fill = static_cast<ulint*>(
+		mem_zalloc(log_sys->buf_size / OS_FILE_LOG_BLOCK_SIZE
+			   * sizeof(ulint)));
+
+	log_sys->write_buf_ptr = static_cast<byte*>(
+		mem_zalloc(LOG_BUFFER_SIZE + OS_FILE_LOG_BLOCK_SIZE));
+
+	log_sys->write_buf = static_cast<byte*>(
+		ut_align(log_sys->write_buf_ptr, OS_FILE_LOG_BLOCK_SIZE));
 
 	log_sys->max_buf_free = log_sys->buf_size / LOG_BUF_FLUSH_RATIO
 		- LOG_BUF_FLUSH_MARGIN;
@@ -984,24 +1077,15 @@ log_init(void)
 	log_sys->last_printout_time = time(NULL);
 	/*----------------------------*/
 
-	log_sys->buf_next_to_write = 0;
-
-	log_sys->write_lsn = 0;
-	log_sys->current_flush_lsn = 0;
-	log_sys->flushed_to_disk_lsn = 0;
-
-	log_sys->written_to_some_lsn = log_sys->lsn;
-	log_sys->written_to_all_lsn = log_sys->lsn;
-
 	log_sys->n_pending_writes = 0;
 
-	log_sys->no_flush_event = os_event_create();
+	log_sys->writer_event = os_event_create();
+	log_sys->flusher_event = os_event_create();
 
-	os_event_set(log_sys->no_flush_event);
-
-	log_sys->one_flushed_event = os_event_create();
-
-	os_event_set(log_sys->one_flushed_event);
+	for (ulint i = 0; i < LOG_N_WAIT_EVENTS; i++) {
+		log_sys->write_events[i] = os_event_create();
+		log_sys->flush_events[i] = os_event_create();
+	}
 
 	/*----------------------------*/
 
@@ -1047,11 +1131,7 @@ log_init(void)
 
 	/*----------------------------*/
 
-	log_block_init(log_sys->buf, log_sys->lsn);
-	log_block_set_first_rec_group(log_sys->buf, LOG_BLOCK_HDR_SIZE);
-
-	log_sys->buf_free = LOG_BLOCK_HDR_SIZE;
-	log_sys->lsn = LOG_START_LSN + LOG_BLOCK_HDR_SIZE; // TODO(minliz): ensure various LOG_START_LSN?
+	log_buf_start(LOG_START_LSN + LOG_BLOCK_HDR_SIZE, LOG_START_LSN, NULL);
 
 	MONITOR_SET(MONITOR_LSN_CHECKPOINT_AGE,
 		    log_sys->lsn - log_sys->last_checkpoint_lsn);
@@ -1154,114 +1234,6 @@ log_group_init(
 	ut_a(log_calc_max_ages());
 }
 
-/******************************************************************//**
-Does the unlockings needed in flush i/o completion. */
-UNIV_INLINE
-void
-log_flush_do_unlocks(
-/*=================*/
-	ulint	code)	/*!< in: any ORed combination of LOG_UNLOCK_FLUSH_LOCK
-			and LOG_UNLOCK_NONE_FLUSHED_LOCK */
-{
-	ut_ad(mutex_own(&(log_sys->mutex)));
-
-	/* NOTE that we must own the log mutex when doing the setting of the
-	events: this is because transactions will wait for these events to
-	be set, and at that moment the log flush they were waiting for must
-	have ended. If the log mutex were not reserved here, the i/o-thread
-	calling this function might be preempted for a while, and when it
-	resumed execution, it might be that a new flush had been started, and
-	this function would erroneously signal the NEW flush as completed.
-	Thus, the changes in the state of these events are performed
-	atomically in conjunction with the changes in the state of
-	log_sys->n_pending_writes etc. */
-
-	if (code & LOG_UNLOCK_NONE_FLUSHED_LOCK) {
-		os_event_set(log_sys->one_flushed_event);
-	}
-
-	if (code & LOG_UNLOCK_FLUSH_LOCK) {
-		os_event_set(log_sys->no_flush_event);
-	}
-}
-
-/******************************************************************//**
-Checks if a flush is completed for a log group and does the completion
-routine if yes.
-@return	LOG_UNLOCK_NONE_FLUSHED_LOCK or 0 */
-UNIV_INLINE
-ulint
-log_group_check_flush_completion(
-/*=============================*/
-	log_group_t*	group)	/*!< in: log group */
-{
-	ut_ad(mutex_own(&(log_sys->mutex)));
-
-	if (!log_sys->one_flushed && group->n_pending_writes == 0) {
-#ifdef UNIV_DEBUG
-		if (log_debug_writes) {
-			fprintf(stderr,
-				"Log flushed first to group %lu\n",
-				(ulong) group->id);
-		}
-#endif /* UNIV_DEBUG */
-		log_sys->written_to_some_lsn = log_sys->write_lsn;
-		log_sys->one_flushed = TRUE;
-
-		return(LOG_UNLOCK_NONE_FLUSHED_LOCK);
-	}
-
-#ifdef UNIV_DEBUG
-	if (log_debug_writes && (group->n_pending_writes == 0)) {
-
-		fprintf(stderr, "Log flushed to group %lu\n",
-			(ulong) group->id);
-	}
-#endif /* UNIV_DEBUG */
-	return(0);
-}
-
-/******************************************************//**
-Checks if a flush is completed and does the completion routine if yes.
-@return	LOG_UNLOCK_FLUSH_LOCK or 0 */
-static
-ulint
-log_sys_check_flush_completion(void)
-/*================================*/
-{
-	ulint	move_start;
-	ulint	move_end;
-
-	ut_ad(mutex_own(&(log_sys->mutex)));
-
-	if (log_sys->n_pending_writes == 0) {
-
-		log_sys->written_to_all_lsn = log_sys->write_lsn;
-		log_sys->buf_next_to_write = log_sys->write_end_offset;
-
-		if (log_sys->write_end_offset > log_sys->max_buf_free / 2) {
-			/* Move the log buffer content to the start of the
-			buffer */
-
-			move_start = ut_calc_align_down(
-				log_sys->write_end_offset,
-				OS_FILE_LOG_BLOCK_SIZE);
-			move_end = ut_calc_align(log_sys->buf_free,
-						 OS_FILE_LOG_BLOCK_SIZE);
-
-			ut_memmove(log_sys->buf, log_sys->buf + move_start,
-				   move_end - move_start);
-			log_sys->buf_free -= move_start;
-
-			log_sys->buf_next_to_write -= move_start;
-		}
-
-		return(LOG_UNLOCK_FLUSH_LOCK);
-	}
-
-	return(0);
-}
-
 /******************************************************//**
 Completes an i/o to a log file. */
 UNIV_INTERN
@@ -1270,8 +1242,6 @@ log_io_complete(
 /*============*/
 	log_group_t*	group)	/*!< in: log group or a dummy pointer */
 {
-	ulint	unlock;
-
 #ifdef UNIV_LOG_ARCHIVE
 	if ((byte*) group == &log_archive_io) {
 		/* It was an archive write */
@@ -1307,31 +1277,6 @@ log_io_complete(
 
 	ut_error;	/*!< We currently use synchronous writing of the
 			logs and cannot end up here! */
-
-	if (srv_unix_file_flush_method != SRV_UNIX_O_DSYNC
-	    && srv_unix_file_flush_method != SRV_UNIX_ALL_O_DIRECT
-	    && srv_unix_file_flush_method != SRV_UNIX_NOSYNC
-	    && thd_flush_log_at_trx_commit(NULL) != 2) {
-
-		fil_flush(group->space_id);
-	}
-
-	mutex_enter(&(log_sys->mutex));
-	ut_ad(!recv_no_log_write);
-
-	ut_a(group->n_pending_writes > 0);
-	ut_a(log_sys->n_pending_writes > 0);
-
-	group->n_pending_writes--;
-	log_sys->n_pending_writes--;
-	MONITOR_DEC(MONITOR_PENDING_LOG_WRITE);
-
-	unlock = log_group_check_flush_completion(group);
-	unlock = unlock | log_sys_check_flush_completion();
-
-	log_flush_do_unlocks(unlock);
-
-	mutex_exit(&(log_sys->mutex));
 }
 
 /******************************************************//**
@@ -1349,7 +1294,8 @@ log_group_file_header_flush(
 	byte*	buf;
 	lsn_t	dest_offset;
 
-	ut_ad(mutex_own(&(log_sys->mutex)));
+	ut_ad(mutex_own(&log_sys->mutex)
+	      || mutex_own(&log_sys->write_mutex));
 	ut_ad(!recv_no_log_write);
 	ut_a(nth_file < group->n_files);
 
@@ -1416,17 +1362,21 @@ log_group_write_buf(
 	lsn_t		start_lsn,	/*!< in: start lsn of the buffer; must
 					be divisible by
 					OS_FILE_LOG_BLOCK_SIZE */
-	ulint		new_data_offset)/*!< in: start offset of new data in
+	ulint		new_data_offset,/*!< in: start offset of new data in
 					buf: this parameter is used to decide
 					if we have to write a new log file
 					header */
+	bool		encrypt)	/*!< in: whether to encrypt the
+					blocks; the caller must own
+					log_sys->mutex then */
 {
 	ulint		write_len;
 	ibool		write_header;
 	lsn_t		next_offset;
 	ulint		i;
 
-	ut_ad(mutex_own(&(log_sys->mutex)));
+	ut_ad(mutex_own(&log_sys->mutex)
+	      || (!encrypt && mutex_own(&log_sys->write_mutex)));
 	ut_ad(!recv_no_log_write);
 	ut_a(len % OS_FILE_LOG_BLOCK_SIZE == 0);
 	ut_a(start_lsn % OS_FILE_LOG_BLOCK_SIZE == 0);
@@ -1455,90 +1405,422 @@ log_group_write_buf(
 					    start_lsn);
 		srv_stats.os_log_written.add(OS_FILE_LOG_BLOCK_SIZE);
 
-		srv_stats.log_writes.inc();
-	}
+		srv_stats.log_writes.inc();
+	}
+
+	if ((next_offset % group->file_size) + len > group->file_size) {
+
+		/* if the above condition holds, then the below expression
+		is < len which is ulint, so the typecast is ok */
+		write_len = (ulint)
+			(group->file_size - (next_offset % group->file_size));
+	} else {
+		write_len = len;
+	}
+
+#ifdef UNIV_DEBUG
+	if (log_debug_writes) {
+
+		fprintf(stderr,
+			"Writing log file segment to group %lu"
+			" offset " LSN_PF " len %lu\n"
+			"start lsn " LSN_PF "\n"
+			"First block n:o %lu last block n:o %lu\n",
+			(ulong) group->id, next_offset,
+			write_len,
+			start_lsn,
+			(ulong) log_block_get_hdr_no(buf),
+			(ulong) log_block_get_hdr_no(
+				buf + write_len - OS_FILE_LOG_BLOCK_SIZE));
+		ut_a(log_block_get_hdr_no(buf)
+		     == log_block_convert_lsn_to_no(start_lsn));
+
+		for (i = 0; i < write_len / OS_FILE_LOG_BLOCK_SIZE; i++) {
+
+			ut_a(log_block_get_hdr_no(buf) + i
+			     == log_block_get_hdr_no(
+				     buf + i * OS_FILE_LOG_BLOCK_SIZE));
+		}
+	}
+#endif /* UNIV_DEBUG */
+	/* Calculate the checksums for each log block and write them to
+	the trailer fields of the log blocks */
+
+	for (i = 0; i < write_len / OS_FILE_LOG_BLOCK_SIZE; i++) {
+		log_block_store_checksum(buf + i * OS_FILE_LOG_BLOCK_SIZE);
+	}
+
+	if (log_do_write) {
+		log_sys->n_log_ios++;
+
+		MONITOR_INC(MONITOR_LOG_IO);
+
+		srv_stats.os_log_pending_writes.inc();
+
+		ut_a(next_offset / UNIV_PAGE_SIZE <= ULINT_MAX);
+
+		if (encrypt) {
+			log_encrypt_before_write(log_sys->next_checkpoint_no,
+						 buf, write_len);
+		}
+
+		fil_io(OS_FILE_WRITE | OS_FILE_LOG, true, group->space_id, 0,
+		       (ulint) (next_offset / UNIV_PAGE_SIZE),
+		       (ulint) (next_offset % UNIV_PAGE_SIZE), write_len, buf,
+		       group, 0);
+
+		srv_stats.os_log_pending_writes.dec();
+
+		srv_stats.os_log_written.add(write_len);
+		srv_stats.log_writes.inc();
+	}
+
+	if (write_len < len) {
+		start_lsn += write_len;
+		len -= write_len;
+		buf += write_len;
+
+		write_header = TRUE;
+
+		goto loop;
+	}
+}
+
+/******************************************************//**
+Sets the events of the threads waiting for the log to be written or flushed
+up to an lsn which has been passed. */
+static
+void
+log_set_events(
+/*===========*/
+	os_event_t*	events,		/*!< in: log_sys->write_events or
+					log_sys->flush_events */
+	lsn_t		old_lsn,	/*!< in: old value of write_lsn or
+					flushed_to_disk_lsn */
+	lsn_t		new_lsn)	/*!< in: new value */
+{
+	ulint	i	= (ulint) (old_lsn / OS_FILE_LOG_BLOCK_SIZE);
+	ulint	n	= (ulint) (new_lsn / OS_FILE_LOG_BLOCK_SIZE) - i + 1;
+
+	for (n = ut_min(n, LOG_N_WAIT_EVENTS); n > 0; n--, i++) {
+		os_event_set(events[i % LOG_N_WAIT_EVENTS]);
+	}
+}
+
+/******************************************************//**
+Waits until the log has been written or flushed up to an lsn. */
+static
+void
+log_wait_for_lsn(
+/*=============*/
+	lsn_t*		field,	/*!< in: log_sys->write_lsn or
+				log_sys->flushed_to_disk_lsn */
+	os_event_t*	events,	/*!< in: log_sys->write_events or
+				log_sys->flush_events */
+	lsn_t		lsn)	/*!< in: lsn to wait for */
+{
+	os_event_t	event = events[(ulint) (lsn / OS_FILE_LOG_BLOCK_SIZE)
+				       % LOG_N_WAIT_EVENTS];
+
+	for (;;) {
+		ib_int64_t	sig_count = os_event_reset(event);
+
+		if (log_read_lsn(field) >= lsn) {
+
+			return;
+		}
+
+		os_event_wait_low(event, sig_count);
+	}
+}
+
+/******************************************************//**
+Requests the log writer or log flusher thread to advance up to an lsn. */
+static
+void
+log_request(
+/*========*/
+	lsn_t*		field,	/*!< in/out: log_sys->write_req_lsn or
+				log_sys->flush_req_lsn */
+	os_event_t	event,	/*!< in: event of the thread */
+	lsn_t		lsn)	/*!< in: requested lsn */
+{
+#ifdef HAVE_ATOMIC_BUILTINS_64
+	for (;;) {
+		lsn_t	old_lsn = *field;
+
+		if (old_lsn >= lsn) {
+
+			return;
+		}
+
+		if (os_compare_and_swap_uint64(field, old_lsn, lsn)) {
+
+			break;
+		}
+	}
+#else
+	mutex_enter(&log_sys->mutex);
+
+	if (*field >= lsn) {
+		mutex_exit(&log_sys->mutex);
+
+		return;
+	}
+
+	*field = lsn;
+
+	mutex_exit(&log_sys->mutex);
+#endif /* HAVE_ATOMIC_BUILTINS_64 */
+
+	os_event_set(event);
+}
+
+/******************************************************//**
+Writes the log buffer to the log files, up to the end of the last log block
+whose reserved space has been completely copied to the buffer. The caller
+must own log_sys->write_mutex.
+@return	lsn up to which the log has been written */
+static
+lsn_t
+log_write_buf(void)
+/*===============*/
+{
+	log_group_t*	group;
+	lsn_t		write_lsn;
+	lsn_t		ready_lsn;
+	lsn_t		start_lsn;
+	lsn_t		end_lsn;
+	lsn_t		block_lsn;
+	lsn_t		flush_lsn;
+	ib_uint64_t	checkpoint_no;
+	byte*		log_block;
+	ulint		offset;
+	ulint		len;
+	bool		dsync;
+	bool		encrypt	= srv_encrypt_log;
+
+	ut_ad(mutex_own(&log_sys->write_mutex));
+	ut_ad(!recv_no_log_write);
+
+	write_lsn = log_sys->write_lsn;
+	start_lsn = ut_uint64_align_down(write_lsn, OS_FILE_LOG_BLOCK_SIZE);
+
+	/* Find the blocks which have been completely copied. The last one
+	can be partially filled, if it contains the current lsn and nothing
+	is being copied to it. */
+
+	for (block_lsn = start_lsn;
+	     block_lsn < start_lsn + log_sys->buf_size;
+	     block_lsn += OS_FILE_LOG_BLOCK_SIZE) {
+
+		lsn_t	lsn	= log_get_lsn();
+		ulint	fill	= log_buf_read_fill(block_lsn);
+
+		if (fill == OS_FILE_LOG_BLOCK_SIZE) {
+
+			continue;
+		}
+
+		if (lsn < block_lsn + OS_FILE_LOG_BLOCK_SIZE
+		    && fill == lsn - block_lsn
+		    && lsn == log_get_lsn()) {
+
+			block_lsn = lsn;
+		}
+
+		break;
+	}
+
+	ready_lsn = ut_max(block_lsn, write_lsn);
+
+	if (ready_lsn == write_lsn) {
+
+		return(write_lsn);
+	}
+
+	end_lsn = ut_uint64_align_up(ready_lsn, OS_FILE_LOG_BLOCK_SIZE);
+	len = (ulint) (end_lsn - start_lsn);
+	offset = (ulint) (start_lsn % log_sys->buf_size);
+
+	/* Read the blocks only after their fill counters */
+	os_rmb;
+
+	if (offset + len > log_sys->buf_size) {
+		ulint	part = log_sys->buf_size - offset;
+
+		ut_memcpy(log_sys->write_buf, log_sys->buf + offset, part);
+		ut_memcpy(log_sys->write_buf + part, log_sys->buf, len - part);
+	} else {
+		ut_memcpy(log_sys->write_buf, log_sys->buf + offset, len);
+	}
+
+	mutex_enter(&log_sys->mutex);
+
+	checkpoint_no = log_sys->next_checkpoint_no;
+
+	/* Complete the block headers, which are not maintained in
+	log_sys->buf, except for the first record group */
+
+	for (block_lsn = start_lsn, log_block = log_sys->write_buf;
+	     block_lsn < end_lsn;
+	     block_lsn += OS_FILE_LOG_BLOCK_SIZE,
+	     log_block += OS_FILE_LOG_BLOCK_SIZE) {
+
+		log_block_set_hdr_no(log_block,
+				     log_block_convert_lsn_to_no(block_lsn));
+		log_block_set_data_len(
+			log_block,
+			ready_lsn >= block_lsn + OS_FILE_LOG_BLOCK_SIZE
+			? OS_FILE_LOG_BLOCK_SIZE
+			: (ulint) (ready_lsn - block_lsn));
+		log_block_set_checkpoint_no(log_block, checkpoint_no);
+	}
+
+	log_block_set_flush_bit(log_sys->write_buf, TRUE);
+
+	log_sys->n_pending_writes++;
+	MONITOR_INC(MONITOR_PENDING_LOG_WRITE);
+
+	mutex_exit(&log_sys->mutex);
+
+#ifdef UNIV_DEBUG
+	if (log_debug_writes) {
+		fprintf(stderr,
+			"Writing log from " LSN_PF " up to lsn " LSN_PF "\n",
+			write_lsn, ready_lsn);
+	}
+#endif /* UNIV_DEBUG */
+
+	/* The encryption keys of the log are looked up under
+	log_sys->mutex: an encrypted log is written holding it */
+
+	if (encrypt) {
+		mutex_enter(&log_sys->mutex);
+	}
+
+	for (group = UT_LIST_GET_FIRST(log_sys->log_groups);
+	     group != NULL;
+	     group = UT_LIST_GET_NEXT(log_groups, group)) {
+
+		log_group_write_buf(group, log_sys->write_buf, len, start_lsn,
+				    (ulint) (write_lsn - start_lsn),
+				    encrypt);
+	}
+
+	if (encrypt) {
+		mutex_exit(&log_sys->mutex);
+	}
+
+	/* The blocks which were written full can be reused for the lsns
+	one buffer size later */
+
+	for (block_lsn = start_lsn;
+	     block_lsn + OS_FILE_LOG_BLOCK_SIZE <= ready_lsn;
+	     block_lsn += OS_FILE_LOG_BLOCK_SIZE) {
+
+		*log_buf_get_fill(block_lsn) = 0;
+	}
+
+	os_wmb;
+
+	/* O_DSYNC or ALL_O_DIRECT means the OS did not buffer the log
+	file at all: so we have also flushed to disk what we have
+	written */
+	dsync = srv_unix_file_flush_method == SRV_UNIX_O_DSYNC
+		|| srv_unix_file_flush_method == SRV_UNIX_ALL_O_DIRECT;
+
+	mutex_enter(&log_sys->mutex);
+
+	for (group = UT_LIST_GET_FIRST(log_sys->log_groups);
+	     group != NULL;
+	     group = UT_LIST_GET_NEXT(log_groups, group)) {
+
+		log_group_set_fields(group, ready_lsn);
+	}
+
+	log_sys->write_lsn = ready_lsn;
+	log_sys->written_to_some_lsn = ready_lsn;
+	log_sys->written_to_all_lsn = ready_lsn;
+
+	if (dsync) {
+		log_sys->flushed_to_disk_lsn = ready_lsn;
+	}
+
+	flush_lsn = log_sys->flushed_to_disk_lsn;
+
+	log_sys->n_pending_writes--;
+	MONITOR_DEC(MONITOR_PENDING_LOG_WRITE);
+
+	mutex_exit(&log_sys->mutex);
 
-	if ((next_offset % group->file_size) + len > group->file_size) {
+	log_set_events(log_sys->write_events, write_lsn, ready_lsn);
 
-		/* if the above condition holds, then the below expression
-		is < len which is ulint, so the typecast is ok */
-		write_len = (ulint)
-			(group->file_size - (next_offset % group->file_size));
-	} else {
-		write_len = len;
+	if (dsync) {
+		log_set_events(log_sys->flush_events, write_lsn, ready_lsn);
 	}
 
-#ifdef UNIV_DEBUG
-	if (log_debug_writes) {
+	innobase_mysql_log_notify(ready_lsn, flush_lsn);
 
-		fprintf(stderr,
-			"Writing log file segment to group %lu"
-			" offset " LSN_PF " len %lu\n"
-			"start lsn " LSN_PF "\n"
-			"First block n:o %lu last block n:o %lu\n",
-			(ulong) group->id, next_offset,
-			write_len,
-			start_lsn,
-			(ulong) log_block_get_hdr_no(buf),
-			(ulong) log_block_get_hdr_no(
-				buf + write_len - OS_FILE_LOG_BLOCK_SIZE));
-		ut_a(log_block_get_hdr_no(buf)
-		     == log_block_convert_lsn_to_no(start_lsn));
+	return(ready_lsn);
+}
 
-		for (i = 0; i < write_len / OS_FILE_LOG_BLOCK_SIZE; i++) {
+/******************************************************//**
+Flushes the log files to disk up to the lsn to which they have been
+written. The caller must own log_sys->flush_mutex. */
+static
+void
+log_flush_buf(void)
+/*===============*/
+{
+	log_group_t*	group;
+	lsn_t		write_lsn;
+	lsn_t		flush_lsn;
 
-			ut_a(log_block_get_hdr_no(buf) + i
-			     == log_block_get_hdr_no(
-				     buf + i * OS_FILE_LOG_BLOCK_SIZE));
-		}
-	}
-#endif /* UNIV_DEBUG */
-	/* Calculate the checksums for each log block and write them to
-	the trailer fields of the log blocks */
+	ut_ad(mutex_own(&log_sys->flush_mutex));
 
-	for (i = 0; i < write_len / OS_FILE_LOG_BLOCK_SIZE; i++) {
-		log_block_store_checksum(buf + i * OS_FILE_LOG_BLOCK_SIZE);
-	}
+	mutex_enter(&log_sys->mutex);
 
-	if (log_do_write) {
-		log_sys->n_log_ios++;
+	write_lsn = log_sys->write_lsn;
+	flush_lsn = log_sys->flushed_to_disk_lsn;
 
-		MONITOR_INC(MONITOR_LOG_IO);
+	if (write_lsn <= flush_lsn) {
+		mutex_exit(&log_sys->mutex);
 
-		srv_stats.os_log_pending_writes.inc();
+		return;
+	}
 
-		ut_a(next_offset / UNIV_PAGE_SIZE <= ULINT_MAX);
+	log_sys->n_pending_writes++;
+	MONITOR_INC(MONITOR_PENDING_LOG_WRITE);
 
-		log_encrypt_before_write(log_sys->next_checkpoint_no,
-					 buf, write_len);
+	group = UT_LIST_GET_FIRST(log_sys->log_groups);
 
-		fil_io(OS_FILE_WRITE | OS_FILE_LOG, true, group->space_id, 0,
-		       (ulint) (next_offset / UNIV_PAGE_SIZE),
-		       (ulint) (next_offset % UNIV_PAGE_SIZE), write_len, buf,
-		       group, 0);
+	mutex_exit(&log_sys->mutex);
 
-		srv_stats.os_log_pending_writes.dec();
+	fil_flush(group->space_id);
 
-		srv_stats.os_log_written.add(write_len);
-		srv_stats.log_writes.inc();
+	mutex_enter(&log_sys->mutex);
+
+	if (log_sys->flushed_to_disk_lsn < write_lsn) {
+		log_sys->flushed_to_disk_lsn = write_lsn;
 	}
 
-	if (write_len < len) {
-		start_lsn += write_len;
-		len -= write_len;
-		buf += write_len;
+	log_sys->n_pending_writes--;
+	MONITOR_DEC(MONITOR_PENDING_LOG_WRITE);
 
-		write_header = TRUE;
+	mutex_exit(&log_sys->mutex);
 
-		goto loop;
-	}
+	log_set_events(log_sys->flush_events, flush_lsn, write_lsn);
+
+	innobase_mysql_log_notify(write_lsn, write_lsn);
 }
 
 /******************************************************//**
 This function is called, e.g., when a transaction wants to commit. It checks
 that the log has been written to the log file up to the last log entry written
-by the transaction. If there is a flush running, it waits and checks if the
-flush flushed enough. If not, starts a new flush. */
+by the transaction. If the log writer and flusher threads are running, it
+requests them to write or flush the log and waits on the event of the lsn;
+otherwise it does the write and flush itself. */
 UNIV_INTERN
 void
 log_write_up_to(
@@ -1552,18 +1834,6 @@ log_write_up_to(
 			/*!< in: TRUE if we want the written log
 			also to be flushed to disk */
 {
-	log_group_t*	group;
-	ulint		start_offset;
-	ulint		end_offset;
-	ulint		area_start;
-	ulint		area_end;
-#ifdef UNIV_DEBUG
-	ulint		loop_count	= 0;
-#endif /* UNIV_DEBUG */
-	ulint		unlock;
-	ib_uint64_t	write_lsn;
-	ib_uint64_t	flush_lsn;
-
 	ut_ad(!srv_read_only_mode);
 
 	if (recv_no_ibuf_operations) {
@@ -1573,276 +1843,291 @@ log_write_up_to(
 		return;
 	}
 
-loop:
-#ifdef UNIV_DEBUG
-	loop_count++;
+	lsn = ut_min(lsn, log_get_lsn());
 
-	ut_ad(loop_count < 5);
+	if (flush_to_disk
+	    ? log_read_lsn(&log_sys->flushed_to_disk_lsn) >= lsn
+	    : log_read_lsn(&log_sys->write_lsn) >= lsn) {
 
-# if 0
-	if (loop_count > 2) {
-		fprintf(stderr, "Log loop count %lu\n", loop_count);
+		return;
 	}
-# endif
-#endif
 
-	mutex_enter(&(log_sys->mutex));
-	ut_ad(!recv_no_log_write);
+	if (log_writer_thread_active) {
+		/* Only one log group is supported: LOG_WAIT_ONE_GROUP
+		and LOG_WAIT_ALL_GROUPS wait for the same */
 
-	if (flush_to_disk
-	    && log_sys->flushed_to_disk_lsn >= lsn) {
+		if (flush_to_disk) {
+			log_request(&log_sys->flush_req_lsn,
+				    log_sys->flusher_event, lsn);
+		}
 
-		mutex_exit(&(log_sys->mutex));
+		log_request(&log_sys->write_req_lsn,
+			    log_sys->writer_event, lsn);
 
-		return;
-	}
+		if (wait == LOG_NO_WAIT) {
 
-	if (!flush_to_disk
-	    && (log_sys->written_to_all_lsn >= lsn
-		|| (log_sys->written_to_some_lsn >= lsn
-		    && wait != LOG_WAIT_ALL_GROUPS))) {
+			return;
+		}
 
-		mutex_exit(&(log_sys->mutex));
+		ut_ad(wait == LOG_WAIT_ONE_GROUP
+		      || wait == LOG_WAIT_ALL_GROUPS);
+
+		if (flush_to_disk) {
+			log_wait_for_lsn(&log_sys->flushed_to_disk_lsn,
+					 log_sys->flush_events, lsn);
+		} else {
+			log_wait_for_lsn(&log_sys->write_lsn,
+					 log_sys->write_events, lsn);
+		}
 
 		return;
 	}
 
-	if (log_sys->n_pending_writes > 0) {
-		/* A write (+ possibly flush to disk) is running */
-
-		if (flush_to_disk
-		    && log_sys->current_flush_lsn >= lsn) {
-			/* The write + flush will write enough: wait for it to
-			complete */
-
-			goto do_waits;
-		}
+	/* The log threads are not running: write and flush the log in
+	this thread */
 
-		if (!flush_to_disk
-		    && log_sys->write_lsn >= lsn) {
-			/* The write will write enough: wait for it to
-			complete */
+	mutex_enter(&log_sys->write_mutex);
 
-			goto do_waits;
-		}
+	while (log_sys->write_lsn < lsn) {
 
-		mutex_exit(&(log_sys->mutex));
+		if (log_write_buf() < lsn) {
+			/* Some mini-transactions are still copying their
+			log records */
 
-		/* Wait for the write to complete and try to start a new
-		write */
+			mutex_exit(&log_sys->write_mutex);
 
-		os_event_wait(log_sys->no_flush_event);
+			os_thread_yield();
 
-		goto loop;
+			mutex_enter(&log_sys->write_mutex);
+		}
 	}
 
-	if (!flush_to_disk
-	    && log_sys->buf_free == log_sys->buf_next_to_write) {
-		/* Nothing to write and no flush to disk requested */
+	mutex_exit(&log_sys->write_mutex);
 
-		mutex_exit(&(log_sys->mutex));
+	if (flush_to_disk) {
+		mutex_enter(&log_sys->flush_mutex);
 
-		return;
-	}
+		log_flush_buf();
 
-#ifdef UNIV_DEBUG
-	if (log_debug_writes) {
-		fprintf(stderr,
-			"Writing log from " LSN_PF " up to lsn " LSN_PF "\n",
-			log_sys->written_to_all_lsn,
-			log_sys->lsn);
+		mutex_exit(&log_sys->flush_mutex);
 	}
-#endif /* UNIV_DEBUG */
-	log_sys->n_pending_writes++;
-	MONITOR_INC(MONITOR_PENDING_LOG_WRITE);
+}
 
-	group = UT_LIST_GET_FIRST(log_sys->log_groups);
-	group->n_pending_writes++;	/*!< We assume here that we have only
-					one log group! */
+/****************************************************************//**
+Does a syncronous flush of the log buffer to disk. */
+UNIV_INTERN
+void
+log_buffer_flush_to_disk(void)
+/*==========================*/
+{
+	ut_ad(!srv_read_only_mode);
 
-	os_event_reset(log_sys->no_flush_event);
-	os_event_reset(log_sys->one_flushed_event);
+	log_write_up_to(log_get_lsn(), LOG_WAIT_ALL_GROUPS, TRUE);
+}
 
-	start_offset = log_sys->buf_next_to_write;
-	end_offset = log_sys->buf_free;
+/****************************************************************//**
+This functions writes the log buffer to the log file and if 'flush'
+is set it forces a flush of the log file as well. This is meant to be
+called from background master thread only as it does not wait for
+the write (+ possible flush) to finish. */
+UNIV_INTERN
+void
+log_buffer_sync_in_background(
+/*==========================*/
+	ibool	flush)	/*!< in: flush the logs to disk */
+{
+	log_write_up_to(log_get_lsn(), LOG_NO_WAIT, flush);
+}
 
-	area_start = ut_calc_align_down(start_offset, OS_FILE_LOG_BLOCK_SIZE);
-	area_end = ut_calc_align(end_offset, OS_FILE_LOG_BLOCK_SIZE);
+/********************************************************************
 
-	ut_ad(area_end - area_start > 0);
+Tries to establish a big enough margin of free space in the log buffer, such
+that a new log entry can be catenated without an immediate need for a flush. */
+static
+void
+log_flush_margin(void)
+/*==================*/
+{
+	lsn_t	lsn	= log_get_lsn();
 
-	log_sys->write_lsn = log_sys->lsn;
+	if (lsn - log_read_lsn(&log_sys->write_lsn) > log_sys->max_buf_free) {
 
-	if (flush_to_disk) {
-		log_sys->current_flush_lsn = log_sys->lsn;
+		log_write_up_to(lsn, LOG_NO_WAIT, FALSE);
 	}
+}
 
-	log_sys->one_flushed = FALSE;
+/******************************************************************//**
+The log writer thread: writes the log buffer to the log files when a write
+has been requested with log_write_up_to(), as far as the buffer has been
+filled by the mini-transactions.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(log_writer_thread)(
+/*==============================*/
+	void*	arg __attribute__((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(log_writer_thread_key);
+#endif /* UNIV_PFS_THREAD */
 
-	log_block_set_flush_bit(log_sys->buf + area_start, TRUE);
-	log_block_set_checkpoint_no(
-		log_sys->buf + area_end - OS_FILE_LOG_BLOCK_SIZE,
-		log_sys->next_checkpoint_no);
+	for (;;) {
+		ib_int64_t	sig_count;
+		lsn_t		req_lsn;
+		lsn_t		old_lsn;
+		lsn_t		write_lsn;
 
-	/* Copy the last, incompletely written, log block a log block length
-	up, so that when the flush operation writes from the log buffer, the
-	segment to write will not be changed by writers to the log */
+		sig_count = os_event_reset(log_sys->writer_event);
 
-	ut_memcpy(log_sys->buf + area_end,
-		  log_sys->buf + area_end - OS_FILE_LOG_BLOCK_SIZE,
-		  OS_FILE_LOG_BLOCK_SIZE);
+		req_lsn = log_read_lsn(&log_sys->write_req_lsn);
 
-	log_sys->buf_free += OS_FILE_LOG_BLOCK_SIZE;
-	log_sys->write_end_offset = log_sys->buf_free;
+		if (log_read_lsn(&log_sys->write_lsn) >= req_lsn) {
 
-	group = UT_LIST_GET_FIRST(log_sys->log_groups);
+			if (log_threads_shutdown) {
 
-	/* Do the write to the log files */
+				break;
+			}
 
-	while (group) {
-		log_group_write_buf(
-			group, log_sys->buf + area_start,
-			area_end - area_start,
-			ut_uint64_align_down(log_sys->written_to_all_lsn,
-					     OS_FILE_LOG_BLOCK_SIZE),
-			start_offset - area_start);
+			os_event_wait_low(log_sys->writer_event, sig_count);
 
-		log_group_set_fields(group, log_sys->write_lsn);
+			continue;
+		}
 
-		group = UT_LIST_GET_NEXT(log_groups, group);
-	}
+		mutex_enter(&log_sys->write_mutex);
 
-	mutex_exit(&(log_sys->mutex));
+		old_lsn = log_sys->write_lsn;
+		write_lsn = log_write_buf();
 
-	if (srv_unix_file_flush_method == SRV_UNIX_O_DSYNC
-	    || srv_unix_file_flush_method == SRV_UNIX_ALL_O_DIRECT) {
-		/* O_DSYNC or ALL_O_DIRECT means the OS did not buffer the log
-		file at all: so we have also flushed to disk what we have
-		written */
+		mutex_exit(&log_sys->write_mutex);
 
-		log_sys->flushed_to_disk_lsn = log_sys->write_lsn;
+		if (write_lsn == old_lsn) {
+			/* The log records up to the requested lsn are
+			still being copied to the log buffer */
 
-	} else if (flush_to_disk) {
+			os_thread_yield();
 
-		group = UT_LIST_GET_FIRST(log_sys->log_groups);
+		} else if (log_read_lsn(&log_sys->flush_req_lsn)
+			   > log_read_lsn(&log_sys->flushed_to_disk_lsn)) {
 
-		fil_flush(group->space_id);
-		log_sys->flushed_to_disk_lsn = log_sys->write_lsn;
+			os_event_set(log_sys->flusher_event);
+		}
 	}
 
-	mutex_enter(&(log_sys->mutex));
+	log_writer_thread_active = false;
 
-	group = UT_LIST_GET_FIRST(log_sys->log_groups);
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
 
-	ut_a(group->n_pending_writes == 1);
-	ut_a(log_sys->n_pending_writes == 1);
+	OS_THREAD_DUMMY_RETURN;
+}
 
-	group->n_pending_writes--;
-	log_sys->n_pending_writes--;
-	MONITOR_DEC(MONITOR_PENDING_LOG_WRITE);
+/******************************************************************//**
+The log flusher thread: flushes the log files to disk when a flush has been
+requested with log_write_up_to(), as far as the log has been written by the
+log writer thread.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(log_flusher_thread)(
+/*===============================*/
+	void*	arg __attribute__((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(log_flusher_thread_key);
+#endif /* UNIV_PFS_THREAD */
 
-	unlock = log_group_check_flush_completion(group);
-	unlock = unlock | log_sys_check_flush_completion();
+	for (;;) {
+		ib_int64_t	sig_count;
+		lsn_t		flush_lsn;
 
-	log_flush_do_unlocks(unlock);
+		sig_count = os_event_reset(log_sys->flusher_event);
 
-	write_lsn = log_sys->write_lsn;
-	flush_lsn = log_sys->flushed_to_disk_lsn;
+		flush_lsn = log_read_lsn(&log_sys->flushed_to_disk_lsn);
 
-	mutex_exit(&(log_sys->mutex));
+		if (log_read_lsn(&log_sys->flush_req_lsn) <= flush_lsn
+		    || log_read_lsn(&log_sys->write_lsn) <= flush_lsn) {
 
-	innobase_mysql_log_notify(write_lsn, flush_lsn);
+			/* The log writer thread wakes us up after it has
+			written the log. It exits first at shutdown. */
 
-	return;
+			if (log_threads_shutdown
+			    && !log_writer_thread_active) {
 
-do_waits:
-	mutex_exit(&(log_sys->mutex));
+				break;
+			}
 
-	switch (wait) {
-	case LOG_WAIT_ONE_GROUP:
-		os_event_wait(log_sys->one_flushed_event);
-		break;
-	case LOG_WAIT_ALL_GROUPS:
-		os_event_wait(log_sys->no_flush_event);
-		break;
-#ifdef UNIV_DEBUG
-	case LOG_NO_WAIT:
-		break;
-	default:
-		ut_error;
-#endif /* UNIV_DEBUG */
-	}
-}
+			os_event_wait_low(log_sys->flusher_event, sig_count);
 
-/****************************************************************//**
-Does a syncronous flush of the log buffer to disk. */
-UNIV_INTERN
-void
-log_buffer_flush_to_disk(void)
-/*==========================*/
-{
-	lsn_t	lsn;
+			continue;
+		}
 
-	ut_ad(!srv_read_only_mode);
-	mutex_enter(&(log_sys->mutex));
+		mutex_enter(&log_sys->flush_mutex);
 
-	lsn = log_sys->lsn;
+		log_flush_buf();
 
-	mutex_exit(&(log_sys->mutex));
+		mutex_exit(&log_sys->flush_mutex);
+	}
 
-	log_write_up_to(lsn, LOG_WAIT_ALL_GROUPS, TRUE);
+	log_flusher_thread_active = false;
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
 }
 
-/****************************************************************//**
-This functions writes the log buffer to the log file and if 'flush'
-is set it forces a flush of the log file as well. This is meant to be
-called from background master thread only as it does not wait for
-the write (+ possible flush) to finish. */
+/******************************************************//**
+Creates the log writer and log flusher threads. From then on, the log
+buffer is written and flushed to the log files by these threads. */
 UNIV_INTERN
 void
-log_buffer_sync_in_background(
-/*==========================*/
-	ibool	flush)	/*!< in: flush the logs to disk */
+log_threads_start(void)
+/*===================*/
 {
-	lsn_t	lsn;
-
-	mutex_enter(&(log_sys->mutex));
-
-	lsn = log_sys->lsn;
+	ut_ad(!srv_read_only_mode);
+	ut_ad(!log_writer_thread_active);
+	ut_ad(!log_flusher_thread_active);
 
-	mutex_exit(&(log_sys->mutex));
+	log_threads_shutdown = false;
+	log_writer_thread_active = true;
+	log_flusher_thread_active = true;
 
-	log_write_up_to(lsn, LOG_NO_WAIT, flush);
+	os_thread_create(log_writer_thread, NULL, NULL);
+	os_thread_create(log_flusher_thread, NULL, NULL);
 }
 
-/********************************************************************
-
-Tries to establish a big enough margin of free space in the log buffer, such
-that a new log entry can be catenated without an immediate need for a flush. */
-static
+/******************************************************//**
+Writes and flushes the whole log buffer and stops the log writer and
+log flusher threads. From then on, log_write_up_to() does the writes
+and flushes itself. */
+UNIV_INTERN
 void
-log_flush_margin(void)
+log_threads_stop(void)
 /*==================*/
 {
-	log_t*	log	= log_sys;
-	lsn_t	lsn	= 0;
+	if (!log_writer_thread_active && !log_flusher_thread_active) {
 
-	mutex_enter(&(log->mutex));
+		return;
+	}
 
-	if (log->buf_free > log->max_buf_free) {
+	log_buffer_flush_to_disk();
 
-		if (log->n_pending_writes > 0) {
-			/* A flush is running: hope that it will provide enough
-			free space */
-		} else {
-			lsn = log->lsn;
-		}
+	log_threads_shutdown = true;
+
+	os_event_set(log_sys->writer_event);
+
+	while (log_writer_thread_active) {
+		os_thread_sleep(10000);
 	}
 
-	mutex_exit(&(log->mutex));
+	os_event_set(log_sys->flusher_event);
 
-	if (lsn) {
-		log_write_up_to(lsn, LOG_NO_WAIT, FALSE);
+	while (log_flusher_thread_active) {
+		os_thread_sleep(10000);
 	}
 }
 
@@ -3737,6 +4022,8 @@ logs_empty_and_mark_files_at_shutdown(void)
 			os_event_set(srv_checkpoint_completed_event);
 		}
 
+		log_threads_stop();
+
 		fil_close_all_files();
 
 		thread_name = srv_any_background_threads_are_active();
@@ -3845,6 +4132,8 @@ logs_empty_and_mark_files_at_shutdown(void)
 		fil_flush_file_spaces(FIL_TABLESPACE);
 	}
 
+	log_threads_stop();
+
 	fil_close_all_files();
 
 	/* Make some checks that the server really is quiet */
@@ -4078,13 +4367,28 @@ log_shutdown(void)
 	mem_free(log_sys->archive_buf_ptr);
 	log_sys->archive_buf_ptr = NULL;
 	log_sys->archive_buf = NULL;
+	mem_free(log_sys->write_buf_ptr);
+	log_sys->write_buf_ptr = NULL;
+	log_sys->write_buf = NULL;
+	mem_free(log_sys->buf_fill);
+	log_sys->buf_fill = NULL;
 
-	os_event_free(log_sys->no_flush_event);
-	os_event_free(log_sys->one_flushed_event);
+	os_event_free(log_sys->writer_event);
+	os_event_free(log_sys->flusher_event);
+
+	for (ulint i = 0; i < LOG_N_WAIT_EVENTS; i++) {
+		os_event_free(log_sys->write_events[i]);
+		os_event_free(log_sys->flush_events[i]);
+	}
 
 	rw_lock_free(&log_sys->checkpoint_lock);
 
 	mutex_free(&log_sys->mutex);
+	mutex_free(&log_sys->write_mutex);
+	mutex_free(&log_sys->flush_mutex);
+#ifndef HAVE_ATOMIC_BUILTINS_64
+	mutex_free(&log_sys->lsn_mutex);
+#endif /* !HAVE_ATOMIC_BUILTINS_64 */
 
 #ifdef UNIV_LOG_ARCHIVE
 	rw_lock_free(&log_sys->archive_lock);
@@ -179,6 +179,7 @@ UNIV_INTERN mysql_pfs_key_t	recv_sys_mutex_key;
 #ifndef UNIV_HOTBACKUP
 # ifdef UNIV_PFS_THREAD
 UNIV_INTERN mysql_pfs_key_t	recv_writer_thread_key;
+UNIV_INTERN mysql_pfs_key_t	recv_apply_thread_key;
 # endif /* UNIV_PFS_THREAD */
 
 # ifdef UNIV_PFS_MUTEX
@@ -188,6 +189,16 @@ UNIV_INTERN mysql_pfs_key_t	recv_writer_mutex_key;
 /** Flag indicating if recv_writer thread is active. */
 UNIV_INTERN bool		recv_writer_thread_active = false;
 UNIV_INTERN os_thread_t		recv_writer_thread_handle = 0;
+
+/** Number of partitions of the pages in an apply batch, one for each
+recv_apply_thread */
+static ulint			recv_apply_n_parts;
+/** Number of recv_apply_thread which have not yet gone through their
+partition; protected by recv_sys->mutex */
+static ulint			recv_apply_n_active;
+
+/** Interval in seconds between the progress reports of an apply batch */
+#define RECV_APPLY_PROGRESS_INTERVAL	10
 #endif /* !UNIV_HOTBACKUP */
 
 /* prototypes */
@@ -587,7 +598,8 @@ recv_truncate_group(
 
 		len = (ulint) (end_lsn - start_lsn);
 
-		log_group_write_buf(group, log_sys->buf, len, start_lsn, 0);
+		log_group_write_buf(group, log_sys->buf, len, start_lsn, 0,
+				    true);
 		if (end_lsn >= finish_lsn) {
 
 			return;
@@ -641,7 +653,8 @@ recv_copy_group(
 
 		len = (ulint) (end_lsn - start_lsn);
 
-		log_group_write_buf(group, log_sys->buf, len, start_lsn, 0);
+		log_group_write_buf(group, log_sys->buf, len, start_lsn, 0,
+				    true);
 
 		if (end_lsn >= recovered_lsn) {
 
@@ -1850,6 +1863,146 @@ recv_read_in_area(
 	return(n);
 }
 
+/*******************************************************************//**
+Returns the partition of the pages of an apply batch to which a page
+belongs. The pages of a read-ahead area belong to the same partition, so
+that recv_read_in_area() reads the pages of the calling thread.
+@return partition number */
+UNIV_INLINE
+ulint
+recv_apply_get_part(
+/*================*/
+	ulint	space,	/*!< in: space id */
+	ulint	page_no)/*!< in: page number */
+{
+	return(ut_fold_ulint_pair(space, page_no / RECV_READ_AHEAD_AREA)
+	       % recv_apply_n_parts);
+}
+
+/*******************************************************************//**
+Applies the log records of the pages of a partition of the hash table.
+The pages which are in the buffer pool are recovered by the calling
+thread; the other pages are read in read-ahead areas, and recovered by
+the i/o handler threads when the reads complete. */
+static
+void
+recv_apply_part(
+/*============*/
+	ulint	part)	/*!< in: partition number */
+{
+	recv_addr_t*	recv_addr;
+	ulint		i;
+	mtr_t		mtr;
+
+	mutex_enter(&recv_sys->mutex);
+
+	for (i = 0; i < hash_get_n_cells(recv_sys->addr_hash); i++) {
+
+		for (recv_addr = static_cast<recv_addr_t*>(
+				HASH_GET_FIRST(recv_sys->addr_hash, i));
+		     recv_addr != 0;
+		     recv_addr = static_cast<recv_addr_t*>(
+				HASH_GET_NEXT(addr_hash, recv_addr))) {
+
+			ulint	space = recv_addr->space;
+			ulint	page_no = recv_addr->page_no;
+			ulint	zip_size;
+
+			if (recv_addr->state != RECV_NOT_PROCESSED
+			    || recv_apply_get_part(space, page_no) != part) {
+
+				continue;
+			}
+
+			mutex_exit(&recv_sys->mutex);
+
+			zip_size = fil_space_get_zip_size(space);
+
+			if (buf_page_peek(space, page_no)) {
+				buf_block_t*	block;
+
+				mtr_start(&mtr);
+
+				block = buf_page_get(
+					space, zip_size, page_no,
+					RW_X_LATCH, &mtr);
+				buf_block_dbg_add_level(
+					block, SYNC_NO_ORDER_CHECK);
+
+				recv_recover_page(FALSE, block);
+				mtr_commit(&mtr);
+			} else {
+				recv_read_in_area(space, zip_size, page_no);
+			}
+
+			mutex_enter(&recv_sys->mutex);
+		}
+	}
+
+	ut_ad(recv_apply_n_active > 0);
+	recv_apply_n_active--;
+
+	mutex_exit(&recv_sys->mutex);
+}
+
+/******************************************************************//**
+A thread which applies the log records of a partition of the pages in an
+apply batch.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(recv_apply_thread)(
+/*==============================*/
+	void*	arg)	/*!< in: the partition number */
+{
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(recv_apply_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	recv_apply_part((ulint) arg);
+
+	/* We count the number of threads in os_thread_exit().
+	A created thread should always use that to exit and not
+	use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*******************************************************************//**
+Prints the progress of an apply batch, with an estimate of the time it
+still takes, to the error log. */
+static
+void
+recv_apply_print_progress(
+/*======================*/
+	ulint		n_total,	/*!< in: number of pages in the
+					batch */
+	ulint		n_left,		/*!< in: number of pages still to
+					be recovered */
+	ib_time_t	start_time)	/*!< in: start time of the batch */
+{
+	ulint	n_done	= n_total - n_left;
+	ulint	elapsed	= (ulint) (ut_time() - start_time);
+	ulint	progress = n_done * 100 / n_total;
+
+	if (n_done == 0) {
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Applying a batch of log records: 0 of %lu pages"
+			" recovered after %lu seconds",
+			(ulong) n_total, (ulong) elapsed);
+	} else {
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Applying a batch of log records: %lu of %lu pages"
+			" recovered (%lu%%), estimated %lu seconds left",
+			(ulong) n_done, (ulong) n_total, (ulong) progress,
+			(ulong) (elapsed * n_left / n_done));
+	}
+
+	sd_notifyf(0, "STATUS=Applying batch of log records for"
+		   " InnoDB: Progress %lu", progress);
+}
+
 /*******************************************************************//**
 Empties the hash table of stored log records, applying them to appropriate
 pages.
@@ -1868,12 +2021,12 @@ recv_apply_hashed_log_recs(
 				the caller must in this case own the log
 				mutex */
 {
-	recv_addr_t* recv_addr;
-	ulint	i;
-	ibool	has_printed	= FALSE;
-	ulong progress;
-	mtr_t	mtr;
-	dberr_t err = DB_SUCCESS;
+	ulint		n_total;
+	ulint		i;
+	ibool		has_printed	= FALSE;
+	ib_time_t	start_time;
+	ib_time_t	last_printed;
+	dberr_t		err = DB_SUCCESS;
 loop:
 	mutex_enter(&(recv_sys->mutex));
 
@@ -1895,80 +2048,47 @@ recv_apply_hashed_log_recs(
 	recv_sys->apply_log_recs = TRUE;
 	recv_sys->apply_batch_on = TRUE;
 
-	for (i = 0; i < hash_get_n_cells(recv_sys->addr_hash); i++) {
+	n_total = recv_sys->n_addrs;
 
-		for (recv_addr = static_cast<recv_addr_t*>(
-				HASH_GET_FIRST(recv_sys->addr_hash, i));
-		     recv_addr != 0;
-		     recv_addr = static_cast<recv_addr_t*>(
-				HASH_GET_NEXT(addr_hash, recv_addr))) {
-
-			ulint	space = recv_addr->space;
-			ulint	zip_size = fil_space_get_zip_size(space);
-			ulint	page_no = recv_addr->page_no;
-
-			if (recv_addr->state == RECV_NOT_PROCESSED) {
-				if (!has_printed) {
-					ib_logf(IB_LOG_LEVEL_INFO,
-						"Starting an apply batch"
-						" of log records"
-						" to the database...");
-					fputs("InnoDB: Progress in percent: ",
-					      stderr);
-					has_printed = TRUE;
-				}
-
-				mutex_exit(&(recv_sys->mutex));
-
-				if (buf_page_peek(space, page_no)) {
-					buf_block_t*	block;
-
-					mtr_start(&mtr);
-
-					block = buf_page_get(
-						space, zip_size, page_no,
-						RW_X_LATCH, &mtr);
-					buf_block_dbg_add_level(
-						block, SYNC_NO_ORDER_CHECK);
-
-					recv_recover_page(FALSE, block);
-					mtr_commit(&mtr);
-				} else {
-					recv_read_in_area(space, zip_size,
-							  page_no);
-				}
+	if (n_total > 0) {
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Starting an apply batch of log records to %lu pages"
+			" of the database with %lu threads...",
+			(ulong) n_total, (ulong) srv_recovery_apply_threads);
+		has_printed = TRUE;
 
-				mutex_enter(&(recv_sys->mutex));
-			}
-		}
+		/* Partition the pages by read-ahead area among the
+		threads: each thread recovers the pages of its partition
+		which are in the buffer pool and issues the reads of
+		the others */
 
-                progress = (ulong) (i * 100)
-                                   / hash_get_n_cells(recv_sys->addr_hash);
-		if (has_printed
-		    && progress
-		    != ((i + 1) * 100)
-		    / hash_get_n_cells(recv_sys->addr_hash)) {
+		recv_apply_n_parts = srv_recovery_apply_threads;
+		recv_apply_n_active = recv_apply_n_parts;
 
-                        fprintf(stderr, "%lu ", progress);
-                        sd_notifyf(0, "STATUS=Applying batch of log records for"
-                                   " InnoDB: Progress %lu", progress);
+		for (i = 0; i < recv_apply_n_parts; i++) {
+			os_thread_create(recv_apply_thread, (void*) i, NULL);
 		}
 	}
 
+	start_time = last_printed = ut_time();
+
 	/* Wait until all the pages have been processed */
 
-	while (recv_sys->n_addrs != 0) {
+	while (recv_apply_n_active > 0 || recv_sys->n_addrs != 0) {
 
 		mutex_exit(&(recv_sys->mutex));
 
-		os_thread_sleep(500000);
+		os_thread_sleep(100000);
 
 		mutex_enter(&(recv_sys->mutex));
-	}
 
-	if (has_printed) {
+		if (ut_time() - last_printed
+		    >= RECV_APPLY_PROGRESS_INTERVAL) {
 
-		fprintf(stderr, "\n");
+			recv_apply_print_progress(
+				n_total, recv_sys->n_addrs, start_time);
+			last_printed = ut_time();
+		}
 	}
 
 	if (!allow_ibuf) {
@@ -2012,7 +2132,9 @@ recv_apply_hashed_log_recs(
 	err = recv_sys_empty_hash();
 
 	if (has_printed) {
-		fprintf(stderr, "InnoDB: Apply batch completed\n");
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Apply batch completed in %lu seconds",
+			(ulong) (ut_time() - start_time));
 		sd_notify(0, "STATUS=InnoDB: Apply batch completed");
 	}
 
@@ -3429,14 +3551,8 @@ recv_recovery_from_checkpoint_start_func(
 		srv_start_lsn = recv_sys->recovered_lsn;
 	}
 
-	log_sys->lsn = recv_sys->recovered_lsn;
-
-	ut_memcpy(log_sys->buf, recv_sys->last_block, OS_FILE_LOG_BLOCK_SIZE);
-
-	log_sys->buf_free = (ulint) log_sys->lsn % OS_FILE_LOG_BLOCK_SIZE;
-	log_sys->buf_next_to_write = log_sys->buf_free;
-	log_sys->written_to_some_lsn = log_sys->lsn;
-	log_sys->written_to_all_lsn = log_sys->lsn;
+	log_buf_start(recv_sys->recovered_lsn, recv_sys->recovered_lsn,
+		      recv_sys->last_block);
 
 	log_sys->last_checkpoint_lsn = checkpoint_lsn;
 
@@ -3641,10 +3757,6 @@ recv_reset_logs(
 		group = UT_LIST_GET_NEXT(log_groups, group);
 	}
 
-	log_sys->buf_next_to_write = 0;
-	log_sys->written_to_some_lsn = log_sys->lsn;
-	log_sys->written_to_all_lsn = log_sys->lsn;
-
 	log_sys->next_checkpoint_no = 0;
 	log_sys->last_checkpoint_lsn = 0;
 
@@ -3654,11 +3766,7 @@ recv_reset_logs(
 
 	log_sys->tracked_lsn = log_sys->lsn;
 
-	log_block_init(log_sys->buf, log_sys->lsn);
-	log_block_set_first_rec_group(log_sys->buf, LOG_BLOCK_HDR_SIZE);
-
-	log_sys->buf_free = LOG_BLOCK_HDR_SIZE;
-	log_sys->lsn += LOG_BLOCK_HDR_SIZE;
+	log_buf_start(log_sys->lsn + LOG_BLOCK_HDR_SIZE, log_sys->lsn, NULL);
 
 	MONITOR_SET(MONITOR_LSN_CHECKPOINT_AGE,
 		    (log_sys->lsn - log_sys->last_checkpoint_lsn));
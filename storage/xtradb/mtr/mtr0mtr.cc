@@ -197,39 +197,6 @@ mtr_memo_note_modifications(
 	}
 }
 
-/************************************************************//**
-Append the dirty pages to the flush list. */
-static
-void
-mtr_add_dirtied_pages_to_flush_list(
-/*================================*/
-	mtr_t*	mtr)	/*!< in/out: mtr */
-{
-	ut_ad(!srv_read_only_mode);
-
-	/* No need to acquire log_flush_order_mutex if this mtr has
-	not dirtied a clean page. log_flush_order_mutex is used to
-	ensure ordered insertions in the flush_list. We need to
-	insert in the flush_list iff the page in question was clean
-	before modifications. */
-	if (mtr->made_dirty) {
-		log_flush_order_mutex_enter();
-	}
-
-	/* It is now safe to release the log mutex because the
-	flush_order mutex will ensure that we are the first one
-	to insert into the flush list. */
-	log_release();
-
-	if (mtr->modifications) {
-		mtr_memo_note_modifications(mtr);
-	}
-
-	if (mtr->made_dirty) {
-		log_flush_order_mutex_exit();
-	}
-}
-
 /************************************************************//**
 Writes the contents of a mini-transaction log, if any, to the database log. */
 static
@@ -255,52 +222,54 @@ mtr_log_reserve_and_write(
 				     | MLOG_SINGLE_REC_FLAG);
 	}
 
-	if (mlog->heap == NULL) {
-		ulint	len;
-
-		len = mtr->log_mode != MTR_LOG_NO_REDO
-			? dyn_block_get_used(mlog) : 0;
-
-		mtr->end_lsn = log_reserve_and_write_fast(
-			first_data, len, &mtr->start_lsn);
+	if (mtr->log_mode == MTR_LOG_ALL) {
+		data_size = dyn_array_get_data_size(mlog);
+	} else {
+		ut_ad(mtr->log_mode == MTR_LOG_NONE
+		      || mtr->log_mode == MTR_LOG_NO_REDO);
+		data_size = 0;
+	}
 
-		if (mtr->end_lsn) {
+	/* No need to acquire log_flush_order_mutex if this mtr has
+	not dirtied a clean page. log_flush_order_mutex is used to
+	ensure ordered insertions in the flush_list. We need to
+	insert in the flush_list iff the page in question was clean
+	before modifications. The log space is reserved while holding
+	it, so that the pages are inserted in the lsn order. */
+	if (mtr->made_dirty) {
+		log_flush_order_mutex_enter();
+	}
 
-			/* Success. We have the log mutex.
-			Add pages to flush list and exit */
-			mtr_add_dirtied_pages_to_flush_list(mtr);
+	mtr->start_lsn = log_open(data_size, &mtr->end_lsn);
 
-			return;
-		}
-	} else {
-		mutex_enter(&log_sys->mutex);
+	if (mtr->modifications) {
+		mtr_memo_note_modifications(mtr);
 	}
 
-	data_size = dyn_array_get_data_size(mlog);
+	if (mtr->made_dirty) {
+		log_flush_order_mutex_exit();
+	}
 
-	/* Open the database log for log_write_low */
-	mtr->start_lsn = log_open(data_size);
+	/* Copy the log records to the reserved space. Other
+	mini-transactions copy theirs at the same time. */
 
-	if (mtr->log_mode == MTR_LOG_ALL) {
+	if (data_size > 0) {
+		lsn_t	lsn = mtr->start_lsn;
 
 		for (dyn_block_t* block = mlog;
 		     block != 0;
 		     block = dyn_array_get_next_block(mlog, block)) {
 
-			log_write_low(
+			lsn = log_write_low(
 				dyn_block_get_data(block),
-				dyn_block_get_used(block));
+				dyn_block_get_used(block),
+				lsn, mtr->end_lsn);
 		}
 
-	} else {
-		ut_ad(mtr->log_mode == MTR_LOG_NONE
-		      || mtr->log_mode == MTR_LOG_NO_REDO);
-		/* Do nothing */
+		ut_ad(lsn == mtr->end_lsn);
 	}
 
-	mtr->end_lsn = log_close();
-
-	mtr_add_dirtied_pages_to_flush_list(mtr);
+	log_close(mtr->end_lsn);
 }
 #endif /* !UNIV_HOTBACKUP */
 
@@ -208,7 +208,7 @@ que_thr_end_lock_wait(
 	ulint		ms;
 	ib_uint64_t	now;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_mutex_own() || lock_mutex_own_shared());
 	ut_ad(trx_mutex_own(trx));
 
 	thr = trx->lock.wait_thr;
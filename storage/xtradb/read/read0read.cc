@@ -135,15 +135,17 @@ FACT C: Purge does not remove any delete-marked row that is visible
 in any cursor read view.
 
 PROOF: We know that:
- 1: Currently active read views in trx_sys_t::view_list are ordered by
-    read_view_t::low_limit_no in descending order, that is,
-    newest read view first.
+ 1: Purge first copies the current state of trx_sys to a view of its own,
+    then clones the oldest open view in trx_sys_t::view_list, waiting for
+    views that are being opened, and uses the older of the two to determine
+    whether there are any active transactions that can see the to be purged
+    records.
 
- 2: Purge clones the oldest read view and uses that to determine whether there
-    are any active transactions that can see the to be purged records.
+ 2: A view that purge found closed was opened after purge looked at it, and
+    it copies a newer state of trx_sys than the view of purge itself.
 
 Therefore any joining or active transaction will not have a view older
-than the purge view, according to 1.
+than the purge view, according to 1 and 2.
 
 When purge needs to remove a delete-marked row from a secondary index,
 it will first check that the DB_TRX_ID value of the corresponding
@@ -167,14 +169,19 @@ For details see: row_vers_old_has_index_entry() and row_purge_poss_sec()
 
 Some additional issues:
 
-What if trx_sys->view_list == NULL and some transaction T1 and Purge both
-try to open read_view at same time. Only one can acquire trx_sys->mutex.
-In which order will the views be opened? Should it matter? If no, why?
+What if no view is open and some transaction T1 and Purge both try to open
+a read view at the same time? T1 does not acquire trx_sys->mutex. In which
+order will the views be opened? Should it matter? If no, why?
 
-The order does not matter. No new transactions can be created and no running
-transaction can commit or rollback (or free views).
+The order does not matter. If purge finds the view of T1 closed, T1 will
+copy a newer state than purge did; otherwise purge waits until T1 has
+copied it, and purges according to the older of the two views.
 */
 
+/** Number of times read_view_open_now() tries to copy the snapshot
+without trx_sys->mutex before it acquires the mutex */
+#define READ_VIEW_SNAPSHOT_TRIES	10
+
 /*********************************************************************//**
 Creates a read view object.
 @return	own: read view struct */
@@ -193,6 +200,8 @@ read_view_create_low(
 					  sizeof(read_view_t));
 		view->max_descr = 0;
 		view->descriptors = NULL;
+		view->state = READ_VIEW_CLOSED;
+		view->in_view_list = false;
 	}
 
 	if (UNIV_UNLIKELY(view->max_descr < n)) {
@@ -216,10 +225,8 @@ read_view_create_low(
 }
 
 /*********************************************************************//**
-Clones a read view object. This function will allocate space for two read
-views contiguously, one identical in size and content as @param view (starting
-at returned pointer) and another view immediately following the trx_ids array.
-The second view will have space for an extra trx_id_t element.
+Clones a read view object. The view must have been pinned with
+read_view_pin(). The clone is not open and not on trx_sys->view_list.
 @return	read view struct */
 UNIV_INTERN
 read_view_t*
@@ -230,20 +237,20 @@ read_view_clone(
 						NULL */
 {
 	read_view_t*	clone;
-	trx_id_t*	old_descriptors;
-	ulint		old_max_descr;
 
 	ut_ad(mutex_own(&trx_sys->mutex));
+	ut_ad(view->state == READ_VIEW_PINNED);
 
 	clone = read_view_create_low(view->n_descr, prebuilt_clone);
 
-	old_descriptors = clone->descriptors;
-	old_max_descr = clone->max_descr;
-
-	memcpy(clone, view, sizeof(*view));
+	ut_ad(clone->state == READ_VIEW_CLOSED);
 
-	clone->descriptors = old_descriptors;
-	clone->max_descr = old_max_descr;
+	clone->type = view->type;
+	clone->undo_no = view->undo_no;
+	clone->low_limit_no = view->low_limit_no;
+	clone->low_limit_id = view->low_limit_id;
+	clone->up_limit_id = view->up_limit_id;
+	clone->creator_trx_id = view->creator_trx_id;
 
 	if (view->n_descr) {
 		memcpy(clone->descriptors, view->descriptors,
@@ -254,107 +261,121 @@ read_view_clone(
 }
 
 /*********************************************************************//**
-Insert the view in the proper order into the trx_sys->view_list. The
-read view list is ordered by read_view_t::low_limit_no in descending order. */
+Puts a view on trx_sys->view_list. */
+static
+void
+read_view_register(
+/*===============*/
+	read_view_t*	view)		/*!< in: view to add */
+{
+	ut_ad(mutex_own(&trx_sys->mutex));
+	ut_ad(!view->in_view_list);
+	ut_ad(view->state == READ_VIEW_CLOSED);
+
+	UT_LIST_ADD_FIRST(view_list, trx_sys->view_list, view);
+	view->in_view_list = true;
+
+	ut_ad(read_view_list_validate());
+}
+
+/*********************************************************************//**
+Opens a view made by read_view_clone(), and puts it on trx_sys->view_list
+unless it is already there. The caller must own trx_sys->mutex. */
 UNIV_INTERN
 void
 read_view_add(
 /*==========*/
 	read_view_t*	view)		/*!< in: view to add to */
 {
-	read_view_t*	elem;
-	read_view_t*	prev_elem;
+	bool	success;
 
 	ut_ad(mutex_own(&trx_sys->mutex));
 	ut_ad(read_view_validate(view));
 
-	/* Find the correct slot for insertion. */
-	for (elem = UT_LIST_GET_FIRST(trx_sys->view_list), prev_elem = NULL;
-	     elem != NULL && view->low_limit_no < elem->low_limit_no;
-	     prev_elem = elem, elem = UT_LIST_GET_NEXT(view_list, elem)) {
-		/* No op */
+	if (!view->in_view_list) {
+		read_view_register(view);
 	}
 
-	if (prev_elem == NULL) {
-		UT_LIST_ADD_FIRST(view_list, trx_sys->view_list, view);
-	} else {
-		UT_LIST_INSERT_AFTER(
-			view_list, trx_sys->view_list, prev_elem, view);
-	}
+	/* Views are only pinned by threads holding trx_sys->mutex, so
+	nobody looks at this one before we release the mutex. */
 
-	ut_ad(read_view_list_validate());
+	success = os_compare_and_swap_ulint(
+		&view->state, READ_VIEW_CLOSED, READ_VIEW_OPEN);
+	ut_a(success);
 }
 
 /*********************************************************************//**
-Opens a read view where exactly the transactions serialized before this
-point in time are seen in the view.
-@return	own: read view struct */
+Copies the ids of the active read-write transactions, trx_sys->max_trx_id
+and trx_sys->serial_min_no to a read view, and sets the limits of the view.
+This does not need trx_sys->mutex: the copy is checked against
+trx_sys->descr_version, which trx_sys_snapshot_change_start() and
+trx_sys_snapshot_change_end() increment around every change of them.
+@return	true if the copy is consistent, which is always the case if the
+caller owns trx_sys->mutex */
 static
-read_view_t*
+bool
 read_view_open_now_low(
 /*===================*/
 	trx_id_t	cr_trx_id,	/*!< in: trx_id of creating
-					transaction, or 0 used in purge */
+					transaction, or 0 */
 	read_view_t*&	view)		/*!< in,out: pre-allocated view array or
 					NULL if a new one needs to be created */
 {
+	ulint		version;
+	ulint		n;
+	trx_id_t	serial_min_no;
 	trx_id_t*	descr;
-	ulint		i;
 
-	ut_ad(mutex_own(&trx_sys->mutex));
+	version = trx_sys->descr_version;
+	os_rmb_strict;
 
-	view = read_view_create_low(trx_sys->descr_n_used, view);
+	if (UNIV_UNLIKELY(version & 1)) {
+		/* A transaction is starting or committing. */
+		return(false);
+	}
 
-	view->undo_no = 0;
-	view->type = VIEW_NORMAL;
-	view->creator_trx_id = cr_trx_id;
+	n = trx_sys->descr_n_used;
 
-	/* No future transactions should be visible in the view */
+	/* trx_reserve_descriptor() stores descriptors before it stores
+	descr_n_used. The array may be reallocated or modified while we
+	copy it, but then the version will change. */
+	os_rmb_strict;
 
-	view->low_limit_no = trx_sys->max_trx_id;
-	view->low_limit_id = view->low_limit_no;
+	view = read_view_create_low(n, view);
 
-	descr = trx_find_descriptor(trx_sys->descriptors,
-				    trx_sys->descr_n_used,
-				    cr_trx_id);
-	if (UNIV_LIKELY(descr != NULL)) {
-		ut_ad(trx_sys->descr_n_used > 0);
-		ut_ad(view->n_descr > 0);
+	memcpy(view->descriptors, trx_sys->descriptors, n * sizeof(trx_id_t));
 
-		view->n_descr--;
+	/* No future transactions should be visible in the view */
 
-		i = descr - trx_sys->descriptors;
-	} else {
-		i = trx_sys->descr_n_used;
-	}
+	view->low_limit_id = trx_sys->max_trx_id;
+	serial_min_no = trx_sys->serial_min_no;
 
-	if (UNIV_LIKELY(i > 0)) {
-		/* Copy the [0; i-1] range */
-		memcpy(view->descriptors, trx_sys->descriptors,
-		       i * sizeof(trx_id_t));
+	os_rmb_strict;
+
+	if (UNIV_UNLIKELY(trx_sys->descr_version != version)) {
+		return(false);
 	}
 
-	if (UNIV_UNLIKELY(i + 1 < trx_sys->descr_n_used)) {
-		/* Copy the [i+1; descr_n_used-1] range */
-		memcpy(view->descriptors + i,
-		       trx_sys->descriptors + i + 1,
-		       (trx_sys->descr_n_used - i - 1) *
-		       sizeof(trx_id_t));
- 	}
+	view->undo_no = 0;
+	view->type = VIEW_NORMAL;
+	view->creator_trx_id = cr_trx_id;
 
 	/* NOTE that a transaction whose trx number is < trx_sys->max_trx_id can
 	still be active, if it is in the middle of its commit! Note that when a
 	transaction starts, we initialize trx->no to TRX_ID_MAX. */
 
-	if (UT_LIST_GET_LEN(trx_sys->trx_serial_list) > 0) {
+	view->low_limit_no = ut_min(view->low_limit_id, serial_min_no);
+
+	descr = trx_find_descriptor(view->descriptors, n, cr_trx_id);
 
-		trx_id_t	trx_no;
+	if (UNIV_LIKELY(descr != NULL)) {
+		ut_ad(n > 0);
 
-		trx_no = UT_LIST_GET_FIRST(trx_sys->trx_serial_list)->no;
+		ut_memmove(descr, descr + 1,
+			   (view->descriptors + n - 1 - descr)
+			   * sizeof(trx_id_t));
 
-		if (trx_no < view->low_limit_no) {
-			view->low_limit_no = trx_no;
-		}
+		view->n_descr--;
 	}
 
 	if (UNIV_LIKELY(view->n_descr > 0)) {
@@ -364,36 +385,242 @@ read_view_open_now_low(
 		view->up_limit_id = view->low_limit_id;
 	}
 
-	/* Purge views are not added to the view list. */
-	if (cr_trx_id > 0) {
-		read_view_add(view);
-	}
-
-	return(view);
+	return(true);
 }
 
 /*********************************************************************//**
 Opens a read view where exactly the transactions serialized before this
-point in time are seen in the view.
+point in time are seen in the view. This does not normally acquire
+trx_sys->mutex. The view is put on trx_sys->view_list when it is
+created, and stays there until read_view_free().
 @return	own: read view struct */
 UNIV_INTERN
 read_view_t*
 read_view_open_now(
 /*===============*/
 	trx_id_t	cr_trx_id,	/*!< in: trx_id of creating
-					transaction, or 0 used in purge */
+					transaction, or 0 if the transaction
+					does not modify anything */
 	read_view_t*&	view)		/*!< in,out: pre-allocated view array or
 					NULL if a new one needs to be created */
 {
+	bool	success;
+
+	if (view == NULL || !view->in_view_list) {
+
+		view = read_view_create_low(0, view);
+
+		mutex_enter(&trx_sys->mutex);
+		read_view_register(view);
+		mutex_exit(&trx_sys->mutex);
+	}
+
+	/* While the view is READ_VIEW_OPENING, read_view_purge_open()
+	waits for it, so that purge cannot miss a snapshot that is older
+	than its own. A view that purge found closed gets a snapshot that
+	is newer than the one purge took before looking at the views. */
+
+	success = os_compare_and_swap_ulint(
+		&view->state, READ_VIEW_CLOSED, READ_VIEW_OPENING);
+	ut_a(success);
+
+	for (ulint i = 0; i < READ_VIEW_SNAPSHOT_TRIES; i++) {
+
+		if (read_view_open_now_low(cr_trx_id, view)) {
+
+			success = os_compare_and_swap_ulint(
+				&view->state, READ_VIEW_OPENING,
+				READ_VIEW_OPEN);
+			ut_a(success);
+
+			return(view);
+		}
+
+		ut_delay(ut_rnd_interval(0, srv_spin_wait_delay));
+	}
+
+	/* Transactions keep starting and committing. Copy the snapshot
+	under trx_sys->mutex. Purge may hold the mutex while it waits for
+	views that are being opened, so close the view first. Purge looks
+	at the views while holding the mutex, so it cannot see this one
+	before it is open. */
+
+	success = os_compare_and_swap_ulint(
+		&view->state, READ_VIEW_OPENING, READ_VIEW_CLOSED);
+	ut_a(success);
+
 	mutex_enter(&trx_sys->mutex);
 
-	view = read_view_open_now_low(cr_trx_id, view);
+	success = read_view_open_now_low(cr_trx_id, view);
+	ut_a(success);
+
+	success = os_compare_and_swap_ulint(
+		&view->state, READ_VIEW_CLOSED, READ_VIEW_OPEN);
+	ut_a(success);
 
 	mutex_exit(&trx_sys->mutex);
 
 	return(view);
 }
 
+/*********************************************************************//**
+Closes a read view that was opened by read_view_open_now() or
+read_view_add(). The view stays on trx_sys->view_list. */
+UNIV_INTERN
+void
+read_view_close(
+/*============*/
+	read_view_t*	view)		/*!< in: read view, can be 0 */
+{
+	if (view == 0) {
+		return;
+	}
+
+	ut_ad(view->in_view_list);
+	ut_ad(read_view_validate(view));
+
+	/* Wait if another thread has pinned the view. */
+
+	while (!os_compare_and_swap_ulint(
+		       &view->state, READ_VIEW_OPEN, READ_VIEW_CLOSED)) {
+
+		ut_ad(view->state == READ_VIEW_PINNED);
+
+		ut_delay(ut_rnd_interval(0, srv_spin_wait_delay));
+	}
+}
+
+/*********************************************************************//**
+Keeps an open view on trx_sys->view_list from being closed, so that it
+can be read by another thread than its owner. Waits if the view is being
+opened. The caller must own trx_sys->mutex.
+@return	true if the view was open and is now pinned */
+UNIV_INTERN
+bool
+read_view_pin(
+/*==========*/
+	read_view_t*	view)		/*!< in/out: read view */
+{
+	ut_ad(mutex_own(&trx_sys->mutex));
+	ut_ad(view->in_view_list);
+
+	for (ulint i = 0;; i++) {
+
+		switch (view->state) {
+		case READ_VIEW_CLOSED:
+			return(false);
+		case READ_VIEW_OPEN:
+			if (os_compare_and_swap_ulint(
+				    &view->state, READ_VIEW_OPEN,
+				    READ_VIEW_PINNED)) {
+				return(true);
+			}
+			continue;
+		}
+
+		/* Only threads that hold trx_sys->mutex pin views. */
+		ut_ad(view->state == READ_VIEW_OPENING);
+
+		/* read_view_open_now() does not wait for trx_sys->mutex
+		while the view is READ_VIEW_OPENING, so this is short. */
+
+		if (i < SYNC_SPIN_ROUNDS) {
+			ut_delay(ut_rnd_interval(0, srv_spin_wait_delay));
+		} else {
+			os_thread_yield();
+		}
+	}
+}
+
+/*********************************************************************//**
+Releases a view that was pinned with read_view_pin(). */
+UNIV_INTERN
+void
+read_view_unpin(
+/*============*/
+	read_view_t*	view)		/*!< in/out: read view */
+{
+	bool	success;
+
+	success = os_compare_and_swap_ulint(
+		&view->state, READ_VIEW_PINNED, READ_VIEW_OPEN);
+	ut_a(success);
+}
+
+/*********************************************************************//**
+Finds the oldest open view on trx_sys->view_list and pins it. The
+caller must own trx_sys->mutex, and release the view with
+read_view_unpin().
+@return	the oldest open view, or NULL if no view is open */
+UNIV_INTERN
+read_view_t*
+read_view_pin_oldest(
+/*=================*/
+	ulint*	n_open)			/*!< out: number of open views, or
+					NULL */
+{
+	read_view_t*	view;
+	read_view_t*	oldest = NULL;
+	ulint		n = 0;
+
+	ut_ad(mutex_own(&trx_sys->mutex));
+
+	for (view = UT_LIST_GET_FIRST(trx_sys->view_list);
+	     view != NULL;
+	     view = UT_LIST_GET_NEXT(view_list, view)) {
+
+		if (!read_view_pin(view)) {
+			continue;
+		}
+
+		n++;
+
+		if (oldest == NULL
+		    || view->low_limit_no < oldest->low_limit_no) {
+
+			if (oldest != NULL) {
+				read_view_unpin(oldest);
+			}
+
+			oldest = view;
+		} else {
+			read_view_unpin(view);
+		}
+	}
+
+	if (n_open != NULL) {
+		*n_open = n;
+	}
+
+	return(oldest);
+}
+
+/*********************************************************************//**
+Counts the open views on trx_sys->view_list. The caller must own
+trx_sys->mutex.
+@return	number of open views */
+UNIV_INTERN
+ulint
+read_view_count_open(void)
+/*======================*/
+{
+	const read_view_t*	view;
+	ulint			n = 0;
+
+	ut_ad(mutex_own(&trx_sys->mutex));
+
+	for (view = UT_LIST_GET_FIRST(trx_sys->view_list);
+	     view != NULL;
+	     view = UT_LIST_GET_NEXT(view_list, view)) {
+
+		if (view->state != READ_VIEW_CLOSED) {
+			n++;
+		}
+	}
+
+	return(n);
+}
+
 /*********************************************************************//**
 Makes a copy of the oldest existing read view, with the exception that also
 the creating trx of the oldest view is set as not visible in the 'copied'
@@ -411,18 +638,33 @@ read_view_purge_open(
 					NULL if a new one needs to be created */
 {
 	ulint		i;
+	bool		success;
 	read_view_t*	view;
 	read_view_t*	oldest_view;
+	read_view_t*	pinned_view;
 	trx_id_t	creator_trx_id;
 	ulint		insert_done	= 0;
 
 	mutex_enter(&trx_sys->mutex);
 
-	oldest_view = UT_LIST_GET_LAST(trx_sys->view_list);
+	/* First take a snapshot of the present. Any view that is opened
+	after this will be newer, see read_view_open_now(). */
+
+	success = read_view_open_now_low(0, prebuilt_view);
+	ut_a(success);
+
+	view = prebuilt_view;
+
+	os_rmb_strict;
+
+	pinned_view = read_view_pin_oldest(NULL);
 
-	if (oldest_view == NULL) {
+	if (pinned_view == NULL
+	    || pinned_view->low_limit_no > view->low_limit_no) {
 
-		view = read_view_open_now_low(0, prebuilt_view);
+		if (pinned_view != NULL) {
+			read_view_unpin(pinned_view);
+		}
 
 		mutex_exit(&trx_sys->mutex);
 
@@ -431,38 +673,54 @@ read_view_purge_open(
 
 	/* Clone the oldest view to a pre-allocated clone view */
 
-	oldest_view = read_view_clone(oldest_view, prebuilt_clone);
+	oldest_view = read_view_clone(pinned_view, prebuilt_clone);
+
+	read_view_unpin(pinned_view);
 
 	ut_ad(read_view_validate(oldest_view));
 
 	mutex_exit(&trx_sys->mutex);
 
-	ut_a(oldest_view->creator_trx_id > 0);
 	creator_trx_id = oldest_view->creator_trx_id;
 
-	view = read_view_create_low(oldest_view->n_descr + 1, prebuilt_view);
-
-	/* Add the creator transaction id in the trx_ids array in the
-	correct slot. */
+	if (creator_trx_id == 0) {
 
-	for (i = 0; i < oldest_view->n_descr; ++i) {
-		trx_id_t	id;
+		/* The creator does not modify anything. */
 
-		id = oldest_view->descriptors[i - insert_done];
+		view = read_view_create_low(oldest_view->n_descr,
+					    prebuilt_view);
 
-		if (insert_done == 0 && creator_trx_id < id) {
-			id = creator_trx_id;
-			insert_done = 1;
+		if (oldest_view->n_descr > 0) {
+			memcpy(view->descriptors, oldest_view->descriptors,
+			       oldest_view->n_descr * sizeof(trx_id_t));
 		}
+	} else {
 
-		view->descriptors[i] = id;
-	}
+		view = read_view_create_low(oldest_view->n_descr + 1,
+					    prebuilt_view);
 
-	if (insert_done == 0) {
-		view->descriptors[i] = creator_trx_id;
-	} else {
-		ut_a(i > 0);
-		view->descriptors[i] = oldest_view->descriptors[i - 1];
+		/* Add the creator transaction id in the trx_ids array in
+		the correct slot. */
+
+		for (i = 0; i < oldest_view->n_descr; ++i) {
+			trx_id_t	id;
+
+			id = oldest_view->descriptors[i - insert_done];
+
+			if (insert_done == 0 && creator_trx_id < id) {
+				id = creator_trx_id;
+				insert_done = 1;
+			}
+
+			view->descriptors[i] = id;
+		}
+
+		if (insert_done == 0) {
+			view->descriptors[i] = creator_trx_id;
+		} else {
+			ut_a(i > 0);
+			view->descriptors[i] = oldest_view->descriptors[i - 1];
+		}
 	}
 
 	view->creator_trx_id = 0;
@@ -492,7 +750,7 @@ read_view_close_for_mysql(
 {
 	ut_a(trx->global_read_view);
 
-	read_view_remove(trx->global_read_view, false);
+	read_view_close(trx->global_read_view);
 
 	trx->read_view = NULL;
 	trx->global_read_view = NULL;
@@ -545,9 +803,9 @@ read_fill_i_s_xtradb_read_view(i_s_xtradb_read_view_t* rv)
 
 	mutex_enter(&trx_sys->mutex);
 
-	if (UT_LIST_GET_LEN(trx_sys->view_list)) {
-		view = UT_LIST_GET_LAST(trx_sys->view_list);
-	} else {
+	view = read_view_pin_oldest(NULL);
+
+	if (view == NULL) {
 		mutex_exit(&trx_sys->mutex);
 		return NULL;
 	}
@@ -562,6 +820,8 @@ read_fill_i_s_xtradb_read_view(i_s_xtradb_read_view_t* rv)
 	rv->up_limit_id = view->up_limit_id;
 	rv->low_limit_id = view->low_limit_id;
 
+	read_view_unpin(view);
+
 	mutex_exit(&trx_sys->mutex);
 
 	return rv;
@@ -580,6 +840,14 @@ read_view_free(
 		return;
 	}
 
+	if (view->in_view_list) {
+		ut_ad(view->state == READ_VIEW_CLOSED);
+
+		mutex_enter(&trx_sys->mutex);
+		UT_LIST_REMOVE(view_list, trx_sys->view_list, view);
+		mutex_exit(&trx_sys->mutex);
+	}
+
 	os_atomic_decrement_ulint(&srv_read_views_memory,
 				 sizeof(read_view_t) +
 				 view->max_descr * sizeof(trx_id_t));
@@ -624,17 +892,13 @@ read_cursor_view_create_for_mysql(
 
 	cr_trx->n_mysql_tables_in_use = 0;
 
-	mutex_enter(&trx_sys->mutex);
-
 	curview->read_view = NULL;
-	read_view_open_now_low(UINT64_UNDEFINED, curview->read_view);
+	read_view_open_now(UINT64_UNDEFINED, curview->read_view);
 
 	view = curview->read_view;
 	view->undo_no = cr_trx->undo_no;
 	view->type = VIEW_HIGH_GRANULARITY;
 
-	mutex_exit(&trx_sys->mutex);
-
 	return(curview);
 }
 
@@ -656,7 +920,7 @@ read_cursor_view_close_for_mysql(
 	belong to this transaction */
 	trx->n_mysql_tables_in_use += curview->n_mysql_tables_in_use;
 
-	read_view_remove(curview->read_view, false);
+	read_view_close(curview->read_view);
 	read_view_free(curview->read_view);
 
 	trx->read_view = trx->global_read_view;
@@ -911,11 +911,14 @@ fts_parallel_tokenization(
 			goto func_exit;
 		}
 
+		/* Each of the fts_sort_pll_degree tokenization threads
+		sorts its own files, so merge the runs in this thread. */
 		error = row_merge_sort(psort_info->psort_common->trx,
 				       psort_info->psort_common->dup,
 				       merge_file[i], block[i], &tmpfd[i],
 				       false, 0.0/* pct_progress */, 0.0/* pct_cost */,
-				       crypt_data, crypt_block[i], table->space);
+				       crypt_data, crypt_block[i], table->space,
+				       1);
 
 		if (error != DB_SUCCESS) {
 			close(tmpfd[i]);
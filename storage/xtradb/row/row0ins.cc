@@ -94,6 +94,8 @@ ins_node_create(
 
 	node->entry_sys_heap = mem_heap_create(128);
 
+	node->defer_sec = false;
+
 	node->magic_n = INS_NODE_MAGIC_N;
 
 	return(node);
@@ -3306,6 +3308,14 @@ row_ins(
 			"row_ins_skip_sec",
 			node->index = NULL; node->entry = NULL; break;);
 
+		if (node->defer_sec) {
+			/* The secondary index entries will be built
+			in a bulk at the end of the statement */
+			node->index = NULL;
+			node->entry = NULL;
+			break;
+		}
+
 		/* Skip corrupted secondary index and its entry */
 		while (node->index && dict_index_is_corrupted(node->index)) {
 
@@ -2371,10 +2371,145 @@ row_merge_blocks_copy(
 	       != NULL);
 }
 
+/** A merge pass over the runs of a file. The pairs of runs are merged
+independently of each other, and each output run is written at an offset
+that is known in advance: the sum of the sizes of the preceding input runs.
+A merged run never takes more blocks than its two input runs, so the output
+runs do not overlap, even though they may leave unused blocks between them. */
+struct row_merge_pass_t {
+	trx_t*			trx;	/*!< transaction */
+	const row_merge_dup_t*	dup;	/*!< descriptor of index being
+					created */
+	const merge_file_t*	file;	/*!< input file */
+	int			fd;	/*!< output file handle */
+	const ulint*		run_offset;
+					/*!< first offset of each input run,
+					followed by file->offset */
+	ulint			n_run;	/*!< number of input runs */
+	ulint			n_pairs;/*!< number of pairs of runs to
+					merge; the first half of the runs is
+					merged with the second half */
+	ulint			n_tasks;/*!< n_pairs, plus one if the last
+					input run is copied as such */
+	const ulint*		out_offset;
+					/*!< first offset of the output run of
+					each task, followed by the end of the
+					output file */
+	fil_space_crypt_t*	crypt_data;/*!< table crypt data */
+	ulint			space;	/*!< space id */
+	ulint			n_threads;/*!< number of threads */
+	volatile bool		abort;	/*!< set when a thread failed */
+	os_event_t		event;	/*!< set when a thread finishes */
+};
+
+/** State of one thread taking part in a merge pass */
+struct row_merge_pass_thr_t {
+	row_merge_pass_t*	pass;	/*!< merge pass */
+	ulint			id;	/*!< thread number, 0 is the
+					thread that called row_merge_sort() */
+	row_merge_block_t*	block;	/*!< 3 buffers */
+	row_merge_block_t*	crypt_block;/*!< crypt buf or NULL */
+	ib_uint64_t		n_rec;	/*!< number of records written */
+	dberr_t			error;	/*!< error code */
+	volatile bool		done;	/*!< set when the thread no longer
+					accesses the merge pass */
+};
+
+/*************************************************************//**
+Merge the runs of a merge pass that belong to a thread: tasks id,
+id + n_threads, id + 2 * n_threads, and so on. */
+static
+void
+row_merge_pass_run(
+/*===============*/
+	row_merge_pass_thr_t*	thr)	/*!< in/out: merge thread */
+{
+	row_merge_pass_t*	pass	= thr->pass;
+	const ulint		half	= pass->n_run / 2;
+
+	thr->n_rec = 0;
+	thr->error = DB_SUCCESS;
+
+	for (ulint i = thr->id; i < pass->n_tasks; i += pass->n_threads) {
+		merge_file_t	of;
+		ulint		foffs0;
+		ulint		foffs1;
+
+		if (pass->abort) {
+			break;
+		}
+
+		if (trx_is_interrupted(pass->trx)) {
+			thr->error = DB_INTERRUPTED;
+			break;
+		}
+
+		of.fd = pass->fd;
+		of.offset = pass->out_offset[i];
+		of.n_rec = 0;
+
+		if (i < pass->n_pairs) {
+			foffs0 = pass->run_offset[i];
+			foffs1 = pass->run_offset[half + i];
+
+			thr->error = row_merge_blocks(
+				pass->dup, pass->file, thr->block,
+				&foffs0, &foffs1, &of,
+				pass->crypt_data, thr->crypt_block,
+				pass->space);
+		} else {
+			/* Copy the last run, which has no pair. */
+			ut_ad(pass->n_run & 1);
+			foffs0 = pass->run_offset[pass->n_run - 1];
+
+			if (!row_merge_blocks_copy(
+				    pass->dup->index, pass->file,
+				    thr->block, &foffs0, &of,
+				    pass->crypt_data, thr->crypt_block,
+				    pass->space)) {
+				thr->error = DB_CORRUPTION;
+			}
+		}
+
+		if (thr->error != DB_SUCCESS) {
+			break;
+		}
+
+		ut_ad(of.offset <= pass->out_offset[i + 1]);
+
+		thr->n_rec += of.n_rec;
+	}
+
+	if (thr->error != DB_SUCCESS) {
+		pass->abort = true;
+	}
+}
+
+/*************************************************************//**
+Thread that takes part in a merge pass.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(row_merge_pass_thread)(
+/*==================================*/
+	void*	arg)	/*!< in: row_merge_pass_thr_t */
+{
+	row_merge_pass_thr_t*	thr = static_cast<row_merge_pass_thr_t*>(arg);
+
+	row_merge_pass_run(thr);
+
+	os_event_set(thr->pass->event);
+	thr->done = true;
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 /*************************************************************//**
 Merge disk files.
 @return	DB_SUCCESS or error code */
-static __attribute__((nonnull(1,2,3,4,5,6,7)))
+static __attribute__((nonnull(1,2,3,4,6,7,8)))
 dberr_t
 row_merge(
 /*======*/
@@ -2383,37 +2518,29 @@ row_merge(
 					index being created */
 	merge_file_t*		file,	/*!< in/out: file containing
 					index entries */
-	row_merge_block_t*	block,	/*!< in/out: 3 buffers */
+	row_merge_pass_thr_t*	thrs,	/*!< in/out: merge threads, with
+					their buffers */
+	ulint			n_threads,/*!< in: number of threads */
 	int*			tmpfd,	/*!< in/out: temporary file handle */
 	ulint*			num_run,/*!< in/out: Number of runs remain
 					to be merged */
 	ulint*			run_offset, /*!< in/out: Array contains the
 					first offset number for each merge
+					run, and file->offset after the last
 					run */
 	fil_space_crypt_t*	crypt_data,/*!< in: table crypt data */
-	row_merge_block_t*	crypt_block, /*!< in: crypt buf or NULL */
 	ulint			space)	   /*!< in: space id */
 {
-	ulint		foffs0;	/*!< first input offset */
-	ulint		foffs1;	/*!< second input offset */
-	dberr_t		error;	/*!< error code */
-	merge_file_t	of;	/*!< output file */
-	const ulint	ihalf	= run_offset[*num_run / 2];
-				/*!< half the input file */
-	ulint		n_run	= 0;
-				/*!< num of runs generated from this merge */
-
-	UNIV_MEM_ASSERT_W(&block[0], 3 * srv_sort_buf_size);
-
-	if (crypt_block) {
-		UNIV_MEM_ASSERT_W(&crypt_block[0], 3 * srv_sort_buf_size);
-	}
-
-	ut_ad(ihalf < file->offset);
+	row_merge_pass_t	pass;
+	ulint*			out_offset;
+	const ulint		half	= *num_run / 2;
+	ib_uint64_t		n_rec	= 0;
+	dberr_t			error	= DB_SUCCESS;
+	ulint			i;
 
-	of.fd = *tmpfd;
-	of.offset = 0;
-	of.n_rec = 0;
+	ut_ad(*num_run > 1);
+	ut_ad(run_offset[half] < file->offset);
+	ut_ad(run_offset[*num_run] == file->offset);
 
 #ifdef POSIX_FADV_SEQUENTIAL
 	/* The input file will be read sequentially, starting from the
@@ -2423,92 +2550,116 @@ row_merge(
 		      POSIX_FADV_SEQUENTIAL | POSIX_FADV_NOREUSE);
 #endif /* POSIX_FADV_SEQUENTIAL */
 
-	/* Merge blocks to the output file. */
-	foffs0 = 0;
-	foffs1 = ihalf;
-
-	UNIV_MEM_INVALID(run_offset, *num_run * sizeof *run_offset);
-
-	for (; foffs0 < ihalf && foffs1 < file->offset; foffs0++, foffs1++) {
-
-		if (trx_is_interrupted(trx)) {
-			return(DB_INTERRUPTED);
+	pass.trx = trx;
+	pass.dup = dup;
+	pass.file = file;
+	pass.fd = *tmpfd;
+	pass.run_offset = run_offset;
+	pass.n_run = *num_run;
+	pass.n_pairs = half;
+	pass.n_tasks = *num_run - half;
+	pass.crypt_data = crypt_data;
+	pass.space = space;
+	pass.abort = false;
+
+	/* Place the output runs. Task i merges the runs i and half + i,
+	or copies the last run. */
+	out_offset = static_cast<ulint*>(
+		mem_alloc((pass.n_tasks + 1) * sizeof *out_offset));
+
+	out_offset[0] = 0;
+
+	for (i = 0; i < pass.n_tasks; i++) {
+		ulint	size = run_offset[half + i + 1]
+			- run_offset[half + i];
+
+		if (i < pass.n_pairs) {
+			size += run_offset[i + 1] - run_offset[i];
 		}
 
-		/* Remember the offset number for this run */
-		run_offset[n_run++] = of.offset;
+		out_offset[i + 1] = out_offset[i] + size;
+	}
 
-		error = row_merge_blocks(dup, file, block,
-					 &foffs0, &foffs1, &of,
-					 crypt_data, crypt_block, space);
+	ut_ad(out_offset[pass.n_tasks] == file->offset);
 
-		if (error != DB_SUCCESS) {
-			return(error);
-		}
+	pass.out_offset = out_offset;
+	pass.n_threads = ut_min(n_threads, pass.n_tasks);
 
+	for (i = 0; i < pass.n_threads; i++) {
+		thrs[i].pass = &pass;
+		thrs[i].id = i;
+		thrs[i].done = false;
 	}
 
-	/* Copy the last blocks, if there are any. */
+	if (pass.n_threads > 1) {
+		pass.event = os_event_create();
 
-	while (foffs0 < ihalf) {
-
-		if (UNIV_UNLIKELY(trx_is_interrupted(trx))) {
-			return(DB_INTERRUPTED);
+		for (i = 1; i < pass.n_threads; i++) {
+			os_thread_create(row_merge_pass_thread, &thrs[i], NULL);
 		}
+	}
 
-		/* Remember the offset number for this run */
-		run_offset[n_run++] = of.offset;
+	row_merge_pass_run(&thrs[0]);
 
-		if (!row_merge_blocks_copy(dup->index, file, block,
-					   &foffs0, &of,
-					   crypt_data, crypt_block, space)) {
-			return(DB_CORRUPTION);
-		}
-	}
+	if (pass.n_threads > 1) {
+		/* Wait for the other threads. A thread sets the event
+		before it sets its done flag, hence the timeout. */
+		for (;;) {
+			ib_int64_t	sig_count = os_event_reset(pass.event);
 
-	ut_ad(foffs0 == ihalf);
+			for (i = 1; i < pass.n_threads; i++) {
+				if (!thrs[i].done) {
+					break;
+				}
+			}
 
-	while (foffs1 < file->offset) {
+			if (i == pass.n_threads) {
+				break;
+			}
 
-		if (trx_is_interrupted(trx)) {
-			return(DB_INTERRUPTED);
+			os_event_wait_time_low(pass.event, 10000, sig_count);
 		}
 
-		/* Remember the offset number for this run */
-		run_offset[n_run++] = of.offset;
+		os_event_free(pass.event);
+	}
 
-		if (!row_merge_blocks_copy(dup->index, file, block,
-					   &foffs1, &of,
-					   crypt_data, crypt_block, space)) {
-			return(DB_CORRUPTION);
+	for (i = 0; i < pass.n_threads; i++) {
+		if (thrs[i].error != DB_SUCCESS) {
+			if (error == DB_SUCCESS
+			    || error == DB_INTERRUPTED) {
+				error = thrs[i].error;
+			}
+		} else {
+			n_rec += thrs[i].n_rec;
 		}
 	}
 
-	ut_ad(foffs1 == file->offset);
+	if (error != DB_SUCCESS) {
+		mem_free(out_offset);
+		return(error);
+	}
 
-	if (UNIV_UNLIKELY(of.n_rec != file->n_rec)) {
+	if (UNIV_UNLIKELY(n_rec != file->n_rec)) {
+		mem_free(out_offset);
 		return(DB_CORRUPTION);
 	}
 
-	ut_ad(n_run <= *num_run);
-
-	*num_run = n_run;
+	/* The output runs start at the task offsets. There are no more
+	runs than there were in the input file. */
+	*num_run = pass.n_tasks;
+	memcpy(run_offset, out_offset, (pass.n_tasks + 1) * sizeof *out_offset);
 
-	/* Each run can contain one or more offsets. As merge goes on,
-	the number of runs (to merge) will reduce until we have one
-	single run. So the number of runs will always be smaller than
-	the number of offsets in file */
-	ut_ad((*num_run) <= file->offset);
+	mem_free(out_offset);
 
-	/* The number of offsets in output file is always equal or
-	smaller than input file */
-	ut_ad(of.offset <= file->offset);
-
-	/* Swap file descriptors for the next pass. */
+	/* Swap file descriptors for the next pass. The output file has
+	the same size as the input file, because the output runs are
+	placed at the offsets of the input runs. */
 	*tmpfd = file->fd;
-	*file = of;
+	file->fd = pass.fd;
 
-	UNIV_MEM_INVALID(&block[0], 3 * srv_sort_buf_size);
+	for (i = 0; i < pass.n_threads; i++) {
+		UNIV_MEM_INVALID(&thrs[i].block[0], 3 * srv_sort_buf_size);
+	}
 
 	return(DB_SUCCESS);
 }
@@ -2537,16 +2688,20 @@ row_merge_sort(
 	const float		pct_cost, /*!< in: current progress percent */
 	fil_space_crypt_t*	crypt_data,/*!< in: table crypt data */
 	row_merge_block_t*	crypt_block, /*!< in: crypt buf or NULL */
-	ulint			space)	   /*!< in: space id */
+	ulint			space,	   /*!< in: space id */
+	ulint			n_threads) /*!< in: number of threads
+					   merging the runs */
 {
-	const ulint	half	= file->offset / 2;
-	ulint		num_runs;
-	ulint		cur_run = 0;
-	ulint*		run_offset;
-	dberr_t		error	= DB_SUCCESS;
-	ulint		merge_count = 0;
-	ulint		total_merge_sort_count;
-	float		curr_progress = 0;
+	ulint			num_runs;
+	ulint			cur_run = 0;
+	ulint*			run_offset;
+	dberr_t			error	= DB_SUCCESS;
+	ulint			merge_count = 0;
+	ulint			total_merge_sort_count;
+	float			curr_progress = 0;
+	row_merge_pass_thr_t*	thrs;
+	ulint			block_size = 3 * srv_sort_buf_size;
+	ulint			i;
 
 	DBUG_ENTER("row_merge_sort");
 
@@ -2565,19 +2720,59 @@ row_merge_sort(
 		DBUG_RETURN(error);
 	}
 
-	/* "run_offset" records each run's first offset number */
-	run_offset = (ulint*) mem_alloc(file->offset * sizeof(ulint));
+	/* "run_offset" records each run's first offset number, and
+	the end of the file after the last run. Initially, each block
+	is a run. */
+	run_offset = (ulint*) mem_alloc((file->offset + 1) * sizeof(ulint));
 
-	/* This tells row_merge() where to start for the first round
-	of merge. */
-	run_offset[half] = half;
+	for (i = 0; i <= file->offset; i++) {
+		run_offset[i] = i;
+	}
 
 	/* The file should always contain at least one byte (the end
 	of file marker).  Thus, it must be at least one block. */
 	ut_ad(file->offset > 0);
 
-	/* Progress report only for "normal" indexes. */
-	if (!(dup->index->type & DICT_FTS)) {
+	/* A duplicate in a unique index is reported in the MySQL row
+	buffer of dup->table, which only one thread may use. */
+	if (n_threads == 0 || (dup->table && dict_index_is_unique(dup->index))) {
+		n_threads = 1;
+	}
+
+	n_threads = ut_min(n_threads, num_runs / 2);
+
+	/* Thread 0 is the calling thread, which uses the buffers of
+	the caller. The other threads get their own buffers. */
+	thrs = static_cast<row_merge_pass_thr_t*>(
+		mem_zalloc(n_threads * sizeof *thrs));
+
+	thrs[0].block = block;
+	thrs[0].crypt_block = crypt_block;
+
+	for (i = 1; i < n_threads; i++) {
+		thrs[i].block = static_cast<row_merge_block_t*>(
+			os_mem_alloc_large(&block_size, FALSE));
+
+		if (crypt_block && thrs[i].block) {
+			thrs[i].crypt_block = static_cast<row_merge_block_t*>(
+				os_mem_alloc_large(&block_size, FALSE));
+
+			if (thrs[i].crypt_block == NULL) {
+				os_mem_free_large(thrs[i].block, block_size);
+				thrs[i].block = NULL;
+			}
+		}
+
+		if (thrs[i].block == NULL) {
+			/* Make do with the threads that got memory. */
+			n_threads = i;
+			break;
+		}
+	}
+
+	/* Progress report only for "normal" indexes, and not when the
+	caller is reporting the progress of a statement like LOAD DATA. */
+	if (update_progress && !(dup->index->type & DICT_FTS)) {
 		thd_progress_init(trx->mysql_thd, num_runs);
 	}
 
@@ -2590,14 +2785,14 @@ row_merge_sort(
 		/* Report progress of merge sort to MySQL for
 		show processlist progress field */
 		/* Progress report only for "normal" indexes. */
-		if (!(dup->index->type & DICT_FTS)) {
+		if (update_progress && !(dup->index->type & DICT_FTS)) {
 			thd_progress_report(trx->mysql_thd, cur_run, num_runs);
 		}
 		sql_print_information("InnoDB: Online DDL : merge-sorting current run %lu estimated %lu runs", cur_run, num_runs);
 
-		error = row_merge(trx, dup, file, block, tmpfd,
+		error = row_merge(trx, dup, file, thrs, n_threads, tmpfd,
 				  &num_runs, run_offset,
-				  crypt_data, crypt_block, space);
+				  crypt_data, space);
 
 		if(update_progress) {
 			merge_count++;
@@ -2617,8 +2812,18 @@ row_merge_sort(
 
 	mem_free(run_offset);
 
+	for (i = 1; i < n_threads; i++) {
+		os_mem_free_large(thrs[i].block, block_size);
+
+		if (thrs[i].crypt_block) {
+			os_mem_free_large(thrs[i].crypt_block, block_size);
+		}
+	}
+
+	mem_free(thrs);
+
 	/* Progress report only for "normal" indexes. */
-	if (!(dup->index->type & DICT_FTS)) {
+	if (update_progress && !(dup->index->type & DICT_FTS)) {
 		thd_progress_end(trx->mysql_thd);
 	}
 
@@ -4144,7 +4349,8 @@ row_merge_build_indexes(
 						trx, &dup, &merge_files[i],
 						block, &tmpfd, true,
 						pct_progress, pct_cost,
-						crypt_data, crypt_block, new_table->space);
+						crypt_data, crypt_block, new_table->space,
+						srv_merge_sort_threads);
 
 				pct_progress += pct_cost;
 
@@ -4293,3 +4499,384 @@ row_merge_build_indexes(
 
 	DBUG_RETURN(error);
 }
+
+/** Secondary index entries of a bulk insert into an empty table */
+struct row_merge_bulk_t {
+	dict_table_t*		table;		/*!< table being inserted into */
+	struct TABLE*		mysql_table;	/*!< MySQL table, for
+						reporting duplicate key
+						values */
+	ulint			n_indexes;	/*!< number of secondary
+						indexes */
+	dict_index_t**		indexes;	/*!< the secondary indexes */
+	row_merge_buf_t**	bufs;		/*!< sort buffer of each
+						index */
+	merge_file_t*		files;		/*!< merge file of each index */
+	int			tmpfd;		/*!< temporary file for
+						merge sort */
+	row_merge_block_t*	block;		/*!< buffers for file I/O */
+	row_merge_block_t*	crypt_block;	/*!< buffers for encryption,
+						or NULL */
+	ulint			block_size;	/*!< size of block and
+						crypt_block in bytes */
+	fil_space_crypt_t*	crypt_data;	/*!< table crypt data,
+						or NULL */
+	trx_id_t		trx_id;		/*!< transaction that holds
+						the table X-lock */
+	ib_uint64_t		n_rows;		/*!< number of rows added */
+};
+
+/*********************************************************************//**
+Check if an index tree contains no records, not even delete-marked ones.
+@return	true if the index is empty */
+static
+bool
+row_merge_bulk_index_is_empty(
+/*==========================*/
+	const dict_index_t*	index)	/*!< in: index */
+{
+	mtr_t		mtr;
+	const page_t*	root;
+	bool		empty;
+
+	mtr_start(&mtr);
+
+	root = btr_root_get(index, &mtr);
+
+	empty = root != NULL
+		&& page_is_leaf(root)
+		&& page_get_n_recs(root) == 0;
+
+	mtr_commit(&mtr);
+
+	return(empty);
+}
+
+/*********************************************************************//**
+Start a bulk insert into a table. The table must be empty and no other
+transaction may hold locks on it; it is X-locked by trx. After this,
+the rows should be inserted with ins_node_t::defer_sec set.
+@return bulk insert state, or NULL if a bulk insert is not possible */
+UNIV_INTERN
+row_merge_bulk_t*
+row_merge_bulk_start(
+/*=================*/
+	trx_t*		trx,		/*!< in/out: transaction */
+	dict_table_t*	table,		/*!< in/out: table to insert into */
+	struct TABLE*	mysql_table)	/*!< in/out: MySQL table, for
+					reporting duplicate key values */
+{
+	row_merge_bulk_t*	bulk;
+	dict_index_t*		index;
+	ulint			n_indexes = 0;
+
+	ut_ad(!srv_read_only_mode);
+
+	/* Foreign key constraints are checked on the secondary
+	indexes, and full-text indexes are maintained at commit. */
+	if (table->fts != NULL
+	    || !table->foreign_set.empty()
+	    || !table->referenced_set.empty()
+	    || table->ibd_file_missing
+	    || dict_table_is_discarded(table)
+	    || table->is_encrypted
+	    || table->corrupted) {
+		return(NULL);
+	}
+
+	for (index = dict_table_get_first_index(table);
+	     index != NULL;
+	     index = dict_table_get_next_index(index)) {
+
+		if (dict_index_is_online_ddl(index)
+		    || dict_index_is_corrupted(index)) {
+			return(NULL);
+		}
+
+		if (!dict_index_is_clust(index)) {
+			n_indexes++;
+		}
+	}
+
+	if (n_indexes == 0
+	    || !row_merge_bulk_index_is_empty(
+		    dict_table_get_first_index(table))) {
+		return(NULL);
+	}
+
+	trx_start_if_not_started_xa(trx);
+
+	if (lock_table_x_nowait(table, trx) != DB_SUCCESS) {
+		return(NULL);
+	}
+
+	/* Another transaction may have inserted rows before we got
+	the table lock. If so, keep the lock but insert normally. Once
+	the table is X-locked, its indexes cannot change. */
+	for (index = dict_table_get_first_index(table);
+	     index != NULL;
+	     index = dict_table_get_next_index(index)) {
+
+		if (!row_merge_bulk_index_is_empty(index)) {
+			return(NULL);
+		}
+	}
+
+	bulk = static_cast<row_merge_bulk_t*>(mem_zalloc(sizeof *bulk));
+
+	bulk->table = table;
+	bulk->mysql_table = mysql_table;
+	bulk->trx_id = trx->id;
+	bulk->tmpfd = -1;
+	bulk->indexes = static_cast<dict_index_t**>(
+		mem_alloc(n_indexes * sizeof *bulk->indexes));
+	bulk->bufs = static_cast<row_merge_buf_t**>(
+		mem_zalloc(n_indexes * sizeof *bulk->bufs));
+	bulk->files = static_cast<merge_file_t*>(
+		mem_alloc(n_indexes * sizeof *bulk->files));
+
+	for (index = dict_table_get_next_index(
+		     dict_table_get_first_index(table));
+	     index != NULL;
+	     index = dict_table_get_next_index(index)) {
+
+		ulint	i = bulk->n_indexes++;
+
+		bulk->indexes[i] = index;
+		bulk->files[i].fd = -1;
+	}
+
+	ut_ad(bulk->n_indexes == n_indexes);
+
+	bulk->block_size = 3 * srv_sort_buf_size;
+	bulk->block = static_cast<row_merge_block_t*>(
+		os_mem_alloc_large(&bulk->block_size, FALSE));
+
+	if (bulk->block == NULL) {
+		goto err_exit;
+	}
+
+	/* Encrypt the temporary files like those of index creation */
+	bulk->crypt_data = fil_space_get_crypt_data(table->space);
+
+	if ((bulk->crypt_data
+	     && bulk->crypt_data->encryption == FIL_SPACE_ENCRYPTION_ON)
+	    || (srv_encrypt_tables && bulk->crypt_data
+		&& bulk->crypt_data->encryption
+		== FIL_SPACE_ENCRYPTION_DEFAULT)) {
+
+		bulk->crypt_block = static_cast<row_merge_block_t*>(
+			os_mem_alloc_large(&bulk->block_size, FALSE));
+
+		if (bulk->crypt_block == NULL) {
+			goto err_exit;
+		}
+	} else {
+		bulk->crypt_data = NULL;
+	}
+
+	for (ulint i = 0; i < n_indexes; i++) {
+		if (row_merge_file_create(&bulk->files[i]) < 0) {
+			goto err_exit;
+		}
+
+		bulk->bufs[i] = row_merge_buf_create(bulk->indexes[i]);
+	}
+
+	bulk->tmpfd = row_merge_file_create_low();
+
+	if (bulk->tmpfd < 0) {
+		goto err_exit;
+	}
+
+	return(bulk);
+
+err_exit:
+	row_merge_bulk_free(bulk);
+	return(NULL);
+}
+
+/*********************************************************************//**
+Sort the sort buffer of an index and write it to the merge file of the
+index as one run.
+@return DB_SUCCESS or error code */
+static __attribute__((nonnull, warn_unused_result))
+dberr_t
+row_merge_bulk_write(
+/*=================*/
+	row_merge_bulk_t*	bulk,	/*!< in/out: bulk insert state */
+	ulint			i,	/*!< in: index number */
+	trx_t*			trx)	/*!< in/out: transaction */
+{
+	row_merge_buf_t*	buf	= bulk->bufs[i];
+	merge_file_t*		file	= &bulk->files[i];
+
+	if (buf->n_tuples == 0) {
+		return(DB_SUCCESS);
+	}
+
+	if (dict_index_is_unique(buf->index)) {
+		row_merge_dup_t	dup = {
+			buf->index, bulk->mysql_table, NULL, 0};
+
+		row_merge_buf_sort(buf, &dup);
+
+		if (dup.n_dup) {
+			trx->error_info = buf->index;
+			return(DB_DUPLICATE_KEY);
+		}
+	} else {
+		row_merge_buf_sort(buf, NULL);
+	}
+
+	row_merge_buf_write(buf, file, bulk->block);
+
+	if (!row_merge_write(file->fd, file->offset++, bulk->block,
+			     bulk->crypt_data, bulk->crypt_block,
+			     bulk->table->space)) {
+		return(DB_TEMP_FILE_WRITE_FAILURE);
+	}
+
+	UNIV_MEM_INVALID(&bulk->block[0], srv_sort_buf_size);
+
+	bulk->bufs[i] = row_merge_buf_empty(buf);
+
+	return(DB_SUCCESS);
+}
+
+/*********************************************************************//**
+Buffer the secondary index entries of a row that was inserted into the
+clustered index.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+row_merge_bulk_add(
+/*===============*/
+	row_merge_bulk_t*	bulk,	/*!< in/out: bulk insert state */
+	const dtuple_t*		row,	/*!< in: inserted row */
+	trx_t*			trx)	/*!< in/out: transaction */
+{
+	for (ulint i = 0; i < bulk->n_indexes; i++) {
+		doc_id_t	doc_id = 0;
+		bool		exceed_page = false;
+
+		if (row_merge_buf_add(bulk->bufs[i], NULL, bulk->table,
+				      NULL, row, NULL, &doc_id, NULL,
+				      &exceed_page, trx)) {
+			bulk->files[i].n_rec++;
+			continue;
+		}
+
+		/* The buffer is full: write it out as a run */
+		dberr_t	err = row_merge_bulk_write(bulk, i, trx);
+
+		if (err != DB_SUCCESS) {
+			return(err);
+		}
+
+		/* An empty buffer has room for at least one record. */
+		ut_a(row_merge_buf_add(bulk->bufs[i], NULL, bulk->table,
+				       NULL, row, NULL, &doc_id, NULL,
+				       &exceed_page, trx));
+		bulk->files[i].n_rec++;
+	}
+
+	bulk->n_rows++;
+
+	return(DB_SUCCESS);
+}
+
+/*********************************************************************//**
+Sort the buffered secondary index entries and insert them into the
+indexes, and free the bulk insert state.
+@return DB_SUCCESS or error code */
+UNIV_INTERN
+dberr_t
+row_merge_bulk_finish(
+/*==================*/
+	row_merge_bulk_t*	bulk,	/*!< in,own: bulk insert state */
+	trx_t*			trx)	/*!< in/out: transaction */
+{
+	dberr_t	error = DB_SUCCESS;
+
+	DBUG_ENTER("row_merge_bulk_finish");
+
+	if (trx->state == TRX_STATE_NOT_STARTED || trx->id != bulk->trx_id) {
+		/* The transaction was rolled back as a whole (for
+		example, after a deadlock), and the clustered index
+		records with it. */
+		row_merge_bulk_free(bulk);
+		DBUG_RETURN(DB_SUCCESS);
+	}
+
+	for (ulint i = 0; i < bulk->n_indexes && error == DB_SUCCESS; i++) {
+		dict_index_t*	index	= bulk->indexes[i];
+		merge_file_t*	file	= &bulk->files[i];
+		row_merge_dup_t	dup	= {index, bulk->mysql_table, NULL, 0};
+
+		error = row_merge_bulk_write(bulk, i, trx);
+
+		if (error != DB_SUCCESS || file->n_rec == 0) {
+			continue;
+		}
+
+		error = row_merge_sort(trx, &dup, file, bulk->block,
+				       &bulk->tmpfd, false, 0, 0,
+				       bulk->crypt_data, bulk->crypt_block,
+				       bulk->table->space,
+				       srv_merge_sort_threads);
+
+		if (error == DB_SUCCESS) {
+			error = row_merge_insert_index_tuples(
+				trx->id, index, bulk->table, file->fd,
+				bulk->block, file->n_rec, 0, 0,
+				bulk->crypt_data, bulk->crypt_block,
+				bulk->table->space);
+		} else if (error == DB_DUPLICATE_KEY) {
+			trx->error_info = index;
+		}
+
+		/* Close the temporary file to free up space. */
+		row_merge_file_destroy(file);
+	}
+
+	if (error == DB_SUCCESS) {
+		MONITOR_INC_VALUE(MONITOR_BULK_LOAD_ROWS, bulk->n_rows);
+	}
+
+	row_merge_bulk_free(bulk);
+
+	DBUG_RETURN(error);
+}
+
+/*********************************************************************//**
+Free a bulk insert state without inserting the buffered entries. */
+UNIV_INTERN
+void
+row_merge_bulk_free(
+/*================*/
+	row_merge_bulk_t*	bulk)	/*!< in,own: bulk insert state */
+{
+	for (ulint i = 0; i < bulk->n_indexes; i++) {
+		if (bulk->bufs[i] != NULL) {
+			row_merge_buf_free(bulk->bufs[i]);
+		}
+
+		row_merge_file_destroy(&bulk->files[i]);
+	}
+
+	row_merge_file_destroy_low(bulk->tmpfd);
+
+	if (bulk->block != NULL) {
+		os_mem_free_large(bulk->block, bulk->block_size);
+	}
+
+	if (bulk->crypt_block != NULL) {
+		os_mem_free_large(bulk->crypt_block, bulk->block_size);
+	}
+
+	mem_free(bulk->files);
+	mem_free(bulk->bufs);
+	mem_free(bulk->indexes);
+	mem_free(bulk);
+}
@@ -897,6 +897,10 @@ row_prebuilt_free(
 		que_graph_free_recursive(prebuilt->ins_graph);
 	}
 
+	if (prebuilt->bulk) {
+		row_merge_bulk_free(prebuilt->bulk);
+	}
+
 	if (prebuilt->sel_graph) {
 		que_graph_free_recursive(prebuilt->sel_graph);
 	}
@@ -1352,6 +1356,7 @@ row_insert_for_mysql(
 
 	row_get_prebuilt_insert_row(prebuilt);
 	node = prebuilt->ins_node;
+	node->defer_sec = prebuilt->bulk != NULL;
 
 	row_mysql_convert_row_to_innobase(node->row, prebuilt, mysql_rec);
 
@@ -1454,6 +1459,19 @@ row_insert_for_mysql(
 
 	que_thr_stop_for_mysql_no_error(thr, trx);
 
+	if (prebuilt->bulk != NULL) {
+		/* The row is in the clustered index. Buffer its
+		secondary index entries. On error, MySQL will roll back
+		the statement. */
+		err = row_merge_bulk_add(prebuilt->bulk, node->row, trx);
+
+		if (err != DB_SUCCESS) {
+			trx->op_info = "";
+
+			return(err);
+		}
+	}
+
 	if (UNIV_LIKELY(!(trx->fake_changes))) {
 
 		if (table->is_system_db) {
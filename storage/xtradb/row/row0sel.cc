@@ -1409,7 +1409,7 @@ row_sel(
 	    && !plan->must_get_clust
 	    && !plan->table->big_rows) {
 		if (!search_latch_locked) {
-			rw_lock_s_lock(btr_search_get_latch(index));
+			btr_search_s_lock(index);
 
 			search_latch_locked = TRUE;
 		} else if (rw_lock_get_writer(btr_search_get_latch(index))
@@ -1423,7 +1423,7 @@ row_sel(
 			performance significantly in multiprocessors. */
 
 			rw_lock_s_unlock(btr_search_get_latch(index));
-			rw_lock_s_lock(btr_search_get_latch(index));
+			btr_search_s_lock(index);
 		}
 
 		found_flag = row_sel_try_search_shortcut(node, plan,
@@ -3932,7 +3932,7 @@ row_search_for_mysql(
 
 #ifndef UNIV_SEARCH_DEBUG
 			ut_ad(!trx->has_search_latch);
-			rw_lock_s_lock(btr_search_get_latch(index));
+			btr_search_s_lock(index);
 			trx->has_search_latch = TRUE;
 #endif
 			switch (row_sel_try_search_shortcut_for_mysql(
@@ -5350,13 +5350,9 @@ row_search_check_if_query_cache_permitted(
 		/* If the isolation level is high, assign a read view for the
 		transaction if it does not yet have one */
 
-		if (trx->isolation_level >= TRX_ISO_REPEATABLE_READ
-		    && !trx->read_view) {
+		if (trx->isolation_level >= TRX_ISO_REPEATABLE_READ) {
 
-			trx->read_view =
-				read_view_open_now(trx->id,
-						   trx->prebuilt_view);
-			trx->global_read_view = trx->read_view;
+			trx_assign_read_view(trx);
 		}
 	}
 
@@ -1131,6 +1131,12 @@ row_undo_mod(
 		return(DB_SUCCESS);
 	}
 
+	/* The rolled back record is removed from the undo log and
+	will never reach purge */
+	if (trx_undo_rec_needs_purge(node->undo_rec)) {
+		dict_table_purge_pending_add(node->table, -1);
+	}
+
 	node->index = dict_table_get_first_index(node->table);
 	ut_ad(dict_index_is_clust(node->index));
 	/* Skip the clustered index (the first index) */
@@ -30,6 +30,7 @@ Created 12/9/2009 Jimmy Yang
 #include "mach0data.h"
 #include "srv0mon.h"
 #include "srv0srv.h"
+#include "btr0sea.h"
 #include "buf0buf.h"
 #include "trx0sys.h"
 #include "trx0rseg.h"
@@ -60,6 +61,37 @@ description and its property/type and corresponding monitor_id.
 Please note: If you add a monitor here, please add its corresponding
 monitor_id to "enum monitor_id_value" structure in srv0mon.h file. */
 
+/** Define the counters of an Adaptive Hash Index partition in
+innodb_counter_info[] */
+#define MONITOR_AHI_PARTITION(n)					\
+	{"adaptive_hash_partition_" #n "_hits", "adaptive_hash_index",	\
+	 "Number of successful searches in Adaptive Hash Index"	\
+	 " partition " #n,						\
+	 static_cast<monitor_type_t>(					\
+	 MONITOR_EXISTING | MONITOR_DEFAULT_ON),			\
+	 MONITOR_DEFAULT_START,						\
+	 static_cast<monitor_id_t>(MONITOR_OVLD_AHI_PARTITION_FIRST	\
+	 + (n) * MONITOR_AHI_PARTITION_N_COUNTERS)},			\
+									\
+	{"adaptive_hash_partition_" #n "_misses", "adaptive_hash_index",\
+	 "Number of failed searches in Adaptive Hash Index"		\
+	 " partition " #n,						\
+	 static_cast<monitor_type_t>(					\
+	 MONITOR_EXISTING | MONITOR_DEFAULT_ON),			\
+	 MONITOR_DEFAULT_START,						\
+	 static_cast<monitor_id_t>(MONITOR_OVLD_AHI_PARTITION_FIRST	\
+	 + (n) * MONITOR_AHI_PARTITION_N_COUNTERS + 1)},		\
+									\
+	{"adaptive_hash_partition_" #n "_latch_waits",			\
+	 "adaptive_hash_index",						\
+	 "Number of times the latch of Adaptive Hash Index partition "	\
+	 #n " was requested while held in a conflicting mode",		\
+	 static_cast<monitor_type_t>(					\
+	 MONITOR_EXISTING | MONITOR_DEFAULT_ON),			\
+	 MONITOR_DEFAULT_START,						\
+	 static_cast<monitor_id_t>(MONITOR_OVLD_AHI_PARTITION_FIRST	\
+	 + (n) * MONITOR_AHI_PARTITION_N_COUNTERS + 2)}
+
 static monitor_info_t	innodb_counter_info[] =
 {
 	/* A dummy item to mark the module start, this is
@@ -412,6 +444,24 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_NONE,
 	 MONITOR_DEFAULT_START, MONITOR_FLUSH_PCT_FOR_LSN},
 
+	{"buffer_flush_io_capacity", "buffer",
+	 "Pages per second that background flushing may write, chosen by"
+	 " innodb_adaptive_io_capacity",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_IO_CAPACITY},
+
+	{"buffer_flush_io_capacity_measured", "buffer",
+	 "Write throughput of flush batches in pages per second, measured"
+	 " by innodb_adaptive_io_capacity",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_IO_CAPACITY_MEASURED},
+
+	{"buffer_flush_batch_time_avg", "buffer",
+	 "Average time in microseconds from the start of a flush batch to"
+	 " its last write, measured by innodb_adaptive_io_capacity",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_BATCH_TIME_AVG},
+
 	{"buffer_flush_sync_waits", "buffer",
 	 "Number of times a wait happens due to sync flushing",
 	 MONITOR_NONE,
@@ -540,6 +590,12 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_NONE,
 	 MONITOR_DEFAULT_START, MONITOR_LRU_GET_FREE_SEARCH},
 
+	{"buffer_LRU_scan_depth", "buffer",
+	 "Sum of the LRU scan depths of the buffer pool instances, chosen by"
+	 " innodb_adaptive_io_capacity",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LRU_SCAN_DEPTH},
+
 	/* Cumulative counter for LRU search scans */
 	{"buffer_LRU_search_scanned", "buffer",
 	 "Total pages scanned as part of LRU search",
@@ -1095,6 +1151,72 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_NONE,
 	 MONITOR_DEFAULT_START, MONITOR_ADAPTIVE_HASH_ROW_UPDATED},
 
+	/* Counters of the partitions, see MONITOR_AHI_PARTITION() */
+	MONITOR_AHI_PARTITION(0),
+	MONITOR_AHI_PARTITION(1),
+	MONITOR_AHI_PARTITION(2),
+	MONITOR_AHI_PARTITION(3),
+	MONITOR_AHI_PARTITION(4),
+	MONITOR_AHI_PARTITION(5),
+	MONITOR_AHI_PARTITION(6),
+	MONITOR_AHI_PARTITION(7),
+	MONITOR_AHI_PARTITION(8),
+	MONITOR_AHI_PARTITION(9),
+	MONITOR_AHI_PARTITION(10),
+	MONITOR_AHI_PARTITION(11),
+	MONITOR_AHI_PARTITION(12),
+	MONITOR_AHI_PARTITION(13),
+	MONITOR_AHI_PARTITION(14),
+	MONITOR_AHI_PARTITION(15),
+	MONITOR_AHI_PARTITION(16),
+	MONITOR_AHI_PARTITION(17),
+	MONITOR_AHI_PARTITION(18),
+	MONITOR_AHI_PARTITION(19),
+	MONITOR_AHI_PARTITION(20),
+	MONITOR_AHI_PARTITION(21),
+	MONITOR_AHI_PARTITION(22),
+	MONITOR_AHI_PARTITION(23),
+	MONITOR_AHI_PARTITION(24),
+	MONITOR_AHI_PARTITION(25),
+	MONITOR_AHI_PARTITION(26),
+	MONITOR_AHI_PARTITION(27),
+	MONITOR_AHI_PARTITION(28),
+	MONITOR_AHI_PARTITION(29),
+	MONITOR_AHI_PARTITION(30),
+	MONITOR_AHI_PARTITION(31),
+	MONITOR_AHI_PARTITION(32),
+	MONITOR_AHI_PARTITION(33),
+	MONITOR_AHI_PARTITION(34),
+	MONITOR_AHI_PARTITION(35),
+	MONITOR_AHI_PARTITION(36),
+	MONITOR_AHI_PARTITION(37),
+	MONITOR_AHI_PARTITION(38),
+	MONITOR_AHI_PARTITION(39),
+	MONITOR_AHI_PARTITION(40),
+	MONITOR_AHI_PARTITION(41),
+	MONITOR_AHI_PARTITION(42),
+	MONITOR_AHI_PARTITION(43),
+	MONITOR_AHI_PARTITION(44),
+	MONITOR_AHI_PARTITION(45),
+	MONITOR_AHI_PARTITION(46),
+	MONITOR_AHI_PARTITION(47),
+	MONITOR_AHI_PARTITION(48),
+	MONITOR_AHI_PARTITION(49),
+	MONITOR_AHI_PARTITION(50),
+	MONITOR_AHI_PARTITION(51),
+	MONITOR_AHI_PARTITION(52),
+	MONITOR_AHI_PARTITION(53),
+	MONITOR_AHI_PARTITION(54),
+	MONITOR_AHI_PARTITION(55),
+	MONITOR_AHI_PARTITION(56),
+	MONITOR_AHI_PARTITION(57),
+	MONITOR_AHI_PARTITION(58),
+	MONITOR_AHI_PARTITION(59),
+	MONITOR_AHI_PARTITION(60),
+	MONITOR_AHI_PARTITION(61),
+	MONITOR_AHI_PARTITION(62),
+	MONITOR_AHI_PARTITION(63),
+
 	/* ========== Counters for tablespace ========== */
 	{"module_file", "file_system", "Tablespace and File System Manager",
 	 MONITOR_MODULE,
@@ -1355,6 +1477,12 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_NONE,
 	 MONITOR_DEFAULT_START, MONITOR_PENDING_ALTER_TABLE},
 
+	{"ddl_bulk_load_rows", "ddl",
+	 "Number of rows loaded into empty tables with their secondary"
+	 " indexes built at the end of the statement",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_BULK_LOAD_ROWS},
+
 	/* ===== Counters for ICP (Index Condition Pushdown) Module ===== */
 	{"module_icp", "icp", "Index Condition Pushdown",
 	 MONITOR_MODULE,
@@ -2060,6 +2188,37 @@ srv_mon_process_existing_counter(
 		break;
 
 	default:
+		if (monitor_id >= MONITOR_OVLD_AHI_PARTITION_FIRST
+		    && monitor_id <= MONITOR_OVLD_AHI_PARTITION_LAST) {
+			ulint	n = monitor_id
+				- MONITOR_OVLD_AHI_PARTITION_FIRST;
+			const btr_search_part_stats_t*	stats;
+
+			/* The counters of the partitions that are not
+			in use are hidden and always 0 */
+			if (!btr_search_part_stats
+			    || n / MONITOR_AHI_PARTITION_N_COUNTERS
+			    >= btr_search_index_num) {
+				value = 0;
+				break;
+			}
+
+			stats = &btr_search_part_stats[
+				n / MONITOR_AHI_PARTITION_N_COUNTERS];
+
+			switch (n % MONITOR_AHI_PARTITION_N_COUNTERS) {
+			case 0:
+				value = stats->n_hits;
+				break;
+			case 1:
+				value = stats->n_misses;
+				break;
+			default:
+				value = stats->n_latch_waits;
+			}
+			break;
+		}
+
 		ut_error;
 	}
 
@@ -169,6 +169,9 @@ on duplicate key checking and foreign key checking */
 UNIV_INTERN ibool	srv_locks_unsafe_for_binlog = FALSE;
 /** Sort buffer size in index creation */
 UNIV_INTERN ulong	srv_sort_buf_size = 1048576;
+/** Number of threads merging the sorted runs of an index in index
+creation */
+UNIV_INTERN ulong	srv_merge_sort_threads = 4;
 /** Maximum modification log file size for online index creation */
 UNIV_INTERN unsigned long long	srv_online_max_size;
 
@@ -257,6 +260,10 @@ UNIV_INTERN char	srv_use_global_flush_log_at_trx_commit	= TRUE;
 the checkpoints. */
 UNIV_INTERN char	srv_adaptive_flushing	= TRUE;
 
+/* Size the flush list and LRU batches from the write throughput measured
+at runtime instead of innodb_io_capacity and innodb_lru_scan_depth. */
+UNIV_INTERN my_bool	srv_adaptive_io_capacity	= FALSE;
+
 UNIV_INTERN ulong	srv_show_locks_held	= 10;
 UNIV_INTERN ulong	srv_show_verbose_locks	= 0;
 
@@ -473,6 +480,10 @@ starting from SRV_FORCE_IGNORE_CORRUPT, so that data can be recovered
 by SELECT or mysqldump. When this is nonzero, we do not allow any user
 modifications to the data. */
 UNIV_INTERN ulong	srv_force_recovery;
+
+/** Number of threads which apply the redo log records to the pages
+in crash recovery */
+UNIV_INTERN ulong	srv_recovery_apply_threads = 4;
 #ifndef DBUG_OFF
 /** Inject a crash at different steps of the recovery process.
 This is for testing and debugging only. */
@@ -1382,7 +1393,9 @@ srv_printf_innodb_monitor(
 	double	time_elapsed;
 	time_t	current_time;
 	ulint	n_reserved;
+	ulint	n_views;
 	ibool	ret;
+	read_view_t*	oldest_view;
 
 	ulong	btr_search_sys_constant;
 	ulong	btr_search_sys_variable;
@@ -1604,8 +1617,9 @@ srv_printf_innodb_monitor(
 
 	mutex_enter(&trx_sys->mutex);
 
-	fprintf(file, "%lu read views open inside InnoDB\n",
-		UT_LIST_GET_LEN(trx_sys->view_list));
+	oldest_view = read_view_pin_oldest(&n_views);
+
+	fprintf(file, "%lu read views open inside InnoDB\n", n_views);
 
 	fprintf(file, "%lu RW transactions active inside InnoDB\n",
 		UT_LIST_GET_LEN(trx_sys->rw_trx_list));
@@ -1616,14 +1630,12 @@ srv_printf_innodb_monitor(
 	fprintf(file, "%lu out of %lu descriptors used\n",
 		trx_sys->descr_n_used, trx_sys->descr_n_max);
 
-	if (UT_LIST_GET_LEN(trx_sys->view_list)) {
-		read_view_t*	view = UT_LIST_GET_LAST(trx_sys->view_list);
+	if (oldest_view != NULL) {
+		fprintf(file, "---OLDEST VIEW---\n");
+		read_view_print(file, oldest_view);
+		fprintf(file, "-----------------\n");
 
-		if (view) {
-			fprintf(file, "---OLDEST VIEW---\n");
-			read_view_print(file, view);
-			fprintf(file, "-----------------\n");
-		}
+		read_view_unpin(oldest_view);
 	}
 
 	mutex_exit(&trx_sys->mutex);
@@ -1890,9 +1902,14 @@ srv_export_innodb_status(void)
 	export_vars.innodb_x_lock_spin_waits
 		= rw_lock_stats.rw_x_spin_wait_count;
 
-	oldest_view = UT_LIST_GET_LAST(trx_sys->view_list);
+	mutex_enter(&trx_sys->mutex);
+	oldest_view = read_view_pin_oldest(NULL);
 	export_vars.innodb_oldest_view_low_limit_trx_id
 		= oldest_view ? oldest_view->low_limit_id : 0;
+	if (oldest_view != NULL) {
+		read_view_unpin(oldest_view);
+	}
+	mutex_exit(&trx_sys->mutex);
 
 	export_vars.innodb_purge_trx_id = purge_sys->limit.trx_no;
 	export_vars.innodb_purge_undo_no = purge_sys->limit.undo_no;
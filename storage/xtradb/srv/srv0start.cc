@@ -2889,6 +2889,10 @@ innobase_start_or_create_for_mysql(void)
 
 		buf_flush_page_cleaner_thread_handle = os_thread_create(buf_flush_page_cleaner_thread, NULL, NULL);
 		buf_flush_page_cleaner_thread_started = true;
+
+		/* From now on the redo log is written and flushed by
+		the log writer and log flusher threads */
+		log_threads_start();
 	}
 
 	buf_flush_lru_manager_thread_handle = os_thread_create(buf_flush_lru_manager_thread, NULL, NULL);
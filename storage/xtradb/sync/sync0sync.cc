@@ -1253,6 +1253,8 @@ sync_thread_add_level(
 	case SYNC_FTS_CACHE:
 	case SYNC_FTS_CACHE_INIT:
 	case SYNC_LOG_ONLINE:
+	case SYNC_LOG_WRITE:
+	case SYNC_LOG_FLUSH:
 	case SYNC_LOG:
 	case SYNC_LOG_FLUSH_ORDER:
 	case SYNC_ANY_LATCH:
@@ -1260,6 +1262,7 @@ sync_thread_add_level(
 	case SYNC_DOUBLEWRITE:
 	case SYNC_THREADS:
 	case SYNC_LOCK_SYS:
+	case SYNC_LOCK_PARTITION:
 	case SYNC_LOCK_WAIT_SYS:
 	case SYNC_TRX_SYS:
 	case SYNC_IBUF_BITMAP_MUTEX:
@@ -45,6 +45,9 @@ Created 3/26/1996 Heikki Tuuri
 #include "os0thread.h"
 #include "srv0mon.h"
 #include "mtr0log.h"
+#include "dict0priv.h"
+
+#include <map>
 
 /** Maximum allowable purge history length.  <=0 means 'infinite'. */
 UNIV_INTERN ulong		srv_max_purge_lag = 0;
@@ -838,9 +841,7 @@ trx_purge_get_next_rec(
 	rec2 = rec;
 
 	for (;;) {
-		ulint		type;
 		trx_undo_rec_t*	next_rec;
-		ulint		cmpl_info;
 
 		/* Try first to find the next record which requires a purge
 		operation from the same page of the same undo log */
@@ -857,21 +858,7 @@ trx_purge_get_next_rec(
 
 		rec2 = next_rec;
 
-		type = trx_undo_rec_get_type(rec2);
-
-		if (type == TRX_UNDO_DEL_MARK_REC) {
-
-			break;
-		}
-
-		cmpl_info = trx_undo_rec_get_cmpl_info(rec2);
-
-		if (trx_undo_rec_get_extern_storage(rec2)) {
-			break;
-		}
-
-		if ((type == TRX_UNDO_UPD_EXIST_REC)
-		    && !(cmpl_info & UPD_NODE_NO_ORD_CHANGE)) {
+		if (trx_undo_rec_needs_purge(rec2)) {
 			break;
 		}
 	}
@@ -959,8 +946,107 @@ trx_purge_fetch_next_rec(
 	return(trx_purge_get_next_rec(n_pages_handled, heap));
 }
 
+/** Share of a purge batch that belongs to one table. All undo log
+records of a table in a batch go to the same purge node, so that the
+purge threads do not contend for the same index trees and pages. */
+struct trx_purge_table_t {
+	purge_node_t*	node;		/*!< purge node owning the table */
+	ulint		n_recs;		/*!< number of records handed to
+					the node */
+	ulint		n_pending;	/*!< number of those records that
+					are counted in
+					dict_table_t::purge_pending */
+};
+
+/** Tables of a purge batch, keyed by table id */
+typedef std::map<table_id_t, trx_purge_table_t> trx_purge_tables_t;
+
 /*******************************************************************//**
-This function runs a purge batch.
+Chooses the purge node with the fewest undo log records attached in this
+batch, for a table that has no purge node yet.
+@return	purge node */
+static
+purge_node_t*
+trx_purge_get_least_loaded_node(
+/*============================*/
+	ulint		n_purge_threads,/*!< in: number of purge threads */
+	trx_purge_t*	purge_sys)	/*!< in: purge instance */
+{
+	que_thr_t*	thr;
+	purge_node_t*	best = NULL;
+	ulint		best_n_recs = ULINT_UNDEFINED;
+	ulint		i = 0;
+
+	for (thr = UT_LIST_GET_FIRST(purge_sys->query->thrs);
+	     thr != NULL && i < n_purge_threads;
+	     thr = UT_LIST_GET_NEXT(thrs, thr), ++i) {
+
+		purge_node_t*	node = (purge_node_t*) thr->child;
+		ulint		n_recs;
+
+		n_recs = node->undo_recs == NULL
+			? 0 : ib_vector_size(node->undo_recs);
+
+		if (n_recs < best_n_recs) {
+			best = node;
+			best_n_recs = n_recs;
+
+			if (n_recs == 0) {
+				break;
+			}
+		}
+	}
+
+	ut_a(best != NULL);
+
+	return(best);
+}
+
+/*******************************************************************//**
+Accounts the undo log records of a purge batch in the purge statistics
+of the tables that are in the dictionary cache. */
+static
+void
+trx_purge_update_table_stats(
+/*=========================*/
+	const trx_purge_tables_t&	tables)	/*!< in: tables of the batch */
+{
+	if (tables.empty()) {
+		return;
+	}
+
+	mutex_enter(&dict_sys->mutex);
+
+	for (trx_purge_tables_t::const_iterator it = tables.begin();
+	     it != tables.end();
+	     ++it) {
+
+		dict_table_t*	table;
+
+		table = dict_table_open_on_id_low(
+			it->first, DICT_ERR_IGNORE_NONE, TRUE);
+
+		if (table == NULL) {
+			/* The table was dropped or evicted from the
+			cache, its statistics are gone with it. */
+			continue;
+		}
+
+		table->n_purged += it->second.n_recs;
+
+		if (it->second.n_pending > 0) {
+			dict_table_purge_pending_add(
+				table, -(lint) it->second.n_pending);
+		}
+	}
+
+	mutex_exit(&dict_sys->mutex);
+}
+
+/*******************************************************************//**
+Fetches the undo log records of a purge batch and attaches them to the
+purge nodes. The records of one table all go to the same node, and a table
+seen for the first time in the batch goes to the least loaded node.
 @return	number of undo log pages handled in the batch */
 static
 ulint
@@ -971,10 +1057,11 @@ trx_purge_attach_undo_recs(
 	purge_iter_t*	limit,		/*!< out: records read up to */
 	ulint		batch_size)	/*!< in: no. of pages to purge */
 {
-	que_thr_t*	thr;
-	ulint		i = 0;
-	ulint		n_pages_handled = 0;
-	ulint		n_thrs = UT_LIST_GET_LEN(purge_sys->query->thrs);
+	que_thr_t*		thr;
+	ulint			i = 0;
+	ulint			n_pages_handled = 0;
+	ulint			n_thrs = UT_LIST_GET_LEN(purge_sys->query->thrs);
+	trx_purge_tables_t	tables;
 
 	ut_a(n_purge_threads > 0);
 
@@ -1000,28 +1087,24 @@ trx_purge_attach_undo_recs(
 	/* There should never be fewer nodes than threads, the inverse
 	however is allowed because we only use purge threads as needed. */
 	ut_a(i == n_purge_threads);
-
-	/* Fetch and parse the UNDO records. The UNDO records are added
-	to a per purge node vector. */
-	thr = UT_LIST_GET_FIRST(purge_sys->query->thrs);
-	ut_a(n_thrs > 0 && thr != NULL);
+	ut_a(n_thrs > 0);
 
 	ut_ad(trx_purge_check_limit());
 
-	i = 0;
+	/* Fetch and parse the UNDO records. The UNDO records are added
+	to a per purge node vector. The copies of the records are made in
+	purge_sys->heap, because the purge node is only known once the
+	table id has been parsed. The heap is emptied at the start of the
+	next batch, after all purge threads have completed this one. */
 
 	for (;;) {
 		purge_node_t*		node;
-		trx_purge_rec_t*	purge_rec;
-
-		ut_a(!thr->is_active);
-
-		/* Get the purge node. */
-		node = (purge_node_t*) thr->child;
-		ut_a(que_node_get_type(node) == QUE_NODE_PURGE);
-
-		purge_rec = static_cast<trx_purge_rec_t*>(
-			mem_heap_zalloc(node->heap, sizeof(*purge_rec)));
+		trx_purge_rec_t		purge_rec;
+		ulint			type;
+		ulint			cmpl_info;
+		bool			updated_extern;
+		undo_no_t		undo_no;
+		table_id_t		table_id;
 
 		/* Track the max {trx_id, undo_no} for truncating the
 		UNDO logs once we have purged the records. */
@@ -1034,41 +1117,71 @@ trx_purge_attach_undo_recs(
 		}
 
 		/* Fetch the next record, and advance the purge_sys->iter. */
-		purge_rec->undo_rec = trx_purge_fetch_next_rec(
-			&purge_rec->roll_ptr, &n_pages_handled, node->heap);
-
-		if (purge_rec->undo_rec != NULL) {
-
-			if (node->undo_recs == NULL) {
-				node->undo_recs = ib_vector_create(
-					ib_heap_allocator_create(node->heap),
-					sizeof(trx_purge_rec_t),
-					batch_size);
-			} else {
-				ut_a(!ib_vector_is_empty(node->undo_recs));
-			}
-
-			ib_vector_push(node->undo_recs, purge_rec);
+		purge_rec.undo_rec = trx_purge_fetch_next_rec(
+			&purge_rec.roll_ptr, &n_pages_handled,
+			purge_sys->heap);
 
+		if (purge_rec.undo_rec == NULL) {
+			break;
+		} else if (purge_rec.undo_rec == &trx_purge_dummy_rec) {
+			/* The whole undo log needs no purge, there is
+			nothing to hand to the purge threads. */
 			if (n_pages_handled >= batch_size) {
-
 				break;
 			}
+
+			continue;
+		}
+
+		trx_undo_rec_get_pars(
+			purge_rec.undo_rec, &type, &cmpl_info,
+			&updated_extern, &undo_no, &table_id);
+
+		trx_purge_tables_t::iterator	it = tables.find(table_id);
+
+		if (it == tables.end()) {
+			trx_purge_table_t	purge_table;
+
+			purge_table.node = trx_purge_get_least_loaded_node(
+				n_purge_threads, purge_sys);
+			purge_table.n_recs = 0;
+			purge_table.n_pending = 0;
+
+			it = tables.insert(
+				trx_purge_tables_t::value_type(
+					table_id, purge_table)).first;
+		}
+
+		node = it->second.node;
+		ut_a(que_node_get_type(node) == QUE_NODE_PURGE);
+
+		if (node->undo_recs == NULL) {
+			node->undo_recs = ib_vector_create(
+				ib_heap_allocator_create(node->heap),
+				sizeof(trx_purge_rec_t),
+				batch_size);
 		} else {
-			break;
+			ut_a(!ib_vector_is_empty(node->undo_recs));
 		}
 
-		thr = UT_LIST_GET_NEXT(thrs, thr);
+		ib_vector_push(node->undo_recs, &purge_rec);
+
+		++it->second.n_recs;
 
-		if (!(++i % n_purge_threads)) {
-			thr = UT_LIST_GET_FIRST(purge_sys->query->thrs);
+		if (trx_undo_rec_needs_purge(purge_rec.undo_rec)) {
+			++it->second.n_pending;
 		}
 
-		ut_a(thr != NULL);
+		if (n_pages_handled >= batch_size) {
+
+			break;
+		}
 	}
 
 	ut_ad(trx_purge_check_limit());
 
+	trx_purge_update_table_stats(tables);
+
 	return(n_pages_handled);
 }
 
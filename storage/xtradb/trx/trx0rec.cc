@@ -275,6 +275,31 @@ trx_undo_page_report_insert(
 	return(trx_undo_page_set_next_prev_and_add(undo_page, ptr, mtr));
 }
 
+/**********************************************************************//**
+Determines if purge has to process an update undo log record, that is,
+if it delete-marks a record, changes an ordering field of a secondary
+index or frees an externally stored field.
+@return	true if purge has work to do for the record */
+UNIV_INTERN
+bool
+trx_undo_rec_needs_purge(
+/*=====================*/
+	const trx_undo_rec_t*	undo_rec)	/*!< in: update undo log
+						record */
+{
+	ulint	type = trx_undo_rec_get_type(undo_rec);
+
+	if (type == TRX_UNDO_DEL_MARK_REC
+	    || trx_undo_rec_get_extern_storage(undo_rec)) {
+
+		return(true);
+	}
+
+	return(type == TRX_UNDO_UPD_EXIST_REC
+	       && !(trx_undo_rec_get_cmpl_info(undo_rec)
+		    & UPD_NODE_NO_ORD_CHANGE));
+}
+
 /**********************************************************************//**
 Reads from an undo log record the general parameters.
 @return	remaining part of undo log record after reading these values */
@@ -1351,6 +1376,11 @@ trx_undo_report_row_operation(
 		} else {
 			/* Success */
 
+			if (op_type == TRX_UNDO_MODIFY_OP
+			    && trx_undo_rec_needs_purge(undo_page + offset)) {
+				dict_table_purge_pending_add(index->table, 1);
+			}
+
 			mtr_commit(&mtr);
 
 			undo->empty = FALSE;
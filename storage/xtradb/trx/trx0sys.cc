@@ -650,6 +650,7 @@ trx_sys_init_at_db_start(void)
 	trx_sys->descr_n_used = 0;
 	srv_descriptors_memory = TRX_DESCR_ARRAY_INITIAL_SIZE *
 		sizeof(trx_id_t);
+	trx_sys->serial_min_no = TRX_ID_MAX;
 
 	sys_header = trx_sysf_get(&mtr);
 
@@ -1314,12 +1315,11 @@ trx_sys_close(void)
 
 	mutex_enter(&trx_sys->mutex);
 
-	if (UT_LIST_GET_LEN(trx_sys->view_list) > 1) {
+	if (ulint n_open = read_view_count_open()) {
 		fprintf(stderr,
 			"InnoDB: Error: all read views were not closed"
 			" before shutdown:\n"
-			"InnoDB: %lu read views open \n",
-			UT_LIST_GET_LEN(trx_sys->view_list) - 1);
+			"InnoDB: %lu read views open \n", n_open);
 	}
 
 	mutex_exit(&trx_sys->mutex);
@@ -1376,6 +1376,10 @@ trx_sys_close(void)
 	ut_ad(trx_sys->descr_n_used == 0);
 	ut_free(trx_sys->descriptors);
 
+	for (i = 0; i < trx_sys->descr_n_retired; i++) {
+		ut_free(trx_sys->descr_retired[i]);
+	}
+
 	mem_free(trx_sys);
 
 	trx_sys = NULL;
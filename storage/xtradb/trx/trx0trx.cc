@@ -116,6 +116,20 @@ trx_descr_cmp(
 	return 0;
 }
 
+/*************************************************************//**
+Updates trx_sys->serial_min_no after trx_sys->trx_serial_list changed. */
+UNIV_INLINE
+void
+trx_sys_update_serial_min_no(void)
+/*==============================*/
+{
+	const trx_t*	first = UT_LIST_GET_FIRST(trx_sys->trx_serial_list);
+
+	ut_ad(mutex_own(&trx_sys->mutex));
+
+	trx_sys->serial_min_no = first != NULL ? first->no : TRX_ID_MAX;
+}
+
 /*************************************************************//**
 Reserve a slot for a given trx in the global descriptors array. */
 UNIV_INLINE
@@ -139,12 +153,21 @@ trx_reserve_descriptor(
 
 	if (UNIV_UNLIKELY(n_used > n_max)) {
 
+		trx_id_t*	old_descr = trx_sys->descriptors;
+
 		n_max = n_max * 2;
 
-		trx_sys->descriptors = static_cast<trx_id_t*>(
-			ut_realloc(trx_sys->descriptors,
-				   n_max * sizeof(trx_id_t)));
+		/* read_view_open_now() may be copying from the old array
+		right now, so it is kept until shutdown. */
+
+		ut_a(trx_sys->descr_n_retired < TRX_DESCR_N_RETIRED);
+		trx_sys->descr_retired[trx_sys->descr_n_retired++] = old_descr;
+
+		descr = static_cast<trx_id_t*>(
+			ut_malloc(n_max * sizeof(trx_id_t)));
+		memcpy(descr, old_descr, trx_sys->descr_n_max * sizeof *descr);
 
+		trx_sys->descriptors = descr;
 		trx_sys->descr_n_max = n_max;
 		srv_descriptors_memory = n_max * sizeof(trx_id_t);
 	}
@@ -174,6 +197,10 @@ trx_reserve_descriptor(
 
 	*descr = trx->id;
 
+	/* A read view that sees the new descr_n_used must also see the
+	array that is large enough for it. */
+	os_wmb_strict;
+
 	trx_sys->descr_n_used = n_used;
 }
 
@@ -190,31 +217,35 @@ trx_release_descriptor(
 
 	ut_ad(mutex_own(&trx_sys->mutex));
 
+	trx_sys_snapshot_change_start();
+
 	if (UNIV_LIKELY(trx->in_trx_serial_list)) {
 
 		UT_LIST_REMOVE(trx_serial_list, trx_sys->trx_serial_list,
 			       trx);
 		trx->in_trx_serial_list = false;
+
+		trx_sys_update_serial_min_no();
 	}
 
 	descr = trx_find_descriptor(trx_sys->descriptors,
 				    trx_sys->descr_n_used,
 				    trx->id);
 
-	if (UNIV_UNLIKELY(descr == NULL)) {
+	if (UNIV_LIKELY(descr != NULL)) {
 
-		return;
-	}
+		size = (trx_sys->descriptors + trx_sys->descr_n_used - 1
+			- descr) * sizeof(trx_id_t);
 
-	size = (trx_sys->descriptors + trx_sys->descr_n_used - 1 - descr) *
-		sizeof(trx_id_t);
+		if (UNIV_LIKELY(size > 0)) {
 
-	if (UNIV_LIKELY(size > 0)) {
+			ut_memmove(descr, descr + 1, size);
+		}
 
-		ut_memmove(descr, descr + 1, size);
+		trx_sys->descr_n_used--;
 	}
 
-	trx_sys->descr_n_used--;
+	trx_sys_snapshot_change_end();
 }
 
 /****************************************************************//**
@@ -1063,6 +1094,34 @@ trx_start_low(
 	ut_a(ib_vector_is_empty(trx->autoinc_locks));
 	ut_a(ib_vector_is_empty(trx->lock.table_locks));
 
+	ut_ad(!trx->in_rw_trx_list);
+	ut_ad(!trx->in_ro_trx_list);
+
+	if (trx_is_autocommit_non_locking(trx)) {
+
+		/* An auto-commit non-locking SELECT is not put on any
+		transaction list and its id is never written anywhere, so it
+		does not need trx_sys->mutex. The id is only used for
+		printouts and for the query cache check in
+		row_search_check_if_query_cache_permitted(), and the id
+		that the next transaction will get serves that as well as
+		a new one. It may become the id of another transaction, so
+		the read view of this one must not exclude it as its own;
+		see trx_assign_read_view(). Like in trx_commit_in_memory(),
+		the state change of such a transaction is not protected by
+		any mutex. */
+
+		trx->id = trx_sys_get_max_trx_id();
+
+		trx->state = TRX_STATE_ACTIVE;
+
+		trx->start_time = ut_time();
+
+		MONITOR_INC(MONITOR_TRX_ACTIVE);
+
+		return;
+	}
+
 	mutex_enter(&trx_sys->mutex);
 
 	/* If this transaction came from trx_allocate_for_mysql(),
@@ -1072,10 +1131,9 @@ trx_start_low(
 
 	trx->state = TRX_STATE_ACTIVE;
 
-	trx->id = trx_sys_get_new_trx_id();
+	trx_sys_snapshot_change_start();
 
-	ut_ad(!trx->in_rw_trx_list);
-	ut_ad(!trx->in_ro_trx_list);
+	trx->id = trx_sys_get_new_trx_id();
 
 	if (trx->read_only) {
 
@@ -1083,10 +1141,8 @@ trx_start_low(
 		be ordered, we should exploit this using a list type that
 		doesn't need a list wide lock to increase concurrency. */
 
-		if (!trx_is_autocommit_non_locking(trx)) {
-			UT_LIST_ADD_FIRST(trx_list, trx_sys->ro_trx_list, trx);
-			ut_d(trx->in_ro_trx_list = TRUE);
-		}
+		UT_LIST_ADD_FIRST(trx_list, trx_sys->ro_trx_list, trx);
+		ut_d(trx->in_ro_trx_list = TRUE);
 	} else {
 
 		ut_ad(trx->rseg != NULL
@@ -1105,6 +1161,8 @@ trx_start_low(
 		trx_reserve_descriptor(trx);
 	}
 
+	trx_sys_snapshot_change_end();
+
 	ut_ad(trx_sys_validate_trx_list());
 
 	mutex_exit(&trx_sys->mutex);
@@ -1130,6 +1188,8 @@ trx_serialisation_number_get(
 
 	mutex_enter(&trx_sys->mutex);
 
+	trx_sys_snapshot_change_start();
+
 	trx->no = trx_sys_get_new_trx_id();
 
 	if (UNIV_LIKELY(!trx->in_trx_serial_list)) {
@@ -1140,6 +1200,10 @@ trx_serialisation_number_get(
 		trx->in_trx_serial_list = true;
 	}
 
+	trx_sys_update_serial_min_no();
+
+	trx_sys_snapshot_change_end();
+
 	/* If the rollack segment is not empty then the
 	new trx_t::no can't be less than any trx_t::no
 	already in the rollback segment. User threads only
@@ -1419,7 +1483,7 @@ trx_commit_in_memory(
 
 		trx->state = TRX_STATE_NOT_STARTED;
 
-		read_view_remove(trx->global_read_view, false);
+		read_view_close(trx->global_read_view);
 
 		MONITOR_INC(MONITOR_TRX_NL_RO_COMMIT);
 	} else {
@@ -1454,13 +1518,11 @@ trx_commit_in_memory(
 
 		trx->state = TRX_STATE_NOT_STARTED;
 
-		/* We already own the trx_sys_t::mutex, by doing it here we
-		avoid a potential context switch later. */
-		read_view_remove(trx->global_read_view, true);
-
 		ut_ad(trx_sys_validate_trx_list());
 
 		mutex_exit(&trx_sys->mutex);
+
+		read_view_close(trx->global_read_view);
 	}
 
 	if (trx->global_read_view != NULL) {
@@ -1729,7 +1791,13 @@ trx_assign_read_view(
 		return(trx->read_view);
 	}
 
-	trx->read_view = read_view_open_now(trx->id, trx->prebuilt_view);
+	/* The id of an auto-commit non-locking transaction can be the id
+	of another transaction, see trx_start_low(). It does not modify
+	anything, so its view does not need to see its own changes. */
+
+	trx->read_view = read_view_open_now(
+		trx_is_autocommit_non_locking(trx) ? 0 : trx->id,
+		trx->prebuilt_view);
 	trx->global_read_view = trx->read_view;
 
 	return(trx->read_view);
@@ -1751,14 +1819,18 @@ trx_clone_read_view(
 	ut_ad(trx_mutex_own(from_trx));
 	ut_ad(trx->read_view == NULL);
 
-	if (from_trx->state != TRX_STATE_ACTIVE ||
-	    from_trx->read_view == NULL) {
+	read_view_t*	from_view = from_trx->read_view;
+
+	if (from_trx->state != TRX_STATE_ACTIVE
+	    || from_view == NULL
+	    || !read_view_pin(from_view)) {
 
 		return(NULL);
 	}
 
-	trx->read_view = read_view_clone(from_trx->read_view,
-					 trx->prebuilt_view);
+	trx->read_view = read_view_clone(from_view, trx->prebuilt_view);
+
+	read_view_unpin(from_view);
 
 	read_view_add(trx->read_view);
 
@@ -0,0 +1,151 @@
+#!/usr/bin/perl -w
+
+# Copyright (c) 2015, MariaDB
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; version 2 of the License.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+
+#
+# Update throughput with many connections, in the style of the sysbench
+# oltp update tests: every connection updates random rows of one table by
+# primary key, one row per autocommit transaction. The test is run for
+# each number of connections in --threads and the updates per second are
+# printed, which shows how the throughput scales with the connections.
+#
+# Example:  fork_update.pl --threads=1,8,16,32,64,128 --time=60
+#
+
+use DBI;
+use Getopt::Long;
+use Time::HiRes qw(time);
+
+$opt_host=$opt_user=$opt_password=""; $opt_db="test";
+$opt_threads="1,8,16,32,64";
+$opt_rows=100000;
+$opt_time=30;
+$opt_engine="InnoDB";
+$opt_index_updates=$opt_skip_create=$opt_skip_drop=0;
+
+GetOptions("host=s","db=s","user=s","password=s","threads=s","rows=i",
+	   "time=i","engine=s","index-updates","skip-create","skip-drop") ||
+  die "Aborted";
+
+$table="bench_update";
+
+if (!$opt_skip_create)
+{
+  $dbh=connect_db();
+  print "Creating table $table with $opt_rows rows\n";
+  $dbh->do("drop table if exists $table");
+  $dbh->do("create table $table (id int not null, k int not null," .
+	   " c char(120) not null, pad char(60) not null," .
+	   " primary key (id), key (k)) engine=$opt_engine") ||
+    die $DBI::errstr;
+  $dbh->do("begin");
+  for ($i=1 ; $i <= $opt_rows ; $i++)
+  {
+    $dbh->do("insert into $table values ($i, $i, '', '')") ||
+      die $DBI::errstr;
+    $dbh->do("commit; begin") if ($i % 1000 == 0);
+  }
+  $dbh->do("commit");
+  $dbh->disconnect;
+}
+
+$|= 1;
+print "threads  updates/s\n";
+
+foreach $threads (split(/,/, $opt_threads))
+{
+  pipe(READER, WRITER) || die "Can't create pipe: $!";
+  $start_time= time() + 1;
+  for ($i=0 ; $i < $threads ; $i++)
+  {
+    if (($pid=fork()) == 0)
+    {
+      close(READER);
+      test_update($start_time, $i);
+    }
+    die "Can't fork: $!" if (!defined($pid));
+  }
+  close(WRITER);
+
+  $updates=0;
+  while (<READER>)
+  {
+    $updates+= $_;
+  }
+  close(READER);
+
+  $errors=0;
+  while (($pid=wait()) != -1)
+  {
+    $errors++ if ($?);
+  }
+  die "$errors connections failed\n" if ($errors);
+  printf("%7d  %9.1f\n", $threads, $updates / $opt_time);
+}
+
+if (!$opt_skip_drop)
+{
+  $dbh=connect_db();
+  $dbh->do("drop table $table");
+  $dbh->disconnect;
+}
+exit(0);
+
+#
+# Update random rows until the time is up, and report the number of
+# updates to the parent process
+#
+
+sub test_update
+{
+  my ($start_time, $thread)= @_;
+  my ($dbh, $sth, $count, $end_time, $set);
+
+  srand($$);
+  $dbh=connect_db();
+  $set= $opt_index_updates ? "k=k+1" : "c=?";
+  $sth=$dbh->prepare("update $table set $set where id=?") ||
+    die $DBI::errstr;
+  $count=0;
+  select(undef, undef, undef, $start_time - time()) if (time() < $start_time);
+  $end_time= $start_time + $opt_time;
+  while (time() < $end_time)
+  {
+    my $id= int(rand($opt_rows)) + 1;
+    if ($opt_index_updates)
+    {
+      $sth->execute($id) || die $DBI::errstr;
+    }
+    else
+    {
+      $sth->execute("$thread-$count", $id) || die $DBI::errstr;
+    }
+    $count++;
+  }
+  $dbh->disconnect;
+  print WRITER "$count\n";
+  close(WRITER);
+  exit(0);
+}
+
+sub connect_db
+{
+  my $dbh= DBI->connect("DBI:mysql:$opt_db:$opt_host",
+			$opt_user, $opt_password,
+			{ PrintError => 0, AutoCommit => 1 }) ||
+    die $DBI::errstr;
+  return $dbh;
+}
@@ -0,0 +1,144 @@
+#!/usr/bin/perl -w
+
+# Copyright (c) 2015, MariaDB
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; version 2 of the License.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+
+#
+# Read-only throughput on a hot index root page: every connection does
+# primary key point selects on one small table, so that every lookup
+# starts from the same root page in the buffer pool. The test is run for
+# each number of connections in --threads and the selects per second are
+# printed, which shows how the buffer pool page lookup scales.
+#
+# Run the server with innodb_adaptive_hash_index=OFF, otherwise most of
+# the lookups never reach the root page.
+#
+# Example:  hot_root_select.pl --threads=1,8,16,32,64 --time=60
+#
+
+use DBI;
+use Getopt::Long;
+use Time::HiRes qw(time);
+
+$opt_host=$opt_user=$opt_password=""; $opt_db="test";
+$opt_threads="1,8,16,32,64";
+$opt_rows=1000;
+$opt_time=30;
+$opt_engine="InnoDB";
+$opt_skip_create=$opt_skip_drop=0;
+
+GetOptions("host=s","db=s","user=s","password=s","threads=s","rows=i",
+	   "time=i","engine=s","skip-create","skip-drop") ||
+  die "Aborted";
+
+$table="bench_hot_root";
+
+if (!$opt_skip_create)
+{
+  $dbh=connect_db();
+  print "Creating table $table with $opt_rows rows\n";
+  $dbh->do("drop table if exists $table");
+  $dbh->do("create table $table (id int not null, c char(120) not null," .
+	   " primary key (id)) engine=$opt_engine") ||
+    die $DBI::errstr;
+  $dbh->do("begin");
+  for ($i=1 ; $i <= $opt_rows ; $i++)
+  {
+    $dbh->do("insert into $table values ($i, '')") ||
+      die $DBI::errstr;
+  }
+  $dbh->do("commit");
+  $dbh->disconnect;
+}
+
+$|= 1;
+print "threads  selects/s\n";
+
+foreach $threads (split(/,/, $opt_threads))
+{
+  pipe(READER, WRITER) || die "Can't create pipe: $!";
+  $start_time= time() + 1;
+  for ($i=0 ; $i < $threads ; $i++)
+  {
+    if (($pid=fork()) == 0)
+    {
+      close(READER);
+      test_select($start_time);
+    }
+    die "Can't fork: $!" if (!defined($pid));
+  }
+  close(WRITER);
+
+  $selects=0;
+  while (<READER>)
+  {
+    $selects+= $_;
+  }
+  close(READER);
+
+  $errors=0;
+  while (($pid=wait()) != -1)
+  {
+    $errors++ if ($?);
+  }
+  die "$errors connections failed\n" if ($errors);
+  printf("%7d  %9.1f\n", $threads, $selects / $opt_time);
+}
+
+if (!$opt_skip_drop)
+{
+  $dbh=connect_db();
+  $dbh->do("drop table $table");
+  $dbh->disconnect;
+}
+exit(0);
+
+#
+# Select random rows until the time is up, and report the number of
+# selects to the parent process
+#
+
+sub test_select
+{
+  my ($start_time)= @_;
+  my ($dbh, $sth, $count, $end_time);
+
+  srand($$);
+  $dbh=connect_db();
+  $sth=$dbh->prepare("select c from $table where id=?") ||
+    die $DBI::errstr;
+  $count=0;
+  select(undef, undef, undef, $start_time - time()) if (time() < $start_time);
+  $end_time= $start_time + $opt_time;
+  while (time() < $end_time)
+  {
+    $sth->execute(int(rand($opt_rows)) + 1) || die $DBI::errstr;
+    $sth->fetchall_arrayref();
+    $count++;
+  }
+  $dbh->disconnect;
+  print WRITER "$count\n";
+  close(WRITER);
+  exit(0);
+}
+
+sub connect_db
+{
+  my $dbh= DBI->connect("DBI:mysql:$opt_db:$opt_host",
+			$opt_user, $opt_password,
+			{ PrintError => 0, AutoCommit => 1 }) ||
+    die $DBI::errstr;
+  return $dbh;
+}
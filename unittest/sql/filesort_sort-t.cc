@@ -0,0 +1,186 @@
+/* Copyright (c) 2015, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/**
+  Unit test and microbenchmark for radixsort_key_prefixes().
+
+  Without arguments the sort result is checked against my_qsort2() for
+  different key lengths and key distributions, and one sort of 1M keys
+  is timed. Numbers of keys given as arguments are timed instead, e.g.
+
+    filesort_sort-t 1000000 10000000 100000000
+*/
+
+#include <my_global.h>
+#include <my_sys.h>
+#include <tap.h>
+#include "filesort_utils.h"
+
+enum key_distribution
+{
+  KEYS_RANDOM,      // Random bytes
+  KEYS_FEW_VALUES,  // Many duplicates
+  KEYS_COMMON_HEAD  // Keys differ only after the 8 byte prefix
+};
+
+static const char *distribution_name[]=
+{ "random", "few values", "common head" };
+
+static ulonglong rnd_state= 1;
+
+static uint rnd()
+{
+  rnd_state= rnd_state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return (uint) (rnd_state >> 33);
+}
+
+
+static uchar *make_keys(size_t count, size_t key_length,
+                        key_distribution distribution)
+{
+  uchar *data= (uchar*) my_malloc(count * key_length, MYF(MY_WME));
+  if (!data)
+    return NULL;
+  for (size_t i= 0; i < count; i++)
+  {
+    uchar *key= data + i * key_length;
+    for (size_t j= 0; j < key_length; j++)
+    {
+      switch (distribution) {
+      case KEYS_RANDOM:
+        key[j]= (uchar) rnd();
+        break;
+      case KEYS_FEW_VALUES:
+        key[j]= (uchar) (rnd() % 3);
+        break;
+      case KEYS_COMMON_HEAD:
+        key[j]= j < 8 ? 'a' : (uchar) rnd();
+        break;
+      }
+    }
+  }
+  return data;
+}
+
+
+static void fill_pointers(uchar **keys, uchar *data, size_t count,
+                          size_t key_length)
+{
+  for (size_t i= 0; i < count; i++)
+    keys[i]= data + i * key_length;
+}
+
+
+/**
+  Sort the same keys with my_qsort2() and radixsort_key_prefixes() and
+  check that both give the same sequence of key values.
+*/
+static void test_sort(size_t count, size_t key_length,
+                      key_distribution distribution, uint threads)
+{
+  uchar *data= make_keys(count, key_length, distribution);
+  uchar **expected= (uchar**) my_malloc(count * sizeof(uchar*), MYF(MY_WME));
+  uchar **keys= (uchar**) my_malloc(count * sizeof(uchar*), MYF(MY_WME));
+  bool error= !data || !expected || !keys;
+
+  if (!error)
+  {
+    fill_pointers(expected, data, count, key_length);
+    fill_pointers(keys, data, count, key_length);
+    my_qsort2(expected, count, sizeof(uchar*), get_ptr_compare(key_length),
+              &key_length);
+    error= radixsort_key_prefixes(keys, count, key_length, threads);
+    for (size_t i= 0; !error && i < count; i++)
+      error= memcmp(keys[i], expected[i], key_length) != 0;
+  }
+  ok(!error, "%lu keys of length %lu, %s, %u threads",
+     (ulong) count, (ulong) key_length, distribution_name[distribution],
+     threads);
+
+  my_free(keys);
+  my_free(expected);
+  my_free(data);
+}
+
+
+static void time_sort(size_t count)
+{
+  const size_t key_length= 16;
+  uchar *data= make_keys(count, key_length, KEYS_RANDOM);
+  uchar **keys= (uchar**) my_malloc(count * sizeof(uchar*), MYF(MY_WME));
+  ulonglong start, qsort_time, radix_time, parallel_time;
+
+  if (!data || !keys)
+  {
+    ok(0, "could not allocate %lu keys", (ulong) count);
+    my_free(keys);
+    my_free(data);
+    return;
+  }
+
+  fill_pointers(keys, data, count, key_length);
+  start= my_interval_timer();
+  my_qsort2(keys, count, sizeof(uchar*), get_ptr_compare(key_length),
+            (void*) &key_length);
+  qsort_time= my_interval_timer() - start;
+
+  fill_pointers(keys, data, count, key_length);
+  start= my_interval_timer();
+  radixsort_key_prefixes(keys, count, key_length, 1);
+  radix_time= my_interval_timer() - start;
+
+  fill_pointers(keys, data, count, key_length);
+  start= my_interval_timer();
+  radixsort_key_prefixes(keys, count, key_length, 4);
+  parallel_time= my_interval_timer() - start;
+
+  ok(1, "%lu keys: my_qsort2 %llu ms, radix %llu ms, radix 4 threads %llu ms",
+     (ulong) count, qsort_time / 1000000, radix_time / 1000000,
+     parallel_time / 1000000);
+
+  my_free(keys);
+  my_free(data);
+}
+
+
+int main(int argc, char **argv)
+{
+  static const size_t key_lengths[]= { 3, 8, 13, 40 };
+  static const size_t counts[]= { 2, 100, 5000 };
+  MY_INIT(argv[0]);
+
+  if (argc > 1)
+  {
+    plan(argc - 1);
+    for (int i= 1; i < argc; i++)
+      time_sort((size_t) strtoull(argv[i], NULL, 10));
+    my_end(0);
+    return exit_status();
+  }
+
+  plan(array_elements(key_lengths) * array_elements(counts) * 3 + 3 + 1);
+  for (uint l= 0; l < array_elements(key_lengths); l++)
+    for (uint c= 0; c < array_elements(counts); c++)
+      for (uint d= KEYS_RANDOM; d <= KEYS_COMMON_HEAD; d++)
+        test_sort(counts[c], key_lengths[l], (key_distribution) d, 1);
+
+  for (uint d= KEYS_RANDOM; d <= KEYS_COMMON_HEAD; d++)
+    test_sort(300000, 20, (key_distribution) d, 4);
+
+  time_sort(1000000);
+
+  my_end(0);
+  return exit_status();
+}
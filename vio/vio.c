@@ -241,6 +241,52 @@ my_bool vio_reset(Vio* vio, enum enum_vio_type type,
 }
 
 
+/**
+  Turn on buffered reads for an open socket-based Vio object.
+
+  @remark Data that is read into vio->read_buffer by other means, for
+          example by an asynchronous read, is passed to the Vio object
+          with vio_buff_fill().
+
+  @return FALSE if the reads are buffered, TRUE if the transport type
+          does not support it or the buffer could not be allocated.
+*/
+
+my_bool vio_buff_enable(Vio *vio)
+{
+  DBUG_ENTER("vio_buff_enable");
+#ifdef HAVE_VIO_READ_BUFF
+  if (vio->read == vio_read_buff)
+    DBUG_RETURN(FALSE);
+  if ((vio->type == VIO_TYPE_TCPIP || vio->type == VIO_TYPE_SOCKET) &&
+      (vio->read_buffer= (char*) my_malloc(VIO_READ_BUFFER_SIZE, MYF(MY_WME))))
+  {
+    vio->read_pos= vio->read_end= vio->read_buffer;
+    vio->read= vio_read_buff;
+    vio->has_data= vio_buff_has_data;
+    DBUG_RETURN(FALSE);
+  }
+#endif
+  DBUG_RETURN(TRUE);
+}
+
+
+/**
+  Pass data that was read into vio->read_buffer to the Vio object.
+
+  @param vio     A Vio object with buffered reads and an empty buffer.
+  @param length  Number of bytes that were read into the buffer.
+*/
+
+void vio_buff_fill(Vio *vio, size_t length)
+{
+  DBUG_ASSERT(vio->read_buffer && vio->read_pos == vio->read_end);
+  DBUG_ASSERT(length <= VIO_READ_BUFFER_SIZE);
+  vio->read_pos= vio->read_buffer;
+  vio->read_end= vio->read_buffer + length;
+}
+
+
 /* Create a new VIO for socket or TCP/IP connection. */
 
 Vio *mysql_socket_vio_new(MYSQL_SOCKET mysql_socket, enum enum_vio_type type, uint flags)